@@ -0,0 +1,990 @@
+// 루프백 HTTP 부하 테스트: 시나리오마다 webserv를 새로 띄우고 이벤트 기반 부하 생성기로 측정
+//
+// 사용법: ./bench/http_load [옵션] [시나리오 ...]
+//   --server PATH      webserv 실행 파일 (기본 ./webserv)
+//   --port N           루프백 포트 (기본 18080)
+//   --duration SEC     시나리오마다 측정 시간 (기본 5초)
+//   --out FILE         결과 JSON (기본 bench/results.json)
+//   --compare FILE     기준 JSON과 비교해 회귀가 있으면 종료 코드 1
+//   --threshold PCT    회귀로 보지 않는 변화 폭 (기본 10%)
+//   --list             시나리오 목록
+//
+// 시나리오 이름을 주면 그 시나리오만 실행. 저장소 루트에서 실행해야 함 (www/를 root로 씀).
+// 측정값: 처리량(요청/초, MB/초), 지연 p50/p99/p999, 서버 RSS와 CPU (/proc), 부하 생성기 CPU.
+// 결과는 빌드 설정에 따라 크게 달라지므로 비교는 같은 빌드(make release 권장)끼리 할 것.
+
+#include "metrics/LatencyHistogram.hpp"
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <time.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+enum Mode {
+	MODE_KEEPALIVE,		// 연결마다 요청 하나씩 주고받음
+	MODE_PIPELINE,		// 연결마다 pipeline개를 응답을 기다리지 않고 보냄
+	MODE_CONNECT		// 요청마다 새 연결 (응답을 받으면 RST로 닫아 TIME_WAIT를 남기지 않음)
+};
+
+enum Body {
+	BODY_NONE,
+	BODY_CHUNKED,		// 16KB raw 바디를 4KB chunk로
+	BODY_MULTIPART		// 64KB 파일 하나 (같은 파일명이라 업로드 디렉터리가 커지지 않음)
+};
+
+struct Scenario {
+	const char*	name;
+	Mode		mode;
+	int			connections;
+	int			pipeline;
+	const char*	method;
+	const char*	path;		// 끝이 '#'이면 요청마다 다른 번호로 바꿈 (404 storm)
+	Body		body;
+	int			expect;		// 기대하는 status (다르면 errors)
+	int			idle;		// 측정 동안 열어 두는 keep-alive 유휴 연결 수
+};
+
+static const Scenario SCENARIOS[] = {
+	{ "static_small",          MODE_KEEPALIVE, 32,  1, "GET",  "/index.html",       BODY_NONE,      200, 0 },
+	{ "static_small_pipeline", MODE_PIPELINE,  8,  16, "GET",  "/index.html",       BODY_NONE,      200, 0 },
+	{ "static_small_connect",  MODE_CONNECT,   32,  1, "GET",  "/index.html",       BODY_NONE,      200, 0 },
+	{ "static_large",          MODE_KEEPALIVE, 8,   1, "GET",  "/data/webserv.pdf", BODY_NONE,      200, 0 },
+	{ "autoindex",             MODE_KEEPALIVE, 16,  1, "GET",  "/data/",            BODY_NONE,      200, 0 },
+	{ "upload_chunked",        MODE_KEEPALIVE, 8,   1, "POST", "/upload/",          BODY_CHUNKED,   201, 0 },
+	{ "upload_multipart",      MODE_KEEPALIVE, 8,   1, "POST", "/upload/",          BODY_MULTIPART, 201, 0 },
+	{ "cgi_hello",             MODE_KEEPALIVE, 8,   1, "GET",  "/hello.py",         BODY_NONE,      200, 0 },
+	{ "not_found_storm",       MODE_KEEPALIVE, 64,  1, "GET",  "/missing/#",        BODY_NONE,      404, 0 },
+	{ "idle_keepalive_10k",    MODE_KEEPALIVE, 16,  1, "GET",  "/index.html",       BODY_NONE,      200, 10000 }
+};
+static const size_t SCENARIO_COUNT = sizeof(SCENARIOS) / sizeof(SCENARIOS[0]);
+
+static const size_t	READ_SIZE = 64 * 1024;
+static const int	MAX_CONNECTING = 256;		// 유휴 연결을 열 때 한 번에 connect 중인 수 (backlog 넘침 방지)
+static const double	SETUP_TIMEOUT = 20.0;		// 서버 시작, 유휴 연결 준비 제한 (초)
+
+struct Options {
+	std::string			server;
+	int					port;
+	double				duration;
+	std::string			out;
+	std::string			compare;
+	double				threshold;
+	std::vector<std::string>	only;
+
+	Options() : server("./webserv"), port(18080), duration(5), out("bench/results.json"), threshold(10) {}
+};
+
+struct Result {
+	std::string			name;
+	Mode				mode;
+	int					connections;
+	int					pipeline;
+	int					idle;
+	unsigned long long	requests;
+	unsigned long long	errors;
+	unsigned long long	bytes;
+	double				seconds;
+	LatencyHistogram	latency;
+	long				rssKb;
+	long				peakRssKb;
+	double				serverCpu;	// 코어 하나 기준 %
+	double				clientCpu;
+
+	Result() : mode(MODE_KEEPALIVE), connections(0), pipeline(0), idle(0), requests(0), errors(0), bytes(0),
+			   seconds(0), rssKb(0), peakRssKb(0), serverCpu(0), clientCpu(0) {}
+};
+
+static long long nowUs() {
+	struct timespec ts;
+	::clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+static const char* modeName(Mode mode) {
+	return mode == MODE_PIPELINE ? "pipeline" : mode == MODE_CONNECT ? "connect" : "keepalive";
+}
+
+// =========================================================================
+// 서버 프로세스
+// =========================================================================
+
+static std::string g_workDir;	// 설정 파일, 업로드 디렉터리, 서버 로그
+
+static bool writeConfig(const std::string& path, int port) {
+	char cwd[4096];
+	if (::getcwd(cwd, sizeof(cwd)) == NULL) {
+		return false;
+	}
+	std::string root(cwd);
+	std::ofstream conf(path.c_str());
+	conf << "http {\n"
+		 << "    client_max_body_size 100M;\n"
+		 << "    server {\n"
+		 << "        listen 127.0.0.1:" << port << ";\n"
+		 << "        server_name localhost;\n"
+		 << "        location / {\n"
+		 << "            root " << root << "/www/html;\n"
+		 << "            index index.html;\n"
+		 << "        }\n"
+		 << "        location /data/ {\n"
+		 << "            root " << root << "/www;\n"
+		 << "            autoindex on;\n"
+		 << "        }\n"
+		 << "        location /upload/ {\n"
+		 << "            root " << g_workDir << ";\n"
+		 << "            limit_except POST {\n"
+		 << "                deny all;\n"
+		 << "            }\n"
+		 << "        }\n"
+		 << "        location .py {\n"
+		 << "            root " << root << "/www/cgi-bin;\n"
+		 << "            cgi_pass /usr/bin/python3;\n"
+		 << "        }\n"
+		 << "    }\n"
+		 << "}\n";
+	return conf.good();
+}
+
+static void removeUploads() {
+	std::string dirPath = g_workDir + "/upload";
+	DIR* dir = ::opendir(dirPath.c_str());
+	if (dir == NULL) {
+		return;
+	}
+	struct dirent* entry;
+	while ((entry = ::readdir(dir)) != NULL) {
+		if (std::strcmp(entry->d_name, ".") != 0 && std::strcmp(entry->d_name, "..") != 0) {
+			::unlink((dirPath + "/" + entry->d_name).c_str());
+		}
+	}
+	::closedir(dir);
+}
+
+static bool canConnect(int port) {
+	int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+	struct sockaddr_in addr;
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	bool ok = ::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0;
+	::close(fd);
+	return ok;
+}
+
+static pid_t startServer(const Options& options, const std::string& config) {
+	if (canConnect(options.port)) {
+		std::fprintf(stderr, "port %d is already in use\n", options.port);
+		return -1;
+	}
+	std::string logPath = g_workDir + "/server.log";
+	pid_t pid = ::fork();
+	if (pid == 0) {
+		int log = ::open(logPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (log != -1) {
+			::dup2(log, STDOUT_FILENO);
+			::dup2(log, STDERR_FILENO);
+			::close(log);
+		}
+		::execl(options.server.c_str(), options.server.c_str(), config.c_str(), static_cast<char*>(NULL));
+		::_exit(127);
+	}
+	if (pid == -1) {
+		std::perror("fork");
+		return -1;
+	}
+
+	long long deadline = nowUs() + static_cast<long long>(SETUP_TIMEOUT * 1000000);
+	while (nowUs() < deadline) {
+		if (::waitpid(pid, NULL, WNOHANG) == pid) {
+			std::fprintf(stderr, "webserv exited during startup (see %s)\n", logPath.c_str());
+			return -1;
+		}
+		if (canConnect(options.port)) {
+			return pid;
+		}
+		::usleep(20000);
+	}
+	std::fprintf(stderr, "webserv did not start listening on port %d\n", options.port);
+	::kill(pid, SIGKILL);
+	::waitpid(pid, NULL, 0);
+	return -1;
+}
+
+static void stopServer(pid_t pid) {
+	::kill(pid, SIGTERM);
+	for (int i = 0; i < 100; ++i) {
+		if (::waitpid(pid, NULL, WNOHANG) == pid) {
+			return;
+		}
+		::usleep(20000);
+	}
+	::kill(pid, SIGKILL);
+	::waitpid(pid, NULL, 0);
+}
+
+// utime + stime (clock tick)
+static unsigned long long processTicks(pid_t pid) {
+	char path[64];
+	std::snprintf(path, sizeof(path), "/proc/%d/stat", static_cast<int>(pid));
+	std::ifstream file(path);
+	std::string stat;
+	std::getline(file, stat);
+
+	// comm에 공백이 있을 수 있으므로 마지막 ')' 뒤부터 셈 (state가 3번째 필드)
+	size_t pos = stat.rfind(')');
+	if (pos == std::string::npos) {
+		return 0;
+	}
+	std::istringstream fields(stat.substr(pos + 2));
+	std::string field;
+	unsigned long long utime = 0;
+	unsigned long long stime = 0;
+	for (int i = 3; i <= 15 && fields >> field; ++i) {
+		if (i == 14) {
+			utime = std::strtoull(field.c_str(), NULL, 10);
+		} else if (i == 15) {
+			stime = std::strtoull(field.c_str(), NULL, 10);
+		}
+	}
+	return utime + stime;
+}
+
+static long statusField(pid_t pid, const char* name) {
+	char path[64];
+	std::snprintf(path, sizeof(path), "/proc/%d/status", static_cast<int>(pid));
+	std::ifstream file(path);
+	std::string line;
+	size_t len = std::strlen(name);
+	while (std::getline(file, line)) {
+		if (line.compare(0, len, name) == 0 && line.size() > len && line[len] == ':') {
+			return std::atol(line.c_str() + len + 1);
+		}
+	}
+	return 0;
+}
+
+static double clientSeconds() {
+	struct rusage usage;
+	::getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+		+ (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000000.0;
+}
+
+// =========================================================================
+// 부하 생성기
+// =========================================================================
+
+struct Connection {
+	enum Parse { PARSE_HEAD, PARSE_BODY, PARSE_CHUNK_SIZE, PARSE_CHUNK_DATA, PARSE_TRAILER, PARSE_UNTIL_CLOSE };
+
+	int						fd;
+	bool					connecting;
+	bool					idle;		// 유휴 연결: 요청 하나를 받은 뒤 아무것도 보내지 않음
+	std::string				out;
+	size_t					outOffset;
+	std::deque<long long>	sentAt;		// 응답을 기다리는 요청을 보낸 시각
+	std::string				in;
+	Parse					parse;
+	size_t					remaining;
+	int						status;
+	bool					head;		// 응답 바디 없음 (HEAD)
+
+	Connection() : fd(-1), connecting(false), idle(false), outOffset(0), parse(PARSE_HEAD), remaining(0),
+				   status(0), head(false) {}
+};
+
+class LoadGenerator {
+public:
+	LoadGenerator(const Options& options, const Scenario& scenario, Result& result)
+		: _options(options), _scenario(scenario), _result(result), _epoll(-1), _sequence(0),
+		  _measuring(false), _stopping(false), _idleReady(0) {
+		_epoll = ::epoll_create(1024);
+		buildBody();
+	}
+
+	~LoadGenerator() {
+		for (size_t i = 0; i < _connections.size(); ++i) {
+			closeConnection(_connections[i]);
+			delete _connections[i];
+		}
+		::close(_epoll);
+	}
+
+	// 유휴 연결을 모두 열고 요청 하나씩 주고받을 때까지 기다림
+	bool prepareIdle() {
+		int opened = 0;
+		long long deadline = nowUs() + static_cast<long long>(SETUP_TIMEOUT * 1000000);
+
+		while (_idleReady < _scenario.idle && nowUs() < deadline) {
+			while (opened < _scenario.idle && opened - _idleReady < MAX_CONNECTING) {
+				Connection* conn = new Connection();
+				conn->idle = true;
+				_connections.push_back(conn);
+				if (!openConnection(conn)) {
+					return false;
+				}
+				++opened;
+			}
+			poll(10);
+		}
+		if (_idleReady < _scenario.idle) {
+			std::fprintf(stderr, "%s: only %d of %d idle connections ready\n",
+						 _scenario.name, _idleReady, _scenario.idle);
+			return false;
+		}
+		return true;
+	}
+
+	void run(double seconds) {
+		_measuring = true;
+		for (int i = 0; i < _scenario.connections; ++i) {
+			Connection* conn = new Connection();
+			_connections.push_back(conn);
+			openConnection(conn);
+		}
+		long long start = nowUs();
+		long long end = start + static_cast<long long>(seconds * 1000000);
+		while (nowUs() < end) {
+			poll(static_cast<int>((end - nowUs()) / 1000) + 1);
+		}
+		_result.seconds = (nowUs() - start) / 1000000.0;
+		_stopping = true;
+	}
+
+private:
+	const Options&			_options;
+	const Scenario&			_scenario;
+	Result&					_result;
+	int						_epoll;
+	std::vector<Connection*>	_connections;
+	std::string				_body;			// 업로드 바디 (chunked는 인코딩까지 한 것)
+	std::string				_bodyHeaders;
+	unsigned long long		_sequence;
+	bool					_measuring;
+	bool					_stopping;
+	int						_idleReady;
+
+	void buildBody() {
+		if (_scenario.body == BODY_CHUNKED) {
+			std::string chunk(4096, 'x');
+			for (int i = 0; i < 4; ++i) {
+				_body += "1000\r\n" + chunk + "\r\n";
+			}
+			_body += "0\r\n\r\n";
+			_bodyHeaders = "Content-Type: application/octet-stream\r\nTransfer-Encoding: chunked\r\n";
+		} else if (_scenario.body == BODY_MULTIPART) {
+			const char* boundary = "----webservbench";
+			_body = std::string("--") + boundary + "\r\n"
+				+ "Content-Disposition: form-data; name=\"file\"; filename=\"bench.bin\"\r\n"
+				+ "Content-Type: application/octet-stream\r\n\r\n"
+				+ std::string(64 * 1024, 'y') + "\r\n"
+				+ "--" + boundary + "--\r\n";
+			std::ostringstream headers;
+			headers << "Content-Type: multipart/form-data; boundary=" << boundary << "\r\n"
+					<< "Content-Length: " << _body.size() << "\r\n";
+			_bodyHeaders = headers.str();
+		}
+	}
+
+	void appendRequest(Connection* conn) {
+		std::string path = _scenario.path;
+		if (!path.empty() && path[path.size() - 1] == '#') {
+			std::ostringstream number;
+			number << _sequence;
+			path.replace(path.size() - 1, 1, number.str());
+		}
+		++_sequence;
+
+		const char* method = conn->idle ? "GET" : _scenario.method;
+		conn->out += std::string(method) + " " + (conn->idle ? std::string("/index.html") : path)
+			+ " HTTP/1.1\r\nHost: localhost\r\nUser-Agent: webserv-bench\r\n";
+		if (!conn->idle && _scenario.body != BODY_NONE) {
+			conn->out += _bodyHeaders + "\r\n" + _body;
+		} else {
+			conn->out += "\r\n";
+		}
+		conn->sentAt.push_back(nowUs());
+	}
+
+	bool openConnection(Connection* conn) {
+		conn->fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+		if (conn->fd == -1) {
+			std::perror("socket");
+			return false;
+		}
+		int one = 1;
+		::setsockopt(conn->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+		struct sockaddr_in addr;
+		std::memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(_options.port);
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		if (::connect(conn->fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == -1
+			&& errno != EINPROGRESS) {
+			::close(conn->fd);
+			conn->fd = -1;
+			++_result.errors;
+			return false;
+		}
+		conn->connecting = true;
+		conn->out.clear();
+		conn->outOffset = 0;
+		conn->sentAt.clear();
+		conn->in.clear();
+		conn->parse = Connection::PARSE_HEAD;
+
+		int depth = conn->idle ? 1 : _scenario.pipeline;
+		for (int i = 0; i < depth; ++i) {
+			appendRequest(conn);
+		}
+		struct epoll_event event;
+		event.events = EPOLLIN | EPOLLOUT;
+		event.data.ptr = conn;
+		::epoll_ctl(_epoll, EPOLL_CTL_ADD, conn->fd, &event);
+		return true;
+	}
+
+	// RST로 닫음 (클라이언트가 먼저 닫아도 TIME_WAIT가 남지 않아 포트가 모자라지 않음)
+	void closeConnection(Connection* conn) {
+		if (conn->fd == -1) {
+			return;
+		}
+		struct linger linger;
+		linger.l_onoff = 1;
+		linger.l_linger = 0;
+		::setsockopt(conn->fd, SOL_SOCKET, SO_LINGER, &linger, sizeof(linger));
+		::close(conn->fd);
+		conn->fd = -1;
+	}
+
+	void reconnect(Connection* conn) {
+		closeConnection(conn);
+		if (!_stopping && !conn->idle) {
+			openConnection(conn);
+		}
+	}
+
+	void updateEvents(Connection* conn) {
+		struct epoll_event event;
+		event.events = EPOLLIN;
+		if (conn->outOffset < conn->out.size()) {
+			event.events |= EPOLLOUT;
+		}
+		event.data.ptr = conn;
+		::epoll_ctl(_epoll, EPOLL_CTL_MOD, conn->fd, &event);
+	}
+
+	void poll(int timeoutMs) {
+		struct epoll_event events[256];
+		int count = ::epoll_wait(_epoll, events, 256, timeoutMs);
+		for (int i = 0; i < count; ++i) {
+			Connection* conn = static_cast<Connection*>(events[i].data.ptr);
+			if (conn->fd == -1) {
+				continue;
+			}
+			if (events[i].events & (EPOLLOUT | EPOLLERR)) {
+				if (!onWritable(conn)) {
+					continue;
+				}
+			}
+			if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+				onReadable(conn);
+			}
+		}
+	}
+
+	bool onWritable(Connection* conn) {
+		if (conn->connecting) {
+			int error = 0;
+			socklen_t len = sizeof(error);
+			::getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, &error, &len);
+			if (error != 0) {
+				countError(conn);
+				reconnect(conn);
+				return false;
+			}
+			conn->connecting = false;
+		}
+		while (conn->outOffset < conn->out.size()) {
+			ssize_t n = ::send(conn->fd, conn->out.data() + conn->outOffset, conn->out.size() - conn->outOffset,
+							   MSG_NOSIGNAL);
+			if (n <= 0) {
+				if (n < 0 && errno == EAGAIN) {
+					break;
+				}
+				countError(conn);
+				reconnect(conn);
+				return false;
+			}
+			conn->outOffset += n;
+		}
+		if (conn->outOffset == conn->out.size()) {
+			conn->out.clear();
+			conn->outOffset = 0;
+		}
+		updateEvents(conn);
+		return true;
+	}
+
+	void onReadable(Connection* conn) {
+		char buffer[READ_SIZE];
+		ssize_t n = ::recv(conn->fd, buffer, sizeof(buffer), 0);
+		if (n < 0 && errno == EAGAIN) {
+			return;
+		}
+		if (n <= 0) {
+			// 길이 없이 닫힐 때까지 오는 바디는 여기서 끝남
+			if (n == 0 && conn->parse == Connection::PARSE_UNTIL_CLOSE) {
+				completeResponse(conn);
+			} else if (!conn->sentAt.empty()) {
+				countError(conn);
+			}
+			reconnect(conn);
+			return;
+		}
+		if (_measuring) {
+			_result.bytes += n;
+		}
+		conn->in.append(buffer, n);
+		if (!parseInput(conn)) {
+			reconnect(conn);
+		}
+	}
+
+	// 받은 만큼 응답을 읽음. false면 연결을 다시 열어야 함
+	bool parseInput(Connection* conn) {
+		size_t offset = 0;
+		std::string& in = conn->in;
+
+		while (offset < in.size()) {
+			if (conn->parse == Connection::PARSE_HEAD) {
+				size_t end = in.find("\r\n\r\n", offset);
+				if (end == std::string::npos) {
+					break;
+				}
+				if (!parseHead(conn, in.substr(offset, end - offset))) {
+					countError(conn);
+					return false;
+				}
+				offset = end + 4;
+			} else if (conn->parse == Connection::PARSE_BODY || conn->parse == Connection::PARSE_CHUNK_DATA) {
+				size_t take = std::min(conn->remaining, in.size() - offset);
+				conn->remaining -= take;
+				offset += take;
+				if (conn->remaining > 0) {
+					break;
+				}
+				if (conn->parse == Connection::PARSE_CHUNK_DATA) {
+					conn->parse = Connection::PARSE_CHUNK_SIZE;
+				} else if (!completeResponse(conn)) {
+					return false;
+				}
+			} else if (conn->parse == Connection::PARSE_CHUNK_SIZE) {
+				size_t end = in.find("\r\n", offset);
+				if (end == std::string::npos) {
+					break;
+				}
+				size_t size = std::strtoul(in.c_str() + offset, NULL, 16);
+				offset = end + 2;
+				if (size == 0) {
+					conn->parse = Connection::PARSE_TRAILER;
+				} else {
+					conn->remaining = size + 2;
+					conn->parse = Connection::PARSE_CHUNK_DATA;
+				}
+			} else if (conn->parse == Connection::PARSE_TRAILER) {
+				size_t end = in.find("\r\n", offset);
+				if (end == std::string::npos) {
+					break;
+				}
+				bool last = (end == offset);
+				offset = end + 2;
+				if (last && !completeResponse(conn)) {
+					return false;
+				}
+			} else {
+				offset = in.size();		// PARSE_UNTIL_CLOSE
+			}
+		}
+		in.erase(0, offset);
+		return true;
+	}
+
+	bool parseHead(Connection* conn, const std::string& head) {
+		if (head.compare(0, 5, "HTTP/") != 0 || head.size() < 12) {
+			return false;
+		}
+		conn->status = std::atoi(head.c_str() + 9);
+
+		bool chunked = false;
+		bool hasLength = false;
+		size_t length = 0;
+		std::string lower(head);
+		for (size_t i = 0; i < lower.size(); ++i) {
+			lower[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(lower[i])));
+		}
+		size_t pos = lower.find("\r\ncontent-length:");
+		if (pos != std::string::npos) {
+			hasLength = true;
+			length = std::strtoul(lower.c_str() + pos + 17, NULL, 10);
+		}
+		pos = lower.find("\r\ntransfer-encoding:");
+		if (pos != std::string::npos && lower.find("chunked", pos) < lower.find("\r\n", pos + 2)) {
+			chunked = true;
+		}
+
+		if (conn->status == 204 || conn->status == 304 || conn->status / 100 == 1) {
+			conn->remaining = 0;
+			conn->parse = Connection::PARSE_BODY;
+		} else if (chunked) {
+			conn->parse = Connection::PARSE_CHUNK_SIZE;
+		} else if (hasLength) {
+			conn->remaining = length;
+			conn->parse = Connection::PARSE_BODY;
+		} else {
+			conn->parse = Connection::PARSE_UNTIL_CLOSE;
+		}
+		if (conn->parse == Connection::PARSE_BODY && conn->remaining == 0) {
+			return completeResponse(conn);
+		}
+		return true;
+	}
+
+	// 응답 하나를 다 받음. false면 연결을 다시 열어야 함
+	bool completeResponse(Connection* conn) {
+		conn->parse = Connection::PARSE_HEAD;
+		if (conn->sentAt.empty()) {
+			return false;
+		}
+		long long sentAt = conn->sentAt.front();
+		conn->sentAt.pop_front();
+
+		if (conn->idle) {
+			++_idleReady;
+			return true;
+		}
+		if (_measuring && !_stopping) {
+			if (conn->status == _scenario.expect) {
+				++_result.requests;
+				_result.latency.record(nowUs() - sentAt);
+			} else {
+				++_result.errors;
+			}
+		}
+		if (_stopping) {
+			return true;
+		}
+		if (_scenario.mode == MODE_CONNECT) {
+			return false;	// 요청마다 새 연결
+		}
+		appendRequest(conn);
+		if (!onWritable(conn)) {
+			return true;	// onWritable이 이미 다시 연결함
+		}
+		return true;
+	}
+
+	void countError(Connection* conn) {
+		if (_measuring && !_stopping && !conn->idle) {
+			++_result.errors;
+		}
+	}
+};
+
+// =========================================================================
+// 시나리오 실행, 결과
+// =========================================================================
+
+static bool runScenario(const Options& options, const Scenario& scenario, const std::string& config, Result& result) {
+	result.name = scenario.name;
+	result.mode = scenario.mode;
+	result.connections = scenario.connections;
+	result.pipeline = scenario.pipeline;
+	result.idle = scenario.idle;
+
+	pid_t pid = startServer(options, config);
+	if (pid == -1) {
+		return false;
+	}
+	bool ok = true;
+	{
+		LoadGenerator generator(options, scenario, result);
+		if (scenario.idle > 0) {
+			ok = generator.prepareIdle();
+		}
+		if (ok) {
+			unsigned long long ticks = processTicks(pid);
+			double client = clientSeconds();
+			generator.run(options.duration);
+			double ticksPerSecond = static_cast<double>(::sysconf(_SC_CLK_TCK));
+			result.serverCpu = (processTicks(pid) - ticks) / ticksPerSecond / result.seconds * 100;
+			result.clientCpu = (clientSeconds() - client) / result.seconds * 100;
+			result.rssKb = statusField(pid, "VmRSS");
+			result.peakRssKb = statusField(pid, "VmHWM");
+		}
+	}
+	stopServer(pid);
+	removeUploads();
+	return ok;
+}
+
+static double quantileMs(const LatencyHistogram& histogram, double q) {
+	return histogram.quantile(q) / 1000.0;
+}
+
+static void printResult(const Result& r) {
+	std::printf("%-22s %10.0f %8.1f %9.3f %9.3f %9.3f %7llu %9ld %8.1f %8.1f\n",
+				r.name.c_str(), r.requests / r.seconds, r.bytes / r.seconds / (1024 * 1024),
+				quantileMs(r.latency, 0.5), quantileMs(r.latency, 0.99), quantileMs(r.latency, 0.999),
+				r.errors, r.peakRssKb, r.serverCpu, r.clientCpu);
+}
+
+static bool writeJson(const std::string& path, const Options& options, const std::vector<Result>& results) {
+	FILE* file = std::fopen(path.c_str(), "w");
+	if (file == NULL) {
+		std::perror(path.c_str());
+		return false;
+	}
+	std::fprintf(file, "{\n  \"version\": 1,\n  \"duration\": %.1f,\n  \"scenarios\": [\n", options.duration);
+	for (size_t i = 0; i < results.size(); ++i) {
+		const Result& r = results[i];
+		std::fprintf(file,
+			"    {\"name\": \"%s\", \"mode\": \"%s\", \"connections\": %d, \"pipeline\": %d, \"idle\": %d,\n"
+			"     \"requests\": %llu, \"errors\": %llu, \"seconds\": %.3f,\n"
+			"     \"throughput_rps\": %.1f, \"throughput_mbps\": %.2f,\n"
+			"     \"p50_ms\": %.3f, \"p99_ms\": %.3f, \"p999_ms\": %.3f, \"max_ms\": %.3f,\n"
+			"     \"rss_kb\": %ld, \"peak_rss_kb\": %ld, \"server_cpu_percent\": %.1f, \"client_cpu_percent\": %.1f}%s\n",
+			r.name.c_str(), modeName(r.mode), r.connections, r.pipeline, r.idle,
+			r.requests, r.errors, r.seconds,
+			r.requests / r.seconds, r.bytes / r.seconds / (1024 * 1024),
+			quantileMs(r.latency, 0.5), quantileMs(r.latency, 0.99), quantileMs(r.latency, 0.999),
+			r.latency.max() / 1000.0,
+			r.rssKb, r.peakRssKb, r.serverCpu, r.clientCpu, i + 1 < results.size() ? "," : "");
+	}
+	std::fprintf(file, "  ]\n}\n");
+	std::fclose(file);
+	return true;
+}
+
+// 기준 JSON에서 시나리오 하나의 숫자 필드 (writeJson이 쓴 형식만 읽음)
+static bool baselineValue(const std::string& json, const std::string& name, const char* key, double& value) {
+	size_t start = json.find("\"name\": \"" + name + "\"");
+	if (start == std::string::npos) {
+		return false;
+	}
+	size_t end = json.find("\"name\": ", start + 1);
+	size_t pos = json.find(std::string("\"") + key + "\": ", start);
+	if (pos == std::string::npos || pos > end) {
+		return false;
+	}
+	value = std::strtod(json.c_str() + pos + std::strlen(key) + 4, NULL);
+	return true;
+}
+
+// 처리량이 줄거나 p99, 최대 RSS가 늘어난 폭이 threshold를 넘으면 회귀, 기준에 없던 오류가 생겨도 회귀
+// (아주 작은 값의 흔들림은 무시: p99 0.5ms, RSS 1MB 이하 차이)
+static int compareBaseline(const Options& options, const std::vector<Result>& results) {
+	std::ifstream file(options.compare.c_str());
+	if (!file) {
+		std::fprintf(stderr, "cannot read baseline %s\n", options.compare.c_str());
+		return 1;
+	}
+	std::stringstream content;
+	content << file.rdbuf();
+	std::string json = content.str();
+	double limit = options.threshold / 100.0;
+	int regressions = 0;
+
+	std::printf("\ncompared with %s (threshold %.0f%%)\n", options.compare.c_str(), options.threshold);
+	std::printf("%-22s %12s %12s %12s %8s\n", "scenario", "rps", "p99", "peak rss", "errors");
+	for (size_t i = 0; i < results.size(); ++i) {
+		const Result& r = results[i];
+		double baseRps, baseP99, baseRss, baseErrors;
+		if (!baselineValue(json, r.name, "throughput_rps", baseRps)
+			|| !baselineValue(json, r.name, "p99_ms", baseP99)
+			|| !baselineValue(json, r.name, "peak_rss_kb", baseRss)
+			|| !baselineValue(json, r.name, "errors", baseErrors)) {
+			std::printf("%-22s (not in baseline)\n", r.name.c_str());
+			continue;
+		}
+		double rps = r.requests / r.seconds;
+		double p99 = quantileMs(r.latency, 0.99);
+		double rss = static_cast<double>(r.peakRssKb);
+		bool slower = baseRps > 0 && rps < baseRps * (1 - limit);
+		bool later = p99 > baseP99 * (1 + limit) && p99 - baseP99 > 0.5;
+		bool larger = rss > baseRss * (1 + limit) && rss - baseRss > 1024;
+		bool failing = baseErrors == 0 && r.errors > 0;
+
+		std::printf("%-22s %+11.1f%% %+11.1f%% %+11.1f%% %8llu%s\n", r.name.c_str(),
+					baseRps > 0 ? (rps / baseRps - 1) * 100 : 0.0,
+					baseP99 > 0 ? (p99 / baseP99 - 1) * 100 : 0.0,
+					baseRss > 0 ? (rss / baseRss - 1) * 100 : 0.0,
+					r.errors, (slower || later || larger || failing) ? "  REGRESSION" : "");
+		if (slower || later || larger || failing) {
+			++regressions;
+		}
+	}
+	if (regressions > 0) {
+		std::printf("%d scenario(s) regressed\n", regressions);
+		return 1;
+	}
+	std::printf("no regressions\n");
+	return 0;
+}
+
+static void usage() {
+	std::fprintf(stderr, "usage: http_load [--server PATH] [--port N] [--duration SEC] [--out FILE]\n"
+						 "                 [--compare FILE] [--threshold PCT] [--list] [scenario ...]\n");
+}
+
+static bool parseOptions(int argc, char* argv[], Options& options) {
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--list") {
+			for (size_t s = 0; s < SCENARIO_COUNT; ++s) {
+				const Scenario& sc = SCENARIOS[s];
+				std::printf("%-22s %-9s %s %s (%d conn%s%s)\n", sc.name, modeName(sc.mode), sc.method, sc.path,
+							sc.connections, sc.pipeline > 1 ? ", pipelined" : "", sc.idle > 0 ? ", +idle" : "");
+			}
+			std::exit(0);
+		} else if (arg == "--server" && hasValue) {
+			options.server = argv[++i];
+		} else if (arg == "--port" && hasValue) {
+			options.port = std::atoi(argv[++i]);
+		} else if (arg == "--duration" && hasValue) {
+			options.duration = std::atof(argv[++i]);
+		} else if (arg == "--out" && hasValue) {
+			options.out = argv[++i];
+		} else if (arg == "--compare" && hasValue) {
+			options.compare = argv[++i];
+		} else if (arg == "--threshold" && hasValue) {
+			options.threshold = std::atof(argv[++i]);
+		} else if (arg.compare(0, 2, "--") != 0) {
+			options.only.push_back(arg);
+		} else {
+			return false;
+		}
+	}
+	return options.port > 0 && options.port < 65536 && options.duration > 0 && options.threshold >= 0;
+}
+
+static bool selected(const Options& options, const char* name) {
+	if (options.only.empty()) {
+		return true;
+	}
+	for (size_t i = 0; i < options.only.size(); ++i) {
+		if (options.only[i] == name) {
+			return true;
+		}
+	}
+	return false;
+}
+
+int main(int argc, char* argv[]) {
+	Options options;
+	if (!parseOptions(argc, argv, options)) {
+		usage();
+		return 2;
+	}
+	for (size_t i = 0; i < options.only.size(); ++i) {
+		bool known = false;
+		for (size_t s = 0; s < SCENARIO_COUNT; ++s) {
+			known = known || options.only[i] == SCENARIOS[s].name;
+		}
+		if (!known) {
+			std::fprintf(stderr, "unknown scenario: %s (see --list)\n", options.only[i].c_str());
+			return 2;
+		}
+	}
+	if (::access("www/html/index.html", R_OK) != 0) {
+		std::fprintf(stderr, "run from the repository root (www/html/index.html not found)\n");
+		return 2;
+	}
+	::signal(SIGPIPE, SIG_IGN);
+
+	// 유휴 연결 10k + 부하 연결: 서버도 이 제한을 물려받음
+	struct rlimit limit;
+	if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+		limit.rlim_cur = limit.rlim_max;
+		::setrlimit(RLIMIT_NOFILE, &limit);
+	}
+
+	char workDir[] = "/tmp/webserv-bench.XXXXXX";
+	if (::mkdtemp(workDir) == NULL) {
+		std::perror("mkdtemp");
+		return 1;
+	}
+	g_workDir = workDir;
+	::mkdir((g_workDir + "/upload").c_str(), 0755);
+	std::string config = g_workDir + "/webserv.conf";
+	if (!writeConfig(config, options.port)) {
+		std::fprintf(stderr, "cannot write %s\n", config.c_str());
+		return 1;
+	}
+
+	std::printf("webserv loopback benchmark: %s, port %d, %.1fs per scenario\n",
+				options.server.c_str(), options.port, options.duration);
+	std::printf("%-22s %10s %8s %9s %9s %9s %7s %9s %8s %8s\n", "scenario", "req/s", "MB/s",
+				"p50 ms", "p99 ms", "p999 ms", "errors", "rss kb", "srv cpu", "cli cpu");
+
+	std::vector<Result> results;
+	bool failed = false;
+	for (size_t s = 0; s < SCENARIO_COUNT; ++s) {
+		const Scenario& scenario = SCENARIOS[s];
+		if (!selected(options, scenario.name)) {
+			continue;
+		}
+		if (scenario.idle > 0 && ::getrlimit(RLIMIT_NOFILE, &limit) == 0
+			&& limit.rlim_cur < static_cast<rlim_t>(scenario.idle + scenario.connections + 64)) {
+			std::printf("%-22s skipped (open file limit %lu)\n", scenario.name,
+						static_cast<unsigned long>(limit.rlim_cur));
+			continue;
+		}
+		results.push_back(Result());
+		if (!runScenario(options, scenario, config, results.back())) {
+			std::printf("%-22s failed (server log: %s/server.log)\n", scenario.name, g_workDir.c_str());
+			results.pop_back();
+			failed = true;
+			continue;
+		}
+		printResult(results.back());
+	}
+
+	if (!writeJson(options.out, options, results)) {
+		return 1;
+	}
+	std::printf("results written to %s\n", options.out.c_str());
+
+	// 실패한 시나리오가 있으면 서버 로그를 볼 수 있도록 작업 디렉터리를 남김
+	if (!failed) {
+		::unlink((g_workDir + "/server.log").c_str());
+		::unlink(config.c_str());
+		::rmdir((g_workDir + "/upload").c_str());
+		::rmdir(g_workDir.c_str());
+	}
+	int status = failed ? 1 : 0;
+	if (!options.compare.empty() && compareBaseline(options, results) != 0) {
+		status = 1;
+	}
+	return status;
+}
@@ -0,0 +1,111 @@
+// 서버 RSS에 따른 CGI 프로세스 실행 지연 비교: fork+execve vs ProcessSpawner(posix_spawn)
+//
+// 사용법: ./bench/spawn_latency [반복 횟수] [RSS(MB) ...]
+//         기본값은 200회, RSS 0 256 1024 2048 MB
+//
+// RSS는 실제로 페이지를 건드린 메모리로 늘림 (fork는 이 페이지 테이블을 복사해야 함).
+
+#include "cgi/ProcessSpawner.hpp"
+#include <sys/wait.h>
+#include <unistd.h>
+#include <time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+static const char*	PROGRAM = "/bin/true";
+static const size_t	BLOCK_SIZE = 64UL * 1024 * 1024;
+
+static double nowMs() {
+	struct timespec ts;
+	::clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static double percentile(std::vector<double>& samples, double p) {
+	std::sort(samples.begin(), samples.end());
+	return samples[static_cast<size_t>(p * (samples.size() - 1))];
+}
+
+// 기존 CgiExecutor 방식: fork 후 자식에서 execve
+static pid_t launchFork(char* const argv[]) {
+	pid_t pid = ::fork();
+	if (pid == 0) {
+		::execv(PROGRAM, argv);
+		::_exit(127);
+	}
+	return pid;
+}
+
+static pid_t launchSpawn(char* const argv[]) {
+	ProcessSpawner::Stdio stdio;
+	return ProcessSpawner::spawn(PROGRAM, argv, NULL, stdio, "/");
+}
+
+static void measure(pid_t (*launch)(char* const[]), int iterations, double& p50, double& p99) {
+	char* argv[] = { const_cast<char*>(PROGRAM), NULL };
+	std::vector<double> samples;
+
+	for (int i = 0; i < iterations; ++i) {
+		double start = nowMs();
+		pid_t pid = launch(argv);
+		if (pid == -1) {
+			std::perror("launch");
+			std::exit(1);
+		}
+		// 호출자가 막히는 시간(spawn 반환까지)만 측정. 종료 대기는 제외
+		samples.push_back(nowMs() - start);
+		::waitpid(pid, NULL, 0);
+	}
+	p50 = percentile(samples, 0.50);
+	p99 = percentile(samples, 0.99);
+}
+
+int main(int argc, char* argv[]) {
+	int iterations = (argc > 1) ? std::atoi(argv[1]) : 200;
+	std::vector<size_t> sizes;
+	for (int i = 2; i < argc; ++i) {
+		sizes.push_back(std::strtoul(argv[i], NULL, 10));
+	}
+	if (sizes.empty()) {
+		sizes.push_back(0);
+		sizes.push_back(256);
+		sizes.push_back(1024);
+		sizes.push_back(2048);
+	}
+	std::sort(sizes.begin(), sizes.end());
+	if (iterations <= 0) {
+		iterations = 200;
+	}
+
+	std::printf("spawn latency of %s (%d runs, caller-side time in ms)\n", PROGRAM, iterations);
+	std::printf("%10s | %12s %12s | %12s %12s\n", "RSS(MB)", "fork p50", "fork p99", "spawn p50", "spawn p99");
+
+	std::vector<char*> ballast;
+	for (size_t i = 0; i < sizes.size(); ++i) {
+		while (ballast.size() * (BLOCK_SIZE >> 20) < sizes[i]) {
+			char* block = static_cast<char*>(std::malloc(BLOCK_SIZE));
+			if (block == NULL) {
+				std::fprintf(stderr, "out of memory at %lu MB\n",
+							 static_cast<unsigned long>(ballast.size() * (BLOCK_SIZE >> 20)));
+				return 1;
+			}
+			std::memset(block, 1, BLOCK_SIZE);
+			ballast.push_back(block);
+		}
+
+		double forkP50, forkP99, spawnP50, spawnP99;
+		measure(launchFork, iterations, forkP50, forkP99);
+		measure(launchSpawn, iterations, spawnP50, spawnP99);
+		std::printf("%10lu | %12.3f %12.3f | %12.3f %12.3f\n",
+					static_cast<unsigned long>(ballast.size() * (BLOCK_SIZE >> 20)),
+					forkP50, forkP99, spawnP50, spawnP99);
+	}
+
+	for (size_t i = 0; i < ballast.size(); ++i) {
+		std::free(ballast[i]);
+	}
+	return 0;
+}
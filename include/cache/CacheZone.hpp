@@ -0,0 +1,97 @@
+#ifndef CACHE_ZONE_HPP
+#define CACHE_ZONE_HPP
+
+#include <string>
+#include <map>
+#include <list>
+#include <ctime>
+#include "webserv.hpp"
+#include "dto/ConfigDTO.hpp"
+
+/**
+ * @brief 캐시된 응답 하나 (또는 캐시하지 않을 응답이라는 표시).
+ */
+struct CacheEntry {
+	std::string							key;
+	int									status;
+	std::map<std::string, std::string>	headers;	// 연결마다 달라지는 헤더(Date, Content-Length 등)는 뺌
+	std::string							body;		// 디스크로 내려 간 동안은 비어 있음
+	time_t								storedAt;
+	time_t								expiresAt;	// 이때까지 fresh
+	time_t								staleUntil;	// 이때까지 갱신하는 동안 stale 응답을 내줄 수 있음
+	bool								pass;		// 캐시할 수 없는 응답: expiresAt까지 요청을 모으지 않고 바로 보냄
+	size_t								size;		// 메모리/디스크 사용량 계산용
+	std::string							file;		// 디스크에 있으면 바디 파일 경로
+	std::list<CacheEntry*>::iterator	lru;		// _memory 또는 _disk 안의 위치
+
+	CacheEntry()
+		: status(0), storedAt(0), expiresAt(0), staleUntil(0), pass(false), size(0) {}
+};
+
+/**
+ * @brief cache_zone 하나. 크기가 제한된 메모리 LRU와 선택적인 디스크 계층.
+ *
+ * 메모리 합이 size를 넘으면 가장 오래 쓰지 않은 응답부터 path 디렉터리로 내려 두고,
+ * 디스크 합이 disk를 넘으면 거기서도 오래된 것부터 지움. 디스크에 있는 응답이 다시
+ * 쓰이면 읽어서 메모리로 올림 (작은 응답 하나를 읽는 blocking IO). 파일 이름은 순번이며
+ * 재시작하면 메모리의 색인이 없으므로 남은 파일은 zone을 만들 때 지움.
+ */
+class CacheZone {
+public:
+	struct Stats {
+		std::string	zone;
+		size_t		hits;			// fresh 응답으로 응답
+		size_t		stale;			// 갱신하는 동안 stale 응답으로 응답
+		size_t		misses;			// 업스트림으로 보내 채움
+		size_t		collapsed;		// 같은 키를 채우는 요청을 기다림
+		size_t		bypass;			// 캐시할 수 없는 요청/응답
+		size_t		stores;
+		size_t		evictions;		// 공간이 없어 버림
+		size_t		spills;			// 디스크로 내려 둠
+		size_t		diskHits;
+		size_t		entries;
+		size_t		memoryBytes;
+		size_t		diskBytes;
+
+		Stats()
+			: hits(0), stale(0), misses(0), collapsed(0), bypass(0), stores(0), evictions(0),
+			  spills(0), diskHits(0), entries(0), memoryBytes(0), diskBytes(0) {}
+	};
+
+	explicit CacheZone(const CacheZoneDirective* config);
+	~CacheZone();
+
+	const CacheZoneDirective*	config() const;
+
+	// 키의 응답 (없으면 NULL). 디스크에 있으면 메모리로 올림
+	CacheEntry*		find(const std::string& key);
+
+	// 같은 키의 이전 응답을 바꿈 (소유권을 가져감)
+	void			store(CacheEntry* entry);
+
+	// fresh/stale 기간이 모두 지난 응답을 지움 (Server::onTick에서 호출)
+	void			expire(time_t now);
+
+	Stats&			stats();
+
+private:
+	const CacheZoneDirective*			_config;
+	std::map<std::string, CacheEntry*>	_entries;
+	std::list<CacheEntry*>				_memory;	// 앞쪽이 가장 최근에 쓴 응답
+	std::list<CacheEntry*>				_disk;
+	size_t								_memorySize;
+	size_t								_diskSize;
+	unsigned long						_fileSeq;
+	Stats								_stats;
+
+	void			remove(CacheEntry* entry);
+	void			shrinkMemory();
+	bool			spill(CacheEntry* entry);
+	bool			load(CacheEntry* entry);
+	void			removeLeftovers();
+
+	CacheZone(const CacheZone&);
+	CacheZone& operator=(const CacheZone&);
+};
+
+#endif
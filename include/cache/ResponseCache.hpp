@@ -0,0 +1,139 @@
+#ifndef RESPONSE_CACHE_HPP
+#define RESPONSE_CACHE_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <ctime>
+#include "webserv.hpp"
+#include "dto/ConfigDTO.hpp"
+#include "server/AsyncTask.hpp"
+#include "server/ResponseTap.hpp"
+#include "cache/CacheZone.hpp"
+
+class Server;
+class Client;
+class HttpResponse;
+class ResponseCache;
+class CacheFill;
+struct CompiledLocation;
+
+/**
+ * @brief 같은 키를 채우는 요청이 끝나기를 기다리는 요청.
+ */
+class CacheWaiter : public AsyncTask {
+private:
+	friend class CacheFill;
+	friend class ResponseCache;
+
+	Client*		_client;	// abort 후 NULL
+
+	explicit CacheWaiter(Client* client);
+
+	CacheWaiter(const CacheWaiter&);
+	CacheWaiter& operator=(const CacheWaiter&);
+
+public:
+	virtual ~CacheWaiter();
+
+	// AsyncTask
+	virtual void	abort();
+};
+
+/**
+ * @brief 캐시에 없는(또는 만료된) 키를 업스트림으로 채우는 요청 하나.
+ *
+ * 요청을 보낸 Client의 응답을 ResponseTap으로 받아 모으고, 끝까지 받으면 zone에 넣은 뒤
+ * 기다리던 요청들에 같은 응답을 내줌. 캐시할 수 없는 응답이면 기다리던 요청들을 바로
+ * 업스트림으로 보냄.
+ */
+class CacheFill : public ResponseTap {
+private:
+	friend class ResponseCache;
+
+	enum State {
+		COLLECTING,
+		PASSED,			// 캐시하지 않음 (기다리던 요청은 이미 보냄)
+		DONE
+	};
+
+	ResponseCache*				_owner;
+	CacheZone*					_zone;
+	const CompiledLocation*		_location;
+	std::string					_key;
+	bool						_refresh;	// 만료된 응답을 갱신 중 (그동안 다른 요청에는 stale 응답)
+	State						_state;
+	CacheEntry*					_entry;		// 모으는 중인 응답
+	std::vector<CacheWaiter*>	_waiters;
+
+	CacheFill(ResponseCache* owner, CacheZone* zone, const CompiledLocation* location,
+			  const std::string& key, bool refresh);
+
+	CacheFill(const CacheFill&);
+	CacheFill& operator=(const CacheFill&);
+
+public:
+	virtual ~CacheFill();
+
+	// ResponseTap
+	virtual void	tapHead(HttpResponse& head);
+	virtual void	tapBody(const char* data, size_t len);
+	virtual void	tapEnd(bool complete);
+};
+
+/**
+ * @brief CGI/FastCGI/proxy_pass 응답의 마이크로 캐시 (cache, cache_valid).
+ *
+ * GET/HEAD 요청을 method + Host + URI (+ cache_key_header 값) 키로 찾아 fresh하면 바로
+ * 응답함. 같은 키를 채우는 요청이 이미 있으면 그 요청이 끝날 때까지 기다렸다가 같은
+ * 응답을 받으므로 업스트림에는 요청 하나만 감. 만료된 응답은 cache_stale(또는 응답의
+ * stale-while-revalidate) 동안 남겨 두고, 그 뒤 처음 온 요청 하나가 갱신하는 동안
+ * 다른 요청에는 이전 응답을 내줌.
+ *
+ * 응답의 Cache-Control(no-store, private, no-cache, max-age/s-maxage)과 Set-Cookie,
+ * Vary를 따르며, 캐시할 수 없는 응답은 PASS_TIME 동안 요청을 모으지 않고 바로 보냄.
+ */
+class ResponseCache {
+public:
+	enum Result {
+		HIT,		// 캐시가 응답함
+		WAIT,		// 채우는 요청을 기다림
+		FILL,		// 평소대로 처리하고 응답으로 캐시를 채움
+		PASS		// 평소대로 처리
+	};
+
+	static const time_t	PASS_TIME;	// 캐시할 수 없는 응답을 기억하는 시간 (초)
+
+	explicit ResponseCache(Server* server);
+	~ResponseCache();
+
+	// cache_zone을 만듦 (설정 적용 시 호출하면 남은 디스크 파일을 미리 정리함)
+	CacheZone*		getZone(const CacheZoneDirective* config);
+
+	// location에 cache가 있는 요청. HIT/WAIT면 캐시가 Client에 응답을 넘김
+	Result			lookup(Client* client);
+
+	// 만료된 응답 정리, 끝난 채우기 해제 (Server::onTick에서 호출)
+	void			onTick();
+
+	std::vector<CacheZone::Stats>	zoneStats();
+
+private:
+	friend class CacheFill;
+
+	Server*										_server;
+	std::map<const CacheZoneDirective*, CacheZone*>	_zones;
+	std::map<std::string, CacheFill*>			_fills;		// zone 이름 + 키 -> 채우는 중인 요청
+	std::vector<CacheFill*>						_finished;	// 콜백 밖에서 삭제할 채우기
+	Client*										_bypass;	// 기다리다 풀려나 캐시 없이 처리할 요청
+
+	std::string		buildKey(Client* client) const;
+	void			serve(Client* client, const CacheEntry& entry, const char* status);
+	void			release(CacheFill* fill);
+	void			finish(CacheFill* fill);
+
+	ResponseCache(const ResponseCache&);
+	ResponseCache& operator=(const ResponseCache&);
+};
+
+#endif
@@ -58,6 +58,30 @@ public:
 	 */
 	~CgiExecutor();
 
+	/**
+	 * @brief CGI/1.1 환경변수 목록("NAME=value")을 생성.
+	 *
+	 * fork-exec CGI의 envp와 FastCGI PARAMS가 같은 규칙을 쓰도록 공유함.
+	 */
+	static std::vector<std::string> buildEnvironment(const HttpRequest* request, const std::string& cgiPath,
+													 const ServerContext* serverConf,
+													 const LocationContext* locConf);
+
+	/**
+	 * @brief 스크립트를 실행할 인터프리터 경로 (직접 실행이면 빈 문자열).
+	 */
+	static std::string resolveInterpreter(const std::string& scriptPath, const LocationContext* locConf);
+
+	/**
+	 * @brief 스크립트를 실행할 수 있는지 (파일이 없어도 되는 인터프리터 포함).
+	 */
+	static bool canExecute(const std::string& scriptPath, const LocationContext* locConf);
+
+	/**
+	 * @brief 스크립트가 HTTP 응답 전체를 직접 쓰는지 (nph-* 파일명 또는 cgi_nph on).
+	 */
+	static bool isNph(const std::string& scriptPath, const LocationContext* locConf);
+
 	/**
 	 * @brief CGI 프로그램을 실행.
 	 *
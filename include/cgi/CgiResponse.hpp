@@ -24,6 +24,21 @@ public:
 	 */
 	HttpResponse* parse(const std::string& cgiOutput);
 
+	/**
+	 * @brief Find the end of the CGI header block (output may still be incomplete)
+	 *
+	 * @param delimLength Output parameter - length of the blank-line delimiter
+	 * @return Offset of the delimiter, or std::string::npos if headers are incomplete
+	 */
+	static size_t findHeaderEnd(const std::string& cgiOutput, size_t& delimLength);
+
+	/**
+	 * @brief Create HttpResponse (status + headers, no body) from the CGI header block
+	 *
+	 * Used to send the response head before the script finishes.
+	 */
+	HttpResponse* parseHead(const std::string& headersPart);
+
 private:
 	/**
 	 * @brief Parse header line to extract name and value
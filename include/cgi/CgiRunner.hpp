@@ -0,0 +1,224 @@
+#ifndef CGI_RUNNER_HPP
+#define CGI_RUNNER_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <sys/types.h>
+#include "webserv.hpp"
+#include "dto/ConfigDTO.hpp"
+#include "server/IoHandler.hpp"
+#include "server/AsyncTask.hpp"
+#include "server/BodySink.hpp"
+#include "server/BodySource.hpp"
+#include "cgi/CircuitBreaker.hpp"
+
+class EventLoop;
+class Client;
+class HttpRequest;
+class CgiRunner;
+struct CompiledLocation;
+
+/**
+ * @brief 실행 중인 CGI 프로세스 하나.
+ *
+ * stdin 파이프는 BodySink로서 Client가 받는 바디를 그대로 흘려보내고(backpressure 포함),
+ * stdout은 헤더 블록이 끝나는 대로 응답 헤더를 보낸 뒤 읽는 대로 Client에 넘김
+ * (BodySource: 소켓이 밀리면 파이프 읽기를 멈춤). nph 스크립트는 출력이 곧 HTTP 응답이므로
+ * 파싱 없이 stdout 파이프에서 클라이언트 소켓으로 splice함.
+ * 출력이 닫혀도 종료 상태를 거둘 때까지 끝내지 않음: 시그널이나 0이 아닌 종료 코드는
+ * 실패로 보고 circuit breaker에 기록하며, 이미 보내던 응답은 잘린 채로 끊음.
+ */
+class CgiProcess : public AsyncTask, public BodySink, public BodySource, public IoHandler {
+private:
+	friend class CgiRunner;
+
+	CgiRunner*				_owner;
+	Client*					_client;		// abort 후 NULL
+	const ServerContext*	_serverConf;
+	const LocationContext*	_locConf;
+	std::string				_scriptPath;
+	pid_t					_pid;
+	const CompiledLocation*	_limit;			// cgi_max_concurrent 자리를 차지하면 해당 location
+	bool					_probe;			// circuit breaker half-open 시험 요청
+
+	int						_stdinFd;		// 닫혔으면 -1
+	int						_stdoutFd;
+	int						_stderrFd;
+	int						_pidFd;			// 종료를 기다리는 동안의 pidfd (없으면 -1, onTick에서 확인)
+	bool					_reaped;
+	int						_exitStatus;	// waitpid status (_reaped일 때만 의미 있음)
+
+	std::string				_stdinBuffer;	// 파이프가 받지 못한 바디
+	size_t					_stdinOffset;
+	bool					_inputEnded;	// endBody 호출됨
+	time_t					_inputEndedAt;	// 타임아웃 기준 (바디를 다 받은 시점)
+
+	std::string				_stdout;		// 헤더 전송 전에는 전체, 이후에는 Client에 넘기기 전 조각
+	std::string				_stderr;
+	bool					_streamOutput;	// HTTP/1.1: 스크립트 종료 전에 응답을 보냄
+	bool					_nph;			// 출력을 그대로 클라이언트 소켓으로 relay
+	bool					_headSent;
+	bool					_outputPaused;	// Client 버퍼가 차서 stdout 읽기를 멈춤
+	time_t					_lastOutputAt;	// 헤더 전송 후 타임아웃 기준
+	bool					_finished;
+
+	CgiProcess(CgiRunner* owner, Client* client, const ServerContext* serverConf,
+			   const LocationContext* locConf, const std::string& scriptPath);
+
+	CgiProcess(const CgiProcess&);
+	CgiProcess& operator=(const CgiProcess&);
+
+	bool			flushStdin();
+	void			closeStdin();
+	void			closeOutput(int& fd);
+	bool			readOutput(int fd, std::string& out, size_t limit);
+	void			tryStartResponse();
+	void			forwardOutput();
+	void			startRelay();
+	void			relayOutput();
+	void			relayEncrypted();
+	void			tryComplete();
+	bool			reap();
+	bool			exitedCleanly() const;
+
+public:
+	static const size_t	STDIN_HIGH_WATERMARK;	// 이만큼 쌓이면 Client 소켓 읽기를 멈춤
+	static const size_t	MAX_HEAD_SIZE;			// 헤더 블록이 이보다 길면 502
+
+	virtual ~CgiProcess();
+
+	// AsyncTask
+	virtual void	abort();
+
+	// BodySink
+	virtual bool	writeBody(const char* data, size_t len);
+	virtual int		bodyPipe() const;
+	virtual void	waitBodyWritable();
+	virtual void	endBody();
+
+	// BodySource
+	virtual void	resumeOutput();
+
+	// IoHandler (stdin/stdout/stderr 파이프, pidfd)
+	virtual void	onIoEvent(int fd, uint32_t events);
+};
+
+/**
+ * @brief cgi_max_concurrent 한도에 걸려 실행 자리를 기다리는 요청.
+ */
+class QueuedCgi : public AsyncTask {
+private:
+	friend class CgiRunner;
+
+	CgiRunner*				_owner;
+	Client*					_client;
+	std::string				_scriptPath;
+	bool					_streamBody;
+	bool					_probe;
+	const CompiledLocation*	_location;
+	double					_enqueuedAt;	// ms (monotonic)
+
+	QueuedCgi(CgiRunner* owner, Client* client, const std::string& scriptPath, bool streamBody,
+			  bool probe, const CompiledLocation* location, double enqueuedAt);
+
+	QueuedCgi(const QueuedCgi&);
+	QueuedCgi& operator=(const QueuedCgi&);
+
+public:
+	// AsyncTask: 대기열에서 빠지고 삭제됨
+	virtual void	abort();
+};
+
+/**
+ * @brief EventLoop에 통합된 비동기 fork-exec CGI 실행기.
+ *
+ * 스크립트를 바로 실행하고 바디/출력은 파이프로 주고받으므로, 요청 바디를
+ * 임시 파일에 모으거나 스크립트 종료까지 이벤트 루프를 막지 않음.
+ * cgi_max_concurrent가 있는 location은 실행 수를 세고, 넘친 요청은 FIFO 대기열에 둠.
+ * cgi_circuit_breaker가 있으면 계속 실패하는 스크립트는 실행하지 않고 503으로 응답함.
+ */
+class CgiRunner {
+public:
+	static const size_t	DEFAULT_QUEUE_SIZE;		// cgi_queue_size 기본값
+	static const size_t	DEFAULT_QUEUE_TIMEOUT;	// cgi_queue_timeout 기본값 (초)
+
+	// location별 실행/대기 통계
+	struct QueueStats {
+		std::string	server;			// 지표 라벨 (CompiledLocation::metricsServer)
+		std::string	location;
+		size_t		running;		// 실행 중인 CGI 수
+		size_t		depth;			// 대기 중인 요청 수
+		size_t		maxDepth;
+		size_t		waited;			// 대기 후 실행된 요청 수
+		double		totalWaitMs;	// waited 요청들의 대기 시간 합
+		size_t		rejected;		// 대기열이 가득 차 503
+		size_t		expired;		// cgi_queue_timeout을 넘겨 503
+
+		QueueStats()
+			: running(0), depth(0), maxDepth(0), waited(0), totalWaitMs(0), rejected(0), expired(0) {}
+	};
+
+private:
+	friend class CgiProcess;
+	friend class QueuedCgi;
+
+	struct Limit {
+		QueueStats				stats;
+		std::deque<QueuedCgi*>	waiting;
+		size_t					loggedEvents;	// 마지막 통계 로그 시점의 waited + rejected + expired
+
+		Limit() : loggedEvents(0) {}
+	};
+
+	EventLoop*					_event_loop;
+	std::vector<CgiProcess*>	_running;
+	std::vector<CgiProcess*>	_finished;	// 콜백 밖에서 삭제할 프로세스
+	std::vector<pid_t>			_exited;	// 종료를 기다리는 pid
+	std::map<const CompiledLocation*, Limit>	_limits;
+	time_t						_statsLoggedAt;
+	CircuitBreaker				_breaker;
+
+	CgiProcess*	start(Client* client, const HttpRequest* request, const std::string& scriptPath,
+					  const ServerContext* serverConf, const LocationContext* locConf);
+	bool		launch(Client* client, const std::string& scriptPath, bool streamBody, bool probe,
+					   const CompiledLocation* limit);
+	void		finish(CgiProcess* process, int statusCode);
+	void		release(CgiProcess* process);
+
+	void		startQueued(const CompiledLocation* location);
+	void		expireQueued();
+	void		cancel(QueuedCgi* queued);
+	Limit&		limitFor(const LocationContext* locConf);
+	void		respondUnavailable(Client* client, time_t retryAfter);
+	void		logQueueStats();
+
+	CgiRunner(const CgiRunner&);
+	CgiRunner& operator=(const CgiRunner&);
+
+public:
+	explicit CgiRunner(EventLoop* eventLoop);
+	~CgiRunner();
+
+	/**
+	 * @brief 스크립트 실행을 요청하고 Client에 작업을 연결.
+	 *
+	 * streamBody면 받는 대로 stdin으로 넘기고(Client::startBodyStream), 아니면 이미 받은
+	 * 바디를 한 번에 넘김. cgi_max_concurrent를 넘으면 대기열에 넣고, 대기열이 가득 차거나
+	 * 스크립트가 차단 중이면 503(Retry-After)으로 응답함.
+	 * @return 실행 실패 시 false (호출자가 다른 경로로 처리)
+	 */
+	bool		submit(Client* client, const std::string& scriptPath, bool streamBody);
+
+	// cgi_max_concurrent location을 설정 적용 시 등록 (요청 전에도 통계에 0으로 나옴)
+	void		addQueue(const LocationContext* locConf);
+
+	// location별 실행/대기 통계 (stub_status)
+	std::vector<QueueStats>	queueStats() const;
+
+	// cgi_timeout/cgi_queue_timeout 검사, 종료된 프로세스 정리 (Server::onTick에서 호출)
+	void		onTick();
+};
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef CGI_WORKER_HPP
+#define CGI_WORKER_HPP
+
+#include <string>
+#include <sys/types.h>
+
+/**
+ * @brief cgi_pool 워커 프로세스 생성.
+ *
+ * 워커는 socketpair 한쪽 끝으로 FastCGI 레코드를 주고받는 작은 파이썬 부트스트랩으로,
+ * 요청마다 environ/stdin/stdout을 CGI 방식으로 바꿔 끼운 뒤 대상 스크립트를 실행함.
+ * 인터프리터 기동 비용은 워커를 띄울 때 한 번만 들고, 연결 관리는 FastCgiClient가 맡음.
+ */
+class CgiWorker {
+public:
+	static const size_t	DEFAULT_MAX_REQUESTS;	// cgi_pool에 교체 주기가 없을 때
+	static const int	WORKER_FD;				// 워커 프로세스 쪽 소켓 fd 번호
+
+	// 부트스트랩을 실행할 수 있는 인터프리터인지 (python, python3, python3.x)
+	static bool		supportsInterpreter(const std::string& interpreter);
+
+	/**
+	 * @brief 워커 프로세스를 띄움.
+	 * @param fd 서버 쪽 소켓 (non-blocking)
+	 * @return 워커 pid. 실패 시 -1
+	 */
+	static pid_t	spawn(const std::string& interpreter, int& fd);
+
+private:
+	CgiWorker();
+	~CgiWorker();
+
+	CgiWorker(const CgiWorker&);
+	CgiWorker& operator=(const CgiWorker&);
+};
+
+#endif
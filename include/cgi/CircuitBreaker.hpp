@@ -0,0 +1,76 @@
+#ifndef CIRCUIT_BREAKER_HPP
+#define CIRCUIT_BREAKER_HPP
+
+#include <string>
+#include <deque>
+#include <map>
+#include <ctime>
+
+struct CompiledLocation;
+
+/**
+ * @brief cgi_circuit_breaker: 계속 실패하는 스크립트로 요청을 보내지 않음.
+ *
+ * 스크립트별로 최근 결과(타임아웃, 출력 없음, 잘못된 헤더, 시그널이나 0이 아닌 종료 코드를 실패로 셈)를 모아
+ * 실패 비율이 기준을 넘으면 차단(open)하고 바로 503으로 응답함. 차단 시간이 지나면
+ * 시험 요청 하나만 보내(half-open) 성공하면 다시 열고, 실패하면 차단을 이어감.
+ */
+class CircuitBreaker {
+public:
+	enum Decision {
+		ALLOW,		// 평소대로 실행
+		PROBE,		// half-open 시험 요청으로 실행 (결과를 probe로 기록)
+		REJECT		// 차단 중: 503
+	};
+
+	static const size_t	WINDOW_SIZE;	// 비율을 계산할 최근 결과 수
+	static const size_t	MIN_SAMPLES;	// 이보다 적으면 차단하지 않음
+	static const time_t	WINDOW_TIME;	// 이보다 오래된 결과는 버림 (초)
+
+	CircuitBreaker();
+	~CircuitBreaker();
+
+	/**
+	 * @param retryAfter REJECT일 때 다시 시도할 때까지 남은 초
+	 */
+	Decision	admit(const std::string& key, time_t now, time_t& retryAfter);
+
+	// 실행을 마친 요청의 결과
+	void		record(const std::string& key, const CompiledLocation* location,
+					   bool failed, bool probe, time_t now);
+
+	// 시험 요청이 결과 없이 끝남 (클라이언트 종료 등): 다음 요청을 시험 요청으로 보냄
+	void		abandon(const std::string& key);
+
+private:
+	enum State {
+		CLOSED,
+		OPEN,
+		HALF_OPEN
+	};
+
+	struct Outcome {
+		time_t	at;
+		bool	failed;
+
+		Outcome(time_t a, bool f) : at(a), failed(f) {}
+	};
+
+	struct Circuit {
+		State				state;
+		time_t				openUntil;
+		bool				probing;	// half-open 시험 요청이 실행 중
+		std::deque<Outcome>	outcomes;
+
+		Circuit() : state(CLOSED), openUntil(0), probing(false) {}
+	};
+
+	std::map<std::string, Circuit>	_circuits;
+
+	void	open(const std::string& key, Circuit& circuit, const CompiledLocation* location, time_t now);
+
+	CircuitBreaker(const CircuitBreaker&);
+	CircuitBreaker& operator=(const CircuitBreaker&);
+};
+
+#endif
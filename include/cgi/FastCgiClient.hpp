@@ -0,0 +1,259 @@
+#ifndef FASTCGI_CLIENT_HPP
+#define FASTCGI_CLIENT_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <deque>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include "webserv.hpp"
+#include "dto/ConfigDTO.hpp"
+#include "server/IoHandler.hpp"
+#include "server/AsyncTask.hpp"
+#include "server/BodySink.hpp"
+#include "server/BodySource.hpp"
+
+class EventLoop;
+class Client;
+class HttpRequest;
+class FastCgiClient;
+class FastCgiConnection;
+struct FastCgiUpstream;
+struct CompiledLocation;
+
+/**
+ * @brief FastCGI 요청 하나. Client가 응답을 기다리는 동안 AsyncTask로 참조함.
+ *
+ * 요청 바디는 BodySink로서 받는 대로 STDIN 레코드로 보내고(연결의 송신 버퍼가 차면 Client 읽기를 멈춤),
+ * STDOUT은 헤더 블록이 끝나는 대로 응답 헤더를 보낸 뒤 받는 대로 Client에 넘김
+ * (BodySource: Client가 밀리면 연결 읽기를 멈춤). 응답은 바디를 다 받은 뒤에 시작함.
+ */
+class FastCgiRequest : public AsyncTask, public BodySink, public BodySource {
+private:
+	friend class FastCgiClient;
+	friend class FastCgiConnection;
+
+	FastCgiClient*			_owner;
+	FastCgiUpstream*		_upstream;
+	FastCgiConnection*		_conn;			// 배정 전, END_REQUEST 후에는 NULL
+	Client*					_client;		// abort, 응답 완료 후 NULL
+	const ServerContext*	_serverConf;
+	const LocationContext*	_locConf;
+
+	unsigned short			_id;			// 연결 안에서의 requestId
+	std::string				_records;		// 배정 전까지 보관하는 BEGIN/PARAMS/STDIN 레코드
+	bool					_inputEnded;	// 빈 STDIN 레코드까지 넘김
+	bool					_bodyPaused;	// Client 소켓 읽기를 멈춰 둠
+	bool					_ended;			// 바디를 다 받기 전에 END_REQUEST를 받음 (endBody에서 응답)
+
+	std::string				_stdout;		// 헤더 전송 전에는 전체, 이후에는 쓰지 않음
+	std::string				_stderr;
+	bool					_streamOutput;	// HTTP/1.1: END_REQUEST 전에 응답을 보냄
+	bool					_headSent;
+	bool					_outputPaused;	// Client 버퍼가 차서 연결 읽기를 멈춤
+	time_t					_inputEndedAt;	// 타임아웃 기준 (바디를 다 받은 시점)
+	time_t					_lastOutputAt;	// 헤더 전송 후 타임아웃 기준
+	time_t					_abortedAt;		// abort 후 END_REQUEST를 기다리기 시작한 시점 (0이면 abort 전)
+
+	FastCgiRequest(FastCgiClient* owner, FastCgiUpstream* upstream, Client* client,
+				   const ServerContext* serverConf, const LocationContext* locConf);
+
+	FastCgiRequest(const FastCgiRequest&);
+	FastCgiRequest& operator=(const FastCgiRequest&);
+
+	void			appendStdin(const char* data, size_t len, bool endOfStream);
+	void			onStdout(const char* data, size_t len);
+	void			tryStartResponse();
+	bool			hasOutput() const;
+
+	// location의 cgi_timeout을 넘겼는지 (바디를 받는 중이거나 Client가 밀린 동안은 제외, abort 후에는 항상 적용)
+	bool			timedOut(time_t now) const;
+
+public:
+	static const size_t	STDIN_HIGH_WATERMARK;	// 연결에 보내지 못한 레코드가 이만큼 쌓이면 Client 읽기를 멈춤
+	static const size_t	MAX_HEAD_SIZE;			// 헤더 블록이 이보다 길면 502
+
+	virtual ~FastCgiRequest();
+
+	// AsyncTask
+	virtual void	abort();
+
+	// BodySink
+	virtual bool	writeBody(const char* data, size_t len);
+	virtual int		bodyPipe() const;
+	virtual void	waitBodyWritable();
+	virtual void	endBody();
+
+	// BodySource
+	virtual void	resumeOutput();
+};
+
+/**
+ * @brief 업스트림 앱 서버와의 연결 하나. 응답이 끝나도 닫지 않고 풀에 남겨 재사용함.
+ *
+ * 업스트림이 FCGI_MPXS_CONNS=1을 알려 오면 한 연결에 여러 requestId를 동시에 보냄.
+ */
+class FastCgiConnection : public IoHandler {
+private:
+	friend class FastCgiClient;
+	friend class FastCgiRequest;
+
+	enum State {
+		CONNECTING,
+		READY,
+		CLOSED
+	};
+
+	FastCgiClient*							_owner;
+	FastCgiUpstream*						_upstream;
+	int										_fd;
+	State									_state;
+
+	std::string								_out;			// 보낼 레코드
+	size_t									_outSent;
+	std::string								_in;			// 아직 처리하지 않은 수신 바이트
+	size_t									_inOffset;
+	bool									_inputClosed;	// 업스트림이 연결을 닫음
+
+	std::map<unsigned short, FastCgiRequest*>	_requests;	// 진행 중인 요청
+	unsigned short							_nextId;
+	time_t									_idleSince;
+
+	pid_t									_pid;			// cgi_pool 워커 (소켓 업스트림은 -1)
+	size_t									_served;		// 완료한 요청 수
+
+	FastCgiConnection(FastCgiClient* owner, FastCgiUpstream* upstream, int fd, pid_t pid);
+
+	FastCgiConnection(const FastCgiConnection&);
+	FastCgiConnection& operator=(const FastCgiConnection&);
+
+	void			queue(const std::string& records);
+	size_t			pendingOutput() const;
+	void			updateEvents();
+	bool			flush();
+	void			resumeBodies();
+	bool			readAvailable();
+	bool			inputPaused() const;
+	bool			processRecords();
+	bool			consumeInput();
+	void			resumeInput();
+	unsigned short	allocateId();
+	bool			shouldRetire() const;
+
+public:
+	virtual ~FastCgiConnection();
+
+	virtual void	onIoEvent(int fd, uint32_t events);
+};
+
+/**
+ * @brief fastcgi_pass 업스트림별 연결 풀.
+ *
+ * cgi_pool도 같은 구조로 관리함: 연결 하나가 socketpair로 붙은 워커 프로세스 하나.
+ */
+struct FastCgiUpstream {
+	std::string							address;	// 설정에 적힌 그대로 (풀 키)
+	struct sockaddr_storage				sockaddr;
+	socklen_t							sockaddrLen;
+	bool								valid;		// 주소 해석 성공 여부
+
+	bool								multiplex;	// FCGI_MPXS_CONNS 응답 값
+	bool								probed;		// GET_VALUES를 이미 보냈는지
+
+	std::string							interpreter;	// cgi_pool 워커 인터프리터 (소켓 업스트림은 빈 문자열)
+	size_t								workers;		// cgi_pool 워커 수
+	size_t								maxRequests;	// cgi_pool 워커 교체 주기
+
+	std::vector<FastCgiConnection*>		connections;
+	std::deque<FastCgiRequest*>			pending;	// 연결을 기다리는 요청
+
+	FastCgiUpstream()
+		: sockaddrLen(0), valid(false), multiplex(false), probed(false), workers(0), maxRequests(0) {}
+};
+
+/**
+ * @brief EventLoop에 통합된 비동기 FastCGI 클라이언트 (php-fpm 등 상주 앱 서버용).
+ *
+ * 요청마다 인터프리터를 fork하는 대신 업스트림 연결 풀에 FastCGI 레코드를 보내고,
+ * STDOUT 레코드를 Client에 스트리밍함 (HTTP/1.0 요청은 END_REQUEST 때 CgiResponseParser로
+ * 응답을 만들어 Client::completeAsync로 넘김). 연결은 FCGI_KEEP_CONN으로 유지함.
+ */
+class FastCgiClient {
+private:
+	friend class FastCgiRequest;
+	friend class FastCgiConnection;
+
+	EventLoop*									_event_loop;
+	std::map<std::string, FastCgiUpstream*>		_upstreams;
+	std::vector<FastCgiConnection*>				_closed;	// 콜백 밖에서 삭제할 연결
+	std::vector<FastCgiRequest*>				_finished;	// 콜백 밖에서 삭제할 요청 (Client가 아직 sink로 참조할 수 있음)
+	std::vector<pid_t>							_exited;	// 종료를 기다리는 cgi_pool 워커
+
+	FastCgiUpstream*	getUpstream(const std::string& address);
+	FastCgiUpstream*	getWorkerPool(const CompiledLocation* compiled);
+	static bool			resolveAddress(FastCgiUpstream* upstream);
+	static size_t		connectionLimit(const FastCgiUpstream* upstream);
+
+	FastCgiConnection*	openConnection(FastCgiUpstream* upstream);
+	FastCgiConnection*	spawnWorker(FastCgiUpstream* upstream);
+	void				replenishWorkers(FastCgiUpstream* upstream);
+	void				dispatchPending(FastCgiUpstream* upstream, bool failUnreachable);
+	void				assign(FastCgiConnection* conn, FastCgiRequest* request);
+
+	void				closeConnection(FastCgiConnection* conn, int statusCode, bool replace = false);
+	void				finishRequest(FastCgiRequest* request, int statusCode);
+	void				failRequest(FastCgiRequest* request, int statusCode);
+	void				abortRequest(FastCgiRequest* request);
+	void				onGetValuesResult(FastCgiUpstream* upstream, const std::map<std::string, std::string>& values);
+	void				deleteClosed();
+	void				reapWorkers();
+
+	FastCgiClient(const FastCgiClient&);
+	FastCgiClient& operator=(const FastCgiClient&);
+
+public:
+	static const size_t	MAX_CONNECTIONS_PER_UPSTREAM;	// 업스트림당 최대 연결 수
+	static const size_t	MAX_IDLE_CONNECTIONS;			// 유지할 유휴 연결 수
+	static const size_t	MAX_REQUESTS_PER_CONNECTION;	// 멀티플렉싱 시 연결당 동시 요청 수
+	static const time_t	IDLE_TIMEOUT;					// 유휴 연결 유지 시간 (초)
+	static const size_t	MAX_BUFFERED_INPUT;				// 연결에서 한 번에 읽어 둘 바이트 (레코드 하나보다 커야 함)
+
+	explicit FastCgiClient(EventLoop* eventLoop);
+	~FastCgiClient();
+
+	/**
+	 * @brief cgi_pool location의 워커들을 미리 띄움 (설정 적용 시 호출).
+	 *
+	 * 같은 인터프리터를 쓰는 location들은 워커 풀 하나를 공유하며, 워커 수는 가장 큰 값을 따름.
+	 */
+	void			startWorkerPool(const CompiledLocation* compiled);
+
+	/**
+	 * @brief location의 fastcgi_pass 주소를 설정 적용 시 미리 해석.
+	 *
+	 * getaddrinfo는 블로킹이므로 이벤트 루프가 돌기 전에 끝내 둠. submit은 여기서 만든
+	 * 업스트림만 찾아 씀.
+	 * @return 주소를 해석하지 못하면 false
+	 */
+	bool			prepare(const CompiledLocation* compiled);
+
+	/**
+	 * @brief 요청을 업스트림(fastcgi_pass 또는 cgi_pool)으로 보내고 Client에 작업을 연결.
+	 *
+	 * streamBody면 받는 대로 STDIN 레코드로 보내고(Client::startBodyStream), 아니면 이미 받은
+	 * 바디를 한 번에 넘김. 응답은 이후 Client::startResponseStream 또는 completeAsync로 전달됨.
+	 * @return 미리 해석한 업스트림이 없는 등 바로 실패하면 false
+	 */
+	bool			submit(Client* client, const std::string& scriptPath, bool streamBody);
+
+	// 요청 타임아웃, 유휴 연결 정리, 워커 보충 (Server::onTick에서 호출)
+	void			onTick();
+
+	// CGI 환경변수에 FastCGI 앱 서버가 기대하는 SCRIPT_FILENAME 등을 보충
+	static std::vector<std::string>	buildParams(const HttpRequest* request, const std::string& scriptPath,
+												const ServerContext* serverConf,
+												const LocationContext* locConf);
+};
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef FASTCGI_PROTOCOL_HPP
+#define FASTCGI_PROTOCOL_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstddef>
+
+/**
+ * @brief FastCGI 1.0 레코드 인코딩/디코딩 (https://fastcgi-archives.github.io/FastCGI_Specification.html)
+ *
+ * 레코드는 8바이트 헤더 + content(최대 65535) + padding으로 구성되며,
+ * 하나의 연결에서 requestId로 여러 요청을 구분함 (0은 관리 레코드).
+ */
+namespace FastCgi {
+
+	// 레코드 타입
+	enum RecordType {
+		BEGIN_REQUEST		= 1,
+		ABORT_REQUEST		= 2,
+		END_REQUEST			= 3,
+		PARAMS				= 4,
+		STDIN				= 5,
+		STDOUT				= 6,
+		STDERR				= 7,
+		DATA				= 8,
+		GET_VALUES			= 9,
+		GET_VALUES_RESULT	= 10,
+		UNKNOWN_TYPE		= 11
+	};
+
+	// END_REQUEST의 protocolStatus
+	enum ProtocolStatus {
+		REQUEST_COMPLETE	= 0,
+		CANT_MPX_CONN		= 1,
+		OVERLOADED			= 2,
+		UNKNOWN_ROLE		= 3
+	};
+
+	const unsigned char		VERSION_1 = 1;
+	const unsigned short	ROLE_RESPONDER = 1;
+	const unsigned char		FLAG_KEEP_CONN = 1;
+	const size_t			HEADER_LEN = 8;
+	const size_t			MAX_CONTENT_LEN = 65535;
+
+	struct RecordHeader {
+		unsigned char	version;
+		unsigned char	type;
+		unsigned short	requestId;
+		unsigned short	contentLength;
+		unsigned char	paddingLength;
+	};
+
+	// 레코드 하나를 out 뒤에 추가 (len은 MAX_CONTENT_LEN 이하)
+	void	appendRecord(std::string& out, unsigned char type, unsigned short requestId,
+						 const char* data, size_t len);
+
+	void	appendBeginRequest(std::string& out, unsigned short requestId, bool keepConn);
+	void	appendAbortRequest(std::string& out, unsigned short requestId);
+
+	// "NAME=value" 목록을 name-value pair로 인코딩해 PARAMS 스트림으로 추가 (빈 레코드로 종료)
+	void	appendParams(std::string& out, unsigned short requestId, const std::vector<std::string>& env);
+
+	// 바디를 STDIN 레코드들로 나눠 추가. endOfStream이면 빈 레코드로 스트림 종료.
+	void	appendStdin(std::string& out, unsigned short requestId, const char* data, size_t len,
+						bool endOfStream);
+
+	// 관리 레코드: 요청한 변수 이름들의 값을 질의 (FCGI_MPXS_CONNS 등)
+	void	appendGetValues(std::string& out, const std::vector<std::string>& names);
+
+	// 미리 인코딩해 둔 레코드들의 requestId를 일괄 변경 (연결 배정 시 사용)
+	void	setRequestId(std::string& records, unsigned short requestId);
+
+	// buf에 헤더 전체가 있으면 파싱해 true
+	bool	parseHeader(const char* buf, size_t len, RecordHeader& header);
+
+	// name-value pair 목록 디코딩 (GET_VALUES_RESULT 등). 형식 오류면 false
+	bool	parseNameValuePairs(const char* data, size_t len, std::map<std::string, std::string>& out);
+
+} // namespace FastCgi
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef PROCESS_SPAWNER_HPP
+#define PROCESS_SPAWNER_HPP
+
+#include <string>
+#include <sys/types.h>
+
+/**
+ * @brief CGI 스크립트와 cgi_pool 워커 프로세스 실행.
+ *
+ * fork()는 서버 RSS가 클수록 페이지 테이블 복사 비용이 커지므로, glibc가
+ * clone(CLONE_VM|CLONE_VFORK)로 구현하는 posix_spawn을 사용함.
+ * argv/envp는 호출 전에 모두 만들어 두고, 자식에서 해야 할 fd 재지정, 상속 fd 정리,
+ * chdir는 file actions로 넘김 (자식에서 메모리를 할당하지 않음).
+ */
+class ProcessSpawner {
+public:
+	// 자식 fd 배치. in/out이 -1이면 /dev/null, err가 -1이면 서버 stderr를 그대로 씀
+	struct Stdio {
+		int	in;
+		int	out;
+		int	err;
+		int	extra;			// 자식의 extraTarget 번호로 넘길 fd (없으면 -1)
+		int	extraTarget;
+
+		Stdio() : in(-1), out(-1), err(-1), extra(-1), extraTarget(-1) {}
+	};
+
+	/**
+	 * @brief path를 실행. 표준 입출력(과 extraTarget) 외의 서버 fd는 자식에 넘기지 않음.
+	 * @param envp NULL이면 서버 환경변수를 그대로 넘김
+	 * @param workDir 비어 있으면 현재 디렉토리 유지
+	 * @return 자식 pid. 실패 시 -1 (errno 설정)
+	 */
+	static pid_t	spawn(const char* path, char* const argv[], char* const envp[],
+						  const Stdio& stdio, const std::string& workDir);
+
+private:
+	ProcessSpawner();
+	~ProcessSpawner();
+
+	ProcessSpawner(const ProcessSpawner&);
+	ProcessSpawner& operator=(const ProcessSpawner&);
+};
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef COMPILED_LOCATION_HPP
+#define COMPILED_LOCATION_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+
+struct UpstreamContext;
+struct CacheZoneDirective;
+struct ExpiresDirective;
+struct AddHeaderDirective;
+class AccessLog;
+class LatencyHistogram;
+
+/**
+ * @brief cascade가 끝난 LocationContext를 요청 처리용으로 미리 풀어 둔 불변 구조체.
+ *
+ * LocationContext의 opXxxDirective 벡터들은 요청마다 empty() 검사, 문자열 파싱,
+ * 확장자 비교를 반복하게 만듦. LocationCompiler가 설정 적용 시점에 한 번 계산해
+ * LocationContext::compiled에 연결하고, 핫패스는 이 구조체만 참조함.
+ */
+struct CompiledLocation {
+	size_t								maxBodySize;	// client_max_body_size (바이트)
+	unsigned int						methodMask;		// 허용 메서드 (limit_except 없으면 전부)
+
+	std::string							documentRoot;	// location > server root (없으면 빈 문자열)
+	std::string							root;			// documentRoot, 없으면 기본 root
+	std::string							alias;
+	bool								hasAlias;
+
+	bool								isCgi;			// cgi_pass 지정 여부
+	std::string							cgiPass;		// cgi_pass 경로
+	std::string							interpreter;	// EXTENSION location의 확정 인터프리터
+	std::string							fastcgiPass;	// fastcgi_pass 주소 (없으면 빈 문자열)
+
+	std::string							proxyPass;		// proxy_pass 업스트림 주소 (없으면 빈 문자열)
+	const UpstreamContext*				proxyUpstream;	// proxy_pass가 가리키는 upstream 블록 (없으면 NULL, 설정 소유)
+	std::string							proxyUri;		// location 경로 대신 붙일 업스트림 경로 (없으면 URI 그대로)
+	size_t								proxyConnectTimeout;	// 초
+	size_t								proxyReadTimeout;		// 응답 바이트 사이 최대 간격 (초)
+	size_t								proxySendTimeout;		// 요청 바이트 사이 최대 간격 (초)
+
+	size_t								cgiPoolWorkers;		// cgi_pool 워커 수 (0이면 요청마다 fork)
+	size_t								cgiPoolMaxRequests;	// 워커 교체 주기
+	std::string							cgiPoolInterpreter;	// 워커로 띄울 인터프리터
+	bool								cgiNph;				// cgi_nph on: 출력을 그대로 클라이언트에 relay
+
+	size_t								cgiMaxConcurrent;	// 동시 실행 CGI 수 (0이면 제한 없음)
+	size_t								cgiQueueSize;		// 한도를 넘은 요청의 대기열 길이
+	size_t								cgiQueueTimeout;	// 대기 최대 시간 (초)
+	size_t								cgiTimeout;			// 스크립트 응답 제한 시간 (초)
+	size_t								cgiBreakerPercent;	// 차단 기준 실패 비율 (0이면 circuit breaker 없음)
+	size_t								cgiBreakerOpenTime;	// 차단 유지 시간 (초)
+
+	const CacheZoneDirective*			cacheZone;		// cache가 가리키는 cache_zone (없으면 NULL, 설정 소유)
+	std::map<int, size_t>				cacheValid;		// status code -> 캐시 시간 (초, 0번 키는 any)
+	std::vector<std::string>			cacheKeyHeaders;	// 캐시 키에 넣을 요청 헤더 (소문자)
+	size_t								cacheStale;		// 만료 후 갱신하는 동안 이전 응답을 내줄 시간 (초)
+
+	bool								gzip;			// gzip on
+	std::vector<std::string>			gzipTypes;		// 압축할 MIME 타입 ("*"이면 모두)
+	size_t								gzipMinLength;
+	int									gzipCompLevel;	// 최대 압축 레벨
+	bool								gzipStatic;		// gzip_static on
+
+	const ExpiresDirective*				expires;		// expires (없거나 off면 NULL, 설정 소유)
+	const std::vector<AddHeaderDirective>*	addHeaders;	// add_header 목록 (없으면 NULL, 설정 소유)
+	bool								immutableAssets;	// immutable_assets on
+
+	AccessLog*							accessLog;		// access_log (없거나 off면 NULL, AccessLog 소유)
+	bool								serverTiming;	// server_timing on
+	long long							slowRequestLog;	// slow_request_log 기준 (마이크로초, 0이면 off)
+	std::string							metricsServer;	// 지표의 server 라벨 (server_name, 없으면 listen 주소)
+	LatencyHistogram*					latency;		// 이 location의 요청 시간 (Metrics 소유)
+	bool								stubStatus;		// stub_status: 서버 지표로 응답
+
+	bool								autoindex;
+	std::vector<std::string>			indexFiles;
+
+	// status code -> 미리 읽어 둔 에러 페이지 본문 (LocationCompiler 소유)
+	std::map<int, const std::string*>	errorPages;
+
+	CompiledLocation()
+		: maxBodySize(0), methodMask(0), hasAlias(false), isCgi(false),
+		  proxyUpstream(NULL), proxyConnectTimeout(0), proxyReadTimeout(0), proxySendTimeout(0),
+		  cgiPoolWorkers(0), cgiPoolMaxRequests(0), cgiNph(false),
+		  cgiMaxConcurrent(0), cgiQueueSize(0), cgiQueueTimeout(0),
+		  cgiTimeout(0), cgiBreakerPercent(0), cgiBreakerOpenTime(0),
+		  cacheZone(NULL), cacheStale(0),
+		  gzip(false), gzipMinLength(0), gzipCompLevel(0), gzipStatic(false),
+		  expires(NULL), addHeaders(NULL), immutableAssets(false), accessLog(NULL),
+		  serverTiming(false), slowRequestLog(0), latency(NULL), stubStatus(false), autoindex(false) {}
+};
+
+#endif
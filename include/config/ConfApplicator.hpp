@@ -6,11 +6,27 @@
 #include "server/Server.hpp"
 #include "http/HttpRequest.hpp"
 
+class RouteTable;
+class VirtualHostTable;
+class LocationCompiler;
+
 class ConfApplicator {
 private:
 	// 전역으로 관리될 최종 설정 객체
 	static ConfigDTO*	_global_config;
 
+	// 전역 설정의 location들을 컴파일한 결과 (CompiledLocation 소유)
+	static LocationCompiler*		_location_compiler;
+
+	// serverContexts와 같은 순서로 컴파일된 라우팅 테이블
+	static std::vector<RouteTable*>	_route_tables;
+
+	// (port, server_name) -> ServerContext 조회 테이블
+	static VirtualHostTable*		_virtual_hosts;
+
+	static void			buildRoutingTables();
+	static void			clearRoutingTables();
+
 public:
 	ConfApplicator();
 	~ConfApplicator();
@@ -21,6 +37,12 @@ public:
 	// 프로그램 전역에서 설정에 접근하기 위한 static 함수들
 	static void			setGlobalConfig(const ConfigDTO& config);
 	static ConfigDTO*	getGlobalConfig();
+
+	// 전역 설정에 속한 server의 라우팅 테이블 (없으면 NULL)
+	static const RouteTable*	getRouteTable(const ServerContext* server);
+
+	// 전역 설정의 vhost 테이블 (설정 적용 전에는 NULL)
+	static const VirtualHostTable*	getVirtualHosts();
 };
 
 #endif
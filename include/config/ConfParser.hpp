@@ -63,19 +63,47 @@ private:
     HttpContext parseHttpContext();
     ServerContext parseServerContext();
     LocationContext parseLocationContext();
+    UpstreamContext parseUpstreamContext();
+    void resolveUpstreams(HttpContext& httpCtx);
+    void resolveCacheZones(const HttpContext& httpCtx);
     
     // 지시어 파싱 함수들
     BodySizeDirective parseBodySizeDirective();
     ListenDirective parseListenDirective();
-    ServerNameDirective parseServerNameDirective();
+    std::vector<ServerNameDirective> parseServerNameDirective();
     ReturnDirective parseReturnDirective();
+    std::string parseFileDirective(const std::string& directive);
     RootDirective parseRootDirective();
     AliasDirective parseAliasDirective();
     AutoindexDirective parseAutoindexDirective();
     IndexDirective parseIndexDirective();
     CgiPassDirective parseCgiPassDirective();
+    FastCgiPassDirective parseFastCgiPassDirective();
+    ProxyPassDirective parseProxyPassDirective();
+    std::string normalizeHostPort(const std::string& hostPort, const std::string& directive,
+                                  const std::string& value);
+    UpstreamServerDirective parseUpstreamServerDirective();
+    HealthCheckDirective parseHealthCheckDirective();
+    CacheZoneDirective parseCacheZoneDirective();
+    CacheDirective parseCacheDirective();
+    CacheValidDirective parseCacheValidDirective();
+    std::vector<CacheKeyHeaderDirective> parseCacheKeyHeaderDirective();
+    size_t parseParameterValue(const std::string& param, size_t prefixLength,
+                               size_t minValue, size_t maxValue, bool seconds);
+    CgiPoolDirective parseCgiPoolDirective();
+    CgiNphDirective parseCgiNphDirective();
+    bool parseSwitchDirective(const std::string& directive);
+    GzipTypesDirective parseGzipTypesDirective();
+    ExpiresDirective parseExpiresDirective();
+    AddHeaderDirective parseAddHeaderDirective();
+    AccessLogDirective parseAccessLogDirective();
+    SlowRequestLogDirective parseSlowRequestLogDirective();
+    size_t parseCountDirective(const std::string& directive, size_t minValue, size_t maxValue);
+    CgiCircuitBreakerDirective parseCgiCircuitBreakerDirective();
     ErrorPageDirective parseErrorPageDirective();
     LimitExceptDirective parseLimitExceptDirective();
+    TypesDirective parseTypesDirective();
+    DefaultTypeDirective parseDefaultTypeDirective();
     
     // 유틸리티 함수들
     bool isBooleanValue(const std::string& value) const;
@@ -88,6 +116,56 @@ private:
     void validateDirectiveContext(const std::string& directive, const std::string& context);
     bool isValidBodySize(const std::string& size);
 
+    // gzip 지시어들은 http/server/location 어디서나 같은 형태 (처리했으면 true)
+    template<typename Context>
+    bool parseGzipDirective(const std::string& directive, const std::string& context, Context& ctx) {
+        if (directive == "gzip") {
+            checkDuplicateDirective(ctx.opGzipDirective, directive, context);
+            ctx.opGzipDirective.push_back(GzipDirective(parseSwitchDirective(directive)));
+        } else if (directive == "gzip_static") {
+            checkDuplicateDirective(ctx.opGzipStaticDirective, directive, context);
+            ctx.opGzipStaticDirective.push_back(GzipStaticDirective(parseSwitchDirective(directive)));
+        } else if (directive == "gzip_types") {
+            checkDuplicateDirective(ctx.opGzipTypesDirective, directive, context);
+            ctx.opGzipTypesDirective.push_back(parseGzipTypesDirective());
+        } else if (directive == "gzip_min_length") {
+            checkDuplicateDirective(ctx.opGzipMinLengthDirective, directive, context);
+            ctx.opGzipMinLengthDirective.push_back(
+                GzipMinLengthDirective(parseCountDirective(directive, 0, 1024UL * 1024 * 1024)));
+        } else if (directive == "gzip_comp_level") {
+            checkDuplicateDirective(ctx.opGzipCompLevelDirective, directive, context);
+            ctx.opGzipCompLevelDirective.push_back(
+                GzipCompLevelDirective(static_cast<int>(parseCountDirective(directive, 1, 9))));
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    // expires, add_header, access_log, server_timing, slow_request_log도 http/server/location 공통
+    // (add_header는 여러 번 쓸 수 있음)
+    template<typename Context>
+    bool parseHeaderDirective(const std::string& directive, const std::string& context, Context& ctx) {
+        if (directive == "expires") {
+            checkDuplicateDirective(ctx.opExpiresDirective, directive, context);
+            ctx.opExpiresDirective.push_back(parseExpiresDirective());
+        } else if (directive == "add_header") {
+            ctx.opAddHeaderDirective.push_back(parseAddHeaderDirective());
+        } else if (directive == "access_log") {
+            checkDuplicateDirective(ctx.opAccessLogDirective, directive, context);
+            ctx.opAccessLogDirective.push_back(parseAccessLogDirective());
+        } else if (directive == "server_timing") {
+            checkDuplicateDirective(ctx.opServerTimingDirective, directive, context);
+            ctx.opServerTimingDirective.push_back(ServerTimingDirective(parseSwitchDirective(directive)));
+        } else if (directive == "slow_request_log") {
+            checkDuplicateDirective(ctx.opSlowRequestLogDirective, directive, context);
+            ctx.opSlowRequestLogDirective.push_back(parseSlowRequestLogDirective());
+        } else {
+            return false;
+        }
+        return true;
+    }
+
     // 중복 지시어 체크 헬퍼 함수 (제네릭)
     template<typename T>
     void checkDuplicateDirective(const std::vector<T>& directiveVector, 
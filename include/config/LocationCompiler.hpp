@@ -0,0 +1,45 @@
+#ifndef LOCATION_COMPILER_HPP
+#define LOCATION_COMPILER_HPP
+
+#include "dto/ConfigDTO.hpp"
+#include "config/CompiledLocation.hpp"
+#include <string>
+#include <vector>
+#include <map>
+
+/**
+ * @brief cascade된 설정의 모든 location을 CompiledLocation으로 변환.
+ *
+ * 생성된 CompiledLocation과 에러 페이지 버퍼는 이 객체가 소유하므로,
+ * 설정(ConfigDTO)이 살아있는 동안 함께 유지되어야 함.
+ */
+class LocationCompiler {
+private:
+	std::vector<CompiledLocation*>			_locations;
+	std::map<std::string, std::string*>		_errorPageBodies;	// 경로 -> 본문 (경로가 같으면 공유)
+
+	CompiledLocation*	compileLocation(const HttpContext& http,
+										const ServerContext& server,
+										const LocationContext& location);
+	void				loadErrorPages(CompiledLocation* compiled,
+									   const std::vector<ErrorPageDirective>& directives);
+	const std::string*	loadErrorPageBody(const std::string& path);
+
+	LocationCompiler(const LocationCompiler&);
+	LocationCompiler& operator=(const LocationCompiler&);
+
+public:
+	static const size_t	DEFAULT_MAX_BODY_SIZE;
+	static const char*	DEFAULT_ROOT;
+
+	LocationCompiler();
+	~LocationCompiler();
+
+	// config의 모든 LocationContext::compiled 포인터를 채움
+	void				compile(ConfigDTO& config);
+
+	// 확장자(".py" 등)에 대응하는 기본 인터프리터 (없으면 빈 문자열)
+	static std::string	interpreterForExtension(const std::string& extension);
+};
+
+#endif
@@ -7,6 +7,8 @@
 #include <string>
 #include <cstdlib>
 
+struct CompiledLocation;
+
 struct BodySizeDirective {
     std::string size;  // "100M", "2000M" 등
 
@@ -16,15 +18,28 @@ struct BodySizeDirective {
 struct ListenDirective {
     std::string address;    // "192.168.1.100:8080", "80" 등
     bool default_server;    // default_server 키워드 여부
+    bool ssl;               // ssl 키워드 여부 (TLS로 받음)
     std::string host;
     int port;
 
-    ListenDirective(const std::string& addr, bool is_default = false) 
-        : address(addr), default_server(is_default) {}
+    ListenDirective(const std::string& addr, bool is_default = false, bool is_ssl = false)
+        : address(addr), default_server(is_default), ssl(is_ssl) {}
+};
+
+struct SslCertificateDirective {
+    std::string path;   // PEM 인증서 (체인 포함)
+
+    SslCertificateDirective(const std::string& p) : path(p) {}
+};
+
+struct SslCertificateKeyDirective {
+    std::string path;   // PEM 개인 키
+
+    SslCertificateKeyDirective(const std::string& p) : path(p) {}
 };
 
 struct ServerNameDirective {
-    std::string name;  // "example.com" 등
+    std::string name;  // "example.com", "*.example.com", "www.example.*" 등
     
     ServerNameDirective(const std::string& n) : name(n) {}
 };
@@ -66,6 +81,233 @@ struct CgiPassDirective {
     CgiPassDirective(const std::string& s) : path(s) {}
 };
 
+struct FastCgiPassDirective {
+    std::string address;  // "unix:/run/php/php-fpm.sock", "127.0.0.1:9000" 등
+
+    FastCgiPassDirective(const std::string& a) : address(a) {}
+};
+
+struct ProxyPassDirective {
+    std::string address;  // 연결할 업스트림: "127.0.0.1:8000", "unix:/run/app.sock" 등
+    std::string uri;      // http://host:port 뒤의 경로 (없으면 빈 문자열)
+    std::string upstream; // 포트 없이 쓴 호스트가 upstream 블록 이름이면 그 이름 (아니면 빈 문자열)
+
+    ProxyPassDirective(const std::string& a, const std::string& u) : address(a), uri(u) {}
+};
+
+struct ProxyTimeoutDirective {
+    size_t seconds;       // proxy_connect_timeout / proxy_read_timeout / proxy_send_timeout
+
+    ProxyTimeoutDirective(size_t s) : seconds(s) {}
+};
+
+struct CgiPoolDirective {
+    size_t workers;       // 미리 띄워 둘 워커 프로세스 수
+    size_t maxRequests;   // 워커 하나가 처리한 뒤 교체되는 요청 수 (0이면 기본값)
+
+    CgiPoolDirective(size_t w, size_t m) : workers(w), maxRequests(m) {}
+};
+
+struct CgiNphDirective {
+    bool enabled;         // on이면 스크립트 출력이 곧 전체 HTTP 응답 (nph-* 스크립트와 같음)
+
+    CgiNphDirective(bool e) : enabled(e) {}
+};
+
+struct CgiMaxConcurrentDirective {
+    size_t count;         // 이 location에서 동시에 실행할 CGI 프로세스 수
+
+    CgiMaxConcurrentDirective(size_t c) : count(c) {}
+};
+
+struct CgiQueueSizeDirective {
+    size_t size;          // 한도를 넘은 요청이 기다릴 수 있는 자리 (0이면 바로 503)
+
+    CgiQueueSizeDirective(size_t s) : size(s) {}
+};
+
+struct CgiQueueTimeoutDirective {
+    size_t seconds;       // 대기열에서 기다릴 최대 시간
+
+    CgiQueueTimeoutDirective(size_t s) : seconds(s) {}
+};
+
+struct CgiTimeoutDirective {
+    size_t seconds;       // 바디를 다 받은 뒤 스크립트가 응답을 마칠 때까지 기다릴 시간
+
+    CgiTimeoutDirective(size_t s) : seconds(s) {}
+};
+
+struct CgiCircuitBreakerDirective {
+    size_t errorPercent;  // 최근 결과 중 실패 비율이 이 이상이면 차단
+    size_t openSeconds;   // 차단 후 시험 요청을 보내기까지 기다릴 시간
+
+    CgiCircuitBreakerDirective(size_t p, size_t o) : errorPercent(p), openSeconds(o) {}
+};
+
+struct UpstreamServerDirective {
+    std::string address;      // "127.0.0.1:8001", "unix:/run/app.sock" 등
+    size_t weight;
+    size_t maxFails;          // fail_timeout 안에서 이만큼 실패하면 down (0이면 추적하지 않음)
+    size_t failTimeout;       // 실패를 세는 구간이자 down 유지 시간 (초)
+
+    UpstreamServerDirective(const std::string& a)
+        : address(a), weight(1), maxFails(1), failTimeout(10) {}
+};
+
+struct HealthCheckDirective {
+    size_t interval;          // 검사 주기 (초), 응답 제한 시간으로도 사용
+    std::string uri;          // GET 요청 경로, 2xx/3xx면 정상
+
+    HealthCheckDirective() : interval(5), uri("/") {}
+};
+
+// upstream 블록의 서버 선택 방식
+enum UpstreamPolicy {
+    UPSTREAM_ROUND_ROBIN,     // 기본 (weight 반영)
+    UPSTREAM_LEAST_CONN,      // least_conn;
+    UPSTREAM_HASH             // hash $request_uri; / hash $cookie_NAME;
+};
+
+struct UpstreamContext {
+    std::string name;
+    std::vector<UpstreamServerDirective> servers;
+    UpstreamPolicy policy;
+    std::string hashCookie;   // hash $cookie_NAME의 NAME (비어 있으면 요청 URI)
+
+    // Optional directives (vector로 구현, 0개 또는 1개 요소)
+    std::vector<HealthCheckDirective> opHealthCheckDirective;
+
+    UpstreamContext(const std::string& n) : name(n), policy(UPSTREAM_ROUND_ROBIN) {}
+};
+
+struct CacheZoneDirective {
+    std::string name;
+    size_t size;              // 메모리에 둘 응답 크기 합 (바이트)
+    size_t maxEntry;          // 이보다 큰 응답은 캐시하지 않음
+    std::string path;         // 메모리에서 밀려난 응답을 내려 둘 디렉터리 (없으면 빈 문자열)
+    size_t diskSize;          // path에 둘 응답 크기 합
+
+    CacheZoneDirective(const std::string& n, size_t s)
+        : name(n), size(s), maxEntry(s / 8), diskSize(0) {}
+};
+
+struct CacheDirective {
+    std::string zone;         // cache_zone 이름
+
+    CacheDirective(const std::string& z) : zone(z) {}
+};
+
+struct CacheValidDirective {
+    std::vector<int> codes;   // 0이면 any
+    size_t seconds;
+
+    CacheValidDirective(const std::vector<int>& c, size_t s) : codes(c), seconds(s) {}
+};
+
+struct CacheKeyHeaderDirective {
+    std::string name;         // 캐시 키에 값을 넣을 요청 헤더 (소문자)
+
+    CacheKeyHeaderDirective(const std::string& n) : name(n) {}
+};
+
+struct CacheStaleDirective {
+    size_t seconds;           // 만료 후 갱신하는 동안 이전 응답을 내줄 시간
+
+    CacheStaleDirective(size_t s) : seconds(s) {}
+};
+
+struct GzipDirective {
+    bool enabled;             // on이면 Accept-Encoding에 따라 응답을 압축
+
+    GzipDirective(bool e) : enabled(e) {}
+};
+
+struct GzipTypesDirective {
+    std::vector<std::string> types;   // 압축할 MIME 타입 ("*"이면 모두, text/html은 항상 포함)
+
+    GzipTypesDirective(const std::vector<std::string>& t) : types(t) {}
+};
+
+struct GzipMinLengthDirective {
+    size_t length;            // 이보다 짧은 바디는 압축하지 않음
+
+    GzipMinLengthDirective(size_t l) : length(l) {}
+};
+
+struct GzipCompLevelDirective {
+    int level;                // 최대 압축 레벨 (1~9, 부하가 높으면 낮춰서 사용)
+
+    GzipCompLevelDirective(int l) : level(l) {}
+};
+
+struct GzipStaticDirective {
+    bool enabled;             // on이면 정적 파일 옆의 .gz 파일을 그대로 보냄
+
+    GzipStaticDirective(bool e) : enabled(e) {}
+};
+
+enum ExpiresMode {
+    EXPIRES_OFF,              // Expires/Cache-Control를 건드리지 않음
+    EXPIRES_EPOCH,            // 1970-01-01 + no-cache
+    EXPIRES_MAX,              // 2037-12-31 + max-age=315360000
+    EXPIRES_TIME              // 지금 + seconds (음수면 no-cache)
+};
+
+struct ExpiresDirective {
+    ExpiresMode mode;
+    long seconds;
+
+    ExpiresDirective(ExpiresMode m, long s) : mode(m), seconds(s) {}
+};
+
+struct AddHeaderDirective {
+    std::string name;
+    std::string value;
+    bool always;              // always면 에러 응답에도 붙임 (아니면 2xx/3xx만)
+
+    AddHeaderDirective(const std::string& n, const std::string& v, bool a) : name(n), value(v), always(a) {}
+};
+
+struct ImmutableAssetsDirective {
+    bool enabled;             // on이면 파일명에 해시가 있는 파일을 1년 immutable로 보냄
+
+    ImmutableAssetsDirective(bool e) : enabled(e) {}
+};
+
+struct StubStatusDirective {
+    // 인자 없음: stub_status;  (이 location은 서버 지표를 Prometheus 텍스트로 응답)
+};
+
+enum AccessLogFormat {
+    ACCESS_LOG_COMBINED,      // 기본: common + "referer" "user-agent"
+    ACCESS_LOG_COMMON,        // addr - - [time] "request" status bytes
+    ACCESS_LOG_TIMED,         // combined + 처리 시간과 단계별 시간 (RequestTrace)
+    ACCESS_LOG_BINARY         // 길이 접두 바이너리 레코드 (AccessLog.hpp 참고)
+};
+
+struct AccessLogDirective {
+    std::string path;         // 비어 있으면 access_log off
+    AccessLogFormat format;
+    size_t bufferSize;        // 이벤트 루프가 쓰는 링 버퍼 크기 (바이트)
+    size_t flush;             // 링 버퍼에 쌓인 로그를 파일에 쓰는 최대 간격 (초)
+    size_t sample;            // N개 요청 중 하나만 기록 (5xx는 항상 기록)
+
+    AccessLogDirective() : format(ACCESS_LOG_COMBINED), bufferSize(64 * 1024), flush(1), sample(1) {}
+};
+
+struct ServerTimingDirective {
+    bool enabled;             // on이면 응답에 Server-Timing 헤더로 단계별 시간을 붙임
+
+    ServerTimingDirective(bool e) : enabled(e) {}
+};
+
+struct SlowRequestLogDirective {
+    long long threshold;      // 마이크로초. 이보다 오래 걸린 요청의 단계별 시간을 로그로 (0이면 off)
+
+    SlowRequestLogDirective(long long t) : threshold(t) {}
+};
+
 struct ErrorPageDirective {
     std::map<int, std::string> errorPageMap;  // status code -> path mapping
 
@@ -80,9 +322,21 @@ struct ErrorPageDirective {
 
 struct LimitExceptDirective {
     std::set<std::string> allowed_methods;  // {"GET", "HEAD"} 등 (중복 자동 제거)
+    unsigned int methodMask;                   // allowed_methods의 비트마스크 (HttpMethodMask)
     bool deny_all;                             // deny all 여부
 
-    LimitExceptDirective() : deny_all(false) {}
+    LimitExceptDirective() : methodMask(0), deny_all(false) {}
+};
+
+struct TypesDirective {
+    std::map<std::string, std::string> extensionMap;  // 확장자('.' 제외) -> MIME type
+    std::vector<std::string> includeFiles;            // mime.types 형식 파일 (예: /etc/mime.types)
+};
+
+struct DefaultTypeDirective {
+    std::string type;  // "application/octet-stream" 등
+
+    DefaultTypeDirective(const std::string& t) : type(t) {}
 };
 
 // Location matching type (우선순위: EXACT > EXTENSION > PREFIX)
@@ -105,9 +359,40 @@ struct LocationContext {
     std::vector<AutoindexDirective> opAutoindexDirective;
     std::vector<IndexDirective> opIndexDirective;
     std::vector<CgiPassDirective> opCgiPassDirective;
+    std::vector<FastCgiPassDirective> opFastCgiPassDirective;
+    std::vector<ProxyPassDirective> opProxyPassDirective;
+    std::vector<ProxyTimeoutDirective> opProxyConnectTimeoutDirective;
+    std::vector<ProxyTimeoutDirective> opProxyReadTimeoutDirective;
+    std::vector<ProxyTimeoutDirective> opProxySendTimeoutDirective;
+    std::vector<CgiPoolDirective> opCgiPoolDirective;
+    std::vector<CgiNphDirective> opCgiNphDirective;
+    std::vector<CgiMaxConcurrentDirective> opCgiMaxConcurrentDirective;
+    std::vector<CgiQueueSizeDirective> opCgiQueueSizeDirective;
+    std::vector<CgiQueueTimeoutDirective> opCgiQueueTimeoutDirective;
+    std::vector<CgiTimeoutDirective> opCgiTimeoutDirective;
+    std::vector<CgiCircuitBreakerDirective> opCgiCircuitBreakerDirective;
+    std::vector<CacheDirective> opCacheDirective;
+    std::vector<CacheValidDirective> opCacheValidDirective;
+    std::vector<CacheKeyHeaderDirective> opCacheKeyHeaderDirective;
+    std::vector<CacheStaleDirective> opCacheStaleDirective;
+    std::vector<GzipDirective> opGzipDirective;
+    std::vector<GzipTypesDirective> opGzipTypesDirective;
+    std::vector<GzipMinLengthDirective> opGzipMinLengthDirective;
+    std::vector<GzipCompLevelDirective> opGzipCompLevelDirective;
+    std::vector<GzipStaticDirective> opGzipStaticDirective;
+    std::vector<ExpiresDirective> opExpiresDirective;
+    std::vector<AddHeaderDirective> opAddHeaderDirective;
+    std::vector<ImmutableAssetsDirective> opImmutableAssetsDirective;
+    std::vector<AccessLogDirective> opAccessLogDirective;
+    std::vector<ServerTimingDirective> opServerTimingDirective;
+    std::vector<SlowRequestLogDirective> opSlowRequestLogDirective;
+    std::vector<StubStatusDirective> opStubStatusDirective;
     std::vector<ErrorPageDirective> opErrorPageDirective;
 
-    LocationContext(const std::string& p) : path(p), matchType(MATCH_PREFIX) {}
+    // 설정 적용 시 LocationCompiler가 채움 (소유권 없음, 적용 전에는 NULL)
+    const CompiledLocation* compiled;
+
+    LocationContext(const std::string& p) : path(p), matchType(MATCH_PREFIX), compiled(NULL) {}
 };
 
 struct ServerContext {
@@ -117,21 +402,47 @@ struct ServerContext {
     std::vector<BodySizeDirective> opBodySizeDirective;
     std::vector<ListenDirective> opListenDirective;
     std::vector<ServerNameDirective> opServerNameDirective;
+    std::vector<SslCertificateDirective> opSslCertificateDirective;
+    std::vector<SslCertificateKeyDirective> opSslCertificateKeyDirective;
     std::vector<ReturnDirective> opReturnDirective;
     std::vector<RootDirective> opRootDirective;
     std::vector<AutoindexDirective> opAutoindexDirective;
     std::vector<IndexDirective> opIndexDirective;
+    std::vector<GzipDirective> opGzipDirective;
+    std::vector<GzipTypesDirective> opGzipTypesDirective;
+    std::vector<GzipMinLengthDirective> opGzipMinLengthDirective;
+    std::vector<GzipCompLevelDirective> opGzipCompLevelDirective;
+    std::vector<GzipStaticDirective> opGzipStaticDirective;
+    std::vector<ExpiresDirective> opExpiresDirective;
+    std::vector<AddHeaderDirective> opAddHeaderDirective;
+    std::vector<AccessLogDirective> opAccessLogDirective;
+    std::vector<ServerTimingDirective> opServerTimingDirective;
+    std::vector<SlowRequestLogDirective> opSlowRequestLogDirective;
     std::vector<ErrorPageDirective> opErrorPageDirective;
 };
 
 struct HttpContext {
     std::vector<ServerContext> serverContexts;
+    std::vector<UpstreamContext> upstreamContexts;
 
     // Optional directives (vector로 구현, 0개 또는 1개 요소)
     std::vector<BodySizeDirective> opBodySizeDirective;
     std::vector<RootDirective> opRootDirective;
     std::vector<IndexDirective> opIndexDirective;
     std::vector<ErrorPageDirective> opErrorPageDirective;
+    std::vector<TypesDirective> opTypesDirective;
+    std::vector<DefaultTypeDirective> opDefaultTypeDirective;
+    std::vector<CacheZoneDirective> opCacheZoneDirective;
+    std::vector<GzipDirective> opGzipDirective;
+    std::vector<GzipTypesDirective> opGzipTypesDirective;
+    std::vector<GzipMinLengthDirective> opGzipMinLengthDirective;
+    std::vector<GzipCompLevelDirective> opGzipCompLevelDirective;
+    std::vector<GzipStaticDirective> opGzipStaticDirective;
+    std::vector<ExpiresDirective> opExpiresDirective;
+    std::vector<AddHeaderDirective> opAddHeaderDirective;
+    std::vector<AccessLogDirective> opAccessLogDirective;
+    std::vector<ServerTimingDirective> opServerTimingDirective;
+    std::vector<SlowRequestLogDirective> opSlowRequestLogDirective;
 };
 
 struct ConfigDTO {
@@ -0,0 +1,35 @@
+#ifndef CONDITIONAL_REQUEST_HPP
+#define CONDITIONAL_REQUEST_HPP
+
+#include <string>
+#include <ctime>
+#include <sys/stat.h>
+
+class HttpRequest;
+
+/**
+ * @brief 정적 파일의 검증자(ETag, Last-Modified)와 조건부 요청 판정.
+ *
+ * 검증자는 이미 해 둔 stat 결과(inode, 크기, mtime)만으로 만들므로 파일을 열지 않고
+ * 304를 결정할 수 있음. If-None-Match가 있으면 If-Modified-Since는 보지 않음 (RFC 9110).
+ */
+class ConditionalRequest {
+public:
+	// "inode-크기-mtime" (16진수). 같은 경로에 새 파일이 생기면 inode가 달라짐
+	static std::string	makeETag(const struct stat& st);
+
+	// IMF-fixdate ("Sun, 06 Nov 1994 08:49:37 GMT")
+	static std::string	formatDate(time_t when);
+	static bool			parseDate(const std::string& value, time_t& when);
+
+	// If-None-Match / If-Modified-Since 기준으로 클라이언트 사본이 최신이면 true
+	static bool			isNotModified(const HttpRequest* request, const std::string& etag, time_t lastModified);
+
+	// If-Range가 없거나 현재 표현과 같으면 true (ETag는 strong 비교, 날짜는 Last-Modified와 정확히 일치)
+	static bool			isRangeFresh(const HttpRequest* request, const std::string& etag, time_t lastModified);
+
+	// If-None-Match 목록에 etag가 있으면 true (weak 비교, "*"는 모두 일치)
+	static bool			matchesETag(const std::string& header, const std::string& etag);
+};
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef HTTP_METHOD_HPP
+# define HTTP_METHOD_HPP
+
+#include <string>
+
+// limit_except 및 라우팅에서 사용하는 메서드 비트마스크
+enum HttpMethodMask {
+	METHOD_NONE		= 0,
+	METHOD_GET		= 1 << 0,
+	METHOD_HEAD		= 1 << 1,
+	METHOD_POST		= 1 << 2,
+	METHOD_PUT		= 1 << 3,
+	METHOD_DELETE	= 1 << 4
+};
+
+namespace HttpMethod {
+
+	// 메서드 문자열을 비트로 변환 (알 수 없는 메서드는 METHOD_NONE)
+	unsigned int	toMask(const std::string& method);
+
+} // namespace HttpMethod
+
+#endif
@@ -4,34 +4,58 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <sys/types.h>
 
 #include "http/HttpRequest.hpp"
 #include "dto/ConfigDTO.hpp"
 
+/**
+ * @brief 파일에서 보낼 바디 조각. prefix(multipart 파트 헤더 등)를 먼저 보내고
+ * 파일의 [offset, offset + length)를 sendfile로 보냄 (length가 0이면 prefix만).
+ */
+struct FileSegment {
+	std::string	prefix;
+	off_t		offset;
+	size_t		length;
+
+	FileSegment(const std::string& p, off_t o, size_t l) : prefix(p), offset(o), length(l) {}
+};
+
 class HttpResponse {
 private:
 	int									_statusCode;
 	std::map<std::string, std::string>	_headers;
 	std::string 						_body;
+	int									_fileFd;	// 파일 바디 (소유, 없으면 -1)
+	std::vector<FileSegment>			_fileSegments;
 
 	// Internal Utility
 	void	setDefaultHeaders(const HttpRequest* request);
 	
 public:
 	HttpResponse();
+	HttpResponse(const HttpResponse& other);
+	HttpResponse& operator=(const HttpResponse& other);
 	~HttpResponse();
 	
 	/* Setters */
 	void setStatus(int code);
 	void setHeader(const std::string& key, const std::string& value);
+	void removeHeader(const std::string& key);
 	void setBody(const std::string& body);
 	void setContentType(const std::string& type);
+	// 바디를 메모리 대신 파일 조각으로 보냄 (fd 소유권을 가져감)
+	void setFileBody(int fd, const std::vector<FileSegment>& segments);
 
 	/* Getters */
 	int getStatus() const;
 	std::string getHeader(const std::string& key) const;
+	const std::map<std::string, std::string>& getHeaders() const;
 	std::string getBody() const;
 	std::string getContentType() const;
+	bool hasFileBody() const;
+	int getFileFd() const;
+	const std::vector<FileSegment>& getFileSegments() const;
 
 	/* Cookie Management */
 	// void addCookie(const std::string& name, const std::string& value, int maxAge = -1, const std::string& path = "/", bool httpOnly = true);
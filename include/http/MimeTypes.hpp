@@ -0,0 +1,43 @@
+#ifndef MIME_TYPES_HPP
+#define MIME_TYPES_HPP
+
+#include <string>
+#include "dto/ConfigDTO.hpp"
+#include "utils/StringHashTable.hpp"
+
+/**
+ * @brief 확장자 -> Content-Type 조회 테이블.
+ *
+ * 내장 기본 타입 위에 http 블록의 types { } / default_type 설정을 덮어써서
+ * 설정 적용 시점에 한 번 구성하고, 요청마다 해시 조회 한 번으로 타입을 찾음.
+ * 반환값은 테이블이 소유한 문자열의 참조이므로 응답마다 복사/소문자 변환이 없음.
+ */
+class MimeTypes {
+private:
+	static StringHashTable<std::string>	_types;		// 확장자('.' 제외) -> MIME type (대소문자 무시)
+	static std::string					_defaultType;
+	static bool							_initialized;
+
+	static void	loadBuiltinTypes();
+	static bool	loadMimeTypesFile(const std::string& path);
+
+	MimeTypes();
+	~MimeTypes();
+	MimeTypes(const MimeTypes&);
+	MimeTypes& operator=(const MimeTypes&);
+
+public:
+	static const char* const	DEFAULT_TYPE;
+
+	// http 블록 설정으로 테이블 재구성 (내장 타입 -> include 파일 -> types 항목 순으로 덮어씀)
+	static void					configure(const HttpContext& http);
+
+	// 확장자('.' 제외)로 조회, 없으면 default_type
+	static const std::string&	lookup(const char* ext, size_t len);
+	static const std::string&	lookup(const std::string& ext);
+
+	// 경로의 마지막 세그먼트에서 확장자를 찾아 조회
+	static const std::string&	fromPath(const std::string& path);
+};
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef RANGE_REQUEST_HPP
+#define RANGE_REQUEST_HPP
+
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+/**
+ * @brief 바이트 범위 하나 (양끝 포함, 파일 크기에 맞춰 잘라 둔 값).
+ */
+struct ByteRange {
+	off_t	first;
+	off_t	last;
+
+	ByteRange(off_t f, off_t l) : first(f), last(l) {}
+
+	off_t	length() const { return last - first + 1; }
+};
+
+/**
+ * @brief Range: bytes=... 헤더 파싱 (RFC 9110 14.2).
+ *
+ * 문법이 틀린 헤더는 무시하고 전체를 보냄(RANGE_NONE). 범위가 겹치거나 MAX_RANGES를
+ * 넘으면 정렬해 합치고(같은 바이트를 여러 번 보내지 않음), 그래도 많으면 무시함.
+ */
+class RangeRequest {
+public:
+	enum Result {
+		RANGE_NONE,				// Range를 무시하고 200
+		RANGE_SATISFIABLE,		// 206
+		RANGE_UNSATISFIABLE		// 416
+	};
+
+	static const size_t	MAX_RANGES;		// 한 요청에서 보낼 최대 범위 수
+
+	static Result		parse(const std::string& header, off_t size, std::vector<ByteRange>& ranges);
+
+	// "bytes first-last/size"
+	static std::string	contentRange(const ByteRange& range, off_t size);
+
+	// multipart/byteranges 경계 문자열 (응답마다 다름)
+	static std::string	makeBoundary();
+};
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef RESPONSE_COMPRESSOR_HPP
+#define RESPONSE_COMPRESSOR_HPP
+
+#include <string>
+#include <map>
+#include <list>
+#include <sys/stat.h>
+#include <zlib.h>
+
+class HttpRequest;
+class HttpResponse;
+struct CompiledLocation;
+
+/**
+ * @brief zlib deflate 스트림 하나. 스트리밍 응답은 바디가 오는 대로 압축해 내보냄.
+ */
+class CompressStream {
+private:
+	z_stream	_zs;
+	bool		_ready;
+
+	CompressStream(const CompressStream&);
+	CompressStream& operator=(const CompressStream&);
+
+public:
+	CompressStream();
+	~CompressStream();
+
+	// gzip: gzip 헤더/트레일러, 아니면 zlib 형식 (HTTP의 "deflate")
+	bool	init(bool gzip, int level);
+
+	/**
+	 * @brief 입력을 압축해 out 뒤에 붙임.
+	 * @param finish false면 지금까지의 입력을 모두 내보내고(Z_SYNC_FLUSH), true면 스트림을 끝냄
+	 */
+	bool	compress(const char* data, size_t len, std::string& out, bool finish);
+};
+
+/**
+ * @brief gzip/gzip_types/gzip_min_length/gzip_static: Accept-Encoding에 따른 응답 압축.
+ *
+ * 다 만들어진 응답은 바디를 한 번에, 스트리밍 응답(CGI, 프록시)은 CompressStream으로
+ * 청크마다 압축함. 압축 레벨은 gzip_comp_level을 상한으로 서버 프로세스의 최근 CPU
+ * 사용률에 따라 낮춤. 정적 파일은 경로별로 압축 결과를 크기 제한 LRU에 두고
+ * mtime/크기/inode가 같으면 다시 압축하지 않으므로 파일마다 한 번만 압축함.
+ */
+class ResponseCompressor {
+public:
+	enum Encoding {
+		IDENTITY,
+		GZIP,
+		DEFLATE
+	};
+
+	static const size_t	DEFAULT_MIN_LENGTH;		// gzip_min_length 기본값
+	static const int	DEFAULT_COMP_LEVEL;		// gzip_comp_level 기본값
+	static const size_t	STATIC_CACHE_SIZE;		// 정적 파일 압축 결과를 둘 메모리 상한
+	static const off_t	MAX_STATIC_SIZE;		// 이보다 큰 정적 파일은 압축하지 않고 원본 그대로 보냄
+
+	// Accept-Encoding에서 쓸 수 있는 인코딩 (gzip 우선, q=0은 제외)
+	static Encoding		negotiate(const HttpRequest* request);
+	static const char*	encodingName(Encoding encoding);
+
+	// location에서 압축할 타입이면 Vary: Accept-Encoding을 붙이고 쓸 인코딩을 돌려줌
+	static Encoding		select(HttpResponse& response, const HttpRequest* request,
+							   const CompiledLocation* location, size_t length);
+
+	// 다 만들어진 응답의 바디를 압축 (대상이 아니면 그대로)
+	static void			compressResponse(HttpResponse& response, const HttpRequest* request,
+										 const CompiledLocation* location);
+
+	// 스트리밍 응답 헤더를 압축용으로 바꾸고 스트림을 돌려줌 (대상이 아니면 NULL)
+	static CompressStream*	startStream(HttpResponse& head, const HttpRequest* request,
+										const CompiledLocation* location);
+
+	/**
+	 * @brief 정적 파일의 압축 결과 (없거나 파일이 바뀌었으면 읽어서 압축해 캐시에 둠).
+	 *
+	 * 이벤트 루프에서 파일 전체를 한 번에 압축하므로 MAX_STATIC_SIZE 이하의 파일만 넘길 것.
+	 * @return 파일을 읽지 못하면 NULL. 반환값은 캐시 항목이므로 다음 호출 전까지만 유효함
+	 */
+	static const std::string*	compressFile(const std::string& path, const struct stat& st,
+											 Encoding encoding, int level);
+
+	static int			level(int maxLevel);	// 현재 부하에서 쓸 압축 레벨
+	static void			updateLoad();			// CPU 사용률 갱신 (Server::onTick에서 호출)
+
+private:
+	struct FileVariant {
+		std::string							body;
+		time_t								mtime;
+		off_t								size;
+		ino_t								inode;
+		std::list<std::string>::iterator	lru;
+	};
+
+	static std::map<std::string, FileVariant>	_files;		// 경로 + 인코딩 -> 압축 결과
+	static std::list<std::string>				_fileLru;	// 앞쪽이 가장 최근에 쓴 파일
+	static size_t								_fileBytes;
+	static double								_cpuLoad;	// 최근 틱 동안 CPU 사용 시간 / 경과 시간
+	static double								_lastCpu;
+	static double								_lastWall;
+
+	static bool		compressBody(const std::string& body, Encoding encoding, int level, std::string& out);
+
+	ResponseCompressor();
+	~ResponseCompressor();
+	ResponseCompressor(const ResponseCompressor&);
+	ResponseCompressor& operator=(const ResponseCompressor&);
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef ROUTE_TABLE_HPP
+# define ROUTE_TABLE_HPP
+
+#include <string>
+#include <vector>
+#include "dto/ConfigDTO.hpp"
+#include "utils/StringHashTable.hpp"
+
+/**
+ * @brief ServerContext 하나를 요청 라우팅용 구조로 컴파일한 결과.
+ *
+ * 설정 적용 시점(ConfApplicator::applyConfig)에 한 번 만들어지며,
+ * 요청마다 location 목록을 순회하는 대신 아래 세 구조만 조회함.
+ *  - EXACT     : 경로 -> location 해시
+ *  - EXTENSION : 확장자 -> location 해시
+ *  - PREFIX    : 경로 prefix radix trie (가장 긴 prefix 매칭)
+ *
+ * 조회는 힙 할당 없이 URI 길이에 비례하는 시간에 끝남.
+ */
+class RouteTable {
+private:
+	struct RadixNode {
+		std::string					label;		// 부모로부터 이어지는 간선 문자열
+		std::string					firstBytes;	// children[i]->label[0] 모음 (memchr 탐색용)
+		std::vector<RadixNode*>		children;
+		const LocationContext*		loc;		// 이 노드에서 끝나는 prefix location
+
+		RadixNode(const std::string& l) : label(l), loc(NULL) {}
+		~RadixNode();
+
+		RadixNode*	findChild(char c) const;
+		void		addChild(RadixNode* child);
+	};
+
+	struct ExtensionEntry {
+		const LocationContext*	loc;
+		size_t					order;	// 설정 파일 내 순서 (나중 것이 우선)
+
+		ExtensionEntry() : loc(NULL), order(0) {}
+		ExtensionEntry(const LocationContext* l, size_t o) : loc(l), order(o) {}
+	};
+
+	StringHashTable<const LocationContext*>	_exact;
+	StringHashTable<ExtensionEntry>			_extensions;
+	size_t									_maxExtensionLength;
+	RadixNode*								_prefixRoot;
+
+	void					insertPrefix(const LocationContext* loc);
+	const LocationContext*	findExact(const char* uri, size_t len) const;
+	const LocationContext*	findExtension(const char* uri, size_t len) const;
+	const LocationContext*	findPrefix(const char* uri, size_t len) const;
+
+	// 소유한 trie 노드를 복사하지 않도록 막음
+	RouteTable(const RouteTable&);
+	RouteTable& operator=(const RouteTable&);
+
+public:
+	RouteTable();
+	~RouteTable();
+
+	// server의 location들로 테이블 구성 (server는 테이블보다 오래 살아야 함)
+	void					build(const ServerContext& server);
+
+	/**
+	 * @brief URI(쿼리 스트링 제외 부분)에 맞는 location 탐색.
+	 *
+	 * 우선순위는 EXACT > EXTENSION > PREFIX이며, EXTENSION이 메서드를 거부하면
+	 * PREFIX로 폴백함 (기존 RequestRouter 동작 유지).
+	 * @param uri URI 시작 포인터
+	 * @param len 쿼리 스트링 이전까지의 길이
+	 * @param methodMask 요청 메서드 비트 (HttpMethodMask)
+	 */
+	const LocationContext*	find(const char* uri, size_t len, unsigned int methodMask) const;
+
+	static bool				isMethodAllowed(unsigned int methodMask, const LocationContext& loc);
+};
+
+#endif
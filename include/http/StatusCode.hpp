@@ -10,6 +10,7 @@ class StatusCode {
 	static const int CREATED                        = 201;
 	static const int ACCEPTED                       = 202;
 	static const int NO_CONTENT                     = 204;
+	static const int PARTIAL_CONTENT                = 206;
 
 	// 3xx Redirection
 	static const int MOVED_PERMANENTLY              = 301;
@@ -27,6 +28,7 @@ class StatusCode {
 	static const int GONE                           = 410;
 	static const int PAYLOAD_TOO_LARGE              = 413;
 	static const int URI_TOO_LONG                   = 414;
+	static const int RANGE_NOT_SATISFIABLE          = 416;
 	static const int REQUEST_HEADER_FIELDS_TOO_LARGE = 431;
 
 	// 5xx Server Error
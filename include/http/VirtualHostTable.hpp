@@ -0,0 +1,56 @@
+#ifndef VIRTUAL_HOST_TABLE_HPP
+# define VIRTUAL_HOST_TABLE_HPP
+
+#include <map>
+#include <string>
+#include "dto/ConfigDTO.hpp"
+#include "utils/StringHashTable.hpp"
+
+/**
+ * @brief (port, server_name) -> ServerContext 조회 테이블.
+ *
+ * ConfApplicator::applyConfig에서 한 번 구성되며, 요청마다 모든 server/listen을
+ * 순회하지 않고 포트별 해시 조회만 수행함. 이름 비교는 대소문자를 구분하지 않음.
+ *
+ * 매칭 우선순위 (nginx와 동일):
+ *  1. 정확한 이름
+ *  2. 가장 긴 앞쪽 와일드카드  (*.example.com, .example.com)
+ *  3. 가장 긴 뒤쪽 와일드카드  (www.example.*)
+ *  4. 해당 포트의 default_server (없으면 그 포트의 첫 번째 server)
+ */
+class VirtualHostTable {
+private:
+	struct PortHosts {
+		StringHashTable<const ServerContext*>	exact;
+		StringHashTable<const ServerContext*>	leading;	// ".example.com" 형태로 저장
+		StringHashTable<const ServerContext*>	trailing;	// "www.example." 형태로 저장
+		const ServerContext*					defaultServer;
+		bool									explicitDefault;	// default_server로 지정되었는지
+
+		PortHosts() : exact(true), leading(true), trailing(true), defaultServer(NULL), explicitDefault(false) {}
+	};
+
+	std::map<int, PortHosts*>	_ports;
+
+	void	addName(PortHosts* hosts, const std::string& name, const ServerContext* server);
+
+	VirtualHostTable(const VirtualHostTable&);
+	VirtualHostTable& operator=(const VirtualHostTable&);
+
+public:
+	VirtualHostTable();
+	~VirtualHostTable();
+
+	void					build(const std::vector<ServerContext>& servers);
+
+	/**
+	 * @brief Host 헤더 값(포트 포함 가능)으로 server 탐색.
+	 * @param port 요청이 들어온 리슨 포트
+	 * @param host Host 헤더 값 시작 포인터 (없으면 len = 0)
+	 * @param len Host 헤더 값 길이
+	 * @return 매칭된 server. 해당 포트에 server가 없으면 NULL.
+	 */
+	const ServerContext*	find(int port, const char* host, size_t len) const;
+};
+
+#endif
@@ -2,7 +2,10 @@
 
 #include "http/HttpResponse.hpp"
 #include "http/HttpRequest.hpp"
+#include "http/ResponseCompressor.hpp"
+#include "http/RangeRequest.hpp"
 #include "dto/ConfigDTO.hpp"
+#include <sys/stat.h>
 
 /**
  * @class GetHandler
@@ -16,9 +19,47 @@ public:
                                 const LocationContext* locConf);
 
 private:
+    // 경로를 풀어 정적 파일, 디렉토리 목록, 리다이렉트 중 하나로 응답
+    static HttpResponse* serveResource(const HttpRequest* request,
+                                       const ServerContext* serverConf,
+                                       const LocationContext* locConf);
+
+    // expires, immutable_assets, add_header 적용 (add_header는 always가 아니면 2xx/3xx에만)
+    static void applyCacheHeaders(HttpResponse* response,
+                                  const HttpRequest* request,
+                                  const LocationContext* locConf);
+    static bool isFingerprinted(const std::string& uri);
+
     // HttpController에서 옮겨온 private 헬퍼 함수들
-    static HttpResponse* serveStaticFile(const std::string& filePath,
+    // 검증자/304 처리 후 바디를 채움 (st는 filePath의 stat 결과)
+    static HttpResponse* serveStaticFile(const HttpRequest* request,
+                                         const std::string& filePath,
+                                         const struct stat& st,
                                          const LocationContext* locConf);
+
+    // 206: 범위를 파일 조각으로 보냄 (여러 범위면 multipart/byteranges)
+    static HttpResponse* serveRanges(HttpResponse* response,
+                                     const std::string& filePath,
+                                     const struct stat& st,
+                                     const std::vector<ByteRange>& ranges,
+                                     const LocationContext* locConf);
+
+    // gzip_static(.gz 경로를 precompressed에) 또는 gzip 설정에 따라 보낼 인코딩을 정함
+    static ResponseCompressor::Encoding selectEncoding(HttpResponse* response,
+                                                       const HttpRequest* request,
+                                                       const std::string& filePath,
+                                                       const struct stat& st,
+                                                       const LocationContext* locConf,
+                                                       std::string& precompressed);
+
+    // 정한 인코딩으로 바디를 채움. HEAD면 파일을 읽지 않고 Content-Length만 설정
+    static bool loadBody(HttpResponse* response,
+                         const HttpRequest* request,
+                         const std::string& filePath,
+                         const struct stat& st,
+                         ResponseCompressor::Encoding encoding,
+                         const std::string& precompressed,
+                         const LocationContext* locConf);
     
     static HttpResponse* serveDirectoryListing(const std::string& dirPath,
                                                const std::string& uri);
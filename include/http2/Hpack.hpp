@@ -0,0 +1,78 @@
+#ifndef HPACK_HPP
+#define HPACK_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <utility>
+#include <cstddef>
+
+typedef std::vector<std::pair<std::string, std::string> >	HeaderList;
+
+/**
+ * @brief HPACK 인덱스 공간: 정적 테이블(1~61) 뒤에 동적 테이블이 이어짐 (RFC 7541 2.3).
+ *
+ * 동적 테이블은 최근에 넣은 항목이 앞에 오며, 항목 크기(name + value + 32)의 합이
+ * maxSize를 넘으면 오래된 항목부터 버림.
+ */
+class HpackTable {
+private:
+	std::deque<std::pair<std::string, std::string> >	_entries;
+	size_t												_size;
+	size_t												_maxSize;
+
+	void	evict(size_t limit);
+
+public:
+	static const size_t	STATIC_COUNT;		// 정적 테이블 항목 수 (61)
+	static const size_t	ENTRY_OVERHEAD;		// 항목마다 더하는 크기 (32)
+
+	explicit HpackTable(size_t maxSize);
+
+	void	add(const std::string& name, const std::string& value);
+	void	setMaxSize(size_t maxSize);
+	size_t	getMaxSize() const;
+
+	// 1부터 시작하는 인덱스. 범위를 벗어나면 false
+	bool	get(size_t index, std::string& name, std::string& value) const;
+
+	// name(과 value)이 같은 항목의 인덱스 (없으면 0). exact: value까지 같은 항목을 찾았는지
+	size_t	find(const std::string& name, const std::string& value, bool& exact) const;
+};
+
+/**
+ * @brief 헤더 블록 디코더. 연결마다 하나이며 블록을 받은 순서대로 디코딩해야 함.
+ *
+ * 실패하면 동적 테이블 상태를 더는 믿을 수 없으므로 연결 전체를 COMPRESSION_ERROR로 닫아야 함.
+ */
+class HpackDecoder {
+private:
+	HpackTable	_table;
+	size_t		_maxTableSize;	// SETTINGS_HEADER_TABLE_SIZE로 알린 상한
+
+public:
+	explicit HpackDecoder(size_t maxTableSize);
+
+	bool	decode(const char* data, size_t len, HeaderList& headers);
+};
+
+/**
+ * @brief 헤더 블록 인코더. 값이 요청마다 바뀌는 헤더는 동적 테이블에 넣지 않고,
+ * set-cookie는 중간 장비가 인덱싱하지 않도록 never-indexed로 보냄.
+ */
+class HpackEncoder {
+private:
+	HpackTable	_table;
+	bool		_sizeChanged;	// 다음 블록 앞에 크기 변경을 알려야 함
+
+public:
+	static const size_t	DEFAULT_TABLE_SIZE;	// 4096
+
+	HpackEncoder();
+
+	// 상대가 알린 SETTINGS_HEADER_TABLE_SIZE. 테이블은 줄이기만 함 (DEFAULT_TABLE_SIZE보다 크게 쓰지 않음)
+	void	setMaxTableSize(size_t size);
+	void	encode(const HeaderList& headers, std::string& out);
+};
+
+#endif
@@ -0,0 +1,186 @@
+#ifndef HTTP2_CONNECTION_HPP
+#define HTTP2_CONNECTION_HPP
+
+#include "webserv.hpp"
+#include "http2/Hpack.hpp"
+#include "http2/Http2Protocol.hpp"
+#include "log/RequestTrace.hpp"
+
+class HttpRequest;
+class HttpResponse;
+class TlsConnection;
+struct ServerContext;
+struct LocationContext;
+
+/**
+ * @brief HTTP/2 스트림 하나 (요청 하나와 그 응답).
+ *
+ * 요청은 END_STREAM까지 받은 뒤 HttpController로 처리하고, 응답 바디는 메모리 바디와
+ * 파일 조각(Range 등)을 DATA 프레임으로 나눠 흐름 제어 창만큼씩 보냄.
+ */
+struct Http2Stream {
+	enum State {
+		OPEN,
+		HALF_CLOSED_REMOTE		// 요청을 다 받음 (응답 전송 중)
+	};
+
+	uint32_t				id;
+	State					state;
+	std::string				body;
+	HttpRequest*			request;
+	const ServerContext*	serverConf;
+	const LocationContext*	locConf;
+
+	HttpResponse*			response;		// 보내는 중인 응답 (파일 바디를 가지고 있음)
+	bool					responded;		// HEADERS를 보냄 (이후 받는 DATA는 버림)
+	std::string				out;			// 아직 DATA로 보내지 않은 메모리 바디
+	size_t					outOffset;
+	size_t					segment;		// 보내는 중인 파일 조각
+	size_t					segmentSent;
+
+	long					sendWindow;
+	long					recvWindow;
+	int						currentWeight;	// smooth weighted round-robin
+
+	// access_log, stub_status, 단계별 시간 (시작은 스트림을 연 시각)
+	int						status;
+	size_t					bytesSent;		// HEADERS 블록 + DATA 페이로드
+	RequestTrace			trace;
+
+	Http2Stream(uint32_t streamId, long initialSendWindow, long initialRecvWindow);
+	~Http2Stream();
+
+	bool	hasPendingData() const;
+};
+
+/**
+ * @brief HTTP/2 연결 하나 (RFC 9113). h2c는 prior knowledge(프리페이스로 시작)와 HTTP/1.1 Upgrade,
+ * TLS는 ALPN으로 h2를 고른 연결.
+ *
+ * Client와 같은 fd를 쓰며 Server가 소켓 이벤트를 넘겨 줌. 요청은 스트림마다 HTTP/1.1 요청으로
+ * 바꿔 HttpController로 처리하고, DATA는 우선순위 트리에서 보낼 수 있는 스트림들 사이에
+ * weight 비율로 나눠 보냄 (조상 스트림에 보낼 데이터가 있으면 자손은 기다림).
+ * CGI/FastCGI/프록시/캐시 location은 HTTP_1_1_REQUIRED로 거절해 HTTP/1.1로 재시도하게 함.
+ */
+class Http2Connection {
+private:
+	struct PriorityNode {
+		uint32_t	parent;
+		int			weight;		// 1~256
+
+		PriorityNode() : parent(0), weight(16) {}
+	};
+
+	int									_fd;
+	int									_port;
+	TlsConnection*						_tls;			// TLS 연결이면 non-NULL (소유)
+	std::string							_remoteAddr;	// access_log
+
+	std::string							_in;
+	size_t								_inOffset;
+	bool								_prefaceReceived;
+	std::string							_out;
+	size_t								_outOffset;
+
+	HpackDecoder						_decoder;
+	HpackEncoder						_encoder;
+
+	// 상대 SETTINGS
+	uint32_t							_peerMaxFrameSize;
+	long								_peerInitialWindow;
+
+	long								_sendWindow;	// 연결 수준 흐름 제어
+	long								_recvWindow;
+
+	std::map<uint32_t, Http2Stream*>	_streams;
+	std::map<uint32_t, PriorityNode>	_priorities;	// 열린 스트림 + PRIORITY로만 알려진 스트림
+	uint32_t							_lastStreamId;
+
+	// 받는 중인 헤더 블록. 거절할 스트림의 블록도 디코딩해야 HPACK 상태가 어긋나지 않음
+	std::string							_headerBlock;
+	uint32_t							_headerStream;
+	bool								_headerEndStream;
+	bool								_headerTrailers;
+	uint32_t							_headerError;			// 블록을 디코딩한 뒤 보낼 RST_STREAM (없으면 0)
+	uint32_t							_continuationStream;	// CONTINUATION을 기다리는 스트림 (없으면 0)
+
+	bool								_goawaySent;	// 보낼 것만 보내고 닫음
+	bool								_peerGoaway;
+	bool								_lingering;		// 출력을 다 보내고 쓰기를 닫음. 남은 입력은 읽어 버림
+	time_t								_lastActivity;
+
+	Http2Connection(const Http2Connection&);
+	Http2Connection& operator=(const Http2Connection&);
+
+	// 프레임 처리 (false: 연결 에러로 GOAWAY를 보냄)
+	void	processInput();
+	bool	handleFrame(const Http2::FrameHeader& header, const char* payload);
+	bool	handleData(const Http2::FrameHeader& header, const char* payload);
+	bool	handleHeaders(const Http2::FrameHeader& header, const char* payload);
+	bool	handleContinuation(const Http2::FrameHeader& header, const char* payload);
+	bool	handlePriority(const Http2::FrameHeader& header, const char* payload);
+	bool	handleRstStream(const Http2::FrameHeader& header, const char* payload);
+	bool	handleSettings(const Http2::FrameHeader& header, const char* payload);
+	bool	handlePing(const Http2::FrameHeader& header, const char* payload);
+	bool	handleGoaway(const Http2::FrameHeader& header, const char* payload);
+	bool	handleWindowUpdate(const Http2::FrameHeader& header, const char* payload);
+	bool	applySettings(const char* payload, size_t len);
+	bool	endHeaderBlock();
+	bool	connectionError(uint32_t errorCode);
+	void	streamError(uint32_t streamId, uint32_t errorCode);
+	void	sendServerPreface();
+
+	// 요청 처리
+	bool	buildRequest(Http2Stream* stream, const HeaderList& headers);
+	void	routeRequest(Http2Stream* stream);
+	void	processStream(Http2Stream* stream);
+	void	sendResponse(Http2Stream* stream, HttpResponse* response);
+	void	sendErrorResponse(Http2Stream* stream, int code);
+
+	// 우선순위
+	void	setPriority(uint32_t streamId, uint32_t parent, int weight, bool exclusive);
+	bool	isAncestor(uint32_t ancestor, uint32_t streamId) const;
+	bool	isBlocked(uint32_t streamId) const;
+	void	closeStream(uint32_t streamId);
+	void	recordStream(const Http2Stream* stream) const;	// access_log, 지표, slow_request_log
+	void	finishStream(Http2Stream* stream);
+	bool	isOpen(uint32_t streamId) const;
+
+	// 출력
+	void	scheduleData();
+	void	writeDataFrame(Http2Stream* stream);
+	bool	flush();
+	bool	isFinished() const;
+
+public:
+	static const uint32_t	MAX_CONCURRENT_STREAMS;
+	static const uint32_t	INITIAL_WINDOW_SIZE;	// 스트림마다 받는 창 (연결 창도 같은 크기로 늘림)
+	static const size_t		MAX_HEADER_LIST_SIZE;	// 디코딩한 요청 헤더 크기 상한 (넘으면 431)
+	static const size_t		MAX_HEADER_BLOCK_SIZE;	// CONTINUATION까지 모은 블록 상한 (넘으면 연결 에러)
+	static const size_t		OUTPUT_HIGH_WATERMARK;	// 보내지 못한 출력이 이보다 많으면 DATA를 더 만들지 않음
+
+	Http2Connection(int fd, int port, TlsConnection* tls, const std::string& remoteAddr);
+	~Http2Connection();
+
+	// Upgrade: h2c 요청 (HTTP2-Settings 헤더가 있고 바디가 없는 요청만)
+	static bool	wantsUpgrade(const HttpRequest* request);
+
+	// 응답을 비동기로 만드는 location (CGI, FastCGI, 프록시, 캐시)과 stub_status는 HTTP/1.1로만 처리
+	// (TLS 포트에 하나라도 있으면 ALPN에서 h2를 고르지 않고, prior knowledge로 오면 HTTP_1_1_REQUIRED)
+	static bool	requiresHttp1(const LocationContext* locConf);
+
+	// prior knowledge: input은 프리페이스로 시작하는 지금까지 받은 바이트
+	bool	start(const std::string& input);
+
+	// 101을 보내고 요청을 스트림 1의 요청으로 처리. input은 요청 헤더 뒤에 받은 바이트
+	bool	startUpgrade(const HttpRequest* request, const std::string& input);
+
+	// false면 연결을 닫음
+	bool	onReadable();
+	bool	onWritable();
+	bool	needsWriteEvent() const;
+	bool	isExpired(time_t now) const;
+	bool	isIdle() const;		// 열린 스트림이 없음
+};
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef HTTP2_PROTOCOL_HPP
+#define HTTP2_PROTOCOL_HPP
+
+#include <string>
+#include <cstddef>
+#include <stdint.h>
+
+/**
+ * @brief HTTP/2 프레임 인코딩/디코딩 (RFC 9113).
+ *
+ * 프레임은 9바이트 헤더(length 24bit, type, flags, R + streamId 31bit) + payload로 구성됨.
+ * streamId 0은 연결 전체에 대한 프레임 (SETTINGS, PING, GOAWAY 등).
+ */
+namespace Http2 {
+
+	// 프레임 타입
+	enum FrameType {
+		DATA			= 0x0,
+		HEADERS			= 0x1,
+		PRIORITY		= 0x2,
+		RST_STREAM		= 0x3,
+		SETTINGS		= 0x4,
+		PUSH_PROMISE	= 0x5,
+		PING			= 0x6,
+		GOAWAY			= 0x7,
+		WINDOW_UPDATE	= 0x8,
+		CONTINUATION	= 0x9
+	};
+
+	// RST_STREAM / GOAWAY 에러 코드
+	enum ErrorCode {
+		NO_ERROR			= 0x0,
+		PROTOCOL_ERROR		= 0x1,
+		INTERNAL_ERROR		= 0x2,
+		FLOW_CONTROL_ERROR	= 0x3,
+		SETTINGS_TIMEOUT	= 0x4,
+		STREAM_CLOSED		= 0x5,
+		FRAME_SIZE_ERROR	= 0x6,
+		REFUSED_STREAM		= 0x7,
+		CANCEL				= 0x8,
+		COMPRESSION_ERROR	= 0x9,
+		CONNECT_ERROR		= 0xa,
+		ENHANCE_YOUR_CALM	= 0xb,
+		INADEQUATE_SECURITY	= 0xc,
+		HTTP_1_1_REQUIRED	= 0xd
+	};
+
+	// SETTINGS 파라미터
+	enum SettingId {
+		SETTINGS_HEADER_TABLE_SIZE		= 0x1,
+		SETTINGS_ENABLE_PUSH			= 0x2,
+		SETTINGS_MAX_CONCURRENT_STREAMS	= 0x3,
+		SETTINGS_INITIAL_WINDOW_SIZE	= 0x4,
+		SETTINGS_MAX_FRAME_SIZE			= 0x5,
+		SETTINGS_MAX_HEADER_LIST_SIZE	= 0x6
+	};
+
+	const unsigned char	FLAG_END_STREAM = 0x1;
+	const unsigned char	FLAG_ACK = 0x1;			// SETTINGS, PING
+	const unsigned char	FLAG_END_HEADERS = 0x4;
+	const unsigned char	FLAG_PADDED = 0x8;
+	const unsigned char	FLAG_PRIORITY = 0x20;
+
+	const char			PREFACE[] = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+	const size_t		PREFACE_LEN = 24;
+	const size_t		FRAME_HEADER_LEN = 9;
+	const uint32_t		DEFAULT_WINDOW_SIZE = 65535;
+	const uint32_t		DEFAULT_MAX_FRAME_SIZE = 16384;
+	const uint32_t		MAX_FRAME_SIZE_LIMIT = 16777215;
+	const uint32_t		MAX_WINDOW_SIZE = 0x7fffffff;
+
+	struct FrameHeader {
+		uint32_t		length;
+		unsigned char	type;
+		unsigned char	flags;
+		uint32_t		streamId;
+	};
+
+	// buf에 헤더 전체가 있으면 파싱해 true
+	bool		parseHeader(const char* buf, size_t len, FrameHeader& header);
+
+	// 4바이트 big-endian (최상위 R 비트는 호출하는 쪽에서 처리)
+	uint32_t	readUint32(const char* data);
+
+	// 프레임 하나를 out 뒤에 추가 (len은 상대의 SETTINGS_MAX_FRAME_SIZE 이하)
+	void		appendFrame(std::string& out, unsigned char type, unsigned char flags, uint32_t streamId,
+							const char* data, size_t len);
+
+	void		appendSetting(std::string& payload, uint16_t id, uint32_t value);
+	void		appendRstStream(std::string& out, uint32_t streamId, uint32_t errorCode);
+	void		appendGoaway(std::string& out, uint32_t lastStreamId, uint32_t errorCode);
+	void		appendWindowUpdate(std::string& out, uint32_t streamId, uint32_t increment);
+
+	// HTTP2-Settings 헤더 값 (base64url, 패딩 없음)을 SETTINGS payload로 디코딩. 형식 오류면 false
+	bool		decodeSettingsHeader(const std::string& value, std::string& payload);
+
+} // namespace Http2
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef ACCESS_LOG_HPP
+#define ACCESS_LOG_HPP
+
+#include <string>
+#include <map>
+#include <ctime>
+#include <pthread.h>
+#include "dto/ConfigDTO.hpp"
+#include "log/RingBuffer.hpp"
+
+class HttpRequest;
+class RequestTrace;
+
+/**
+ * @brief access_log 파일 하나. 이벤트 루프는 포맷한 레코드를 링 버퍼에 넣기만 하고
+ * 파일 쓰기는 writer 스레드가 모아서 writev로 함.
+ *
+ * 이벤트 루프가 하나이므로 파일마다 링 버퍼 하나 (생산자 = 이벤트 루프, 소비자 = writer).
+ * writer는 flush 간격마다, 또는 링 버퍼가 절반 넘게 차서 이벤트 루프가 eventfd로 깨우면
+ * 쌓인 레코드를 씀. 링 버퍼가 가득 차면 레코드를 버리고 개수만 세어 onTick에서 알림
+ * (요청 처리를 디스크 속도에 묶지 않음). 시그널로 종료되면 마지막 flush 간격만큼은 잃을 수 있음.
+ *
+ * binary 포맷 레코드 (리틀 엔디언, 버전 2):
+ *   u16 레코드 길이 (자신 포함) | u8 버전 | u8 프로토콜 (1: HTTP/1.x, 2: HTTP/2)
+ *   u32 시각 (epoch 초) | u32 처리 시간 (마이크로초) | u16 status | u64 보낸 바이트
+ *   이후 u16 길이 + 바이트로 addr, method, uri, referer, user-agent
+ *   u8 단계 수 + 단계마다 u32 시간 (마이크로초, RequestTrace::Phase 순서)
+ */
+class AccessLog {
+private:
+	std::string				_path;
+	int						_fd;
+	AccessLogDirective		_config;
+	RingBuffer				_ring;
+
+	// 이벤트 루프 쪽
+	size_t					_requests;		// sample 계산용
+	size_t					_dropped;		// 링 버퍼가 가득 차서 버린 레코드 (onTick에서 0으로)
+	bool					_wakeSent;		// 절반을 넘어 writer를 깨움 (절반 아래로 내려가면 다시)
+
+	// writer 쪽
+	time_t					_lastFlush;
+
+	static std::map<std::string, AccessLog*>	_logs;		// 경로 -> 로그
+	static AccessLog*							_default;	// location이 정해지기 전 응답 (http 블록 access_log)
+	static bool									_failed;	// 열지 못한 로그가 있음
+	static pthread_t							_writer;
+	static bool									_running;	// writer 스레드가 돌고 있음
+	static int									_wakeFd;	// eventfd: 이벤트 루프 -> writer
+
+	AccessLog(const std::string& path, int fd, const AccessLogDirective& config);
+	AccessLog(const AccessLog&);
+	AccessLog& operator=(const AccessLog&);
+
+	void			formatText(std::string& line, const std::string& addr, const HttpRequest* request,
+							   const char* protocol, int status, size_t bytes, long long usec,
+							   const long long* phases) const;
+	void			formatBinary(std::string& record, const std::string& addr, const HttpRequest* request,
+								 bool http2, int status, size_t bytes, long long usec,
+								 const long long* phases) const;
+	bool			drain(time_t now, bool force);	// writer: 쌓인 레코드를 씀 (썼으면 true)
+
+	static void*	run(void* arg);
+	static void		wakeWriter();
+
+public:
+	static const size_t	MAX_FIELD;	// uri, referer, user-agent를 이 길이에서 자름
+
+	~AccessLog();
+
+	// 설정의 access_log에 해당하는 로그 (off면 NULL). 경로가 같으면 같은 로그를 공유
+	static AccessLog*	open(const AccessLogDirective& config);
+
+	// http 블록 로그를 기본으로 정하고 writer 스레드 시작. 열지 못한 로그가 있으면 false
+	static bool			start(const std::vector<AccessLogDirective>& httpLog);
+
+	// writer를 멈추고 남은 레코드를 모두 쓴 뒤 파일을 닫음
+	static void			closeAll();
+
+	// 버린 레코드 수를 알림 (Server::onTick에서 호출)
+	static void			onTick();
+
+	static AccessLog*	defaultLog();
+
+	// 단조 시계 (마이크로초). 요청 처리 시간 계산용
+	static long long	now();
+
+	// 응답 하나를 기록. request는 헤더를 파싱하지 못했으면 method/uri가 비어 있음
+	// protocol이 NULL이면 요청의 HTTP 버전, end는 응답을 끝낸 시각 (now)
+	void				write(const std::string& addr, const HttpRequest* request, const char* protocol,
+							  int status, size_t bytes, const RequestTrace& trace, long long end);
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef REQUEST_TRACE_HPP
+#define REQUEST_TRACE_HPP
+
+#include <string>
+
+/**
+ * @brief 요청 하나가 어느 단계에서 시간을 썼는지 (Server-Timing, access_log, slow_request_log, 지표).
+ *
+ * 상태가 바뀌는 시점의 단조 시각(AccessLog::now)을 찍어 두고, 라우팅과 경로 계산처럼 중간에
+ * 여러 번 끼어드는 일은 걸린 시간을 더해 둠. 단계별 시간은 응답을 끝낼 때 한 번 계산함.
+ *
+ * 이벤트 루프가 하나이므로 처리 중인 요청은 항상 하나: Scope로 current를 정해 두면
+ * PathResolver 같은 유틸리티가 Timer로 인자 없이 시간을 더할 수 있음.
+ */
+class RequestTrace {
+public:
+	// 찍는 시각 (처음 지날 때만, 지나지 않았으면 0)
+	enum Mark {
+		MARK_START,			// 요청 첫 바이트
+		MARK_HEADERS,		// 헤더를 다 받음
+		MARK_READY,			// 바디까지 다 받음
+		MARK_DISPATCHED,	// CGI, FastCGI, 프록시, 캐시로 넘김
+		MARK_RESPONDED,		// 응답 헤더가 준비됨
+		MARK_COUNT
+	};
+
+	enum Phase {
+		PHASE_HEADER,		// 첫 바이트 -> 헤더
+		PHASE_BODY,			// 헤더 -> 바디 (라우팅 시간 제외)
+		PHASE_ROUTE,		// server/location 찾기
+		PHASE_RESOLVE,		// 요청 경로 -> 파일 경로, index 찾기
+		PHASE_HANDLER,		// 핸들러 (파일 열기, 디렉터리 목록 등)
+		PHASE_UPSTREAM,		// 넘긴 뒤 응답 헤더가 올 때까지 (CGI 실행 포함)
+		PHASE_SEND,			// 응답 헤더 -> 마지막 바이트
+		PHASE_COUNT
+	};
+
+	RequestTrace();
+
+	void				reset(long long start);		// 다음 요청 (start는 이미 받은 바이트가 있을 때의 시각, 없으면 0)
+	void				mark(Mark which);
+	long long			at(Mark which) const;
+	bool				started() const;
+	void				add(Phase phase, long long usec);
+
+	// 단계별 시간 (마이크로초). end는 send 단계의 끝 (응답 전이면 지금)
+	void				phases(long long end, long long out[PHASE_COUNT]) const;
+	long long			total(long long end) const;
+
+	// Server-Timing 헤더 값 (응답 헤더를 만드는 시점이므로 send는 빠짐)
+	std::string			serverTiming(long long now) const;
+	// "header=0.120ms body=... total=..." (slow_request_log)
+	std::string			describe(long long end) const;
+
+	static const char*	phaseName(Phase phase);
+
+	static RequestTrace*	current();
+
+	// 이 범위 안에서 Timer가 더하는 요청을 정함 (끝나면 이전 값으로)
+	class Scope {
+	public:
+		explicit Scope(RequestTrace& trace);
+		~Scope();
+	private:
+		RequestTrace*	_previous;
+		Scope(const Scope&);
+		Scope& operator=(const Scope&);
+	};
+
+	// 이 범위에서 걸린 시간을 current의 phase에 더함 (current가 없으면 아무것도 안 함)
+	class Timer {
+	public:
+		explicit Timer(Phase phase);
+		~Timer();
+	private:
+		RequestTrace*	_trace;
+		Phase			_phase;
+		long long		_start;
+		Timer(const Timer&);
+		Timer& operator=(const Timer&);
+	};
+
+private:
+	long long			_marks[MARK_COUNT];
+	long long			_spent[PHASE_COUNT];	// PHASE_ROUTE, PHASE_RESOLVE만 씀
+
+	static RequestTrace*	_current;
+};
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef RING_BUFFER_HPP
+#define RING_BUFFER_HPP
+
+#include <cstddef>
+#include <sys/uio.h>
+
+/**
+ * @brief 생산자 하나, 소비자 하나가 락 없이 쓰는 바이트 링 버퍼 (SPSC).
+ *
+ * 이벤트 루프가 push로 레코드를 통째로 넣고, writer 스레드가 readable로 읽을 수 있는
+ * 구간을 iovec(최대 2개, 끝에서 감기면 둘로 나뉨)으로 받아 writev한 뒤 consume함.
+ * 위치는 줄어들지 않는 카운터로 두고 용량(2의 거듭제곱)으로 마스킹함. _head는 생산자만,
+ * _tail은 소비자만 쓰며 상대 쪽 값은 acquire로 읽고 자기 값은 release로 씀.
+ * 두 카운터는 서로 다른 캐시 라인에 둬서 양쪽이 같은 라인을 번갈아 가져가지 않게 함.
+ */
+class RingBuffer {
+private:
+	static const size_t	CACHE_LINE = 64;
+
+	char*	_data;
+	size_t	_capacity;
+	size_t	_mask;
+	char	_pad0[CACHE_LINE];
+	size_t	_head;		// 다음에 쓸 위치 (생산자)
+	char	_pad1[CACHE_LINE - sizeof(size_t)];
+	size_t	_tail;		// 다음에 읽을 위치 (소비자)
+	char	_pad2[CACHE_LINE - sizeof(size_t)];
+
+	RingBuffer(const RingBuffer&);
+	RingBuffer& operator=(const RingBuffer&);
+
+public:
+	// capacity는 2의 거듭제곱으로 올림
+	explicit RingBuffer(size_t capacity);
+	~RingBuffer();
+
+	size_t	capacity() const;
+	size_t	size() const;		// 어느 쪽에서 불러도 됨 (근삿값)
+
+	// 생산자: 남은 공간이 len보다 작으면 아무것도 쓰지 않고 false
+	bool	push(const char* data, size_t len);
+
+	// 소비자: 읽을 수 있는 구간 (iovec 수를 반환, 비었으면 0)
+	int		readable(struct iovec iov[2]) const;
+	void	consume(size_t len);
+};
+
+#endif
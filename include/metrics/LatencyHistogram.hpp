@@ -0,0 +1,44 @@
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <cstddef>
+
+/**
+ * @brief HDR 방식의 지연 시간 히스토그램 (마이크로초).
+ *
+ * 값을 2의 거듭제곱 구간으로 나누고 각 구간을 다시 SUB_BUCKETS개로 나눠, 범위 전체에서
+ * 상대 오차가 1/SUB_BUCKETS 이하로 유지됨 (1us ~ 38시간, 고정 크기 배열).
+ * record는 비트 연산과 덧셈 몇 번뿐이고, 분위수와 Prometheus 버킷은 scrape할 때 계산함.
+ */
+class LatencyHistogram {
+public:
+	static const int	SUB_BITS = 5;
+	static const size_t	SUB_BUCKETS = 1 << SUB_BITS;
+	static const int	MAX_BITS = 37;		// 이보다 큰 값은 마지막 버킷에 넣음
+	static const size_t	BUCKETS = SUB_BUCKETS * (MAX_BITS - SUB_BITS + 2);
+
+	LatencyHistogram();
+
+	void				record(long long usec);
+
+	unsigned long long	count() const;
+	unsigned long long	sum() const;		// 마이크로초
+	long long			max() const;
+
+	// 값이 usec 이하인 기록 수 (경계에 걸친 버킷은 빼므로 최대 1/SUB_BUCKETS만큼 적게 셈)
+	unsigned long long	countAtOrBelow(long long usec) const;
+
+	// 분위수 (0 < q <= 1), 해당 버킷의 상한으로 돌려줌. 기록이 없으면 0
+	long long			quantile(double q) const;
+
+private:
+	unsigned long long	_counts[BUCKETS];
+	unsigned long long	_count;
+	unsigned long long	_sum;
+	long long			_max;
+
+	static size_t		bucketOf(unsigned long long value);
+	static long long	upperBound(size_t bucket);	// 버킷에 들어가는 가장 큰 값
+};
+
+#endif
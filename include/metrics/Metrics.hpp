@@ -0,0 +1,74 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <string>
+#include <map>
+#include <vector>
+#include "cache/CacheZone.hpp"
+#include "cgi/CgiRunner.hpp"
+#include "metrics/LatencyHistogram.hpp"
+#include "log/RequestTrace.hpp"
+
+/**
+ * @brief stub_status location이 내보내는 서버 지표 (Prometheus 텍스트 포맷).
+ *
+ * 요청 처리 중에는 이벤트 루프가 자기 카운터 블록(캐시 라인 정렬)에 더하기만 하고,
+ * 연결 상태, 캐시 zone 통계, CGI 대기열, 분위수 같은 값은 scrape할 때 모아서 계산함.
+ * 지연 시간은 location별 전체 시간과 RequestTrace의 단계별 시간을 LatencyHistogram에 기록.
+ */
+class Metrics {
+public:
+	enum Timeout {
+		TIMEOUT_CLIENT,		// 클라이언트 유휴 연결
+		TIMEOUT_CGI,
+		TIMEOUT_FASTCGI,
+		TIMEOUT_PROXY,
+		TIMEOUT_COUNT
+	};
+
+	static const int	MAX_STATUS = 600;
+
+	// 이벤트 루프 하나가 쓰는 카운터. 다른 스레드의 카운터와 캐시 라인을 공유하지 않도록 정렬
+	struct Counters {
+		unsigned long long	accepts;
+		unsigned long long	requests;
+		unsigned long long	bytesIn;
+		unsigned long long	bytesOut;
+		unsigned long long	cgiSpawns;
+		unsigned long long	timeouts[TIMEOUT_COUNT];
+		unsigned long long	responses[MAX_STATUS];	// status code별 (범위 밖은 0번)
+
+		Counters();
+	} __attribute__((aligned(64)));
+
+	// scrape 시점의 연결 수 (Server가 채움)
+	struct Connections {
+		size_t	active;
+		size_t	reading;	// 요청을 받는 중
+		size_t	writing;	// 요청을 처리하거나 응답을 보내는 중
+		size_t	idle;		// keep-alive로 다음 요청을 기다림
+
+		Connections() : active(0), reading(0), writing(0), idle(0) {}
+	};
+
+	static Counters&	counters() { return _counters; }
+
+	// location 하나의 지연 시간 히스토그램 (설정을 다시 읽어도 같은 이름이면 이어서 씀)
+	static LatencyHistogram*	location(const std::string& server, const std::string& path);
+
+	// 응답을 다 보낸 (또는 끊긴) 요청 하나를 기록. latency는 location이 없으면 NULL
+	static void			recordRequest(LatencyHistogram* latency, int status, size_t bytesSent,
+									  const RequestTrace& trace, long long end);
+
+	static std::string	render(const Connections& connections, const std::vector<CacheZone::Stats>& zones,
+							   const std::vector<CgiRunner::QueueStats>& queues);
+
+private:
+	static Counters		_counters;
+	static LatencyHistogram	_phases[RequestTrace::PHASE_COUNT];
+	static std::map<std::pair<std::string, std::string>, LatencyHistogram*>	_locations;
+
+	Metrics();
+};
+
+#endif
@@ -0,0 +1,226 @@
+#ifndef PROXY_CLIENT_HPP
+#define PROXY_CLIENT_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <sys/socket.h>
+#include "webserv.hpp"
+#include "dto/ConfigDTO.hpp"
+#include "server/IoHandler.hpp"
+#include "server/AsyncTask.hpp"
+#include "server/BodySink.hpp"
+#include "server/BodySource.hpp"
+
+class EventLoop;
+class Client;
+class HttpRequest;
+class ProxyClient;
+class UpstreamGroup;
+struct ProxyUpstream;
+struct UpstreamPeer;
+
+/**
+ * @brief proxy_pass 요청 하나. 업스트림 연결 하나를 빌려 요청을 보내고 응답을 중계함.
+ *
+ * 요청 바디는 BodySink로서 Client가 받는 대로 업스트림 소켓에 쓰고(backpressure 포함),
+ * 응답은 헤더를 파싱해 바로 Client에 스트리밍함 (BodySource: Client가 밀리면 읽기를 멈춤).
+ * 응답이 Content-Length/chunked로 끝을 알 수 있으면 연결을 업스트림 풀에 돌려줌.
+ */
+class ProxyRequest : public AsyncTask, public BodySink, public BodySource, public IoHandler {
+private:
+	friend class ProxyClient;
+
+	enum State {
+		CONNECTING,
+		CONNECTED,
+		DONE
+	};
+
+	enum BodyMode {
+		BODY_NONE,
+		BODY_LENGTH,
+		BODY_CHUNKED,
+		BODY_UNTIL_CLOSE
+	};
+
+	enum ChunkState {
+		CHUNK_SIZE,
+		CHUNK_DATA,
+		CHUNK_DATA_END,
+		CHUNK_TRAILER
+	};
+
+	ProxyClient*			_owner;
+	ProxyUpstream*			_upstream;
+	UpstreamGroup*			_group;			// upstream 블록이면 서버를 고른 그룹 (아니면 NULL)
+	UpstreamPeer*			_peer;
+	std::vector<UpstreamPeer*>	_tried;		// 연결에 실패한 서버
+	std::string				_hashKey;
+	Client*					_client;		// abort 후 NULL
+	const ServerContext*	_serverConf;
+	const LocationContext*	_locConf;
+	std::string				_method;
+
+	int						_fd;
+	bool					_reused;		// 풀에서 꺼낸 연결 (끊겨 있으면 새 연결로 한 번 재시도)
+	State					_state;
+
+	std::string				_out;			// 요청 헤더 + 아직 보내지 못한 바디
+	size_t					_outOffset;
+	const char*				_body;			// 다 받은 바디 (스트리밍이 아니면 HttpRequest 소유)
+	size_t					_bodyLength;
+	size_t					_bodySent;
+	bool					_streamBody;	// 받는 대로 보내는 바디
+	bool					_inputEnded;	// 바디를 다 넘겨받음
+	bool					_bodyPaused;	// Client 소켓 읽기를 멈춰 둠
+	bool					_sendClosed;	// 업스트림이 요청을 더 받지 않음 (먼저 응답하고 닫음)
+
+	std::string				_in;			// 아직 처리하지 않은 응답 바이트
+	size_t					_inOffset;
+	bool					_upstreamClosed;
+	bool					_responseStarted;	// 응답 바이트를 하나라도 받음
+	bool					_headSent;
+	bool					_outputPaused;	// Client 버퍼가 차서 업스트림 읽기를 멈춤
+	BodyMode				_bodyMode;
+	ChunkState				_chunkState;
+	size_t					_remaining;		// BODY_LENGTH 남은 바이트, 현재 청크 남은 바이트
+	bool					_keepAlive;		// 응답이 끝나면 연결을 풀에 돌려줄 수 있음
+
+	time_t					_connectStartedAt;
+	time_t					_lastSendAt;
+	time_t					_lastReadAt;
+
+	ProxyRequest(ProxyClient* owner, Client* client,
+				 const ServerContext* serverConf, const LocationContext* locConf);
+
+	ProxyRequest(const ProxyRequest&);
+	ProxyRequest& operator=(const ProxyRequest&);
+
+	void			buildHead(const HttpRequest* request, int clientFd, bool https);
+	bool			hasPendingOutput() const;
+	bool			flush();
+	void			onSendError();
+	void			onConnectError(int statusCode);
+	void			readResponse();
+	void			updateEvents();
+	void			processResponse();
+	bool			parseHead();
+	void			processBody();
+	bool			retry();
+	void			fail(int statusCode);
+	void			complete();
+
+public:
+	static const size_t	OUTPUT_HIGH_WATERMARK;	// 보내지 못한 요청 바디가 이만큼 쌓이면 Client 읽기를 멈춤
+	static const size_t	MAX_HEAD_SIZE;			// 업스트림 응답 헤더가 이보다 길면 502
+
+	virtual ~ProxyRequest();
+
+	// AsyncTask
+	virtual void	abort();
+
+	// BodySink
+	virtual bool	writeBody(const char* data, size_t len);
+	virtual int		bodyPipe() const;
+	virtual void	waitBodyWritable();
+	virtual void	endBody();
+
+	// BodySource
+	virtual void	resumeOutput();
+
+	// IoHandler (업스트림 소켓)
+	virtual void	onIoEvent(int fd, uint32_t events);
+};
+
+/**
+ * @brief proxy_pass 업스트림 하나와 유휴 keep-alive 연결 풀.
+ */
+struct ProxyUpstream {
+	struct IdleConnection {
+		int		fd;
+		time_t	since;
+
+		IdleConnection(int f, time_t s) : fd(f), since(s) {}
+	};
+
+	std::string						address;	// 설정에 적힌 그대로 (풀 키)
+	struct sockaddr_storage			sockaddr;
+	socklen_t						sockaddrLen;
+	bool							valid;		// 주소 해석 성공 여부
+
+	std::vector<IdleConnection>		idle;		// 뒤쪽이 가장 최근에 반납된 연결
+
+	ProxyUpstream() : sockaddrLen(0), valid(false) {}
+};
+
+/**
+ * @brief EventLoop에 통합된 비동기 HTTP 리버스 프록시 (proxy_pass).
+ *
+ * 요청마다 업스트림에 새로 연결하는 대신 응답을 마친 연결을 업스트림별 풀에 두고
+ * 다음 요청에 재사용함. 유휴 연결은 ProxyClient가 IoHandler로 지켜보다가 업스트림이
+ * 닫으면 풀에서 뺌. proxy_pass가 upstream 블록을 가리키면 UpstreamGroup이 서버를 고르고,
+ * 연결에 실패하면 아직 보낸 것이 없으므로 다른 서버로 다시 연결함.
+ */
+class ProxyClient : public IoHandler {
+private:
+	friend class ProxyRequest;
+
+	EventLoop*								_event_loop;
+	std::map<std::string, ProxyUpstream*>	_upstreams;
+	std::map<const UpstreamContext*, UpstreamGroup*>	_groups;
+	std::map<int, ProxyUpstream*>			_idleFds;	// 유휴 연결 fd -> 업스트림
+	std::vector<ProxyRequest*>				_active;
+	std::vector<ProxyRequest*>				_finished;	// 콜백 밖에서 삭제할 요청
+
+	ProxyUpstream*	getUpstream(const std::string& address);
+	static bool		resolveAddress(ProxyUpstream* upstream);
+
+	bool			start(ProxyRequest* request);
+	bool			failover(ProxyRequest* request);
+	bool			connect(ProxyRequest* request, bool reuse);
+	void			release(ProxyRequest* request);
+	void			closeIdle(int fd);
+
+	ProxyClient(const ProxyClient&);
+	ProxyClient& operator=(const ProxyClient&);
+
+public:
+	static const size_t	DEFAULT_CONNECT_TIMEOUT;	// proxy_connect_timeout 기본값 (초)
+	static const size_t	DEFAULT_READ_TIMEOUT;		// proxy_read_timeout 기본값 (초)
+	static const size_t	DEFAULT_SEND_TIMEOUT;		// proxy_send_timeout 기본값 (초)
+	static const size_t	MAX_IDLE_CONNECTIONS;		// 업스트림당 유지할 유휴 연결 수
+	static const time_t	IDLE_TIMEOUT;				// 유휴 연결 유지 시간 (초)
+
+	explicit ProxyClient(EventLoop* eventLoop);
+	~ProxyClient();
+
+	/**
+	 * @brief 요청을 location의 proxy_pass 업스트림으로 보내고 Client에 작업을 연결.
+	 *
+	 * streamBody면 받는 대로 업스트림에 쓰고(Client::startBodyStream), 아니면 이미 받은
+	 * 바디를 Content-Length로 보냄.
+	 * @return 주소가 잘못되었거나 연결을 시작할 수 없으면 false
+	 */
+	bool			submit(Client* client, bool streamBody);
+
+	// upstream 블록의 그룹 (없으면 만듦). 설정 적용 시 미리 만들어 두면 health_check가 바로 시작됨
+	UpstreamGroup*	getGroup(const UpstreamContext* config);
+
+	/**
+	 * @brief location의 proxy_pass 주소를 설정 적용 시 미리 해석 (upstream 블록이면 그룹과 모든 server).
+	 *
+	 * getaddrinfo는 블로킹이므로 이벤트 루프가 돌기 전에 끝내 둠. submit은 여기서 만든
+	 * 업스트림만 찾아 쓰고 요청 처리 중에는 주소를 해석하지 않음.
+	 * @return 해석하지 못한 주소가 있으면 false
+	 */
+	bool			prepare(const CompiledLocation* compiled);
+
+	// 연결/송신/수신 타임아웃, 유휴 연결 정리, health_check (Server::onTick에서 호출)
+	void			onTick();
+
+	// IoHandler (유휴 연결: 업스트림이 닫거나 보낸 데이터가 있으면 버림)
+	virtual void	onIoEvent(int fd, uint32_t events);
+};
+
+#endif
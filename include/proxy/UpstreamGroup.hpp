@@ -0,0 +1,121 @@
+#ifndef UPSTREAM_GROUP_HPP
+#define UPSTREAM_GROUP_HPP
+
+#include <string>
+#include <vector>
+#include <utility>
+#include "webserv.hpp"
+#include "dto/ConfigDTO.hpp"
+#include "server/IoHandler.hpp"
+
+class EventLoop;
+class HttpRequest;
+class HealthProbe;
+class UpstreamGroup;
+struct ProxyUpstream;
+
+/**
+ * @brief upstream 블록의 server 하나의 선택/상태 정보.
+ */
+struct UpstreamPeer {
+	ProxyUpstream*	upstream;		// 주소와 유휴 연결 풀 (ProxyClient 소유, 같은 주소면 공유)
+	size_t			weight;
+	size_t			maxFails;
+	time_t			failTimeout;
+
+	int				currentWeight;	// smooth weighted round-robin 상태
+	size_t			active;			// 진행 중인 요청 수 (least_conn)
+	size_t			fails;			// failTimeout 구간 안의 실패 수
+	time_t			firstFailAt;
+	time_t			downUntil;		// passive: 이 시각까지 선택하지 않음
+	bool			healthy;		// active: 마지막 health check 결과
+	HealthProbe*	probe;			// 진행 중인 health check (없으면 NULL)
+	time_t			nextCheckAt;
+
+	UpstreamPeer(ProxyUpstream* u, const UpstreamServerDirective& server)
+		: upstream(u), weight(server.weight), maxFails(server.maxFails), failTimeout(server.failTimeout),
+		  currentWeight(0), active(0), fails(0), firstFailAt(0), downUntil(0), healthy(true),
+		  probe(NULL), nextCheckAt(0) {}
+};
+
+/**
+ * @brief health_check 요청 하나. 연결해 GET을 보내고 상태 줄만 확인함.
+ */
+class HealthProbe : public IoHandler {
+private:
+	friend class UpstreamGroup;
+
+	UpstreamGroup*	_group;
+	UpstreamPeer*	_peer;
+	EventLoop*		_event_loop;
+	int				_fd;
+	std::string		_out;
+	size_t			_outOffset;
+	std::string		_in;
+	time_t			_startedAt;
+
+	HealthProbe(UpstreamGroup* group, UpstreamPeer* peer, EventLoop* eventLoop);
+
+	HealthProbe(const HealthProbe&);
+	HealthProbe& operator=(const HealthProbe&);
+
+	bool			start(const std::string& uri, const std::string& host);
+	void			finish(bool healthy);
+
+public:
+	virtual ~HealthProbe();
+
+	virtual void	onIoEvent(int fd, uint32_t events);
+};
+
+/**
+ * @brief upstream 블록 하나. 요청마다 서버를 고르고 실패를 추적함.
+ *
+ * 정책은 weight를 반영한 round-robin, least_conn, 일관 해시(URI 또는 쿠키)이며,
+ * 해시는 서버당 weight * HASH_POINTS개의 가상 노드로 링을 만들어 서버가 빠져도
+ * 나머지 키의 배치가 유지됨. max_fails번 실패한 서버는 fail_timeout 동안 제외하고,
+ * health_check가 있으면 이벤트 루프 타이머에서 주기적으로 검사해 실패한 서버를 제외함.
+ */
+class UpstreamGroup {
+private:
+	friend class HealthProbe;
+
+	const UpstreamContext*					_config;
+	std::vector<UpstreamPeer>				_peers;
+	std::vector<std::pair<uint32_t, size_t> >	_ring;		// 해시 -> peer 인덱스 (정렬됨)
+	std::vector<HealthProbe*>				_finishedProbes;	// 콜백 밖에서 삭제할 probe
+
+	bool			isAvailable(const UpstreamPeer& peer, time_t now,
+								const std::vector<UpstreamPeer*>& tried) const;
+	UpstreamPeer*	selectRoundRobin(time_t now, const std::vector<UpstreamPeer*>& tried, bool leastConn);
+	UpstreamPeer*	selectHash(const std::string& key, time_t now, const std::vector<UpstreamPeer*>& tried);
+
+	UpstreamGroup(const UpstreamGroup&);
+	UpstreamGroup& operator=(const UpstreamGroup&);
+
+public:
+	static const size_t	HASH_POINTS;	// weight 1당 링에 넣는 가상 노드 수
+
+	UpstreamGroup(const UpstreamContext* config, const std::vector<ProxyUpstream*>& upstreams);
+	~UpstreamGroup();
+
+	const std::string&	name() const;
+
+	// 해시 정책의 키 (URI 또는 쿠키 값, 해시가 아니거나 쿠키가 없으면 빈 문자열)
+	std::string		hashKey(const HttpRequest* request) const;
+
+	/**
+	 * @brief 요청을 보낼 서버를 고름.
+	 * @param tried 이미 실패해 제외할 서버 (다른 서버로 다시 시도할 때)
+	 * @return 선택할 수 있는 서버가 없으면 NULL
+	 */
+	UpstreamPeer*	select(const std::string& key, const std::vector<UpstreamPeer*>& tried);
+
+	void			recordFailure(UpstreamPeer* peer);
+	void			recordSuccess(UpstreamPeer* peer);
+
+	// health_check 시작/타임아웃 (ProxyClient::onTick에서 호출)
+	void			runHealthChecks(EventLoop* eventLoop);
+};
+
+#endif
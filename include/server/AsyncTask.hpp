@@ -0,0 +1,18 @@
+#ifndef ASYNC_TASK_HPP
+# define ASYNC_TASK_HPP
+
+/**
+ * @brief 이벤트 루프에서 비동기로 진행되는 요청 처리 작업 (FastCGI 요청 등).
+ *
+ * Client는 작업을 소유하지 않고 참조만 하며, 작업이 끝나면 Client::completeAsync로
+ * 응답을 넘겨받음. 작업이 끝나기 전에 Client가 사라지면 abort()가 호출되고,
+ * 그 이후 작업은 Client에 접근하면 안 됨.
+ */
+class AsyncTask {
+public:
+	virtual ~AsyncTask() {}
+
+	virtual void	abort() = 0;
+};
+
+#endif
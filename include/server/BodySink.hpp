@@ -0,0 +1,29 @@
+#ifndef BODY_SINK_HPP
+# define BODY_SINK_HPP
+
+#include <cstddef>
+
+/**
+ * @brief 요청 바디를 다 받기 전에 받는 대로 넘겨받는 대상 (CGI stdin 등).
+ *
+ * Client는 소켓에서 읽은 바디를 writeBody로 넘기고, false가 돌아오면 소켓 읽기를 멈춤.
+ * sink는 버퍼가 비면 Client::resumeBody를 호출해 다시 읽게 함.
+ */
+class BodySink {
+public:
+	virtual ~BodySink() {}
+
+	// 바디 조각 전달. 더 받을 수 있으면 true, 버퍼가 차서 resumeBody를 기다려야 하면 false
+	virtual bool	writeBody(const char* data, size_t len) = 0;
+
+	// 소켓에서 직접 splice할 수 있는 파이프 fd (sink 버퍼가 비어 있을 때만, 아니면 -1)
+	virtual int		bodyPipe() const = 0;
+
+	// splice 중 파이프가 가득 참: 다시 쓸 수 있게 되면 resumeBody 호출
+	virtual void	waitBodyWritable() = 0;
+
+	// 바디 끝
+	virtual void	endBody() = 0;
+};
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef BODY_SOURCE_HPP
+# define BODY_SOURCE_HPP
+
+/**
+ * @brief 응답 바디를 만드는 대로 Client에 넘기는 쪽 (CGI stdout 등).
+ *
+ * Client::appendResponseBody가 false를 돌려주면 source는 읽기를 멈추고,
+ * Client가 쌓인 응답을 소켓으로 다 보내면 resumeOutput으로 다시 읽게 함.
+ */
+class BodySource {
+public:
+	virtual ~BodySource() {}
+
+	virtual void	resumeOutput() = 0;
+};
+
+#endif
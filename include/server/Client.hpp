@@ -3,9 +3,17 @@
 #define CLIENT_HPP
 
 #include "../webserv.hpp"
+#include "log/RequestTrace.hpp"
 
 class HttpRequest;
 class HttpResponse;
+class EventLoop;
+class AsyncTask;
+class BodySink;
+class BodySource;
+class ResponseTap;
+class CompressStream;
+class TlsConnection;
 struct ServerContext;
 struct LocationContext;
 
@@ -27,6 +35,8 @@ class Client {
 private:
 	int					_fd;
 	int					_port;
+	EventLoop*			_event_loop;
+	TlsConnection*		_tls;				// listen ... ssl이면 non-NULL (소유)
 	ClientState			_state;
 	ClientHeaderState	_headerState;
 	
@@ -34,11 +44,38 @@ private:
 	HttpResponse*		_response;
 	size_t				_response_sent;
 	time_t				_last_activity;
+
+	// access_log, 단계별 시간
+	std::string			_remote_addr;
+	RequestTrace		_trace;
+	size_t				_bytes_sent;		// 이 요청의 응답으로 소켓에 쓴 바이트
 	size_t				_headerEnd;
 	
 	const ServerContext*	_serverConf;
 	const LocationContext*	_locConf;
 
+	// 진행 중인 비동기 작업 (FastCGI 등, 소유하지 않음)
+	AsyncTask*			_task;
+
+	// 바디 스트리밍 (CGI stdin 등으로 받는 대로 넘김, 소유하지 않음)
+	BodySink*			_bodySink;
+	size_t				_bodyRemaining;		// 아직 넘기지 않은 바디 바이트
+	bool				_bodyPaused;		// sink가 가득 차서 소켓 읽기를 멈춤
+
+	// 응답 스트리밍 (헤더를 먼저 보내고 바디는 만들어지는 대로 이어 붙임)
+	BodySource*			_responseSource;	// 바디가 아직 오는 중이면 non-NULL
+	bool				_responseStream;
+	bool				_responseChunked;
+	bool				_closeAfterStream;	// 바디가 끊겼거나 길이를 알 수 없음: 보낸 뒤 연결 종료
+	CompressStream*		_compressor;		// gzip: 스트리밍 바디를 압축해서 보냄
+
+	// 파일 바디 (Range): 보내는 중인 조각과 그 조각에서 보낸 파일 바이트
+	size_t				_fileSegment;
+	size_t				_fileSent;
+
+	// 응답을 함께 받아 보는 쪽 (응답 캐시 채우기 등, 소유하지 않음)
+	ResponseTap*		_responseTap;
+
 	// Buffer Index Offset 방식 추가
 	std::string			_raw_buffer;
 	size_t				_buffer_read_offset;  // 읽은 데이터의 오프셋
@@ -57,12 +94,21 @@ private:
 	void				consumeBuffer(size_t n);
 	void				compactBuffer();  // 주기적 버퍼 정리
 
+	void				pauseBody(void);
+	void				finishBodyStream(void);
+	void				endTap(bool complete);
+	void				appendFramed(const char* data, size_t len);
+	int					sendFileBody(void);	// 1: 다 보냄, 0: 쓰기 이벤트 대기, -1: 연결 종료
+	void				finishRequest(void);	// access_log, 지표, slow_request_log 기록
+	void				logSlowRequest(long long end) const;
+
 public:
 	static const size_t MAX_REQUEST_SIZE;
 	static const size_t MAX_HEADER_SIZE;
 	static const size_t BUFFER_COMPACT_THRESHOLD;  // 버퍼 정리 임계값
+	static const size_t OUTPUT_HIGH_WATERMARK;     // 보내지 못한 스트리밍 응답 상한
 	
-	Client(int fd, int port);
+	Client(int fd, int port, EventLoop* eventLoop);
 	~Client(void);
 	
 	// I/O 처리
@@ -70,6 +116,30 @@ public:
 	bool				tryParseBody(void);
 	bool				handleWrite(void);
 	void				setResponse(HttpResponse* response);
+
+	// 비동기 처리: attach 후 작업이 completeAsync로 응답을 넘기면 쓰기 이벤트를 켬
+	void				attachAsync(AsyncTask* task);
+	void				completeAsync(HttpResponse* response);
+	bool				hasAsyncTask(void) const;
+
+	// 바디 스트리밍: 헤더만 받은 상태에서 시작하고, 이후 받은 바디는 sink로 넘김
+	void				startBodyStream(BodySink* sink);
+	bool				isStreamingBody(void) const;
+	void				pumpBody(void);
+	void				resumeBody(void);
+	int					spliceBody(void);	// 1: 처리함, 0: recv로 처리, -1: 연결 종료
+
+	// 응답 스트리밍: Content-Length가 없으면 chunked로 보냄
+	void				startResponseStream(HttpResponse* head, BodySource* source);
+	bool				appendResponseBody(const char* data, size_t len);	// false: resumeOutput 대기
+	void				endResponseStream(bool complete);
+
+	// nph CGI: source가 소켓에 응답을 직접 씀 (splice). 끝나면 연결을 닫음
+	void				startResponseRelay(BodySource* source);
+	void				waitRelayWritable(void);	// 소켓이 쓰기 가능해지면 resumeOutput 호출
+
+	// 이 요청의 응답을 tap에도 넘김 (응답이 끝나거나 요청이 버려지면 tapEnd)
+	void				setResponseTap(ResponseTap* tap);
 	
 	// 상태 조회
 	int					getFd(void) const;
@@ -85,8 +155,29 @@ public:
 	void				setServerContext(const ServerContext* conf);
 	void				setLocationContext(const LocationContext* conf);
 	void				appendRawBuffer(const char* data, size_t len);
+
+	// access_log: 받은 소켓의 주소, 소켓에 직접 쓴 응답 바이트 (nph relay)
+	void				setRemoteAddress(const std::string& addr);
+	const std::string&	getRemoteAddress(void) const;
+	void				addBytesSent(size_t bytes);
+	RequestTrace&		trace(void);
+
+	// 소켓 I/O: TLS 연결이면 복호화/암호화해서 읽고 씀 (recv/send와 같은 반환값)
+	void				setTls(TlsConnection* tls);
+	TlsConnection*		getTls(void) const;
+	TlsConnection*		releaseTls(void);	// HTTP/2로 넘길 때 소유권을 넘김
+	ssize_t				readSocket(char* buffer, size_t len);
+	bool				hasPendingInput(void) const;	// TLS 안에 읽지 않은 바이트가 남음
+	ssize_t				writeSocket(const char* data, size_t len);
+	bool				canWriteSocketDirectly(void) const;	// 평문 소켓이나 kTLS: splice 가능
+
+	// HTTP/2 prior knowledge: 1이면 프리페이스, 0이면 더 받아 봐야 함, -1이면 HTTP/1.x
+	int					detectHttp2Preface(void) const;
+	// HTTP/2로 넘길 때 아직 처리하지 않은 입력 (헤더를 파싱했으면 헤더 뒤부터)
+	std::string			takeBufferedInput(void);
 	void				updateActivity(void);
 	bool				isExpired(time_t now) const;
+	bool				isIdle(void) const;	// keep-alive로 다음 요청을 기다림
 	bool				needsWriteEvent(void) const;
 };
 
@@ -5,12 +5,14 @@
 #include <map>
 
 class	Server;
+class	IoHandler;
 
 class	EventLoop {
 private:
 	int							_epfd; // epoll fd
 	std::map<int, u_int32_t>	_interests; // fd -> 이벤트 마스크
 	int							_timeout_ms; // epoll_wait 타임아웃
+	std::map<int, IoHandler*>	_handlers; // fd -> 핸들러 (Server 콜백 대신 호출, 소유하지 않음)
 
 	bool		ctl(int op, int fd, u_int32_t events); // epoll_clt()의 wrapper 함수
 	static bool	setNonBlocking(int fd);
@@ -23,7 +25,11 @@ public:
 	bool	addServerSocket(int fd);			// EPOLLIN 등록
 	bool	addClientSocket(int fd);			// EPOLLIN 등록
 	bool	setWritable(int fd, bool enable);	// EPOLLOUT on/off
-	bool	remove(int fd);						// epoll_ctl DEL
+	bool	setReadable(int fd, bool enable);	// EPOLLIN on/off (요청 바디 backpressure)
+	bool	remove(int fd);						// epoll_ctl DEL (핸들러 등록도 해제)
+
+	bool	addHandler(int fd, uint32_t events, IoHandler* handler);	// 비소켓/업스트림 fd 등록
+	bool	modifyHandler(int fd, uint32_t events);						// 핸들러 fd의 이벤트 마스크 변경
 
 	void	run(Server& server);				// 단일 이벤트 루프
 };
@@ -0,0 +1,20 @@
+#ifndef IO_HANDLER_HPP
+# define IO_HANDLER_HPP
+
+#include "webserv.hpp"
+
+/**
+ * @brief 클라이언트 소켓 외의 fd(FastCGI 연결, CGI 파이프 등)를 EventLoop에 등록하기 위한 인터페이스.
+ *
+ * EventLoop는 등록된 fd의 이벤트를 Server 콜백 대신 해당 핸들러로 전달함.
+ * 핸들러는 onIoEvent 안에서 자신의 fd를 EventLoop에서 제거할 수 있음.
+ */
+class IoHandler {
+public:
+	virtual ~IoHandler() {}
+
+	// events: epoll 이벤트 마스크 (EPOLLIN, EPOLLOUT, EPOLLHUP, EPOLLERR ...)
+	virtual void	onIoEvent(int fd, uint32_t events) = 0;
+};
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef RESPONSE_TAP_HPP
+# define RESPONSE_TAP_HPP
+
+# include <cstddef>
+
+class HttpResponse;
+
+/**
+ * @brief Client가 내보내는 응답을 옆에서 받아 보는 쪽 (응답 캐시 등).
+ *
+ * tapHead는 응답 헤더를 직렬화하기 전에 호출되므로 헤더를 덧붙일 수 있음
+ * (completeAsync로 넘긴 응답은 바디도 들어 있음). 스트리밍 응답의 바디는 프레이밍
+ * 전에 tapBody로 넘기고, 응답이 끝나거나 버려지면 tapEnd가 한 번 호출됨.
+ * tapEnd 이후 Client는 tap을 참조하지 않음.
+ */
+class ResponseTap {
+public:
+	virtual ~ResponseTap() {}
+
+	virtual void	tapHead(HttpResponse& head) = 0;
+	virtual void	tapBody(const char* data, size_t len) = 0;
+	virtual void	tapEnd(bool complete) = 0;
+};
+
+#endif
@@ -5,12 +5,28 @@
 #include "EventLoop.hpp"
 #include "Client.hpp"
 
+class	FastCgiClient;
+class	CgiRunner;
+class	ProxyClient;
+class	ResponseCache;
+class	Http2Connection;
+class	TlsContext;
+struct	CompiledLocation;
+struct	UpstreamContext;
+struct	CacheZoneDirective;
+
 class	Server {
 private:
 	EventLoop*				_event_loop;
+	FastCgiClient*			_fastcgi;		// fastcgi_pass 업스트림, cgi_pool 워커 연결 풀
+	CgiRunner*				_cgi;			// fork-exec CGI 프로세스
+	ProxyClient*			_proxy;			// proxy_pass 업스트림 연결 풀
+	ResponseCache*			_cache;			// cache location의 응답 캐시
 	std::vector<int>		_server_fds;	// Server sockets
 	std::map<int, Client*>	_clients;		// fd -> Client mapping
+	std::map<int, Http2Connection*>	_http2;	// fd -> HTTP/2로 넘어간 연결
 	std::map<int, int>		_server_ports;	// fd -> port mapping
+	std::map<int, TlsContext*>	_server_tls;	// listen ... ssl 소켓 fd -> 기본 인증서 (소유하지 않음)
 	bool					_running;
 
 	// Setting server sockets
@@ -25,6 +41,18 @@ private:
 	// onReadable helper functions
 	void	handleNewConnection(int server_fd);
 	void	handleClientData(int client_fd);
+	bool	dispatchAsync(Client* client);
+	HttpResponse*	createStatusResponse(void);
+	bool	startCgiStream(Client* client);
+	bool	startProxy(Client* client, bool streamBody);
+	bool	checkCache(Client* client);
+	bool	canStreamBody(Client* client) const;
+	bool	usesProxy(Client* client) const;
+	bool	resolveCgiScript(Client* client, std::string& scriptPath) const;
+	bool	usesCgiPool(const LocationContext* locConf, const std::string& scriptPath) const;
+	void	continueHandshake(Client* client);
+	void	startHttp2(Client* client, bool upgrade);
+	void	updateHttp2(int fd, bool alive);
 
 public:
 	Server();
@@ -32,10 +60,18 @@ public:
 
 	// Server initializing, Executing
 	bool	init();
-	bool	addListenPort(const std::string& host, int port);
+	bool	addListenPort(const std::string& host, int port, TlsContext* tls);
+	void	startCgiPool(const CompiledLocation* compiled);
+	void	startCgiQueue(const LocationContext* location);
+	bool	startUpstream(const CompiledLocation* compiled);
+	bool	startFastCgiUpstream(const CompiledLocation* compiled);
+	void	startCacheZone(const CacheZoneDirective* zone);
 	void	run();
 	void	stop();
 
+	// 요청 전체를 받은 Client의 응답을 만듦 (비동기 작업으로 넘기거나 바로 응답)
+	void	processRequest(Client* client);
+
 	// EventLoop callback functions
 	void	onReadable(int fd);
 	void	onWritable(int fd);
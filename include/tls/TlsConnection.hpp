@@ -0,0 +1,53 @@
+#ifndef TLS_CONNECTION_HPP
+#define TLS_CONNECTION_HPP
+
+#include <string>
+#include <sys/types.h>
+#include <openssl/ssl.h>
+
+/**
+ * @brief 소켓 하나의 TLS 상태 (SSL). Client와 Http2Connection이 recv/send 대신 사용.
+ *
+ * read/write/sendFile은 recv/send와 같은 반환값을 씀: 소켓을 기다려야 하면 -1과 errno = EAGAIN.
+ * 레코드가 일부만 나가면 다음 호출에서 같은 데이터로 다시 써야 함 (버퍼가 옮겨지는 것은 허용).
+ */
+class TlsConnection {
+private:
+	SSL*	_ssl;
+	bool	_established;
+	bool	_failed;		// 치명적 오류: close_notify를 보내지 않음
+	bool	_wantWrite;		// 핸드셰이크가 소켓 쓰기 가능을 기다림
+	bool	_ktlsSend;		// 송신 암호화를 커널이 함
+
+	TlsConnection(const TlsConnection&);
+	TlsConnection& operator=(const TlsConnection&);
+
+	ssize_t	fail(int ret);
+
+public:
+	static const size_t	FILE_CHUNK;		// kTLS가 없을 때 파일을 읽어 암호화하는 단위
+
+	explicit TlsConnection(SSL* ssl);
+	~TlsConnection();
+
+	// 1: 완료, 0: 소켓 이벤트 대기 (wantsWrite로 방향 확인), -1: 실패
+	int			handshake();
+	bool		isEstablished() const;
+	bool		wantsWrite() const;
+
+	// ALPN으로 고른 프로토콜 ("h2", "http/1.1", 없으면 빈 문자열)
+	std::string	getProtocol() const;
+
+	ssize_t		read(char* buffer, size_t len);
+	bool		hasPendingInput() const;	// 복호화해 둔 바이트가 남음 (소켓 이벤트가 다시 오지 않음)
+	ssize_t		write(const char* data, size_t len);
+	ssize_t		sendFile(int fd, off_t offset, size_t len);
+
+	// kTLS 송신이면 소켓에 직접 써도 됨 (splice, send)
+	bool		canWriteSocket() const;
+
+	// close_notify를 보냄 (한 번만, 응답을 기다리지 않음)
+	void		shutdown();
+};
+
+#endif
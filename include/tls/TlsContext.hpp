@@ -0,0 +1,53 @@
+#ifndef TLS_CONTEXT_HPP
+#define TLS_CONTEXT_HPP
+
+#include <map>
+#include <string>
+#include <openssl/ssl.h>
+
+class TlsConnection;
+struct ServerContext;
+
+/**
+ * @brief listen ... ssl인 server 블록 하나의 인증서와 TLS 설정 (SSL_CTX).
+ *
+ * 설정 적용 시 server 블록마다 하나씩 만들어 두고, 리슨 소켓은 그 포트의 기본 server 컨텍스트로
+ * 핸드셰이크를 시작함. SNI로 이름이 오면 VirtualHostTable로 server를 찾아 그 인증서로 바꿈.
+ * ALPN은 h2를 먼저 고르고(포트에 HTTP/2로 처리하지 못하는 location이 있으면 http/1.1만),
+ * 세션 캐시와 세션 티켓으로 재접속 시 전체 핸드셰이크를 생략함.
+ * 커널이 지원하면 kTLS를 켜서 암호화를 커널에 맡김 (sendfile/splice를 그대로 쓸 수 있음).
+ */
+class TlsContext {
+private:
+	SSL_CTX*	_ctx;
+	int			_port;
+	bool		_http2;		// ALPN으로 h2를 고를 수 있음
+
+	static std::map<const ServerContext*, TlsContext*>	_contexts;
+
+	TlsContext(SSL_CTX* ctx, int port, bool http2);
+	TlsContext(const TlsContext&);
+	TlsContext& operator=(const TlsContext&);
+
+	static std::string	lastError();
+	static bool			supportsHttp2(int port);
+	static int			selectServerName(SSL* ssl, int* alert, void* arg);
+	static int			selectProtocol(SSL* ssl, const unsigned char** out, unsigned char* outlen,
+									   const unsigned char* in, unsigned int inlen, void* arg);
+
+public:
+	static const long	SESSION_CACHE_SIZE;	// 서버 세션 캐시 항목 수
+	static const long	SESSION_TIMEOUT;	// 세션/티켓 유효 시간 (초)
+
+	~TlsContext();
+
+	// server 블록의 인증서를 읽어 컨텍스트를 만듦. 이미 있으면 그대로 반환, 실패하면 NULL
+	static TlsContext*	create(const ServerContext* server, int port);
+	static TlsContext*	find(const ServerContext* server);
+	static void			clear();
+
+	// 받은 소켓에 대한 TLS 연결 (핸드셰이크 전). 실패하면 NULL
+	TlsConnection*		accept(int fd) const;
+};
+
+#endif
@@ -27,13 +27,11 @@ private:
 	);
 	
 	static std::string resolveExtensionPath(
-		const ServerContext* server,
 		const LocationContext* loc, 
 		const std::string& uri
 	);
 	
 	static std::string resolvePrefixPath(
-		const ServerContext* server,
 		const LocationContext* loc, 
 		const std::string& uri
 	);
@@ -45,7 +43,6 @@ private:
 	);
 	
 	static std::string resolveWithRoot(
-		const ServerContext* server,
 		const LocationContext* loc,
 		const std::string& uri
 	);
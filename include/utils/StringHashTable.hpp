@@ -0,0 +1,142 @@
+#ifndef STRING_HASH_TABLE_HPP
+#define STRING_HASH_TABLE_HPP
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstddef>
+
+/**
+ * @brief 문자열 키 전용 open addressing 해시 테이블.
+ *
+ * C++98에는 unordered_map이 없으므로, 설정 적용 시점에 한 번 만들어 두고
+ * 요청마다 조회만 하는 용도(라우팅, vhost, MIME 등)로 사용함.
+ * 조회는 (포인터, 길이) 형태로도 가능해서 substr 없이 URI 일부를 바로 찾을 수 있음.
+ */
+template<typename T>
+class StringHashTable {
+private:
+	struct Slot {
+		std::string	key;
+		size_t		hash;
+		T			value;
+		bool		used;
+
+		Slot() : hash(0), value(), used(false) {}
+	};
+
+	std::vector<Slot>	_slots;		// 크기는 항상 2의 거듭제곱
+	size_t				_count;
+	bool				_caseInsensitive;
+
+	static unsigned char fold(unsigned char c, bool icase) {
+		return (icase && c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c - 'A' + 'a') : c;
+	}
+
+	// FNV-1a
+	size_t hashBytes(const char* data, size_t len) const {
+		size_t h = static_cast<size_t>(2166136261UL);
+		for (size_t i = 0; i < len; ++i) {
+			h ^= fold(static_cast<unsigned char>(data[i]), _caseInsensitive);
+			h *= static_cast<size_t>(16777619UL);
+		}
+		return h;
+	}
+
+	bool keyEquals(const std::string& key, const char* data, size_t len) const {
+		if (key.length() != len) {
+			return false;
+		}
+		if (!_caseInsensitive) {
+			return std::memcmp(key.data(), data, len) == 0;
+		}
+		for (size_t i = 0; i < len; ++i) {
+			if (fold(static_cast<unsigned char>(key[i]), true) != fold(static_cast<unsigned char>(data[i]), true)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	size_t findSlot(const char* data, size_t len, size_t hash) const {
+		size_t mask = _slots.size() - 1;
+		size_t idx = hash & mask;
+		while (_slots[idx].used) {
+			if (_slots[idx].hash == hash && keyEquals(_slots[idx].key, data, len)) {
+				return idx;
+			}
+			idx = (idx + 1) & mask;
+		}
+		return idx;  // 빈 슬롯
+	}
+
+	void grow() {
+		std::vector<Slot> old;
+		old.swap(_slots);
+		_slots.resize(old.empty() ? 16 : old.size() * 2);
+		for (size_t i = 0; i < old.size(); ++i) {
+			if (!old[i].used) {
+				continue;
+			}
+			size_t idx = findSlot(old[i].key.data(), old[i].key.length(), old[i].hash);
+			_slots[idx] = old[i];
+		}
+	}
+
+	// 공통 삽입 로직. overwrite가 false면 기존 값을 유지함.
+	bool put(const std::string& key, const T& value, bool overwrite) {
+		if ((_count + 1) * 2 > _slots.size()) {
+			grow();
+		}
+		size_t hash = hashBytes(key.data(), key.length());
+		size_t idx = findSlot(key.data(), key.length(), hash);
+		if (_slots[idx].used) {
+			if (overwrite) {
+				_slots[idx].value = value;
+			}
+			return false;
+		}
+		_slots[idx].key = key;
+		_slots[idx].hash = hash;
+		_slots[idx].value = value;
+		_slots[idx].used = true;
+		++_count;
+		return true;
+	}
+
+public:
+	explicit StringHashTable(bool caseInsensitive = false)
+		: _count(0), _caseInsensitive(caseInsensitive) {}
+
+	// 이미 같은 키가 있으면 먼저 등록된 값을 유지하고 false 반환
+	bool insert(const std::string& key, const T& value) {
+		return put(key, value, false);
+	}
+
+	// 같은 키가 있으면 덮어씀
+	void set(const std::string& key, const T& value) {
+		put(key, value, true);
+	}
+
+	const T* find(const char* data, size_t len) const {
+		if (_count == 0) {
+			return NULL;
+		}
+		size_t idx = findSlot(data, len, hashBytes(data, len));
+		return _slots[idx].used ? &_slots[idx].value : NULL;
+	}
+
+	const T* find(const std::string& key) const {
+		return find(key.data(), key.length());
+	}
+
+	size_t size() const { return _count; }
+	bool empty() const { return _count == 0; }
+
+	void clear() {
+		_slots.clear();
+		_count = 0;
+	}
+};
+
+#endif
@@ -0,0 +1,169 @@
+#include "cache/CacheZone.hpp"
+#include "utils/FileManager.hpp"
+#include <sstream>
+#include <cstring>
+#include <dirent.h>
+#include <unistd.h>
+
+CacheZone::CacheZone(const CacheZoneDirective* config)
+	: _config(config), _memorySize(0), _diskSize(0), _fileSeq(0) {
+	_stats.zone = config->name;
+	if (!_config->path.empty()) {
+		removeLeftovers();
+	}
+}
+
+CacheZone::~CacheZone() {
+	for (std::map<std::string, CacheEntry*>::iterator it = _entries.begin(); it != _entries.end(); ++it) {
+		if (!it->second->file.empty()) {
+			::unlink(it->second->file.c_str());
+		}
+		delete it->second;
+	}
+}
+
+const CacheZoneDirective* CacheZone::config() const {
+	return _config;
+}
+
+CacheZone::Stats& CacheZone::stats() {
+	_stats.entries = _entries.size();
+	_stats.memoryBytes = _memorySize;
+	_stats.diskBytes = _diskSize;
+	return _stats;
+}
+
+CacheEntry* CacheZone::find(const std::string& key) {
+	std::map<std::string, CacheEntry*>::iterator it = _entries.find(key);
+	if (it == _entries.end()) {
+		return NULL;
+	}
+	CacheEntry* entry = it->second;
+
+	if (!entry->file.empty()) {
+		if (!load(entry)) {
+			remove(entry);
+			return NULL;
+		}
+		++_stats.diskHits;
+		shrinkMemory();
+		return entry;
+	}
+	_memory.splice(_memory.begin(), _memory, entry->lru);
+	return entry;
+}
+
+void CacheZone::store(CacheEntry* entry) {
+	std::map<std::string, CacheEntry*>::iterator it = _entries.find(entry->key);
+	if (it != _entries.end()) {
+		remove(it->second);
+	}
+	if (!entry->pass) {
+		++_stats.stores;
+	}
+
+	entry->size = entry->key.size() + entry->body.size();
+	for (std::map<std::string, std::string>::const_iterator header = entry->headers.begin();
+		 header != entry->headers.end(); ++header) {
+		entry->size += header->first.size() + header->second.size();
+	}
+	_entries[entry->key] = entry;
+	_memory.push_front(entry);
+	entry->lru = _memory.begin();
+	_memorySize += entry->size;
+	shrinkMemory();
+}
+
+void CacheZone::expire(time_t now) {
+	std::map<std::string, CacheEntry*>::iterator it = _entries.begin();
+	while (it != _entries.end()) {
+		CacheEntry* entry = it->second;
+		++it;
+		if (now >= entry->staleUntil) {
+			remove(entry);
+		}
+	}
+}
+
+void CacheZone::remove(CacheEntry* entry) {
+	if (entry->file.empty()) {
+		_memory.erase(entry->lru);
+		_memorySize -= entry->size;
+	} else {
+		_disk.erase(entry->lru);
+		_diskSize -= entry->size;
+		::unlink(entry->file.c_str());
+	}
+	_entries.erase(entry->key);
+	delete entry;
+}
+
+// 메모리 합이 size 안으로 들어올 때까지 오래된 응답을 디스크로 내리거나 버림
+void CacheZone::shrinkMemory() {
+	while (_memorySize > _config->size && !_memory.empty()) {
+		CacheEntry* entry = _memory.back();
+		if (entry->pass || _config->path.empty() || entry->size > _config->diskSize || !spill(entry)) {
+			++_stats.evictions;
+			remove(entry);
+		}
+	}
+
+	while (_diskSize > _config->diskSize && !_disk.empty()) {
+		++_stats.evictions;
+		remove(_disk.back());
+	}
+}
+
+bool CacheZone::spill(CacheEntry* entry) {
+	std::ostringstream path;
+	path << _config->path << "/" << _config->name << "-" << ++_fileSeq << ".cache";
+	if (!FileManager::saveFile(path.str(), entry->body)) {
+		::unlink(path.str().c_str());
+		return false;
+	}
+
+	_memory.erase(entry->lru);
+	_memorySize -= entry->size;
+	std::string().swap(entry->body);
+	entry->file = path.str();
+	_disk.push_front(entry);
+	entry->lru = _disk.begin();
+	_diskSize += entry->size;
+	++_stats.spills;
+	return true;
+}
+
+bool CacheZone::load(CacheEntry* entry) {
+	if (!FileManager::readFile(entry->file, entry->body)) {
+		return false;
+	}
+
+	_disk.erase(entry->lru);
+	_diskSize -= entry->size;
+	::unlink(entry->file.c_str());
+	entry->file.clear();
+	_memory.push_front(entry);
+	entry->lru = _memory.begin();
+	_memorySize += entry->size;
+	return true;
+}
+
+// 이전 실행에서 남은 <zone>-N.cache 파일
+void CacheZone::removeLeftovers() {
+	DIR* dir = ::opendir(_config->path.c_str());
+	if (dir == NULL) {
+		ERROR_LOG("[Cache] cache_zone " << _config->name << " path is not accessible: " << _config->path);
+		return;
+	}
+
+	std::string prefix = _config->name + "-";
+	struct dirent* ent;
+	while ((ent = ::readdir(dir)) != NULL) {
+		std::string name = ent->d_name;
+		if (name.compare(0, prefix.length(), prefix) == 0 && name.length() > 6
+			&& name.compare(name.length() - 6, 6, ".cache") == 0) {
+			::unlink((_config->path + "/" + name).c_str());
+		}
+	}
+	::closedir(dir);
+}
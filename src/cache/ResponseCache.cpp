@@ -0,0 +1,359 @@
+#include "cache/ResponseCache.hpp"
+#include "server/Server.hpp"
+#include "server/Client.hpp"
+#include "http/HttpRequest.hpp"
+#include "http/HttpResponse.hpp"
+#include "config/CompiledLocation.hpp"
+#include "utils/StringUtils.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+const time_t ResponseCache::PASS_TIME = 10;
+
+static std::string lowerCase(const std::string& value) {
+	std::string lower = value;
+	std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+	return lower;
+}
+
+// 헤더 이름은 CGI/업스트림이 쓴 대소문자 그대로 들어 있음
+static std::string findHeader(const HttpResponse& response, const std::string& name) {
+	const std::map<std::string, std::string>& headers = response.getHeaders();
+	for (std::map<std::string, std::string>::const_iterator it = headers.begin(); it != headers.end(); ++it) {
+		if (lowerCase(it->first) == name) {
+			return it->second;
+		}
+	}
+	return "";
+}
+
+// 연결마다 다시 만드는 헤더와 캐시가 붙이는 헤더는 저장하지 않음
+static bool isStoredHeader(const std::string& name) {
+	std::string lower = lowerCase(name);
+	return lower != "date" && lower != "connection" && lower != "keep-alive" && lower != "content-length"
+		&& lower != "transfer-encoding" && lower != "age" && lower != "x-cache-status";
+}
+
+// "a, b=1" -> ["a", "b=1"] (소문자)
+static std::vector<std::string> splitList(const std::string& value) {
+	std::vector<std::string> items;
+	size_t pos = 0;
+	while (pos <= value.length()) {
+		size_t end = value.find(',', pos);
+		if (end == std::string::npos) {
+			end = value.length();
+		}
+		std::string item = StringUtils::trim(value.substr(pos, end - pos));
+		if (!item.empty()) {
+			items.push_back(lowerCase(item));
+		}
+		pos = end + 1;
+	}
+	return items;
+}
+
+// =========================================================================
+// CacheWaiter
+// =========================================================================
+
+CacheWaiter::CacheWaiter(Client* client) : _client(client) {}
+
+CacheWaiter::~CacheWaiter() {}
+
+void CacheWaiter::abort() {
+	_client = NULL;
+}
+
+// =========================================================================
+// CacheFill
+// =========================================================================
+
+CacheFill::CacheFill(ResponseCache* owner, CacheZone* zone, const CompiledLocation* location,
+					 const std::string& key, bool refresh)
+	: _owner(owner), _zone(zone), _location(location), _key(key), _refresh(refresh),
+	  _state(COLLECTING), _entry(NULL) {}
+
+CacheFill::~CacheFill() {
+	delete _entry;
+	for (size_t i = 0; i < _waiters.size(); ++i) {
+		delete _waiters[i];
+	}
+}
+
+void CacheFill::tapHead(HttpResponse& head) {
+	time_t now = ::time(NULL);
+	int status = head.getStatus();
+
+	// cache_valid 시간을 Cache-Control이 덮어씀 (s-maxage > max-age)
+	std::map<int, size_t>::const_iterator valid = _location->cacheValid.find(status);
+	if (valid == _location->cacheValid.end()) {
+		valid = _location->cacheValid.find(0);
+	}
+	bool cacheable = (valid != _location->cacheValid.end());
+	long ttl = cacheable ? static_cast<long>(valid->second) : 0;
+	long stale = static_cast<long>(_location->cacheStale);
+	bool pass = false;
+	bool sharedMaxAge = false;
+
+	std::vector<std::string> cacheControl = splitList(findHeader(head, "cache-control"));
+	for (size_t i = 0; i < cacheControl.size(); ++i) {
+		const std::string& directive = cacheControl[i];
+		if (directive == "no-store" || directive == "private" || directive == "no-cache") {
+			pass = true;
+		} else if (directive.compare(0, 9, "s-maxage=") == 0) {
+			ttl = std::atol(directive.c_str() + 9);
+			sharedMaxAge = true;
+		} else if (directive.compare(0, 8, "max-age=") == 0 && !sharedMaxAge) {
+			ttl = std::atol(directive.c_str() + 8);
+		} else if (directive.compare(0, 23, "stale-while-revalidate=") == 0) {
+			stale = std::atol(directive.c_str() + 23);
+		}
+	}
+
+	// 키에 없는 요청 헤더에 따라 달라지는 응답은 키 하나에 담을 수 없음
+	std::vector<std::string> vary = splitList(findHeader(head, "vary"));
+	for (size_t i = 0; i < vary.size(); ++i) {
+		if (std::find(_location->cacheKeyHeaders.begin(), _location->cacheKeyHeaders.end(), vary[i])
+			== _location->cacheKeyHeaders.end()) {
+			pass = true;
+		}
+	}
+
+	const std::map<std::string, std::string>& headers = head.getHeaders();
+	for (std::map<std::string, std::string>::const_iterator it = headers.begin(); it != headers.end(); ++it) {
+		if (lowerCase(it->first).compare(0, 10, "set-cookie") == 0) {
+			pass = true;
+		}
+	}
+
+	head.setHeader("X-Cache-Status", _refresh ? "EXPIRED" : "MISS");
+
+	if (cacheable && (pass || ttl <= 0)) {
+		CacheEntry* marker = new CacheEntry();
+		marker->key = _key;
+		marker->pass = true;
+		marker->storedAt = now;
+		marker->expiresAt = now + ResponseCache::PASS_TIME;
+		marker->staleUntil = marker->expiresAt;
+		_zone->store(marker);
+		cacheable = false;
+	}
+	if (!cacheable || head.getBody().size() > _zone->config()->maxEntry) {
+		_state = PASSED;
+		_owner->release(this);
+		return;
+	}
+
+	_entry = new CacheEntry();
+	_entry->key = _key;
+	_entry->status = status;
+	for (std::map<std::string, std::string>::const_iterator it = headers.begin(); it != headers.end(); ++it) {
+		if (isStoredHeader(it->first)) {
+			_entry->headers[it->first] = it->second;
+		}
+	}
+	_entry->body = head.getBody();
+	_entry->storedAt = now;
+	_entry->expiresAt = now + ttl;
+	_entry->staleUntil = _entry->expiresAt + (stale > 0 ? stale : 0);
+}
+
+void CacheFill::tapBody(const char* data, size_t len) {
+	if (_state != COLLECTING) {
+		return;
+	}
+	if (_entry->body.size() + len > _zone->config()->maxEntry) {
+		DEBUG_LOG("[Cache] response larger than max_entry, not caching " << _key);
+		delete _entry;
+		_entry = NULL;
+		_state = PASSED;
+		_owner->release(this);
+		return;
+	}
+	_entry->body.append(data, len);
+}
+
+void CacheFill::tapEnd(bool complete) {
+	if (_state == COLLECTING && _entry != NULL && complete) {
+		CacheEntry* entry = _entry;
+		_entry = NULL;
+		_zone->store(entry);
+		_state = DONE;
+
+		// 기다리던 요청에 같은 응답
+		for (size_t i = 0; i < _waiters.size(); ++i) {
+			if (_waiters[i]->_client != NULL) {
+				_owner->serve(_waiters[i]->_client, *entry, "HIT");
+				_waiters[i]->_client = NULL;
+			}
+		}
+	} else if (_state == COLLECTING) {
+		_state = PASSED;
+		_owner->release(this);
+	}
+	_owner->finish(this);
+}
+
+// =========================================================================
+// ResponseCache
+// =========================================================================
+
+ResponseCache::ResponseCache(Server* server) : _server(server), _bypass(NULL) {}
+
+ResponseCache::~ResponseCache() {
+	for (std::map<std::string, CacheFill*>::iterator it = _fills.begin(); it != _fills.end(); ++it) {
+		delete it->second;
+	}
+	for (size_t i = 0; i < _finished.size(); ++i) {
+		delete _finished[i];
+	}
+	for (std::map<const CacheZoneDirective*, CacheZone*>::iterator it = _zones.begin(); it != _zones.end(); ++it) {
+		delete it->second;
+	}
+}
+
+CacheZone* ResponseCache::getZone(const CacheZoneDirective* config) {
+	std::map<const CacheZoneDirective*, CacheZone*>::iterator it = _zones.find(config);
+	if (it != _zones.end()) {
+		return it->second;
+	}
+	CacheZone* zone = new CacheZone(config);
+	_zones[config] = zone;
+	return zone;
+}
+
+std::string ResponseCache::buildKey(Client* client) const {
+	const HttpRequest* request = client->getRequest();
+	const CompiledLocation* location = client->getLocationContext()->compiled;
+
+	std::ostringstream key;
+	key << client->getPort() << " " << lowerCase(request->getHeader("host")) << request->getUri();
+	for (size_t i = 0; i < location->cacheKeyHeaders.size(); ++i) {
+		key << "\n" << location->cacheKeyHeaders[i] << ": " << request->getHeader(location->cacheKeyHeaders[i]);
+	}
+	return key.str();
+}
+
+ResponseCache::Result ResponseCache::lookup(Client* client) {
+	const CompiledLocation* location = client->getLocationContext()->compiled;
+	const HttpRequest* request = client->getRequest();
+	const std::string& method = request->getMethod();
+	CacheZone* zone = getZone(location->cacheZone);
+	CacheZone::Stats& stats = zone->stats();
+
+	if (client == _bypass) {
+		return PASS;
+	}
+	if ((method != "GET" && method != "HEAD") || !request->getHeader("authorization").empty()) {
+		++stats.bypass;
+		return PASS;
+	}
+
+	std::string key = buildKey(client);
+	std::string fillKey = zone->config()->name + " " + key;
+	std::map<std::string, CacheFill*>::iterator fill = _fills.find(fillKey);
+	CacheEntry* entry = zone->find(key);
+	time_t now = ::time(NULL);
+
+	if (entry != NULL && entry->pass && now < entry->expiresAt) {
+		++stats.bypass;
+		return PASS;
+	}
+	if (entry != NULL && !entry->pass && now < entry->expiresAt) {
+		++stats.hits;
+		serve(client, *entry, "HIT");
+		return HIT;
+	}
+	bool stale = (entry != NULL && !entry->pass && now < entry->staleUntil);
+	if (stale && fill != _fills.end()) {
+		++stats.stale;
+		serve(client, *entry, "UPDATING");
+		return HIT;
+	}
+
+	// 같은 키를 채우는 요청이 끝나면 그 응답을 받음
+	if (fill != _fills.end()) {
+		++stats.collapsed;
+		CacheWaiter* waiter = new CacheWaiter(client);
+		fill->second->_waiters.push_back(waiter);
+		client->attachAsync(waiter);
+		return WAIT;
+	}
+	if (method == "HEAD") {
+		++stats.bypass;
+		return PASS;
+	}
+
+	++stats.misses;
+	CacheFill* filler = new CacheFill(this, zone, location, key, stale);
+	_fills[fillKey] = filler;
+	client->setResponseTap(filler);
+	return FILL;
+}
+
+void ResponseCache::serve(Client* client, const CacheEntry& entry, const char* status) {
+	HttpResponse* response = new HttpResponse();
+	response->setStatus(entry.status);
+	for (std::map<std::string, std::string>::const_iterator it = entry.headers.begin();
+		 it != entry.headers.end(); ++it) {
+		response->setHeader(it->first, it->second);
+	}
+	response->setBody(entry.body);
+
+	std::ostringstream age;
+	age << (::time(NULL) - entry.storedAt);
+	response->setHeader("Age", age.str());
+	response->setHeader("X-Cache-Status", status);
+	client->completeAsync(response);
+}
+
+// 캐시할 수 없는 응답: 기다리던 요청은 각자 업스트림으로 보냄
+void ResponseCache::release(CacheFill* fill) {
+	std::map<std::string, CacheFill*>::iterator it = _fills.find(fill->_zone->config()->name + " " + fill->_key);
+	if (it != _fills.end() && it->second == fill) {
+		_fills.erase(it);
+	}
+
+	std::vector<CacheWaiter*> waiters;
+	waiters.swap(fill->_waiters);
+	for (size_t i = 0; i < waiters.size(); ++i) {
+		Client* client = waiters[i]->_client;
+		delete waiters[i];
+		if (client == NULL) {
+			continue;
+		}
+		client->attachAsync(NULL);
+		_bypass = client;
+		_server->processRequest(client);
+		_bypass = NULL;
+	}
+}
+
+void ResponseCache::finish(CacheFill* fill) {
+	std::map<std::string, CacheFill*>::iterator it = _fills.find(fill->_zone->config()->name + " " + fill->_key);
+	if (it != _fills.end() && it->second == fill) {
+		_fills.erase(it);
+	}
+	_finished.push_back(fill);
+}
+
+void ResponseCache::onTick() {
+	for (size_t i = 0; i < _finished.size(); ++i) {
+		delete _finished[i];
+	}
+	_finished.clear();
+
+	time_t now = ::time(NULL);
+	for (std::map<const CacheZoneDirective*, CacheZone*>::iterator it = _zones.begin(); it != _zones.end(); ++it) {
+		it->second->expire(now);
+	}
+}
+
+std::vector<CacheZone::Stats> ResponseCache::zoneStats() {
+	std::vector<CacheZone::Stats> stats;
+	for (std::map<const CacheZoneDirective*, CacheZone*>::iterator it = _zones.begin(); it != _zones.end(); ++it) {
+		stats.push_back(it->second->stats());
+	}
+	return stats;
+}
@@ -1,5 +1,8 @@
 #include "cgi/CgiExecutor.hpp"
+#include "cgi/ProcessSpawner.hpp"
 #include "http/HttpRequest.hpp"
+#include "config/CompiledLocation.hpp"
+#include "config/LocationCompiler.hpp"
 #include "utils/Common.hpp"
 #include <unistd.h>
 #include <sys/wait.h>
@@ -36,34 +39,45 @@ static std::string getDirectoryFromPath(const std::string& path) {
  * @param scriptPath CGI 스크립트 경로
  * @return 인터프리터 경로 (없으면 빈 문자열)
  */
-static std::string getInterpreter(const std::string& scriptPath, const LocationContext* locConf) {
-	// 확장자 추출
+std::string CgiExecutor::resolveInterpreter(const std::string& scriptPath, const LocationContext* locConf) {
+	const CompiledLocation* compiled = (locConf != NULL) ? locConf->compiled : NULL;
+
+	// 확장자 location은 컴파일 시 인터프리터가 확정됨
+	if (compiled != NULL && locConf->matchType == MATCH_EXTENSION) {
+		return compiled->interpreter;
+	}
+
+	// 확장자에 따라 인터프리터 매핑
 	size_t dotPos = scriptPath.find_last_of('.');
-	if (dotPos == std::string::npos) {
-		// 확장자 없음: cgi_pass 사용 가능하면 사용, 아니면 직접 실행
-		if (locConf != NULL && !locConf->opCgiPassDirective.empty()) {
-			return locConf->opCgiPassDirective[0].path;
+	if (dotPos != std::string::npos) {
+		std::string interpreter = LocationCompiler::interpreterForExtension(scriptPath.substr(dotPos));
+		if (!interpreter.empty()) {
+			return interpreter;
 		}
-		return ""; // 실행 파일로 간주
 	}
 
-	std::string ext = scriptPath.substr(dotPos);
-
-	// 확장자에 따라 인터프리터 매핑
-	if (ext == ".py") {
-		return "/usr/bin/python3";
-	} else if (ext == ".php") {
-		return "/usr/bin/php-cgi";
-	} else if (ext == ".sh") {
-		return "/bin/sh";
+	// 확장자 없음 또는 알 수 없는 확장자: cgi_pass 사용, 없으면 직접 실행으로 간주
+	if (compiled != NULL) {
+		return compiled->cgiPass;
 	}
+	return "";
+}
 
-	// 알 수 없는 확장자: cgi_pass 사용
-	if (locConf != NULL && !locConf->opCgiPassDirective.empty()) {
-		return locConf->opCgiPassDirective[0].path;
+bool CgiExecutor::canExecute(const std::string& scriptPath, const LocationContext* locConf) {
+	// ubuntu_cgi_tester는 파일이 없어도 stdin을 처리하고 200을 반환함
+	if (resolveInterpreter(scriptPath, locConf).find("ubuntu_cgi_tester") != std::string::npos) {
+		return true;
 	}
+	return access(scriptPath.c_str(), F_OK) == 0;
+}
 
-	return ""; // cgi_pass도 없으면 직접 실행으로 간주
+bool CgiExecutor::isNph(const std::string& scriptPath, const LocationContext* locConf) {
+	if (locConf != NULL && locConf->compiled != NULL && locConf->compiled->cgiNph) {
+		return true;
+	}
+	size_t slash = scriptPath.find_last_of('/');
+	size_t nameStart = (slash == std::string::npos) ? 0 : slash + 1;
+	return scriptPath.compare(nameStart, 4, "nph-") == 0;
 }
 
 /**
@@ -113,6 +127,19 @@ CgiExecutor::~CgiExecutor() {
 }
 
 void CgiExecutor::setupEnvironment() {
+	std::vector<std::string> envList = buildEnvironment(_request, _cgiPath, _serverConf, _locConf);
+
+	// vector를 char** 배열로 변환
+	_envp = new char*[envList.size() + 1];
+	for (size_t i = 0; i < envList.size(); ++i) {
+		_envp[i] = stringDup(envList[i]);
+	}
+	_envp[envList.size()] = NULL; // NULL 종료
+}
+
+std::vector<std::string> CgiExecutor::buildEnvironment(const HttpRequest* request, const std::string& cgiPath,
+													   const ServerContext* serverConf,
+													   const LocationContext* locConf) {
 	std::vector<std::string> envList;
 
 	// 0. REDIRECT_STATUS (required for PHP-CGI security)
@@ -123,10 +150,10 @@ void CgiExecutor::setupEnvironment() {
 	envList.push_back("SERVER_PROTOCOL=HTTP/1.1");
 
 	// 2. REQUEST_METHOD
-	envList.push_back("REQUEST_METHOD=" + _request->getMethod());
+	envList.push_back("REQUEST_METHOD=" + request->getMethod());
 
 	// 3. QUERY_STRING
-	std::string uri = _request->getUri();
+	std::string uri = request->getUri();
 	size_t qPos = uri.find('?');
 	if (qPos != std::string::npos) {
 		envList.push_back("QUERY_STRING=" + uri.substr(qPos + 1));
@@ -135,7 +162,9 @@ void CgiExecutor::setupEnvironment() {
 	}
 
     // 4. CONTENT_LENGTH (Zero-Copy 지원)
-    size_t contentLength = _request->getBodyLength();  // getBody() → getBodyLength()
+    // 바디를 스트리밍하는 요청은 아직 바디가 없으므로 Content-Length 헤더 값을 씀
+    size_t contentLength = request->isChunkedEncoding() ? request->getBodyLength()
+                                                        : request->getContentLength();
     DEBUG_LOG("[CgiExecutor] Setting CONTENT_LENGTH=" << contentLength);
     
     std::stringstream ss;
@@ -143,7 +172,7 @@ void CgiExecutor::setupEnvironment() {
     envList.push_back("CONTENT_LENGTH=" + ss.str());
 
 	// 5. CONTENT_TYPE
-	std::string contentType = _request->getHeader("Content-Type");
+	std::string contentType = request->getHeader("Content-Type");
 	if (!contentType.empty()) {
 		envList.push_back("CONTENT_TYPE=" + contentType);
 	} else {
@@ -151,25 +180,32 @@ void CgiExecutor::setupEnvironment() {
 	}
 
 	// 6. SERVER_NAME
-	if (!_serverConf->opServerNameDirective.empty()) {
-		envList.push_back("SERVER_NAME=" + _serverConf->opServerNameDirective[0].name);
+	if (!serverConf->opServerNameDirective.empty()) {
+		envList.push_back("SERVER_NAME=" + serverConf->opServerNameDirective[0].name);
 	} else {
 		envList.push_back("SERVER_NAME=localhost");
 	}
 
 	// 7. SERVER_PORT
-	if (!_serverConf->opListenDirective.empty()) {
+	if (!serverConf->opListenDirective.empty()) {
 		std::stringstream portSs;
-		portSs << _serverConf->opListenDirective[0].port;
+		portSs << serverConf->opListenDirective[0].port;
 		envList.push_back("SERVER_PORT=" + portSs.str());
 	} else {
 		envList.push_back("SERVER_PORT=80");
 	}
 
+	// 8. REQUEST_SCHEME, HTTPS (listen ... ssl)
+	bool https = !serverConf->opListenDirective.empty() && serverConf->opListenDirective[0].ssl;
+	envList.push_back(std::string("REQUEST_SCHEME=") + (https ? "https" : "http"));
+	if (https) {
+		envList.push_back("HTTPS=on");
+	}
+
 	// 파일명 추출
-	size_t lastSlash = _cgiPath.find_last_of('/');
+	size_t lastSlash = cgiPath.find_last_of('/');
 	std::string fileName = (lastSlash != std::string::npos) ?
-		_cgiPath.substr(lastSlash + 1) : _cgiPath;
+		cgiPath.substr(lastSlash + 1) : cgiPath;
 
 	// 파일명의 끝이 .php인지 확인 (경로에 .php가 포함되어 있어도 무시)
 	bool isPhpCgi = (fileName.length() >= 4 &&
@@ -182,24 +218,22 @@ void CgiExecutor::setupEnvironment() {
 			scriptName = scriptName.substr(0, scriptQPos);
 		}
 		envList.push_back("SCRIPT_NAME=" + scriptName);
-		envList.push_back("SCRIPT_FILENAME=" + _cgiPath);
+		envList.push_back("SCRIPT_FILENAME=" + cgiPath);
 	}
 
-	if (!_locConf->opRootDirective.empty()) {
-		envList.push_back("DOCUMENT_ROOT=" + _locConf->opRootDirective[0].path);
-	} else if (!_serverConf->opRootDirective.empty()) {
-		envList.push_back("DOCUMENT_ROOT=" + _serverConf->opRootDirective[0].path);
+	if (locConf->compiled != NULL && !locConf->compiled->documentRoot.empty()) {
+		envList.push_back("DOCUMENT_ROOT=" + locConf->compiled->documentRoot);
 	}
 
 	// 9. PATH_INFO (location type에 따라 다르게 처리)
 	std::string pathInfo;
 
-	if (_locConf->matchType == MATCH_EXTENSION) {
+	if (locConf->matchType == MATCH_EXTENSION) {
 		// Extension location: PATH_INFO = root + filename
 		// 예: URI=/directory/youpi.bla, root=/home/.../YoupiBanane -> PATH_INFO=/home/.../YoupiBanane/youpi.bla
-		if (!_locConf->opRootDirective.empty()) {
+		if (!locConf->opRootDirective.empty()) {
 			std::string fileName = uri.substr(uri.find_last_of('/'));
-			pathInfo = _locConf->opRootDirective[0].path + fileName;
+			pathInfo = locConf->opRootDirective[0].path + fileName;
 
 			// QUERY_STRING 제거
 			size_t queryPos = pathInfo.find('?');
@@ -207,11 +241,11 @@ void CgiExecutor::setupEnvironment() {
 				pathInfo = pathInfo.substr(0, queryPos);
 			}
 		}
-	} else if (_locConf->matchType == MATCH_PREFIX) {
+	} else if (locConf->matchType == MATCH_PREFIX) {
 		// Prefix location: 표준 CGI PATH_INFO (URI에서 location path 제거)
 		// 예: URI=/cgi-bin/script.py/extra, location=/cgi-bin/ -> PATH_INFO=script.py/extra
-		if (uri.find(_locConf->path) == 0) {
-			pathInfo = uri.substr(_locConf->path.length());
+		if (uri.find(locConf->path) == 0) {
+			pathInfo = uri.substr(locConf->path.length());
 
 			// QUERY_STRING 제거
 			size_t queryPos = pathInfo.find('?');
@@ -223,8 +257,16 @@ void CgiExecutor::setupEnvironment() {
 
 	envList.push_back("PATH_INFO=" + pathInfo);
 
+	// REQUEST_DEADLINE_MS: 바디를 다 받은 뒤 서버가 응답을 기다리는 남은 시간 (cgi_timeout).
+	// 스크립트는 이 시간을 넘기기 전에 스스로 중단할 수 있음
+	if (locConf->compiled != NULL) {
+		std::stringstream deadline;
+		deadline << locConf->compiled->cgiTimeout * 1000;
+		envList.push_back("REQUEST_DEADLINE_MS=" + deadline.str());
+	}
+
 	// 10. All HTTP headers to HTTP_* environment variables (RFC 3875)
-	const std::map<std::string, std::string>& headers = _request->getHeaders();
+	const std::map<std::string, std::string>& headers = request->getHeaders();
 	for (std::map<std::string, std::string>::const_iterator it = headers.begin();
 	     it != headers.end(); ++it) {
 		const std::string& headerName = it->first;
@@ -254,12 +296,7 @@ void CgiExecutor::setupEnvironment() {
 	}
 	DEBUG_LOG('\n');
 
-	// vector를 char** 배열로 변환
-	_envp = new char*[envList.size() + 1];
-	for (size_t i = 0; i < envList.size(); ++i) {
-		_envp[i] = stringDup(envList[i]);
-	}
-	_envp[envList.size()] = NULL; // NULL 종료
+	return envList;
 }
 
 void CgiExecutor::clearEnvironment() {
@@ -275,18 +312,12 @@ void CgiExecutor::clearEnvironment() {
 // src/cgi/CgiExecutor.cpp (execute 메서드만 수정)
 // CgiExecutor.cpp - execute() 수정
 std::string CgiExecutor::execute() {
-    std::string interpreter = getInterpreter(_cgiPath, _locConf);
+    std::string interpreter = resolveInterpreter(_cgiPath, _locConf);
 
-    // ubuntu_cgi_tester는 파일이 없어도 정상 응답 반환
     // python3, php-cgi 등 일반 인터프리터는 파일이 없으면 실행 실패
-    bool isUbuntuCgiTester = (interpreter.find("ubuntu_cgi_tester") != std::string::npos);
-
-    if (!isUbuntuCgiTester) {
-        // 파일 존재 확인 (ubuntu_cgi_tester 제외)
-        if (access(_cgiPath.c_str(), F_OK) == -1) {
-            DEBUG_LOG("[CgiExecutor] CGI script not found: " << _cgiPath);
-            return "CGI_NOT_FOUND";
-        }
+    if (!canExecute(_cgiPath, _locConf)) {
+        DEBUG_LOG("[CgiExecutor] CGI script not found: " << _cgiPath);
+        return "CGI_NOT_FOUND";
     }
 
     // Pipe 생성
@@ -326,9 +357,28 @@ std::string CgiExecutor::execute() {
         lseek(tmpBodyFd, 0, SEEK_SET);
     }
     
-    // Fork
-    pid_t pid = fork();
+    // argv는 실행 전에 모두 준비 (자식에서 할당하지 않음)
+    char* argv[3];
+    if (!interpreter.empty()) {
+        argv[0] = const_cast<char*>(interpreter.c_str());
+        argv[1] = const_cast<char*>(_cgiPath.c_str());
+        argv[2] = NULL;
+    } else {
+        argv[0] = const_cast<char*>(_cgiPath.c_str());
+        argv[1] = NULL;
+    }
+    const std::string& program = interpreter.empty() ? _cgiPath : interpreter;
+
+    // Spawn: body 임시 파일(없으면 /dev/null)을 stdin, 파이프를 stdout/stderr로 연결하고
+    // 스크립트 디렉토리에서 실행 (fork와 달리 서버 RSS에 비례한 복사 비용이 없음)
+    ProcessSpawner::Stdio stdio;
+    stdio.in = tmpBodyFd;
+    stdio.out = pipeStdout[1];
+    stdio.err = pipeStderr[1];
+
+    pid_t pid = ProcessSpawner::spawn(program.c_str(), argv, _envp, stdio, getDirectoryFromPath(_cgiPath));
     if (pid == -1) {
+        ERROR_LOG("[CgiExecutor] Failed to spawn " << program << ": " << std::strerror(errno));
         if (tmpBodyFd != -1) {
             close(tmpBodyFd);
             unlink(tmpBodyPath);
@@ -339,49 +389,6 @@ std::string CgiExecutor::execute() {
         return "";
     }
     
-    if (pid == 0) {
-        // ========== 자식 프로세스 ==========
-        
-        // 임시 파일을 stdin으로 리다이렉트
-        if (tmpBodyFd != -1) {
-            dup2(tmpBodyFd, STDIN_FILENO);
-            close(tmpBodyFd);
-        } else {
-            // Body 없으면 /dev/null
-            int devnull = open("/dev/null", O_RDONLY);
-            dup2(devnull, STDIN_FILENO);
-            close(devnull);
-        }
-        
-        // Stdout, Stderr 리다이렉트
-        dup2(pipeStdout[1], STDOUT_FILENO);
-        dup2(pipeStderr[1], STDERR_FILENO);
-        
-        close(pipeStdin[0]); close(pipeStdin[1]);
-        close(pipeStdout[0]); close(pipeStdout[1]);
-        close(pipeStderr[0]); close(pipeStderr[1]);
-        
-        // Working directory 변경
-        std::string scriptDir = getDirectoryFromPath(_cgiPath);
-        chdir(scriptDir.c_str());
-
-        // Execve
-        char* argv[3];
-
-        if (!interpreter.empty()) {
-            argv[0] = stringDup(interpreter);
-            argv[1] = stringDup(_cgiPath);
-            argv[2] = NULL;
-            execve(interpreter.c_str(), argv, _envp);
-        } else {
-            argv[0] = stringDup(_cgiPath);
-            argv[1] = NULL;
-            execve(_cgiPath.c_str(), argv, _envp);
-        }
-
-        exit(1);
-    }
-    
     // ========== 부모 프로세스 ==========
     
     // 임시 파일 정리 (자식이 이미 열었으므로 부모는 닫아도 됨)
@@ -409,14 +416,15 @@ std::string CgiExecutor::execute() {
 
     // CGI 타임아웃 설정
     time_t startTime = time(NULL);
+    time_t timeout = (_locConf->compiled != NULL) ? static_cast<time_t>(_locConf->compiled->cgiTimeout) : CGI_TIMEOUT;
     bool timedOut = false;
 
     // Stdout/Stderr만 읽기 (stdin write 필요 없음!)
     while (stdoutFd != -1 || stderrFd != -1) {
         // 누적 시간 체크
         time_t elapsed = time(NULL) - startTime;
-        if (elapsed > CGI_TIMEOUT) {
-            DEBUG_LOG("[CgiExecutor] CGI timeout exceeded (" << elapsed << "s > " << CGI_TIMEOUT << "s)");
+        if (elapsed > timeout) {
+            DEBUG_LOG("[CgiExecutor] CGI timeout exceeded (" << elapsed << "s > " << timeout << "s)");
             timedOut = true;
             break;
         }
@@ -10,27 +10,34 @@ HttpResponse* CgiResponseParser::parse(const std::string& cgiOutput) {
 	}
 
 	// 1. Separate headers and body (\r\n\r\n or \n\n)
-	size_t headerEndPos = cgiOutput.find("\r\n\r\n");
-	std::string headerDelim = "\r\n";
+	size_t delimLength;
+	size_t headerEndPos = findHeaderEnd(cgiOutput, delimLength);
+	if (headerEndPos == std::string::npos) {
+		// No header delimiter found -> parsing failure
+		return NULL;
+	}
+
+	// 2. Create HttpResponse object from headers, then attach body
+	HttpResponse* response = parseHead(cgiOutput.substr(0, headerEndPos));
+	response->setBody(cgiOutput.substr(headerEndPos + delimLength));
+	return response;
+}
 
+size_t CgiResponseParser::findHeaderEnd(const std::string& cgiOutput, size_t& delimLength) {
+	delimLength = 4;
+	size_t headerEndPos = cgiOutput.find("\r\n\r\n");
 	if (headerEndPos == std::string::npos) {
 		// If \r\n\r\n not found, try \n\n
+		delimLength = 2;
 		headerEndPos = cgiOutput.find("\n\n");
-		headerDelim = "\n";
-
-		if (headerEndPos == std::string::npos) {
-			// No header delimiter found -> parsing failure
-			return NULL;
-		}
 	}
+	return headerEndPos;
+}
 
-	std::string headersPart = cgiOutput.substr(0, headerEndPos);
-	std::string bodyPart = cgiOutput.substr(headerEndPos + headerDelim.length() * 2);
-
-	// 2. Create HttpResponse object
+HttpResponse* CgiResponseParser::parseHead(const std::string& headersPart) {
 	HttpResponse* response = new HttpResponse();
 
-	// 3. Parse headers line by line
+	// Parse headers line by line
 	std::istringstream headerStream(headersPart);
 	std::string line;
 	int statusCode = StatusCode::OK; // Default value
@@ -58,15 +65,17 @@ HttpResponse* CgiResponseParser::parse(const std::string& cgiOutput) {
 			// Status: 200 OK format
 			std::istringstream statusStream(value);
 			statusStream >> statusCode;
+		} else if (name == "Content-Length" || name == "content-length") {
+			// Streaming decides between identity and chunked by this header
+			response->setHeader("Content-Length", value);
 		} else {
 			// Add other headers as-is
 			response->setHeader(name, value);
 		}
 	}
 
-	// 4. Configure HttpResponse
+	// Configure HttpResponse
 	response->setStatus(statusCode);
-	response->setBody(bodyPart);
 
 	// Set Content-Type if present
 	if (!contentType.empty()) {
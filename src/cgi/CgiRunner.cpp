@@ -0,0 +1,913 @@
+#include "cgi/CgiRunner.hpp"
+#include "cgi/CgiExecutor.hpp"
+#include "cgi/CgiResponse.hpp"
+#include "cgi/ProcessSpawner.hpp"
+#include "server/EventLoop.hpp"
+#include "server/Client.hpp"
+#include "http/HttpRequest.hpp"
+#include "http/HttpResponse.hpp"
+#include "http/StatusCode.hpp"
+#include "config/CompiledLocation.hpp"
+#include "metrics/Metrics.hpp"
+#include <sys/wait.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <signal.h>
+
+const size_t CgiProcess::STDIN_HIGH_WATERMARK = 1024 * 1024;
+const size_t CgiProcess::MAX_HEAD_SIZE = 64 * 1024;
+const size_t CgiRunner::DEFAULT_QUEUE_SIZE = 64;
+const size_t CgiRunner::DEFAULT_QUEUE_TIMEOUT = 10;
+
+// stdin 파이프 용량 (기본 64KB보다 크게 잡아 업로드 중 왕복 횟수를 줄임)
+static const int STDIN_PIPE_SIZE = 1024 * 1024;
+
+// nph relay: splice 한 번에 옮길 최대 바이트, 이벤트 하나에서 반복할 횟수
+static const size_t RELAY_CHUNK = 1024 * 1024;
+static const int RELAY_ROUNDS = 16;
+
+// 대기열 통계 로그 간격 (초). 그 사이 변화가 없으면 남기지 않음
+static const time_t QUEUE_STATS_INTERVAL = 60;
+
+static double monotonicMs() {
+	struct timespec ts;
+	::clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// =========================================================================
+// CgiProcess
+// =========================================================================
+
+CgiProcess::CgiProcess(CgiRunner* owner, Client* client, const ServerContext* serverConf,
+					   const LocationContext* locConf, const std::string& scriptPath)
+	: _owner(owner), _client(client), _serverConf(serverConf), _locConf(locConf),
+	  _scriptPath(scriptPath), _pid(-1), _limit(NULL), _probe(false), _stdinFd(-1), _stdoutFd(-1), _stderrFd(-1),
+	  _pidFd(-1), _reaped(false), _exitStatus(0),
+	  _stdinOffset(0), _inputEnded(false), _inputEndedAt(0),
+	  _streamOutput(false), _nph(false), _headSent(false), _outputPaused(false), _lastOutputAt(0), _finished(false) {}
+
+CgiProcess::~CgiProcess() {}
+
+void CgiProcess::abort() {
+	_client = NULL;
+	_owner->release(this);
+}
+
+bool CgiProcess::writeBody(const char* data, size_t len) {
+	// 스크립트가 stdin을 닫았으면 남은 바디는 버림 (응답은 바디를 다 받은 뒤 보냄)
+	if (_stdinFd == -1) {
+		return true;
+	}
+
+	size_t written = 0;
+	if (_stdinOffset == _stdinBuffer.size()) {
+		while (written < len) {
+			ssize_t n = ::write(_stdinFd, data + written, len - written);
+			if (n > 0) {
+				written += n;
+				continue;
+			}
+			if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+				break;
+			}
+			closeStdin();
+			return true;
+		}
+	}
+
+	if (written < len) {
+		_stdinBuffer.append(data + written, len - written);
+		_owner->_event_loop->modifyHandler(_stdinFd, EPOLLOUT);
+	}
+	return _stdinBuffer.size() - _stdinOffset < STDIN_HIGH_WATERMARK;
+}
+
+int CgiProcess::bodyPipe() const {
+	return (_stdinFd != -1 && _stdinOffset == _stdinBuffer.size()) ? _stdinFd : -1;
+}
+
+void CgiProcess::waitBodyWritable() {
+	if (_stdinFd != -1) {
+		_owner->_event_loop->modifyHandler(_stdinFd, EPOLLOUT);
+	}
+}
+
+void CgiProcess::endBody() {
+	_inputEnded = true;
+	_inputEndedAt = ::time(NULL);
+	if (_stdinOffset == _stdinBuffer.size()) {
+		closeStdin();
+	}
+	tryStartResponse();
+	if (!_finished) {
+		tryComplete();
+	}
+}
+
+void CgiProcess::resumeOutput() {
+	_lastOutputAt = ::time(NULL);
+	if (_outputPaused && _stdoutFd != -1) {
+		_owner->_event_loop->modifyHandler(_stdoutFd, EPOLLIN);
+	}
+	_outputPaused = false;
+
+	// nph: 소켓이 다시 쓰기 가능해짐. 바디를 받는 동안 읽어 둔 출력이 남았을 수 있음
+	if (_nph && !_finished) {
+		relayOutput();
+		if (!_finished) {
+			tryComplete();
+		}
+	}
+}
+
+// 버퍼에 남은 바디를 파이프로 보냄. 스크립트가 stdin을 닫았으면 false
+bool CgiProcess::flushStdin() {
+	while (_stdinOffset < _stdinBuffer.size()) {
+		ssize_t n = ::write(_stdinFd, _stdinBuffer.data() + _stdinOffset, _stdinBuffer.size() - _stdinOffset);
+		if (n > 0) {
+			_stdinOffset += n;
+			continue;
+		}
+		if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			return true;
+		}
+		closeStdin();
+		return false;
+	}
+
+	_stdinBuffer.clear();
+	_stdinOffset = 0;
+	return true;
+}
+
+void CgiProcess::closeStdin() {
+	if (_stdinFd != -1) {
+		_owner->_event_loop->remove(_stdinFd);
+		::close(_stdinFd);
+		_stdinFd = -1;
+	}
+	std::string().swap(_stdinBuffer);
+	_stdinOffset = 0;
+}
+
+void CgiProcess::closeOutput(int& fd) {
+	if (fd != -1) {
+		_owner->_event_loop->remove(fd);
+		::close(fd);
+		fd = -1;
+	}
+}
+
+// 파이프에 쌓인 출력을 읽음 (limit을 넘으면 다음 이벤트로 미룸). EOF 또는 오류면 false
+bool CgiProcess::readOutput(int fd, std::string& out, size_t limit) {
+	char buffer[BUFFER_SIZE];
+
+	while (out.size() < limit) {
+		ssize_t n = ::read(fd, buffer, sizeof(buffer));
+		if (n > 0) {
+			out.append(buffer, n);
+			continue;
+		}
+		if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			return true;
+		}
+		return false;
+	}
+	return true;
+}
+
+// 바디를 다 받았고 헤더 블록이 끝났으면 응답 헤더를 먼저 보냄
+void CgiProcess::tryStartResponse() {
+	if (_headSent || !_inputEnded || _client == NULL) {
+		return;
+	}
+	if (_nph) {
+		if (!_stdout.empty()) {
+			startRelay();
+		}
+		return;
+	}
+	if (!_streamOutput) {
+		return;
+	}
+
+	size_t delimLength;
+	size_t headerEnd = CgiResponseParser::findHeaderEnd(_stdout, delimLength);
+	if (headerEnd == std::string::npos) {
+		if (_stdout.size() > MAX_HEAD_SIZE) {
+			ERROR_LOG("[CgiRunner] CGI header block too large from: " << _scriptPath);
+			_owner->finish(this, StatusCode::BAD_GATEWAY);
+		}
+		return;
+	}
+
+	CgiResponseParser parser;
+	HttpResponse* head = parser.parseHead(_stdout.substr(0, headerEnd));
+	_stdout.erase(0, headerEnd + delimLength);
+	_headSent = true;
+	_lastOutputAt = ::time(NULL);
+	_client->startResponseStream(head, this);
+	forwardOutput();
+}
+
+// 읽은 출력을 Client에 넘기고, Client 버퍼가 차면 stdout 읽기를 멈춤
+void CgiProcess::forwardOutput() {
+	if (_stdout.empty() || _client == NULL) {
+		return;
+	}
+
+	bool more = _client->appendResponseBody(_stdout.data(), _stdout.size());
+	_stdout.clear();
+	_lastOutputAt = ::time(NULL);
+	if (!more && !_outputPaused && _stdoutFd != -1) {
+		_outputPaused = true;
+		_owner->_event_loop->modifyHandler(_stdoutFd, 0);
+	}
+}
+
+// nph: 첫 출력이 나오면 Client를 relay 모드로 바꾸고 소켓에 직접 씀
+void CgiProcess::startRelay() {
+	_headSent = true;
+	_lastOutputAt = ::time(NULL);
+	_client->startResponseRelay(this);
+	relayOutput();
+}
+
+// stdout 파이프 -> 클라이언트 소켓 (커널 안에서 복사). 소켓이 차면 쓰기 가능을 기다림
+void CgiProcess::relayOutput() {
+	if (!_client->canWriteSocketDirectly()) {
+		relayEncrypted();
+		return;
+	}
+
+	int sock = _client->getFd();
+	bool moved = false;
+
+	// 바디를 받는 동안 읽어 둔 출력은 먼저 send로 보냄
+	while (!_stdout.empty()) {
+		ssize_t n = _client->writeSocket(_stdout.data(), _stdout.size());
+		if (n > 0) {
+			_stdout.erase(0, n);
+			moved = true;
+			continue;
+		}
+		if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			break;
+		}
+		_owner->finish(this, StatusCode::BAD_GATEWAY);
+		return;
+	}
+
+	for (int round = 0; _stdout.empty() && _stdoutFd != -1 && round < RELAY_ROUNDS; ++round) {
+		ssize_t n = ::splice(_stdoutFd, NULL, sock, NULL, RELAY_CHUNK, SPLICE_F_NONBLOCK | SPLICE_F_MOVE);
+		if (n > 0) {
+			_client->addBytesSent(n);
+			moved = true;
+			continue;
+		}
+		if (n == 0) {
+			closeOutput(_stdoutFd);  // 스크립트 출력 끝
+			break;
+		}
+		if (errno == EAGAIN || errno == EWOULDBLOCK) {
+			// 파이프가 비었으면 다음 EPOLLIN을, 데이터가 남았으면 소켓이 찬 것이므로 EPOLLOUT을 기다림
+			int pending = 0;
+			if (::ioctl(_stdoutFd, FIONREAD, &pending) == -1 || pending == 0) {
+				break;
+			}
+		} else {
+			_owner->finish(this, StatusCode::BAD_GATEWAY);
+			return;
+		}
+		_outputPaused = true;
+		_owner->_event_loop->modifyHandler(_stdoutFd, 0);
+		_client->waitRelayWritable();
+		break;
+	}
+
+	if (!_stdout.empty() && !_outputPaused) {
+		_outputPaused = true;
+		if (_stdoutFd != -1) {
+			_owner->_event_loop->modifyHandler(_stdoutFd, 0);
+		}
+		_client->waitRelayWritable();
+	}
+	if (moved) {
+		_lastOutputAt = ::time(NULL);
+		_client->updateActivity();
+	}
+}
+
+// TLS (kTLS 없음): 소켓에 직접 쓸 수 없으므로 파이프에서 읽어 암호화해서 보냄
+void CgiProcess::relayEncrypted() {
+	bool moved = false;
+
+	for (int round = 0; round < RELAY_ROUNDS; ++round) {
+		if (_stdout.empty()) {
+			if (_stdoutFd == -1) {
+				break;
+			}
+			char buffer[BUFFER_SIZE];
+			ssize_t n = ::read(_stdoutFd, buffer, sizeof(buffer));
+			if (n == 0) {
+				closeOutput(_stdoutFd);  // 스크립트 출력 끝
+				break;
+			}
+			if (n < 0) {
+				if (errno == EAGAIN || errno == EWOULDBLOCK) {
+					break;
+				}
+				_owner->finish(this, StatusCode::BAD_GATEWAY);
+				return;
+			}
+			_stdout.assign(buffer, n);
+		}
+
+		// 레코드가 일부만 나갔으면 다음에 같은 데이터로 이어 써야 하므로 _stdout에 남겨 둠
+		ssize_t n = _client->writeSocket(_stdout.data(), _stdout.size());
+		if (n > 0) {
+			_stdout.erase(0, n);
+			moved = true;
+			continue;
+		}
+		if (n < 0 && errno == EAGAIN) {
+			break;
+		}
+		_owner->finish(this, StatusCode::BAD_GATEWAY);
+		return;
+	}
+
+	if (!_stdout.empty() && !_outputPaused) {
+		_outputPaused = true;
+		if (_stdoutFd != -1) {
+			_owner->_event_loop->modifyHandler(_stdoutFd, 0);
+		}
+		_client->waitRelayWritable();
+	}
+	if (moved) {
+		_lastOutputAt = ::time(NULL);
+		_client->updateActivity();
+	}
+}
+
+// 출력이 모두 닫히고 바디도 다 받았고 스크립트가 종료했으면 응답 생성
+void CgiProcess::tryComplete() {
+	if (_finished || !_inputEnded || _stdoutFd != -1 || _stderrFd != -1) {
+		return;
+	}
+	// nph는 바디를 받는 동안 읽어 둔 출력까지 다 보낸 뒤 종료
+	if (_nph && _headSent && !_stdout.empty()) {
+		return;
+	}
+	if (!reap()) {
+		return;
+	}
+
+	// 보내던 응답은 끝까지 나왔는지 알 수 없으므로 끊음. 다 모은 출력은 시그널로 죽었을 때만 버림
+	int statusCode = StatusCode::OK;
+	if (WIFSIGNALED(_exitStatus)) {
+		ERROR_LOG("[CgiRunner] " << _scriptPath << " killed by signal " << WTERMSIG(_exitStatus));
+		statusCode = StatusCode::BAD_GATEWAY;
+	} else if (!exitedCleanly()) {
+		ERROR_LOG("[CgiRunner] " << _scriptPath << " exited with status " << WEXITSTATUS(_exitStatus));
+		if (_headSent) {
+			statusCode = StatusCode::BAD_GATEWAY;
+		}
+	}
+	_owner->finish(this, statusCode);
+}
+
+// 종료 상태를 거둠. 출력을 닫고도 아직 살아 있으면 pidfd로 종료를 기다리고 false
+bool CgiProcess::reap() {
+	if (_reaped) {
+		return true;
+	}
+	pid_t result = ::waitpid(_pid, &_exitStatus, WNOHANG);
+	if (result == _pid || result == -1) {
+		if (result == -1) {
+			_exitStatus = 0;	// 이미 거둬짐: 결과를 알 수 없으므로 정상으로 봄
+		}
+		_reaped = true;
+		_pid = -1;
+		closeOutput(_pidFd);
+		return true;
+	}
+#ifdef SYS_pidfd_open
+	if (_pidFd == -1) {
+		int fd = static_cast<int>(::syscall(SYS_pidfd_open, _pid, 0));
+		if (fd != -1 && !_owner->_event_loop->addHandler(fd, EPOLLIN, this)) {
+			::close(fd);
+			fd = -1;
+		}
+		_pidFd = fd;
+	}
+#endif
+	return false;
+}
+
+bool CgiProcess::exitedCleanly() const {
+	return _reaped && WIFEXITED(_exitStatus) && WEXITSTATUS(_exitStatus) == 0;
+}
+
+void CgiProcess::onIoEvent(int fd, uint32_t events) {
+	if (_finished) {
+		return;
+	}
+
+	if (fd == _stdinFd) {
+		if (events & EPOLLERR) {
+			closeStdin();  // 스크립트가 stdin을 닫고 종료함
+		} else if (flushStdin() && _stdinOffset == _stdinBuffer.size()) {
+			if (_inputEnded) {
+				closeStdin();
+			} else {
+				_owner->_event_loop->modifyHandler(_stdinFd, 0);
+			}
+		}
+
+		// 버퍼가 비었거나 stdin이 닫혔으면 멈춰 둔 Client 소켓 읽기를 재개
+		if (!_inputEnded && _client != NULL && (_stdinFd == -1 || _stdinOffset == _stdinBuffer.size())) {
+			_client->resumeBody();
+		}
+	} else if (fd == _stdoutFd && _nph && _inputEnded) {
+		if (_headSent) {
+			relayOutput();
+		} else {
+			startRelay();
+		}
+	} else if (fd == _stdoutFd) {
+		// 헤더를 보낸 뒤에는 한 번에 한 버퍼씩만 읽어 Client backpressure가 걸리게 함
+		bool open = readOutput(fd, _stdout, _headSent ? BUFFER_SIZE : std::string::npos);
+		if (_headSent) {
+			forwardOutput();
+		} else {
+			tryStartResponse();
+		}
+		if (!open && !_finished) {
+			closeOutput(_stdoutFd);
+		}
+	} else if (fd == _stderrFd) {
+		if (!readOutput(fd, _stderr, std::string::npos)) {
+			closeOutput(_stderrFd);
+		}
+	}
+
+	if (!_finished) {
+		tryComplete();
+	}
+}
+
+// =========================================================================
+// QueuedCgi
+// =========================================================================
+
+QueuedCgi::QueuedCgi(CgiRunner* owner, Client* client, const std::string& scriptPath, bool streamBody,
+					 bool probe, const CompiledLocation* location, double enqueuedAt)
+	: _owner(owner), _client(client), _scriptPath(scriptPath), _streamBody(streamBody), _probe(probe),
+	  _location(location), _enqueuedAt(enqueuedAt) {}
+
+void QueuedCgi::abort() {
+	_owner->cancel(this);
+}
+
+// =========================================================================
+// CgiRunner
+// =========================================================================
+
+CgiRunner::CgiRunner(EventLoop* eventLoop) : _event_loop(eventLoop), _statsLoggedAt(::time(NULL)) {}
+
+CgiRunner::~CgiRunner() {
+	// 대기 중인 요청을 먼저 비워 release가 대기열을 실행하지 않게 함
+	for (std::map<const CompiledLocation*, Limit>::iterator it = _limits.begin(); it != _limits.end(); ++it) {
+		for (size_t i = 0; i < it->second.waiting.size(); ++i) {
+			delete it->second.waiting[i];
+		}
+		it->second.waiting.clear();
+	}
+	while (!_running.empty()) {
+		_running.back()->_client = NULL;
+		release(_running.back());
+	}
+	for (size_t i = 0; i < _finished.size(); ++i) {
+		delete _finished[i];
+	}
+	for (size_t i = 0; i < _exited.size(); ++i) {
+		::waitpid(_exited[i], NULL, 0);
+	}
+}
+
+static std::string scriptDirectory(const std::string& scriptPath) {
+	size_t slash = scriptPath.find_last_of('/');
+	if (slash == std::string::npos) {
+		return ".";
+	}
+	return slash == 0 ? "/" : scriptPath.substr(0, slash);
+}
+
+bool CgiRunner::submit(Client* client, const std::string& scriptPath, bool streamBody) {
+	const LocationContext* locConf = client->getLocationContext();
+	const CompiledLocation* location = locConf->compiled;
+
+	bool probe = false;
+	if (location->cgiBreakerPercent > 0) {
+		time_t retryAfter = 0;
+		CircuitBreaker::Decision decision = _breaker.admit(scriptPath, ::time(NULL), retryAfter);
+		if (decision == CircuitBreaker::REJECT) {
+			DEBUG_LOG("[CgiRunner] circuit open, rejecting " << scriptPath);
+			respondUnavailable(client, retryAfter);
+			return true;
+		}
+		probe = (decision == CircuitBreaker::PROBE);
+	}
+
+	if (location->cgiMaxConcurrent == 0) {
+		return launch(client, scriptPath, streamBody, probe, NULL);
+	}
+
+	Limit& limit = limitFor(locConf);
+	if (limit.stats.running < location->cgiMaxConcurrent && limit.waiting.empty()) {
+		return launch(client, scriptPath, streamBody, probe, location);
+	}
+
+	if (limit.waiting.size() >= location->cgiQueueSize) {
+		++limit.stats.rejected;
+		DEBUG_LOG("[CgiRunner] " << locConf->path << " queue full, rejecting " << scriptPath);
+		if (probe) {
+			_breaker.abandon(scriptPath);
+		}
+		respondUnavailable(client, location->cgiQueueTimeout);
+		return true;
+	}
+
+	// 실행 자리가 날 때까지 스트리밍할 바디는 소켓에 그대로 둠
+	QueuedCgi* queued = new QueuedCgi(this, client, scriptPath, streamBody, probe, location, monotonicMs());
+	limit.waiting.push_back(queued);
+	if (limit.waiting.size() > limit.stats.maxDepth) {
+		limit.stats.maxDepth = limit.waiting.size();
+	}
+	client->attachAsync(queued);
+	if (streamBody) {
+		_event_loop->setReadable(client->getFd(), false);
+	}
+	DEBUG_LOG("[CgiRunner] queued " << scriptPath << " (" << limit.waiting.size() << " waiting)");
+	return true;
+}
+
+// 프로세스를 띄워 Client에 연결하고 바디를 넘기기 시작
+bool CgiRunner::launch(Client* client, const std::string& scriptPath, bool streamBody, bool probe,
+					   const CompiledLocation* limit) {
+	HttpRequest* request = client->getRequest();
+	CgiProcess* process = start(client, request, scriptPath, client->getServerContext(),
+								client->getLocationContext());
+	if (!process) {
+		if (probe) {
+			_breaker.abandon(scriptPath);
+		}
+		return false;
+	}
+	process->_probe = probe;
+	if (limit != NULL) {
+		process->_limit = limit;
+		++_limits[limit].stats.running;
+	}
+
+	client->attachAsync(process);
+	if (streamBody) {
+		DEBUG_LOG("[CgiRunner] streaming " << request->getContentLength() << " bytes to " << scriptPath);
+		client->startBodyStream(process);
+	} else {
+		process->writeBody(request->getBodyData(), request->getBodyLength());
+		process->endBody();
+	}
+	return true;
+}
+
+// 자리가 난 location의 대기열 앞에서부터 실행
+void CgiRunner::startQueued(const CompiledLocation* location) {
+	std::map<const CompiledLocation*, Limit>::iterator it = _limits.find(location);
+	if (it == _limits.end()) {
+		return;
+	}
+	Limit& limit = it->second;
+
+	while (!limit.waiting.empty() && limit.stats.running < location->cgiMaxConcurrent) {
+		QueuedCgi* queued = limit.waiting.front();
+		limit.waiting.pop_front();
+		++limit.stats.waited;
+		limit.stats.totalWaitMs += monotonicMs() - queued->_enqueuedAt;
+
+		Client* client = queued->_client;
+		if (queued->_streamBody) {
+			_event_loop->setReadable(client->getFd(), true);
+		}
+		if (!launch(client, queued->_scriptPath, queued->_streamBody, queued->_probe, location)) {
+			client->completeAsync(new HttpResponse(HttpResponse::createErrorResponse(
+				StatusCode::BAD_GATEWAY, client->getServerContext(), client->getLocationContext()
+			)));
+		}
+		delete queued;
+	}
+}
+
+// cgi_queue_timeout 안에 실행되지 못한 요청은 503
+void CgiRunner::expireQueued() {
+	double now = monotonicMs();
+
+	for (std::map<const CompiledLocation*, Limit>::iterator it = _limits.begin(); it != _limits.end(); ++it) {
+		Limit& limit = it->second;
+		double timeoutMs = it->first->cgiQueueTimeout * 1000.0;
+
+		while (!limit.waiting.empty() && now - limit.waiting.front()->_enqueuedAt > timeoutMs) {
+			QueuedCgi* queued = limit.waiting.front();
+			limit.waiting.pop_front();
+			++limit.stats.expired;
+			DEBUG_LOG("[CgiRunner] queue timeout for " << queued->_scriptPath);
+			if (queued->_probe) {
+				_breaker.abandon(queued->_scriptPath);
+			}
+			respondUnavailable(queued->_client, it->first->cgiQueueTimeout);
+			delete queued;
+		}
+	}
+}
+
+// Client가 대기 중에 끊김
+void CgiRunner::cancel(QueuedCgi* queued) {
+	std::deque<QueuedCgi*>& waiting = _limits[queued->_location].waiting;
+	for (std::deque<QueuedCgi*>::iterator it = waiting.begin(); it != waiting.end(); ++it) {
+		if (*it == queued) {
+			waiting.erase(it);
+			break;
+		}
+	}
+	if (queued->_probe) {
+		_breaker.abandon(queued->_scriptPath);
+	}
+	delete queued;
+}
+
+void CgiRunner::addQueue(const LocationContext* locConf) {
+	limitFor(locConf);
+}
+
+CgiRunner::Limit& CgiRunner::limitFor(const LocationContext* locConf) {
+	Limit& limit = _limits[locConf->compiled];
+	if (limit.stats.location.empty()) {
+		limit.stats.server = locConf->compiled->metricsServer;
+		limit.stats.location = locConf->path;
+	}
+	return limit;
+}
+
+void CgiRunner::respondUnavailable(Client* client, time_t retryAfter) {
+	HttpResponse* response = new HttpResponse(HttpResponse::createErrorResponse(
+		StatusCode::SERVICE_UNAVAILABLE, client->getServerContext(), client->getLocationContext()
+	));
+	std::ostringstream seconds;
+	seconds << retryAfter;
+	response->setHeader("Retry-After", seconds.str());
+	client->completeAsync(response);
+}
+
+std::vector<CgiRunner::QueueStats> CgiRunner::queueStats() const {
+	std::vector<QueueStats> stats;
+	for (std::map<const CompiledLocation*, Limit>::const_iterator it = _limits.begin(); it != _limits.end(); ++it) {
+		stats.push_back(it->second.stats);
+		stats.back().depth = it->second.waiting.size();
+	}
+	return stats;
+}
+
+void CgiRunner::logQueueStats() {
+	for (std::map<const CompiledLocation*, Limit>::iterator it = _limits.begin(); it != _limits.end(); ++it) {
+		Limit& limit = it->second;
+		const QueueStats& stats = limit.stats;
+		size_t events = stats.waited + stats.rejected + stats.expired;
+		if (events == limit.loggedEvents) {
+			continue;
+		}
+		limit.loggedEvents = events;
+
+		double avgWaitMs = stats.waited > 0 ? stats.totalWaitMs / stats.waited : 0;
+		INFO_LOG("[CgiRunner] queue " << stats.location << ": running=" << stats.running
+				 << " depth=" << limit.waiting.size() << " max_depth=" << stats.maxDepth
+				 << " waited=" << stats.waited << " avg_wait_ms=" << avgWaitMs
+				 << " rejected=" << stats.rejected << " expired=" << stats.expired);
+	}
+}
+
+CgiProcess* CgiRunner::start(Client* client, const HttpRequest* request, const std::string& scriptPath,
+							 const ServerContext* serverConf, const LocationContext* locConf) {
+	std::string interpreter = CgiExecutor::resolveInterpreter(scriptPath, locConf);
+	const std::string& program = interpreter.empty() ? scriptPath : interpreter;
+
+	// argv/envp는 실행 전에 모두 준비
+	std::vector<std::string> env = CgiExecutor::buildEnvironment(request, scriptPath, serverConf, locConf);
+	std::vector<char*> envp;
+	for (size_t i = 0; i < env.size(); ++i) {
+		envp.push_back(const_cast<char*>(env[i].c_str()));
+	}
+	envp.push_back(NULL);
+
+	char* argv[3];
+	argv[0] = const_cast<char*>(program.c_str());
+	argv[1] = interpreter.empty() ? NULL : const_cast<char*>(scriptPath.c_str());
+	argv[2] = NULL;
+
+	int pipeStdin[2];
+	int pipeStdout[2];
+	int pipeStderr[2];
+	if (::pipe(pipeStdin) == -1) {
+		return NULL;
+	}
+	if (::pipe(pipeStdout) == -1) {
+		::close(pipeStdin[0]); ::close(pipeStdin[1]);
+		return NULL;
+	}
+	if (::pipe(pipeStderr) == -1) {
+		::close(pipeStdin[0]); ::close(pipeStdin[1]);
+		::close(pipeStdout[0]); ::close(pipeStdout[1]);
+		return NULL;
+	}
+
+	ProcessSpawner::Stdio stdio;
+	stdio.in = pipeStdin[0];
+	stdio.out = pipeStdout[1];
+	stdio.err = pipeStderr[1];
+	pid_t pid = ProcessSpawner::spawn(program.c_str(), argv, &envp[0], stdio, scriptDirectory(scriptPath));
+
+	::close(pipeStdin[0]);
+	::close(pipeStdout[1]);
+	::close(pipeStderr[1]);
+
+	if (pid == -1) {
+		ERROR_LOG("[CgiRunner] Failed to spawn " << program << ": " << std::strerror(errno));
+		::close(pipeStdin[1]);
+		::close(pipeStdout[0]);
+		::close(pipeStderr[0]);
+		return NULL;
+	}
+	++Metrics::counters().cgiSpawns;
+
+#ifdef F_SETPIPE_SZ
+	::fcntl(pipeStdin[1], F_SETPIPE_SZ, STDIN_PIPE_SIZE);
+#endif
+
+	CgiProcess* process = new CgiProcess(this, client, serverConf, locConf, scriptPath);
+	process->_pid = pid;
+	process->_stdinFd = pipeStdin[1];
+	process->_stdoutFd = pipeStdout[0];
+	process->_stderrFd = pipeStderr[0];
+	process->_streamOutput = (request->getVersion() == "HTTP/1.1");
+	process->_nph = CgiExecutor::isNph(scriptPath, locConf);
+	_running.push_back(process);
+
+	// stdin은 보낼 바디가 쌓였을 때만 EPOLLOUT을 켬
+	if (!_event_loop->addHandler(process->_stdinFd, 0, process)
+		|| !_event_loop->addHandler(process->_stdoutFd, EPOLLIN, process)
+		|| !_event_loop->addHandler(process->_stderrFd, EPOLLIN, process)) {
+		process->_client = NULL;
+		release(process);
+		return NULL;
+	}
+
+	DEBUG_LOG("[CgiRunner] started " << program << " " << scriptPath << " pid=" << pid);
+	return process;
+}
+
+void CgiRunner::finish(CgiProcess* process, int statusCode) {
+	if (!process->_stderr.empty()) {
+		ERROR_LOG("[CgiRunner] " << process->_scriptPath << " stderr: " << process->_stderr);
+	}
+
+	Client* client = process->_client;
+	bool failed = (statusCode != StatusCode::OK) || !process->exitedCleanly();
+	if (client != NULL && process->_headSent) {
+		// 헤더를 이미 보냄: 정상 종료면 응답을 마무리하고, 아니면 잘린 채로 연결을 끊음
+		process->_client = NULL;
+		client->endResponseStream(statusCode == StatusCode::OK);
+	} else if (client != NULL) {
+		HttpResponse* response = NULL;
+
+		if (statusCode == StatusCode::OK) {
+			if (process->_stdout.empty()) {
+				ERROR_LOG("[CgiRunner] CGI execution failed for path: " << process->_scriptPath);
+				statusCode = StatusCode::INTERNAL_SERVER_ERROR;
+			} else {
+				CgiResponseParser parser;
+				response = parser.parse(process->_stdout);
+				if (response == NULL) {
+					ERROR_LOG("[CgiRunner] Failed to parse CGI output from: " << process->_scriptPath);
+					statusCode = StatusCode::BAD_GATEWAY;
+				}
+			}
+		}
+		if (response == NULL) {
+			failed = true;
+			response = new HttpResponse(
+				HttpResponse::createErrorResponse(statusCode, process->_serverConf, process->_locConf)
+			);
+		}
+
+		process->_client = NULL;
+		client->completeAsync(response);
+	}
+
+	// 클라이언트가 먼저 끊어 결과를 모르는 요청은 abort에서 release만 함
+	const CompiledLocation* location = process->_locConf->compiled;
+	if (location->cgiBreakerPercent > 0) {
+		_breaker.record(process->_scriptPath, location, failed, process->_probe, ::time(NULL));
+		process->_probe = false;
+	}
+	release(process);
+}
+
+// 파이프를 닫고 아직 실행 중인 자식은 종료시킨 뒤 삭제 대기열로 옮김
+void CgiRunner::release(CgiProcess* process) {
+	if (process->_finished) {
+		return;
+	}
+	process->_finished = true;
+	if (process->_probe) {
+		_breaker.abandon(process->_scriptPath);
+	}
+
+	process->closeStdin();
+	process->closeOutput(process->_stdoutFd);
+	process->closeOutput(process->_stderrFd);
+	process->closeOutput(process->_pidFd);
+
+	if (process->_pid != -1 && ::waitpid(process->_pid, NULL, WNOHANG) == 0) {
+		::kill(process->_pid, SIGKILL);
+		_exited.push_back(process->_pid);
+	}
+
+	for (size_t i = 0; i < _running.size(); ++i) {
+		if (_running[i] == process) {
+			_running.erase(_running.begin() + i);
+			break;
+		}
+	}
+	_finished.push_back(process);
+
+	if (process->_limit != NULL) {
+		--_limits[process->_limit].stats.running;
+		startQueued(process->_limit);
+	}
+}
+
+void CgiRunner::onTick() {
+	time_t now = ::time(NULL);
+
+	// 바디를 다 받은 뒤 cgi_timeout 안에 응답 헤더를 내지 않았거나, 헤더를 보낸 뒤
+	// cgi_timeout 동안 출력이 없는 스크립트 (Client가 밀려 읽기를 멈춘 동안은 제외)
+	std::vector<CgiProcess*> timedOut;
+	for (size_t i = 0; i < _running.size(); ++i) {
+		CgiProcess* process = _running[i];
+		if (!process->_inputEnded || process->_outputPaused) {
+			continue;
+		}
+		time_t since = process->_headSent ? process->_lastOutputAt : process->_inputEndedAt;
+		if (now - since > static_cast<time_t>(process->_locConf->compiled->cgiTimeout)) {
+			timedOut.push_back(process);
+		}
+	}
+	Metrics::counters().timeouts[Metrics::TIMEOUT_CGI] += timedOut.size();
+	for (size_t i = 0; i < timedOut.size(); ++i) {
+		ERROR_LOG("[CgiRunner] CGI execution timeout for path: " << timedOut[i]->_scriptPath);
+		finish(timedOut[i], StatusCode::GATEWAY_TIMEOUT);
+	}
+
+	// pidfd를 쓸 수 없어 출력을 닫은 뒤 종료를 기다리는 프로세스
+	std::vector<CgiProcess*> exiting;
+	for (size_t i = 0; i < _running.size(); ++i) {
+		if (_running[i]->_pidFd == -1 && _running[i]->_stdoutFd == -1 && _running[i]->_stderrFd == -1) {
+			exiting.push_back(_running[i]);
+		}
+	}
+	for (size_t i = 0; i < exiting.size(); ++i) {
+		exiting[i]->tryComplete();
+	}
+
+	expireQueued();
+	if (now - _statsLoggedAt >= QUEUE_STATS_INTERVAL) {
+		_statsLoggedAt = now;
+		logQueueStats();
+	}
+
+	for (size_t i = 0; i < _finished.size(); ++i) {
+		delete _finished[i];
+	}
+	_finished.clear();
+
+	std::vector<pid_t> running;
+	for (size_t i = 0; i < _exited.size(); ++i) {
+		if (::waitpid(_exited[i], NULL, WNOHANG) == 0) {
+			running.push_back(_exited[i]);
+		}
+	}
+	_exited.swap(running);
+}
@@ -0,0 +1,143 @@
+#include "cgi/CgiWorker.hpp"
+#include "cgi/ProcessSpawner.hpp"
+#include "webserv.hpp"
+#include <sys/wait.h>
+#include <signal.h>
+#include <cstdio>
+
+const size_t CgiWorker::DEFAULT_MAX_REQUESTS = 500;
+const int CgiWorker::WORKER_FD = 3;
+
+/**
+ * 워커 부트스트랩 (python3 -c BOOTSTRAP <fd>).
+ *
+ * BEGIN_REQUEST/PARAMS/STDIN을 모아 한 요청씩 실행하고 STDOUT/STDERR/END_REQUEST로 응답함.
+ * stdout은 64KB씩 모이는 대로 STDOUT 레코드로 보내므로 서버가 스크립트 종료 전에 응답을 시작할 수 있음.
+ * 바디를 받는 중에 ABORT_REQUEST가 오면 실행하지 않고 END_REQUEST로 답함.
+ * 스크립트는 runpy로 같은 프로세스에서 실행되므로 import한 모듈은 다음 요청에서 재사용됨.
+ * 서버가 소켓을 닫으면 EOF로 종료하고, SIGINT는 서버가 처리하도록 무시함.
+ */
+static const char* BOOTSTRAP =
+	"import io, os, runpy, signal, socket, struct, sys, traceback\n"
+	"signal.signal(signal.SIGINT, signal.SIG_IGN)\n"
+	"sock = socket.socket(fileno=int(sys.argv[1]))\n"
+	"rfile = sock.makefile('rb')\n"
+	"def record(t, rid, data=b''):\n"
+	"    pad = -len(data) % 8\n"
+	"    return struct.pack('>BBHHBx', 1, t, rid, len(data), pad) + data + bytes(pad)\n"
+	"def stream(t, rid, data):\n"
+	"    return b''.join(record(t, rid, data[i:i + 65535]) for i in range(0, len(data), 65535))\n"
+	"def pairs(data):\n"
+	"    env, i = {}, 0\n"
+	"    while i < len(data):\n"
+	"        size = []\n"
+	"        for _ in range(2):\n"
+	"            if data[i] & 0x80:\n"
+	"                size.append(struct.unpack('>I', data[i:i + 4])[0] & 0x7fffffff)\n"
+	"                i += 4\n"
+	"            else:\n"
+	"                size.append(data[i])\n"
+	"                i += 1\n"
+	"        name = data[i:i + size[0]].decode('latin-1')\n"
+	"        env[name] = data[i + size[0]:i + size[0] + size[1]].decode('utf-8', 'surrogateescape')\n"
+	"        i += size[0] + size[1]\n"
+	"    return env\n"
+	"class Stdout(io.RawIOBase):\n"
+	"    def __init__(self, rid):\n"
+	"        self.rid = rid\n"
+	"    def writable(self):\n"
+	"        return True\n"
+	"    def write(self, data):\n"
+	"        sock.sendall(stream(6, self.rid, bytes(data)))\n"
+	"        return len(data)\n"
+	"def run(env, body, rid):\n"
+	"    script = env.get('SCRIPT_FILENAME', '')\n"
+	"    out, err = io.BufferedWriter(Stdout(rid), 65535), io.BytesIO()\n"
+	"    stdout = io.TextIOWrapper(out, encoding='utf-8', write_through=True)\n"
+	"    stderr = io.TextIOWrapper(err, encoding='utf-8', write_through=True)\n"
+	"    os.environ.clear()\n"
+	"    os.environ.update(env)\n"
+	"    sys.argv = [script]\n"
+	"    sys.stdin = io.TextIOWrapper(io.BytesIO(bytes(body)), encoding='utf-8')\n"
+	"    sys.stdout, sys.stderr = stdout, stderr\n"
+	"    try:\n"
+	"        os.chdir(os.path.dirname(script) or '.')\n"
+	"        sys.path[0] = os.path.dirname(script)\n"
+	"        runpy.run_path(script, run_name='__main__')\n"
+	"    except SystemExit:\n"
+	"        pass\n"
+	"    except BaseException:\n"
+	"        traceback.print_exc()\n"
+	"    finally:\n"
+	"        stdout.flush()\n"
+	"        stderr.flush()\n"
+	"        sys.stdin, sys.stdout, sys.stderr = sys.__stdin__, sys.__stdout__, sys.__stderr__\n"
+	"    return err.getvalue()\n"
+	"requests = {}\n"
+	"while True:\n"
+	"    header = rfile.read(8)\n"
+	"    if len(header) < 8:\n"
+	"        break\n"
+	"    _, t, rid, clen, plen = struct.unpack('>BBHHBx', header)\n"
+	"    data = rfile.read(clen + plen)[:clen]\n"
+	"    if t == 1:\n"
+	"        requests[rid] = [bytearray(), bytearray()]\n"
+	"    elif t == 2 and rid in requests:\n"
+	"        del requests[rid]\n"
+	"        sock.sendall(record(3, rid, bytes(8)))\n"
+	"    elif t in (4, 5) and rid in requests:\n"
+	"        requests[rid][t - 4] += data\n"
+	"        if t == 5 and not data:\n"
+	"            params, body = requests.pop(rid)\n"
+	"            err = run(pairs(params), body, rid)\n"
+	"            sock.sendall(stream(7, rid, err) + record(6, rid) + record(3, rid, bytes(8)))\n";
+
+bool CgiWorker::supportsInterpreter(const std::string& interpreter) {
+	size_t slash = interpreter.rfind('/');
+	std::string name = (slash == std::string::npos) ? interpreter : interpreter.substr(slash + 1);
+	return name == "python" || name.compare(0, 7, "python3") == 0;
+}
+
+pid_t CgiWorker::spawn(const std::string& interpreter, int& fd) {
+	int sv[2];
+	if (::socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == -1) {
+		ERROR_LOG("[CgiWorker] socketpair failed: " << std::strerror(errno));
+		return -1;
+	}
+
+	char fdArg[16];
+	std::sprintf(fdArg, "%d", WORKER_FD);
+
+	char* argv[5];
+	argv[0] = const_cast<char*>(interpreter.c_str());
+	argv[1] = const_cast<char*>("-c");
+	argv[2] = const_cast<char*>(BOOTSTRAP);
+	argv[3] = fdArg;
+	argv[4] = NULL;
+
+	// 워커 쪽 소켓만 WORKER_FD로 넘기고 stdin/stdout은 /dev/null (출력은 STDOUT 레코드로 받음)
+	ProcessSpawner::Stdio stdio;
+	stdio.extra = sv[1];
+	stdio.extraTarget = WORKER_FD;
+
+	pid_t pid = ProcessSpawner::spawn(interpreter.c_str(), argv, NULL, stdio, "");
+	if (pid == -1) {
+		ERROR_LOG("[CgiWorker] Failed to spawn " << interpreter << ": " << std::strerror(errno));
+		::close(sv[0]);
+		::close(sv[1]);
+		return -1;
+	}
+
+	::close(sv[1]);
+	if (::fcntl(sv[0], F_SETFL, O_NONBLOCK) < 0) {
+		ERROR_LOG("[CgiWorker] fcntl failed");
+		::close(sv[0]);
+		::kill(pid, SIGKILL);
+		::waitpid(pid, NULL, 0);
+		return -1;
+	}
+
+	fd = sv[0];
+	DEBUG_LOG("[CgiWorker] spawned " << interpreter << " worker pid=" << pid << " fd=" << fd);
+	return pid;
+}
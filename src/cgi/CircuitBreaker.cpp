@@ -0,0 +1,89 @@
+#include "cgi/CircuitBreaker.hpp"
+#include "config/CompiledLocation.hpp"
+#include "webserv.hpp"
+
+const size_t CircuitBreaker::WINDOW_SIZE = 20;
+const size_t CircuitBreaker::MIN_SAMPLES = 10;
+const time_t CircuitBreaker::WINDOW_TIME = 60;
+
+CircuitBreaker::CircuitBreaker() {}
+
+CircuitBreaker::~CircuitBreaker() {}
+
+CircuitBreaker::Decision CircuitBreaker::admit(const std::string& key, time_t now, time_t& retryAfter) {
+	std::map<std::string, Circuit>::iterator it = _circuits.find(key);
+	if (it == _circuits.end() || it->second.state == CLOSED) {
+		return ALLOW;
+	}
+
+	Circuit& circuit = it->second;
+	if (circuit.state == OPEN && now < circuit.openUntil) {
+		retryAfter = circuit.openUntil - now;
+		return REJECT;
+	}
+	// 차단 시간이 지남: 시험 요청은 한 번에 하나만
+	circuit.state = HALF_OPEN;
+	if (circuit.probing) {
+		retryAfter = 1;
+		return REJECT;
+	}
+	circuit.probing = true;
+	INFO_LOG("[CircuitBreaker] " << key << " half-open, sending probe request");
+	return PROBE;
+}
+
+void CircuitBreaker::record(const std::string& key, const CompiledLocation* location,
+							bool failed, bool probe, time_t now) {
+	Circuit& circuit = _circuits[key];
+
+	if (probe) {
+		circuit.probing = false;
+		if (failed) {
+			open(key, circuit, location, now);
+		} else {
+			INFO_LOG("[CircuitBreaker] " << key << " closed after successful probe");
+			circuit.state = CLOSED;
+			circuit.outcomes.clear();
+		}
+		return;
+	}
+	// 차단 전에 시작한 요청의 결과는 판단에 쓰지 않음
+	if (circuit.state != CLOSED) {
+		return;
+	}
+
+	circuit.outcomes.push_back(Outcome(now, failed));
+	while (circuit.outcomes.size() > WINDOW_SIZE
+		   || (!circuit.outcomes.empty() && now - circuit.outcomes.front().at > WINDOW_TIME)) {
+		circuit.outcomes.pop_front();
+	}
+	if (!failed || circuit.outcomes.size() < MIN_SAMPLES) {
+		return;
+	}
+
+	size_t failures = 0;
+	for (size_t i = 0; i < circuit.outcomes.size(); ++i) {
+		if (circuit.outcomes[i].failed) {
+			++failures;
+		}
+	}
+	if (failures * 100 >= location->cgiBreakerPercent * circuit.outcomes.size()) {
+		ERROR_LOG("[CircuitBreaker] " << key << " failed " << failures << "/" << circuit.outcomes.size()
+				  << " recent requests");
+		open(key, circuit, location, now);
+	}
+}
+
+void CircuitBreaker::abandon(const std::string& key) {
+	std::map<std::string, Circuit>::iterator it = _circuits.find(key);
+	if (it != _circuits.end()) {
+		it->second.probing = false;
+	}
+}
+
+void CircuitBreaker::open(const std::string& key, Circuit& circuit, const CompiledLocation* location, time_t now) {
+	circuit.state = OPEN;
+	circuit.openUntil = now + location->cgiBreakerOpenTime;
+	circuit.outcomes.clear();
+	ERROR_LOG("[CircuitBreaker] " << key << " open for " << location->cgiBreakerOpenTime << "s");
+}
@@ -0,0 +1,1035 @@
+#include "cgi/FastCgiClient.hpp"
+#include "cgi/FastCgiProtocol.hpp"
+#include "cgi/CgiExecutor.hpp"
+#include "cgi/CgiResponse.hpp"
+#include "cgi/CgiWorker.hpp"
+#include "config/CompiledLocation.hpp"
+#include "metrics/Metrics.hpp"
+#include "server/EventLoop.hpp"
+#include "server/Client.hpp"
+#include "http/HttpRequest.hpp"
+#include "http/HttpResponse.hpp"
+#include "http/StatusCode.hpp"
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <netdb.h>
+#include <signal.h>
+#include <cstdlib>
+
+const size_t FastCgiClient::MAX_CONNECTIONS_PER_UPSTREAM = 32;
+const size_t FastCgiClient::MAX_IDLE_CONNECTIONS = 8;
+const size_t FastCgiClient::MAX_REQUESTS_PER_CONNECTION = 16;
+const time_t FastCgiClient::IDLE_TIMEOUT = 60;
+const size_t FastCgiClient::MAX_BUFFERED_INPUT = 256 * 1024;
+
+const size_t FastCgiRequest::STDIN_HIGH_WATERMARK = 1024 * 1024;
+const size_t FastCgiRequest::MAX_HEAD_SIZE = 64 * 1024;
+
+// =========================================================================
+// FastCgiRequest
+// =========================================================================
+
+FastCgiRequest::FastCgiRequest(FastCgiClient* owner, FastCgiUpstream* upstream, Client* client,
+							   const ServerContext* serverConf, const LocationContext* locConf)
+	: _owner(owner), _upstream(upstream), _conn(NULL), _client(client),
+	  _serverConf(serverConf), _locConf(locConf), _id(0),
+	  _inputEnded(false), _bodyPaused(false), _ended(false),
+	  _streamOutput(false), _headSent(false), _outputPaused(false), _inputEndedAt(0), _lastOutputAt(0),
+	  _abortedAt(0) {}
+
+FastCgiRequest::~FastCgiRequest() {}
+
+bool FastCgiRequest::timedOut(time_t now) const {
+	time_t timeout = static_cast<time_t>(_locConf->compiled->cgiTimeout);
+
+	// abort된 요청은 바디를 다 보내지 못했어도 END_REQUEST를 cgi_timeout까지만 기다림
+	if (_abortedAt != 0) {
+		return now - _abortedAt > timeout;
+	}
+	if (!_inputEnded || _outputPaused) {
+		return false;
+	}
+	time_t since = _headSent ? _lastOutputAt : _inputEndedAt;
+	return now - since > timeout;
+}
+
+void FastCgiRequest::abort() {
+	_owner->abortRequest(this);
+}
+
+bool FastCgiRequest::writeBody(const char* data, size_t len) {
+	// 앱 서버가 먼저 응답을 끝냈거나 이미 실패로 응답했으면 남은 바디는 버림
+	if (_client == NULL || _ended) {
+		return true;
+	}
+	appendStdin(data, len, false);
+
+	size_t pending = (_conn != NULL) ? _conn->pendingOutput() : _records.size();
+	if (pending >= STDIN_HIGH_WATERMARK) {
+		_bodyPaused = true;
+		return false;
+	}
+	return true;
+}
+
+int FastCgiRequest::bodyPipe() const {
+	return -1;
+}
+
+void FastCgiRequest::waitBodyWritable() {
+	if (_conn != NULL) {
+		_conn->updateEvents();
+	}
+}
+
+void FastCgiRequest::endBody() {
+	if (_client == NULL) {
+		return;
+	}
+	_inputEnded = true;
+	_inputEndedAt = ::time(NULL);
+	if (_ended) {
+		_owner->finishRequest(this, StatusCode::OK);
+		return;
+	}
+	appendStdin(NULL, 0, true);
+	tryStartResponse();
+}
+
+void FastCgiRequest::resumeOutput() {
+	_lastOutputAt = ::time(NULL);
+	if (!_outputPaused) {
+		return;
+	}
+	_outputPaused = false;
+	if (_conn != NULL) {
+		_conn->resumeInput();
+	}
+}
+
+// 배정 전이면 임시 id로 모아 두고, 배정 후에는 연결 송신 버퍼에 바로 넣음
+void FastCgiRequest::appendStdin(const char* data, size_t len, bool endOfStream) {
+	if (_conn == NULL) {
+		FastCgi::appendStdin(_records, 1, data, len, endOfStream);
+		return;
+	}
+	std::string records;
+	FastCgi::appendStdin(records, _id, data, len, endOfStream);
+	_conn->queue(records);
+}
+
+// STDOUT 레코드: 헤더 전송 후에는 Client에 바로 넘기고, Client 버퍼가 차면 연결 읽기를 멈춤
+void FastCgiRequest::onStdout(const char* data, size_t len) {
+	if (_client == NULL || len == 0) {
+		return;
+	}
+	if (!_headSent) {
+		_stdout.append(data, len);
+		tryStartResponse();
+		return;
+	}
+	_lastOutputAt = ::time(NULL);
+	if (!_client->appendResponseBody(data, len)) {
+		_outputPaused = true;
+	}
+}
+
+// 바디를 다 받았고 헤더 블록이 끝났으면 응답 헤더를 먼저 보냄
+void FastCgiRequest::tryStartResponse() {
+	if (_headSent || !_inputEnded || !_streamOutput || _client == NULL) {
+		return;
+	}
+
+	size_t delimLength;
+	size_t headerEnd = CgiResponseParser::findHeaderEnd(_stdout, delimLength);
+	if (headerEnd == std::string::npos) {
+		if (_stdout.size() > MAX_HEAD_SIZE) {
+			ERROR_LOG("[FastCgi] header block too large from " << _upstream->address);
+			_owner->failRequest(this, StatusCode::BAD_GATEWAY);
+		}
+		return;
+	}
+
+	CgiResponseParser parser;
+	HttpResponse* head = parser.parseHead(_stdout.substr(0, headerEnd));
+	std::string body = _stdout.substr(headerEnd + delimLength);
+	std::string().swap(_stdout);
+	_headSent = true;
+	_lastOutputAt = ::time(NULL);
+	_client->startResponseStream(head, this);
+	if (!body.empty() && !_client->appendResponseBody(body.data(), body.size())) {
+		_outputPaused = true;
+	}
+}
+
+// cgi_pool: 출력이 하나도 없으면 스크립트 실패로 봄
+bool FastCgiRequest::hasOutput() const {
+	return _headSent || !_stdout.empty();
+}
+
+// =========================================================================
+// FastCgiConnection
+// =========================================================================
+
+FastCgiConnection::FastCgiConnection(FastCgiClient* owner, FastCgiUpstream* upstream, int fd, pid_t pid)
+	: _owner(owner), _upstream(upstream), _fd(fd), _state(CONNECTING),
+	  _outSent(0), _inOffset(0), _inputClosed(false), _nextId(1), _idleSince(::time(NULL)), _pid(pid), _served(0) {}
+
+FastCgiConnection::~FastCgiConnection() {
+	if (_fd != -1) {
+		::close(_fd);
+	}
+}
+
+void FastCgiConnection::queue(const std::string& records) {
+	_out.append(records);
+	updateEvents();
+}
+
+size_t FastCgiConnection::pendingOutput() const {
+	return _out.size() - _outSent;
+}
+
+// 보낼 레코드가 있으면 EPOLLOUT, Client가 밀린 요청이 없으면 EPOLLIN
+void FastCgiConnection::updateEvents() {
+	if (_state != READY) {
+		return;  // 연결 중에는 EPOLLIN | EPOLLOUT 유지
+	}
+	uint32_t events = 0;
+	if (pendingOutput() > 0) {
+		events |= EPOLLOUT;
+	}
+	if (!inputPaused()) {
+		events |= EPOLLIN;
+	}
+	_owner->_event_loop->modifyHandler(_fd, events);
+}
+
+bool FastCgiConnection::flush() {
+	while (_outSent < _out.size()) {
+		ssize_t n = ::send(_fd, _out.data() + _outSent, _out.size() - _outSent, MSG_NOSIGNAL);
+		if (n > 0) {
+			_outSent += n;
+			continue;
+		}
+		if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			return true;  // EPOLLOUT 유지
+		}
+		return false;
+	}
+
+	_out.clear();
+	_outSent = 0;
+	return true;
+}
+
+// 송신 버퍼를 다 비웠으면 멈춰 둔 요청 바디 읽기를 재개
+void FastCgiConnection::resumeBodies() {
+	std::vector<FastCgiRequest*> paused;
+	for (std::map<unsigned short, FastCgiRequest*>::iterator it = _requests.begin(); it != _requests.end(); ++it) {
+		if (it->second->_bodyPaused) {
+			paused.push_back(it->second);
+		}
+	}
+	for (size_t i = 0; i < paused.size() && _state == READY; ++i) {
+		paused[i]->_bodyPaused = false;
+		if (paused[i]->_client != NULL) {
+			paused[i]->_client->resumeBody();
+		}
+	}
+}
+
+// 소켓에 쌓인 데이터를 MAX_BUFFERED_INPUT까지 읽음. 업스트림이 연결을 닫았거나 오류면 false
+bool FastCgiConnection::readAvailable() {
+	char buffer[BUFFER_SIZE];
+
+	while (_in.size() - _inOffset < FastCgiClient::MAX_BUFFERED_INPUT) {
+		ssize_t n = ::recv(_fd, buffer, sizeof(buffer), 0);
+		if (n > 0) {
+			_in.append(buffer, n);
+			continue;
+		}
+		if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			return true;
+		}
+		return false;
+	}
+	return true;
+}
+
+// Client 버퍼가 차서 출력을 멈춘 요청이 있는지 (멀티플렉싱 연결은 모든 요청의 읽기가 멈춤)
+bool FastCgiConnection::inputPaused() const {
+	for (std::map<unsigned short, FastCgiRequest*>::const_iterator it = _requests.begin(); it != _requests.end(); ++it) {
+		if (it->second->_outputPaused) {
+			return true;
+		}
+	}
+	return false;
+}
+
+unsigned short FastCgiConnection::allocateId() {
+	while (_requests.find(_nextId) != _requests.end() || _nextId == 0) {
+		++_nextId;
+	}
+	return _nextId++;
+}
+
+// cgi_pool 워커가 교체 주기에 도달했는지 (진행 중인 요청이 없을 때만)
+bool FastCgiConnection::shouldRetire() const {
+	return _pid != -1 && _requests.empty() && _upstream->maxRequests != 0
+		&& _served >= _upstream->maxRequests;
+}
+
+// 완성된 레코드들을 처리. 프로토콜 오류면 false
+bool FastCgiConnection::processRecords() {
+	FastCgi::RecordHeader header;
+
+	// 업스트림이 닫았으면 이미 받은 레코드는 멈추지 않고 모두 처리
+	while ((_inputClosed || !inputPaused())
+		   && FastCgi::parseHeader(_in.data() + _inOffset, _in.size() - _inOffset, header)) {
+		size_t total = FastCgi::HEADER_LEN + header.contentLength + header.paddingLength;
+		if (_in.size() - _inOffset < total) {
+			break;
+		}
+		if (header.version != FastCgi::VERSION_1) {
+			ERROR_LOG("[FastCgi] Unsupported record version " << static_cast<int>(header.version)
+					  << " from " << _upstream->address);
+			return false;
+		}
+
+		const char* content = _in.data() + _inOffset + FastCgi::HEADER_LEN;
+		size_t contentLength = header.contentLength;
+		_inOffset += total;
+
+		if (header.requestId == 0) {
+			if (header.type == FastCgi::GET_VALUES_RESULT) {
+				std::map<std::string, std::string> values;
+				if (FastCgi::parseNameValuePairs(content, contentLength, values)) {
+					_owner->onGetValuesResult(_upstream, values);
+				}
+			}
+			continue;
+		}
+
+		std::map<unsigned short, FastCgiRequest*>::iterator it = _requests.find(header.requestId);
+		if (it == _requests.end()) {
+			continue;  // 이미 정리된 요청의 잔여 레코드
+		}
+		FastCgiRequest* request = it->second;
+
+		switch (header.type) {
+			case FastCgi::STDOUT:
+				request->onStdout(content, contentLength);
+				break;
+
+			case FastCgi::STDERR:
+				request->_stderr.append(content, contentLength);
+				break;
+
+			case FastCgi::END_REQUEST: {
+				int protocolStatus = (contentLength >= 5)
+					? static_cast<unsigned char>(content[4]) : static_cast<int>(FastCgi::REQUEST_COMPLETE);
+
+				_requests.erase(it);
+				request->_conn = NULL;
+				++_served;
+				if (_requests.empty()) {
+					_idleSince = ::time(NULL);
+				}
+
+				if (protocolStatus == FastCgi::REQUEST_COMPLETE) {
+					_owner->finishRequest(request, StatusCode::OK);
+				} else {
+					ERROR_LOG("[FastCgi] " << _upstream->address << " rejected request (protocolStatus="
+							  << protocolStatus << ")");
+					_owner->finishRequest(request, StatusCode::SERVICE_UNAVAILABLE);
+				}
+				break;
+			}
+
+			default:
+				break;
+		}
+	}
+
+	// 처리한 레코드 정리
+	if (_inOffset == _in.size()) {
+		_in.clear();
+		_inOffset = 0;
+	} else if (_inOffset > BUFFER_SIZE) {
+		_in.erase(0, _inOffset);
+		_inOffset = 0;
+	}
+	return true;
+}
+
+// 받은 레코드를 처리한 뒤 연결 상태를 정리. 연결을 닫았으면 false
+bool FastCgiConnection::consumeInput() {
+	if (!processRecords()) {
+		_owner->closeConnection(this, StatusCode::BAD_GATEWAY);
+		return false;
+	}
+	if (_inputClosed) {
+		// 업스트림이 연결을 닫음: 진행 중이던 요청만 실패 처리
+		DEBUG_LOG("[FastCgi] " << _upstream->address << " closed connection fd=" << _fd);
+		_owner->closeConnection(this, StatusCode::BAD_GATEWAY);
+		return false;
+	}
+	if (shouldRetire()) {
+		DEBUG_LOG("[FastCgi] recycling worker pid=" << _pid << " after " << _served << " requests");
+		_owner->closeConnection(this, StatusCode::BAD_GATEWAY);
+		return false;
+	}
+	_owner->dispatchPending(_upstream, true);
+	return true;
+}
+
+// Client가 응답을 다시 받을 수 있음: 읽어 둔 레코드를 처리하고 읽기를 재개
+void FastCgiConnection::resumeInput() {
+	if (_state == CLOSED) {
+		return;
+	}
+	if (consumeInput()) {
+		updateEvents();
+	}
+}
+
+void FastCgiConnection::onIoEvent(int fd, uint32_t events) {
+	(void)fd;
+
+	// 비동기 connect 완료 확인
+	if (_state == CONNECTING && (events & (EPOLLOUT | EPOLLERR | EPOLLHUP))) {
+		int err = 0;
+		socklen_t len = sizeof(err);
+		if (::getsockopt(_fd, SOL_SOCKET, SO_ERROR, &err, &len) == -1 || err != 0) {
+			ERROR_LOG("[FastCgi] connect to " << _upstream->address << " failed: " << std::strerror(err));
+			_owner->closeConnection(this, StatusCode::BAD_GATEWAY);
+			return;
+		}
+		_state = READY;
+		DEBUG_LOG("[FastCgi] connected to " << _upstream->address << " fd=" << _fd);
+	}
+
+	if (events & EPOLLIN) {
+		if (!readAvailable()) {
+			_inputClosed = true;
+		}
+		if (!consumeInput()) {
+			return;
+		}
+	}
+
+	if (events & (EPOLLERR | EPOLLHUP)) {
+		_owner->closeConnection(this, StatusCode::BAD_GATEWAY);
+		return;
+	}
+
+	if ((events & EPOLLOUT) && _state == READY) {
+		if (!flush()) {
+			ERROR_LOG("[FastCgi] write to " << _upstream->address << " failed");
+			_owner->closeConnection(this, StatusCode::BAD_GATEWAY);
+			return;
+		}
+		if (pendingOutput() == 0) {
+			resumeBodies();
+		}
+	}
+	if (_state == READY) {
+		updateEvents();
+	}
+}
+
+// =========================================================================
+// FastCgiClient
+// =========================================================================
+
+FastCgiClient::FastCgiClient(EventLoop* eventLoop) : _event_loop(eventLoop) {}
+
+FastCgiClient::~FastCgiClient() {
+	for (std::map<std::string, FastCgiUpstream*>::iterator it = _upstreams.begin();
+		 it != _upstreams.end(); ++it) {
+		FastCgiUpstream* upstream = it->second;
+
+		for (size_t i = 0; i < upstream->connections.size(); ++i) {
+			FastCgiConnection* conn = upstream->connections[i];
+			for (std::map<unsigned short, FastCgiRequest*>::iterator req = conn->_requests.begin();
+				 req != conn->_requests.end(); ++req) {
+				delete req->second;
+			}
+			_event_loop->remove(conn->_fd);
+			if (conn->_pid != -1) {
+				_exited.push_back(conn->_pid);
+			}
+			delete conn;
+		}
+		for (size_t i = 0; i < upstream->pending.size(); ++i) {
+			delete upstream->pending[i];
+		}
+		delete upstream;
+	}
+	deleteClosed();
+
+	// 소켓이 닫혔으므로 워커는 EOF로 종료하지만, 스크립트 실행 중일 수 있어 신호로 정리
+	for (size_t i = 0; i < _exited.size(); ++i) {
+		::kill(_exited[i], SIGTERM);
+		::waitpid(_exited[i], NULL, 0);
+	}
+}
+
+std::vector<std::string> FastCgiClient::buildParams(const HttpRequest* request, const std::string& scriptPath,
+													const ServerContext* serverConf,
+													const LocationContext* locConf) {
+	std::vector<std::string> params = CgiExecutor::buildEnvironment(request, scriptPath, serverConf, locConf);
+
+	const std::string& uri = request->getUri();
+	std::string path = uri.substr(0, uri.find('?'));
+
+	// php-fpm 등은 실행할 스크립트를 SCRIPT_FILENAME으로 찾음 (.php가 아니어도 필요)
+	bool hasScriptFilename = false;
+	for (size_t i = 0; i < params.size(); ++i) {
+		if (params[i].compare(0, 16, "SCRIPT_FILENAME=") == 0) {
+			hasScriptFilename = true;
+			break;
+		}
+	}
+	if (!hasScriptFilename) {
+		params.push_back("SCRIPT_FILENAME=" + scriptPath);
+		params.push_back("SCRIPT_NAME=" + path);
+	}
+	params.push_back("REQUEST_URI=" + uri);
+	params.push_back("DOCUMENT_URI=" + path);
+	return params;
+}
+
+bool FastCgiClient::submit(Client* client, const std::string& scriptPath, bool streamBody) {
+	const ServerContext* serverConf = client->getServerContext();
+	const LocationContext* locConf = client->getLocationContext();
+	const HttpRequest* request = client->getRequest();
+	const CompiledLocation* compiled = locConf->compiled;
+	FastCgiUpstream* upstream;
+	if (compiled->fastcgiPass.empty()) {
+		upstream = getWorkerPool(compiled);
+		if (!upstream->valid) {
+			return false;
+		}
+	} else {
+		std::map<std::string, FastCgiUpstream*>::iterator it = _upstreams.find(compiled->fastcgiPass);
+		if (it == _upstreams.end() || !it->second->valid) {
+			ERROR_LOG("[FastCgi] fastcgi_pass " << compiled->fastcgiPass << " was not resolved at startup");
+			return false;
+		}
+		upstream = it->second;
+	}
+
+	FastCgiRequest* fcgiRequest = new FastCgiRequest(this, upstream, client, serverConf, locConf);
+	fcgiRequest->_streamOutput = (request->getVersion() == "HTTP/1.1");
+
+	// requestId는 연결 배정 시 정해지므로 임시 id로 인코딩해 둠
+	std::vector<std::string> params = buildParams(request, scriptPath, serverConf, locConf);
+	FastCgi::appendBeginRequest(fcgiRequest->_records, 1, true);
+	FastCgi::appendParams(fcgiRequest->_records, 1, params);
+
+	upstream->pending.push_back(fcgiRequest);
+	dispatchPending(upstream, false);
+
+	// 연결을 하나도 만들 수 없으면 Client에 바로 실패를 알림 (아직 attach 전이므로 콜백하지 않음)
+	if (fcgiRequest->_conn == NULL && upstream->connections.empty()) {
+		upstream->pending.pop_back();
+		delete fcgiRequest;
+		return false;
+	}
+
+	DEBUG_LOG("[FastCgi] request queued to " << upstream->address
+			  << (fcgiRequest->_conn ? " (assigned)" : " (waiting for connection)"));
+
+	client->attachAsync(fcgiRequest);
+	if (streamBody) {
+		client->startBodyStream(fcgiRequest);
+	} else {
+		fcgiRequest->writeBody(request->getBodyData(), request->getBodyLength());
+		fcgiRequest->endBody();
+	}
+	return true;
+}
+
+FastCgiUpstream* FastCgiClient::getUpstream(const std::string& address) {
+	std::map<std::string, FastCgiUpstream*>::iterator it = _upstreams.find(address);
+	if (it != _upstreams.end()) {
+		// 이전 설정에서 해석하지 못한 주소는 다시 시도
+		if (!it->second->valid) {
+			it->second->valid = resolveAddress(it->second);
+		}
+		return it->second;
+	}
+
+	FastCgiUpstream* upstream = new FastCgiUpstream();
+	upstream->address = address;
+	upstream->valid = resolveAddress(upstream);
+	_upstreams[address] = upstream;
+	return upstream;
+}
+
+FastCgiUpstream* FastCgiClient::getWorkerPool(const CompiledLocation* compiled) {
+	std::string key = "cgi_pool:" + compiled->cgiPoolInterpreter;
+
+	FastCgiUpstream* upstream;
+	std::map<std::string, FastCgiUpstream*>::iterator it = _upstreams.find(key);
+	if (it != _upstreams.end()) {
+		upstream = it->second;
+	} else {
+		upstream = new FastCgiUpstream();
+		upstream->address = key;
+		upstream->interpreter = compiled->cgiPoolInterpreter;
+		upstream->valid = true;
+		upstream->probed = true;	// 워커는 한 번에 한 요청만 처리
+		_upstreams[key] = upstream;
+	}
+
+	// 여러 location이 공유하면 워커 수는 큰 값, 교체 주기는 짧은 값을 따름
+	if (compiled->cgiPoolWorkers > upstream->workers) {
+		upstream->workers = compiled->cgiPoolWorkers;
+	}
+	if (upstream->maxRequests == 0 || compiled->cgiPoolMaxRequests < upstream->maxRequests) {
+		upstream->maxRequests = compiled->cgiPoolMaxRequests;
+	}
+	return upstream;
+}
+
+void FastCgiClient::startWorkerPool(const CompiledLocation* compiled) {
+	FastCgiUpstream* upstream = getWorkerPool(compiled);
+	replenishWorkers(upstream);
+	INFO_LOG("[FastCgi] cgi_pool " << upstream->interpreter << ": " << upstream->connections.size()
+			 << " workers (recycled every " << upstream->maxRequests << " requests)");
+}
+
+bool FastCgiClient::prepare(const CompiledLocation* compiled) {
+	return getUpstream(compiled->fastcgiPass)->valid;
+}
+
+size_t FastCgiClient::connectionLimit(const FastCgiUpstream* upstream) {
+	return upstream->interpreter.empty() ? MAX_CONNECTIONS_PER_UPSTREAM : upstream->workers;
+}
+
+bool FastCgiClient::resolveAddress(FastCgiUpstream* upstream) {
+	const std::string& address = upstream->address;
+	std::memset(&upstream->sockaddr, 0, sizeof(upstream->sockaddr));
+
+	// unix:/path
+	if (address.compare(0, 5, "unix:") == 0) {
+		std::string path = address.substr(5);
+		struct sockaddr_un* un = reinterpret_cast<struct sockaddr_un*>(&upstream->sockaddr);
+		if (path.length() >= sizeof(un->sun_path)) {
+			ERROR_LOG("[FastCgi] unix socket path too long: " << path);
+			return false;
+		}
+		un->sun_family = AF_UNIX;
+		std::memcpy(un->sun_path, path.c_str(), path.length() + 1);
+		upstream->sockaddrLen = sizeof(struct sockaddr_un);
+		return true;
+	}
+
+	// host:port ([::1]:9000 형식 포함)
+	size_t colon = address.rfind(':');
+	if (colon == std::string::npos) {
+		ERROR_LOG("[FastCgi] invalid upstream address: " << address);
+		return false;
+	}
+	std::string host = address.substr(0, colon);
+	std::string port = address.substr(colon + 1);
+	if (host.length() >= 2 && host[0] == '[' && host[host.length() - 1] == ']') {
+		host = host.substr(1, host.length() - 2);
+	}
+
+	struct addrinfo hints;
+	struct addrinfo* result = NULL;
+	std::memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+
+	int rc = ::getaddrinfo(host.c_str(), port.c_str(), &hints, &result);
+	if (rc != 0 || result == NULL) {
+		ERROR_LOG("[FastCgi] cannot resolve " << address << ": " << ::gai_strerror(rc));
+		return false;
+	}
+	std::memcpy(&upstream->sockaddr, result->ai_addr, result->ai_addrlen);
+	upstream->sockaddrLen = result->ai_addrlen;
+	::freeaddrinfo(result);
+	return true;
+}
+
+FastCgiConnection* FastCgiClient::openConnection(FastCgiUpstream* upstream) {
+	if (!upstream->interpreter.empty()) {
+		return spawnWorker(upstream);
+	}
+
+	int fd = ::socket(upstream->sockaddr.ss_family, SOCK_STREAM, 0);
+	if (fd == -1) {
+		ERROR_LOG("[FastCgi] socket() failed: " << std::strerror(errno));
+		return NULL;
+	}
+	if (::fcntl(fd, F_SETFL, O_NONBLOCK) < 0) {
+		ERROR_LOG("[FastCgi] fcntl failed");
+		::close(fd);
+		return NULL;
+	}
+
+	int rc = ::connect(fd, reinterpret_cast<struct sockaddr*>(&upstream->sockaddr), upstream->sockaddrLen);
+	if (rc == -1 && errno != EINPROGRESS) {
+		ERROR_LOG("[FastCgi] connect to " << upstream->address << " failed: " << std::strerror(errno));
+		::close(fd);
+		return NULL;
+	}
+
+	FastCgiConnection* conn = new FastCgiConnection(this, upstream, fd, -1);
+	if (rc == 0) {
+		conn->_state = FastCgiConnection::READY;
+	}
+	if (!_event_loop->addHandler(fd, EPOLLIN | EPOLLOUT, conn)) {
+		delete conn;
+		return NULL;
+	}
+	upstream->connections.push_back(conn);
+
+	// 업스트림이 한 연결에서 여러 요청을 받는지 첫 연결에서 한 번만 질의
+	if (!upstream->probed) {
+		std::vector<std::string> names;
+		names.push_back("FCGI_MPXS_CONNS");
+		FastCgi::appendGetValues(conn->_out, names);
+		upstream->probed = true;
+	}
+
+	DEBUG_LOG("[FastCgi] opened connection to " << upstream->address << " fd=" << fd
+			  << " (" << upstream->connections.size() << " total)");
+	return conn;
+}
+
+FastCgiConnection* FastCgiClient::spawnWorker(FastCgiUpstream* upstream) {
+	int fd = -1;
+	pid_t pid = CgiWorker::spawn(upstream->interpreter, fd);
+	if (pid == -1) {
+		return NULL;
+	}
+	++Metrics::counters().cgiSpawns;
+
+	FastCgiConnection* conn = new FastCgiConnection(this, upstream, fd, pid);
+	conn->_state = FastCgiConnection::READY;
+	if (!_event_loop->addHandler(fd, EPOLLIN, conn)) {
+		::kill(pid, SIGKILL);
+		_exited.push_back(pid);
+		delete conn;
+		return NULL;
+	}
+	upstream->connections.push_back(conn);
+	return conn;
+}
+
+// cgi_pool 워커 수를 설정값까지 채움
+void FastCgiClient::replenishWorkers(FastCgiUpstream* upstream) {
+	while (upstream->connections.size() < upstream->workers) {
+		if (spawnWorker(upstream) == NULL) {
+			break;
+		}
+	}
+}
+
+void FastCgiClient::dispatchPending(FastCgiUpstream* upstream, bool failUnreachable) {
+	bool canOpen = true;
+
+	while (!upstream->pending.empty()) {
+		// 1. 요청이 없는 연결 우선
+		FastCgiConnection* target = NULL;
+		FastCgiConnection* shared = NULL;
+		for (size_t i = 0; i < upstream->connections.size(); ++i) {
+			FastCgiConnection* conn = upstream->connections[i];
+			size_t load = conn->_requests.size();
+			if (load == 0) {
+				target = conn;
+				break;
+			}
+			if (upstream->multiplex && load < MAX_REQUESTS_PER_CONNECTION
+				&& (shared == NULL || load < shared->_requests.size())) {
+				shared = conn;
+			}
+		}
+
+		// 2. 없으면 새 연결, 한도에 찼으면 멀티플렉싱 가능한 연결에 합류
+		if (target == NULL && canOpen && upstream->connections.size() < connectionLimit(upstream)) {
+			target = openConnection(upstream);
+			canOpen = (target != NULL);
+		}
+		if (target == NULL) {
+			target = shared;
+		}
+		if (target == NULL) {
+			break;  // 연결이 빌 때까지 대기
+		}
+
+		FastCgiRequest* request = upstream->pending.front();
+		upstream->pending.pop_front();
+		assign(target, request);
+	}
+
+	// 살아 있는 연결이 하나도 없으면 대기 중인 요청은 처리될 수 없음
+	if (failUnreachable && upstream->connections.empty()) {
+		while (!upstream->pending.empty()) {
+			FastCgiRequest* request = upstream->pending.front();
+			upstream->pending.pop_front();
+			finishRequest(request, StatusCode::BAD_GATEWAY);
+		}
+	}
+}
+
+void FastCgiClient::assign(FastCgiConnection* conn, FastCgiRequest* request) {
+	unsigned short id = conn->allocateId();
+
+	request->_id = id;
+	request->_conn = conn;
+	conn->_requests[id] = request;
+
+	FastCgi::setRequestId(request->_records, id);
+	conn->queue(request->_records);
+	std::string().swap(request->_records);
+}
+
+// replace: 비정상 종료가 아니라 서버가 내린 워커이므로 onTick을 기다리지 않고 바로 대체
+void FastCgiClient::closeConnection(FastCgiConnection* conn, int statusCode, bool replace) {
+	if (conn->_state == FastCgiConnection::CLOSED) {
+		return;
+	}
+	conn->_state = FastCgiConnection::CLOSED;
+	bool recycled = replace || conn->shouldRetire();
+
+	_event_loop->remove(conn->_fd);
+	::close(conn->_fd);
+	conn->_fd = -1;
+
+	// 워커는 소켓 EOF로 스스로 종료함. 스크립트가 멈춘 경우(타임아웃 등)만 강제 종료
+	if (conn->_pid != -1) {
+		if (!conn->_requests.empty()) {
+			::kill(conn->_pid, SIGKILL);
+		}
+		_exited.push_back(conn->_pid);
+	}
+
+	FastCgiUpstream* upstream = conn->_upstream;
+	for (size_t i = 0; i < upstream->connections.size(); ++i) {
+		if (upstream->connections[i] == conn) {
+			upstream->connections.erase(upstream->connections.begin() + i);
+			break;
+		}
+	}
+
+	std::map<unsigned short, FastCgiRequest*> requests;
+	requests.swap(conn->_requests);
+	for (std::map<unsigned short, FastCgiRequest*>::iterator it = requests.begin(); it != requests.end(); ++it) {
+		it->second->_conn = NULL;
+		finishRequest(it->second, statusCode);
+	}
+
+	// 콜백 안에서 호출될 수 있으므로 삭제는 onTick에서
+	_closed.push_back(conn);
+
+	// 교체 주기나 abort로 내린 워커는 바로 대체 (비정상 종료한 워커는 onTick에서 보충해 재시작 폭주를 막음)
+	if (recycled) {
+		replenishWorkers(upstream);
+	}
+
+	dispatchPending(upstream, true);
+}
+
+void FastCgiClient::finishRequest(FastCgiRequest* request, int statusCode) {
+	Client* client = request->_client;
+
+	// 바디를 다 받기 전에 끝난 응답은 endBody에서 보냄 (멈춰 둔 바디는 받아서 버림)
+	if (client != NULL && statusCode == StatusCode::OK && !request->_inputEnded) {
+		request->_ended = true;
+		if (request->_bodyPaused) {
+			request->_bodyPaused = false;
+			client->resumeBody();
+		}
+		return;
+	}
+
+	if (!request->_stderr.empty()) {
+		ERROR_LOG("[FastCgi] " << request->_upstream->address << " stderr: " << request->_stderr);
+	}
+
+	request->_client = NULL;
+	if (client != NULL && request->_headSent) {
+		// 헤더를 이미 보냄: 정상 종료면 응답을 마무리하고, 아니면 잘린 채로 연결을 끊음
+		client->endResponseStream(statusCode == StatusCode::OK);
+	} else if (client != NULL) {
+		HttpResponse* response = NULL;
+
+		// cgi_pool은 fork-exec CGI와 같게: 출력이 없으면 스크립트 실패(500)
+		if (statusCode == StatusCode::OK && !request->hasOutput() && !request->_upstream->interpreter.empty()) {
+			statusCode = StatusCode::INTERNAL_SERVER_ERROR;
+		}
+		if (statusCode == StatusCode::OK) {
+			CgiResponseParser parser;
+			response = parser.parse(request->_stdout);
+			if (response == NULL) {
+				ERROR_LOG("[FastCgi] Failed to parse response from " << request->_upstream->address);
+				statusCode = StatusCode::BAD_GATEWAY;
+			}
+		}
+		if (response == NULL) {
+			response = new HttpResponse(
+				HttpResponse::createErrorResponse(statusCode, request->_serverConf, request->_locConf)
+			);
+		}
+		client->completeAsync(response);
+	}
+
+	// Client가 스트리밍 중인 바디의 sink로 아직 참조할 수 있으므로 삭제는 onTick에서
+	_finished.push_back(request);
+}
+
+// 연결에 배정된 요청을 실패로 응답하고 앱 서버에는 중단을 알림 (END_REQUEST를 받을 때 정리)
+void FastCgiClient::failRequest(FastCgiRequest* request, int statusCode) {
+	Client* client = request->_client;
+	request->_client = NULL;
+	if (client != NULL && request->_headSent) {
+		client->endResponseStream(false);
+	} else if (client != NULL) {
+		client->completeAsync(new HttpResponse(
+			HttpResponse::createErrorResponse(statusCode, request->_serverConf, request->_locConf)
+		));
+	}
+	abortRequest(request);
+}
+
+void FastCgiClient::abortRequest(FastCgiRequest* request) {
+	request->_client = NULL;
+
+	// 아직 연결에 배정되지 않았거나 END_REQUEST를 이미 받았으면 바로 정리
+	if (request->_conn == NULL) {
+		std::deque<FastCgiRequest*>& pending = request->_upstream->pending;
+		for (std::deque<FastCgiRequest*>::iterator it = pending.begin(); it != pending.end(); ++it) {
+			if (*it == request) {
+				pending.erase(it);
+				break;
+			}
+		}
+		_finished.push_back(request);
+		return;
+	}
+
+	// 바디를 다 보내지 못한 요청은 앱 서버가 STDIN 끝을 기다리며 멈춰 있을 수 있음:
+	// 연결을 혼자 쓰면(cgi_pool 워커 포함) 닫아서 정리 (워커는 종료되고 onTick에서 보충)
+	FastCgiConnection* conn = request->_conn;
+	if (!request->_inputEnded && (conn->_pid != -1 || conn->_requests.size() == 1)) {
+		DEBUG_LOG("[FastCgi] closing " << conn->_upstream->address << " fd=" << conn->_fd
+				  << " after aborted upload");
+		closeConnection(conn, StatusCode::BAD_GATEWAY, true);
+		return;
+	}
+
+	// 진행 중이면 앱 서버에 중단을 알리고 END_REQUEST를 받을 때 정리 (연결은 유지, cgi_timeout까지만 기다림)
+	request->_abortedAt = ::time(NULL);
+	bool paused = request->_outputPaused;
+	request->_outputPaused = false;
+	std::string record;
+	FastCgi::appendAbortRequest(record, request->_id);
+	conn->queue(record);
+
+	// 이 요청 때문에 멈춰 둔 연결 읽기를 재개
+	if (paused) {
+		conn->resumeInput();
+	}
+}
+
+void FastCgiClient::onGetValuesResult(FastCgiUpstream* upstream, const std::map<std::string, std::string>& values) {
+	std::map<std::string, std::string>::const_iterator it = values.find("FCGI_MPXS_CONNS");
+	if (it != values.end()) {
+		upstream->multiplex = (it->second == "1");
+		DEBUG_LOG("[FastCgi] " << upstream->address << " FCGI_MPXS_CONNS=" << it->second);
+	}
+}
+
+void FastCgiClient::deleteClosed() {
+	for (size_t i = 0; i < _closed.size(); ++i) {
+		delete _closed[i];
+	}
+	_closed.clear();
+	for (size_t i = 0; i < _finished.size(); ++i) {
+		delete _finished[i];
+	}
+	_finished.clear();
+}
+
+void FastCgiClient::onTick() {
+	time_t now = ::time(NULL);
+
+	for (std::map<std::string, FastCgiUpstream*>::iterator it = _upstreams.begin();
+		 it != _upstreams.end(); ++it) {
+		FastCgiUpstream* upstream = it->second;
+
+		// 1. 응답이 cgi_timeout을 넘긴 연결은 닫음 (앱 서버가 멈췄을 수 있음)
+		// 2. 유휴 연결은 MAX_IDLE_CONNECTIONS개까지, IDLE_TIMEOUT 동안만 유지
+		std::vector<FastCgiConnection*> timedOut;
+		std::vector<FastCgiConnection*> expired;
+		size_t idle = 0;
+
+		for (size_t i = 0; i < upstream->connections.size(); ++i) {
+			FastCgiConnection* conn = upstream->connections[i];
+
+			if (conn->_requests.empty()) {
+				if (!conn->_out.empty() || !upstream->interpreter.empty()) {
+					continue;  // cgi_pool 워커는 유휴 상태로 유지
+				}
+				if (++idle > MAX_IDLE_CONNECTIONS || now - conn->_idleSince > IDLE_TIMEOUT) {
+					expired.push_back(conn);
+				}
+				continue;
+			}
+
+			for (std::map<unsigned short, FastCgiRequest*>::iterator req = conn->_requests.begin();
+				 req != conn->_requests.end(); ++req) {
+				if (req->second->timedOut(now)) {
+					timedOut.push_back(conn);
+					break;
+				}
+			}
+		}
+
+		Metrics::counters().timeouts[Metrics::TIMEOUT_FASTCGI] += timedOut.size();
+		for (size_t i = 0; i < timedOut.size(); ++i) {
+			ERROR_LOG("[FastCgi] request to " << upstream->address << " timed out");
+			closeConnection(timedOut[i], StatusCode::GATEWAY_TIMEOUT);
+		}
+		for (size_t i = 0; i < expired.size(); ++i) {
+			closeConnection(expired[i], StatusCode::BAD_GATEWAY);
+		}
+
+		// 3. 연결을 기다리다 시간을 넘긴 요청 (바디를 받는 중인 요청은 Client 타임아웃에 맡김)
+		for (size_t i = 0; i < upstream->pending.size();) {
+			FastCgiRequest* request = upstream->pending[i];
+			if (!request->timedOut(now)) {
+				++i;
+				continue;
+			}
+			upstream->pending.erase(upstream->pending.begin() + i);
+			++Metrics::counters().timeouts[Metrics::TIMEOUT_FASTCGI];
+			finishRequest(request, StatusCode::GATEWAY_TIMEOUT);
+		}
+
+		// 4. 종료된 cgi_pool 워커 보충
+		if (!upstream->interpreter.empty()) {
+			replenishWorkers(upstream);
+		}
+	}
+
+	deleteClosed();
+	reapWorkers();
+}
+
+void FastCgiClient::reapWorkers() {
+	std::vector<pid_t> running;
+	for (size_t i = 0; i < _exited.size(); ++i) {
+		if (::waitpid(_exited[i], NULL, WNOHANG) == 0) {
+			running.push_back(_exited[i]);
+		}
+	}
+	_exited.swap(running);
+}
@@ -0,0 +1,163 @@
+#include "cgi/FastCgiProtocol.hpp"
+
+namespace FastCgi {
+
+// name/value 길이: 127 이하는 1바이트, 그 이상은 최상위 비트를 켠 4바이트
+static void appendLength(std::string& out, size_t len) {
+	if (len < 128) {
+		out += static_cast<char>(len);
+		return;
+	}
+	out += static_cast<char>(((len >> 24) & 0x7f) | 0x80);
+	out += static_cast<char>((len >> 16) & 0xff);
+	out += static_cast<char>((len >> 8) & 0xff);
+	out += static_cast<char>(len & 0xff);
+}
+
+static bool readLength(const unsigned char* data, size_t len, size_t& pos, size_t& value) {
+	if (pos >= len) {
+		return false;
+	}
+	if ((data[pos] & 0x80) == 0) {
+		value = data[pos++];
+		return true;
+	}
+	if (pos + 4 > len) {
+		return false;
+	}
+	value = (static_cast<size_t>(data[pos] & 0x7f) << 24) | (static_cast<size_t>(data[pos + 1]) << 16)
+		| (static_cast<size_t>(data[pos + 2]) << 8) | static_cast<size_t>(data[pos + 3]);
+	pos += 4;
+	return true;
+}
+
+static void appendNameValue(std::string& out, const char* name, size_t nameLen,
+							const char* value, size_t valueLen) {
+	appendLength(out, nameLen);
+	appendLength(out, valueLen);
+	out.append(name, nameLen);
+	out.append(value, valueLen);
+}
+
+// content 스트림을 MAX_CONTENT_LEN 단위 레코드들로 분할
+static void appendStream(std::string& out, unsigned char type, unsigned short requestId,
+						 const char* data, size_t len) {
+	size_t offset = 0;
+	while (offset < len) {
+		size_t chunk = len - offset;
+		if (chunk > MAX_CONTENT_LEN) {
+			chunk = MAX_CONTENT_LEN;
+		}
+		appendRecord(out, type, requestId, data + offset, chunk);
+		offset += chunk;
+	}
+}
+
+void appendRecord(std::string& out, unsigned char type, unsigned short requestId,
+				  const char* data, size_t len) {
+	// content를 8바이트 경계로 맞춤 (스펙 권장)
+	unsigned char padding = static_cast<unsigned char>((8 - (len % 8)) % 8);
+
+	char header[HEADER_LEN];
+	header[0] = static_cast<char>(VERSION_1);
+	header[1] = static_cast<char>(type);
+	header[2] = static_cast<char>((requestId >> 8) & 0xff);
+	header[3] = static_cast<char>(requestId & 0xff);
+	header[4] = static_cast<char>((len >> 8) & 0xff);
+	header[5] = static_cast<char>(len & 0xff);
+	header[6] = static_cast<char>(padding);
+	header[7] = 0;
+
+	out.append(header, HEADER_LEN);
+	if (len > 0) {
+		out.append(data, len);
+	}
+	out.append(padding, '\0');
+}
+
+void appendBeginRequest(std::string& out, unsigned short requestId, bool keepConn) {
+	char body[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+	body[0] = static_cast<char>((ROLE_RESPONDER >> 8) & 0xff);
+	body[1] = static_cast<char>(ROLE_RESPONDER & 0xff);
+	body[2] = keepConn ? static_cast<char>(FLAG_KEEP_CONN) : 0;
+	appendRecord(out, BEGIN_REQUEST, requestId, body, sizeof(body));
+}
+
+void appendAbortRequest(std::string& out, unsigned short requestId) {
+	appendRecord(out, ABORT_REQUEST, requestId, NULL, 0);
+}
+
+void appendParams(std::string& out, unsigned short requestId, const std::vector<std::string>& env) {
+	std::string encoded;
+	for (size_t i = 0; i < env.size(); ++i) {
+		const std::string& entry = env[i];
+		size_t eq = entry.find('=');
+		if (eq == std::string::npos || eq == 0) {
+			continue;
+		}
+		appendNameValue(encoded, entry.data(), eq, entry.data() + eq + 1, entry.length() - eq - 1);
+	}
+	appendStream(out, PARAMS, requestId, encoded.data(), encoded.length());
+	appendRecord(out, PARAMS, requestId, NULL, 0);
+}
+
+void appendStdin(std::string& out, unsigned short requestId, const char* data, size_t len,
+				 bool endOfStream) {
+	appendStream(out, STDIN, requestId, data, len);
+	if (endOfStream) {
+		appendRecord(out, STDIN, requestId, NULL, 0);
+	}
+}
+
+void appendGetValues(std::string& out, const std::vector<std::string>& names) {
+	std::string encoded;
+	for (size_t i = 0; i < names.size(); ++i) {
+		appendNameValue(encoded, names[i].data(), names[i].length(), "", 0);
+	}
+	appendRecord(out, GET_VALUES, 0, encoded.data(), encoded.length());
+}
+
+void setRequestId(std::string& records, unsigned short requestId) {
+	size_t pos = 0;
+	RecordHeader header;
+
+	while (parseHeader(records.data() + pos, records.length() - pos, header)) {
+		records[pos + 2] = static_cast<char>((requestId >> 8) & 0xff);
+		records[pos + 3] = static_cast<char>(requestId & 0xff);
+		pos += HEADER_LEN + header.contentLength + header.paddingLength;
+	}
+}
+
+bool parseHeader(const char* buf, size_t len, RecordHeader& header) {
+	if (len < HEADER_LEN) {
+		return false;
+	}
+	const unsigned char* p = reinterpret_cast<const unsigned char*>(buf);
+	header.version = p[0];
+	header.type = p[1];
+	header.requestId = static_cast<unsigned short>((p[2] << 8) | p[3]);
+	header.contentLength = static_cast<unsigned short>((p[4] << 8) | p[5]);
+	header.paddingLength = p[6];
+	return true;
+}
+
+bool parseNameValuePairs(const char* data, size_t len, std::map<std::string, std::string>& out) {
+	const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+	size_t pos = 0;
+
+	while (pos < len) {
+		size_t nameLen;
+		size_t valueLen;
+		if (!readLength(p, len, pos, nameLen) || !readLength(p, len, pos, valueLen)) {
+			return false;
+		}
+		if (nameLen > len - pos || valueLen > len - pos - nameLen) {
+			return false;
+		}
+		out[std::string(data + pos, nameLen)] = std::string(data + pos + nameLen, valueLen);
+		pos += nameLen + valueLen;
+	}
+	return true;
+}
+
+} // namespace FastCgi
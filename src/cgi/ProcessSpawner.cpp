@@ -0,0 +1,124 @@
+#include "cgi/ProcessSpawner.hpp"
+#include "webserv.hpp"
+#include <spawn.h>
+#include <signal.h>
+#include <cstdlib>
+
+extern char** environ;
+
+// chdir(2.29), closefrom(2.34) file action이 모두 있어야 posix_spawn으로 처리 가능
+#if defined(__GLIBC__) && defined(__GLIBC_PREREQ)
+# if __GLIBC_PREREQ(2, 34)
+#  define HAVE_SPAWN_FILE_ACTIONS_NP 1
+# endif
+#endif
+
+static int firstInheritedFd(const ProcessSpawner::Stdio& stdio) {
+	return (stdio.extra != -1 && stdio.extraTarget >= 3) ? stdio.extraTarget + 1 : 3;
+}
+
+#ifdef HAVE_SPAWN_FILE_ACTIONS_NP
+
+pid_t ProcessSpawner::spawn(const char* path, char* const argv[], char* const envp[],
+							const Stdio& stdio, const std::string& workDir) {
+	posix_spawn_file_actions_t actions;
+	int rc = ::posix_spawn_file_actions_init(&actions);
+	if (rc != 0) {
+		errno = rc;
+		return -1;
+	}
+
+	if (stdio.in != -1) {
+		rc = ::posix_spawn_file_actions_adddup2(&actions, stdio.in, STDIN_FILENO);
+	} else {
+		rc = ::posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+	}
+	if (rc == 0 && stdio.out != -1) {
+		rc = ::posix_spawn_file_actions_adddup2(&actions, stdio.out, STDOUT_FILENO);
+	} else if (rc == 0) {
+		rc = ::posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+	}
+	if (rc == 0 && stdio.err != -1) {
+		rc = ::posix_spawn_file_actions_adddup2(&actions, stdio.err, STDERR_FILENO);
+	}
+	if (rc == 0 && stdio.extra != -1) {
+		rc = ::posix_spawn_file_actions_adddup2(&actions, stdio.extra, stdio.extraTarget);
+	}
+	// 리슨 소켓, epoll, 클라이언트 소켓 등 서버 fd는 넘기지 않음
+	if (rc == 0) {
+		rc = ::posix_spawn_file_actions_addclosefrom_np(&actions, firstInheritedFd(stdio));
+	}
+	if (rc == 0 && !workDir.empty()) {
+		rc = ::posix_spawn_file_actions_addchdir_np(&actions, workDir.c_str());
+	}
+
+	// 서버가 무시하는 SIGPIPE는 자식에서 기본 동작으로 되돌림
+	posix_spawnattr_t attr;
+	bool hasAttr = false;
+	if (rc == 0) {
+		rc = ::posix_spawnattr_init(&attr);
+		hasAttr = (rc == 0);
+	}
+	if (rc == 0) {
+		sigset_t defaults;
+		::sigemptyset(&defaults);
+		::sigaddset(&defaults, SIGPIPE);
+		rc = ::posix_spawnattr_setsigdefault(&attr, &defaults);
+	}
+	if (rc == 0) {
+		rc = ::posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGDEF);
+	}
+
+	pid_t pid = -1;
+	if (rc == 0) {
+		rc = ::posix_spawn(&pid, path, &actions, &attr, argv, envp ? envp : environ);
+	}
+	if (hasAttr) {
+		::posix_spawnattr_destroy(&attr);
+	}
+	::posix_spawn_file_actions_destroy(&actions);
+
+	if (rc != 0) {
+		errno = rc;
+		return -1;
+	}
+	return pid;
+}
+
+#else
+
+// 구형 libc: fork 후 자식에서 같은 작업을 직접 수행 (자식에서는 할당하지 않음)
+pid_t ProcessSpawner::spawn(const char* path, char* const argv[], char* const envp[],
+							const Stdio& stdio, const std::string& workDir) {
+	const char* dir = workDir.empty() ? NULL : workDir.c_str();
+	long maxFd = ::sysconf(_SC_OPEN_MAX);
+	if (maxFd < 0 || maxFd > 65536) {
+		maxFd = 65536;
+	}
+
+	pid_t pid = ::fork();
+	if (pid != 0) {
+		return pid;
+	}
+
+	int devnull = ::open("/dev/null", O_RDWR);
+	::dup2(stdio.in != -1 ? stdio.in : devnull, STDIN_FILENO);
+	::dup2(stdio.out != -1 ? stdio.out : devnull, STDOUT_FILENO);
+	if (stdio.err != -1) {
+		::dup2(stdio.err, STDERR_FILENO);
+	}
+	if (stdio.extra != -1) {
+		::dup2(stdio.extra, stdio.extraTarget);
+	}
+	for (int fd = firstInheritedFd(stdio); fd < maxFd; ++fd) {
+		::close(fd);
+	}
+	::signal(SIGPIPE, SIG_DFL);
+	if (dir != NULL && ::chdir(dir) == -1) {
+		::_exit(127);
+	}
+	::execve(path, argv, envp ? envp : environ);
+	::_exit(127);
+}
+
+#endif
@@ -1,8 +1,18 @@
 #include "config/ConfApplicator.hpp"
 #include "http/HttpRequest.hpp"
+#include "http/RouteTable.hpp"
+#include "http/VirtualHostTable.hpp"
+#include "http/MimeTypes.hpp"
+#include "config/LocationCompiler.hpp"
+#include "tls/TlsContext.hpp"
+#include "log/AccessLog.hpp"
 #include <sstream>
+#include <map>
 
 ConfigDTO* ConfApplicator::_global_config = 0;
+std::vector<RouteTable*> ConfApplicator::_route_tables;
+VirtualHostTable* ConfApplicator::_virtual_hosts = 0;
+LocationCompiler* ConfApplicator::_location_compiler = 0;
 
 ConfApplicator::ConfApplicator() {}
 
@@ -20,7 +30,22 @@ bool ConfApplicator::applyConfig(Server* server, const ConfigDTO& config) {
 
 	std::vector<ServerContext>& servers = ConfApplicator::getGlobalConfig()->httpContext.serverContexts;
 
-	// 2. 각 server 블록의 listen 지시어를 Server 객체에 등록.
+	// 2. location을 요청 처리용 구조로 컴파일하고,
+	//    요청마다 location/server를 순회하지 않도록 라우팅 테이블과 vhost 테이블, MIME 테이블 구성.
+	buildRoutingTables();
+
+	// 3. listen ... ssl인 server 블록의 인증서를 모두 읽어 둠 (같은 포트의 다른 server 인증서도 SNI로 고름)
+	for (size_t i = 0; i < servers.size(); ++i) {
+		const ServerContext& serverCtx = servers[i];
+		if (!serverCtx.opListenDirective.empty() && serverCtx.opListenDirective[0].ssl
+			&& TlsContext::create(&serverCtx, serverCtx.opListenDirective[0].port) == NULL) {
+			return false;
+		}
+	}
+
+	// 4. 각 server 블록의 listen 지시어를 Server 객체에 등록.
+	//    같은 host:port를 공유하는 vhost들은 소켓 하나만 bind (ssl 여부도 같아야 함).
+	std::map<std::string, bool> bound;
 	for (size_t i = 0; i < servers.size(); ++i) {
 		ServerContext& serverCtx = servers[i];
 
@@ -36,15 +61,82 @@ bool ConfApplicator::applyConfig(Server* server, const ConfigDTO& config) {
 			continue;
 		}
 
-		if (!server->addListenPort(listen.host, listen.port)) {
+		std::stringstream key;
+		key << listen.host << ":" << listen.port;
+		std::map<std::string, bool>::iterator previous = bound.find(key.str());
+		if (previous != bound.end()) {
+			if (previous->second != listen.ssl) {
+				ERROR_LOG("listen " << key.str() << ": ssl must be set on every server block sharing the address");
+				return false;
+			}
+			continue;
+		}
+		bound[key.str()] = listen.ssl;
+
+		// SNI가 없거나 모르는 이름이면 그 포트의 기본 server 인증서로 응답
+		TlsContext* tls = NULL;
+		if (listen.ssl) {
+			tls = TlsContext::find(_virtual_hosts->find(listen.port, NULL, 0));
+			if (tls == NULL) {
+				tls = TlsContext::find(&serverCtx);
+			}
+		}
+
+		if (!server->addListenPort(listen.host, listen.port, tls)) {
 			ERROR_LOG("Failed to bind to " << listen.host << ":" << listen.port);
 			return false; // 포트 바인딩 실패
 		}
 	}
+
+	// 5. cgi_pool location의 워커를 미리 띄우고 (첫 요청부터 인터프리터 기동 비용 없이 처리),
+	//    cgi_max_concurrent location의 대기열을 등록 (요청 전에도 stub_status에 나옴)
+	for (size_t i = 0; i < servers.size(); ++i) {
+		const std::vector<LocationContext>& locations = servers[i].locationContexts;
+		for (size_t j = 0; j < locations.size(); ++j) {
+			if (locations[j].compiled->cgiPoolWorkers > 0) {
+				server->startCgiPool(locations[j].compiled);
+			}
+			if (locations[j].compiled->cgiMaxConcurrent > 0) {
+				server->startCgiQueue(&locations[j]);
+			}
+		}
+	}
+
+	// 6. proxy_pass/fastcgi_pass 주소를 모두 해석하고 upstream 그룹을 미리 만들어 첫 요청 전부터 health_check 시작
+	//    (이벤트 루프에서 블로킹 getaddrinfo를 하지 않도록, 해석하지 못하면 설정 오류)
+	for (size_t i = 0; i < servers.size(); ++i) {
+		const std::vector<LocationContext>& locations = servers[i].locationContexts;
+		for (size_t j = 0; j < locations.size(); ++j) {
+			if (!locations[j].compiled->proxyPass.empty() && !server->startUpstream(locations[j].compiled)) {
+				ERROR_LOG("proxy_pass " << locations[j].compiled->proxyPass << " in location " << locations[j].path
+						  << ": host not found");
+				return false;
+			}
+			if (!locations[j].compiled->fastcgiPass.empty() && !server->startFastCgiUpstream(locations[j].compiled)) {
+				ERROR_LOG("fastcgi_pass " << locations[j].compiled->fastcgiPass << " in location " << locations[j].path
+						  << ": host not found");
+				return false;
+			}
+		}
+	}
+
+	// 7. cache_zone을 만들어 이전 실행에서 디스크에 남은 응답 파일을 정리
+	const std::vector<CacheZoneDirective>& zones = ConfApplicator::getGlobalConfig()->httpContext.opCacheZoneDirective;
+	for (size_t i = 0; i < zones.size(); ++i) {
+		server->startCacheZone(&zones[i]);
+	}
+
+	// 8. access_log writer 스레드 시작 (location이 정해지기 전의 응답은 http 블록의 access_log로)
+	if (!AccessLog::start(ConfApplicator::getGlobalConfig()->httpContext.opAccessLogDirective)) {
+		ERROR_LOG("Failed to open access_log");
+		return false;
+	}
 	return true;
 }
 
 void ConfApplicator::setGlobalConfig(const ConfigDTO& config) {
+	// 테이블이 이전 설정의 location을 가리키므로 먼저 정리
+	clearRoutingTables();
 	if (_global_config != 0) {
 		delete _global_config;
 	}
@@ -54,3 +146,63 @@ void ConfApplicator::setGlobalConfig(const ConfigDTO& config) {
 ConfigDTO* ConfApplicator::getGlobalConfig() {
 	return _global_config;
 }
+
+void ConfApplicator::buildRoutingTables() {
+	clearRoutingTables();
+
+	_location_compiler = new LocationCompiler();
+	_location_compiler->compile(*_global_config);
+
+	const std::vector<ServerContext>& servers = _global_config->httpContext.serverContexts;
+	for (size_t i = 0; i < servers.size(); ++i) {
+		RouteTable* table = new RouteTable();
+		table->build(servers[i]);
+		_route_tables.push_back(table);
+	}
+
+	_virtual_hosts = new VirtualHostTable();
+	_virtual_hosts->build(servers);
+
+	MimeTypes::configure(_global_config->httpContext);
+}
+
+void ConfApplicator::clearRoutingTables() {
+	for (size_t i = 0; i < _route_tables.size(); ++i) {
+		delete _route_tables[i];
+	}
+	_route_tables.clear();
+
+	delete _virtual_hosts;
+	_virtual_hosts = 0;
+
+	delete _location_compiler;
+	_location_compiler = 0;
+
+	// 인증서 컨텍스트도 server 블록을 키로 쓰므로 함께 정리
+	TlsContext::clear();
+
+	// location이 가리키는 로그도 닫음 (쌓인 레코드는 모두 씀)
+	AccessLog::closeAll();
+}
+
+const RouteTable* ConfApplicator::getRouteTable(const ServerContext* server) {
+	if (_global_config == 0 || server == NULL) {
+		return NULL;
+	}
+
+	// serverContexts는 설정 적용 후 변경되지 않으므로 포인터 차로 인덱스를 구함
+	const std::vector<ServerContext>& servers = _global_config->httpContext.serverContexts;
+	if (servers.empty() || server < &servers[0] || server > &servers[servers.size() - 1]) {
+		return NULL;
+	}
+
+	size_t index = static_cast<size_t>(server - &servers[0]);
+	if (index >= _route_tables.size()) {
+		return NULL;
+	}
+	return _route_tables[index];
+}
+
+const VirtualHostTable* ConfApplicator::getVirtualHosts() {
+	return _virtual_hosts;
+}
@@ -37,6 +37,16 @@ void ConfCascader::cascadeHttpToServer(const HttpContext& http, ServerContext& s
 	cascadeDirective(http.opRootDirective, server.opRootDirective, "root");
 	cascadeDirective(http.opIndexDirective, server.opIndexDirective, "index");
 	cascadeErrorPage(http.opErrorPageDirective, server.opErrorPageDirective);
+	cascadeDirective(http.opGzipDirective, server.opGzipDirective, "gzip");
+	cascadeDirective(http.opGzipTypesDirective, server.opGzipTypesDirective, "gzip_types");
+	cascadeDirective(http.opGzipMinLengthDirective, server.opGzipMinLengthDirective, "gzip_min_length");
+	cascadeDirective(http.opGzipCompLevelDirective, server.opGzipCompLevelDirective, "gzip_comp_level");
+	cascadeDirective(http.opGzipStaticDirective, server.opGzipStaticDirective, "gzip_static");
+	cascadeDirective(http.opExpiresDirective, server.opExpiresDirective, "expires");
+	cascadeDirective(http.opAddHeaderDirective, server.opAddHeaderDirective, "add_header");
+	cascadeDirective(http.opAccessLogDirective, server.opAccessLogDirective, "access_log");
+	cascadeDirective(http.opServerTimingDirective, server.opServerTimingDirective, "server_timing");
+	cascadeDirective(http.opSlowRequestLogDirective, server.opSlowRequestLogDirective, "slow_request_log");
 }
 
 void ConfCascader::cascadeServerToLocation(const ServerContext& server, LocationContext& location) const {
@@ -45,6 +55,16 @@ void ConfCascader::cascadeServerToLocation(const ServerContext& server, Location
 	cascadeDirective(server.opIndexDirective, location.opIndexDirective, "index");
 	cascadeErrorPage(server.opErrorPageDirective, location.opErrorPageDirective);
 	cascadeDirective(server.opAutoindexDirective, location.opAutoindexDirective, "autoindex");
+	cascadeDirective(server.opGzipDirective, location.opGzipDirective, "gzip");
+	cascadeDirective(server.opGzipTypesDirective, location.opGzipTypesDirective, "gzip_types");
+	cascadeDirective(server.opGzipMinLengthDirective, location.opGzipMinLengthDirective, "gzip_min_length");
+	cascadeDirective(server.opGzipCompLevelDirective, location.opGzipCompLevelDirective, "gzip_comp_level");
+	cascadeDirective(server.opGzipStaticDirective, location.opGzipStaticDirective, "gzip_static");
+	cascadeDirective(server.opExpiresDirective, location.opExpiresDirective, "expires");
+	cascadeDirective(server.opAddHeaderDirective, location.opAddHeaderDirective, "add_header");
+	cascadeDirective(server.opAccessLogDirective, location.opAccessLogDirective, "access_log");
+	cascadeDirective(server.opServerTimingDirective, location.opServerTimingDirective, "server_timing");
+	cascadeDirective(server.opSlowRequestLogDirective, location.opSlowRequestLogDirective, "slow_request_log");
 }
 
 void ConfCascader::cascadeHttpToLocation(const HttpContext& http, LocationContext& location) const {
@@ -53,6 +73,16 @@ void ConfCascader::cascadeHttpToLocation(const HttpContext& http, LocationContex
 	cascadeDirective(http.opRootDirective, location.opRootDirective, "root");
 	cascadeDirective(http.opIndexDirective, location.opIndexDirective, "index");
 	cascadeErrorPage(http.opErrorPageDirective, location.opErrorPageDirective);
+	cascadeDirective(http.opGzipDirective, location.opGzipDirective, "gzip");
+	cascadeDirective(http.opGzipTypesDirective, location.opGzipTypesDirective, "gzip_types");
+	cascadeDirective(http.opGzipMinLengthDirective, location.opGzipMinLengthDirective, "gzip_min_length");
+	cascadeDirective(http.opGzipCompLevelDirective, location.opGzipCompLevelDirective, "gzip_comp_level");
+	cascadeDirective(http.opGzipStaticDirective, location.opGzipStaticDirective, "gzip_static");
+	cascadeDirective(http.opExpiresDirective, location.opExpiresDirective, "expires");
+	cascadeDirective(http.opAddHeaderDirective, location.opAddHeaderDirective, "add_header");
+	cascadeDirective(http.opAccessLogDirective, location.opAccessLogDirective, "access_log");
+	cascadeDirective(http.opServerTimingDirective, location.opServerTimingDirective, "server_timing");
+	cascadeDirective(http.opSlowRequestLogDirective, location.opSlowRequestLogDirective, "slow_request_log");
 }
 
 ServerContext ConfCascader::cascadeToServer(const HttpContext& http, const ServerContext& server) const {
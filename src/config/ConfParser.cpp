@@ -1,5 +1,7 @@
 #include "config/ConfParser.hpp"
 #include "http/StatusCode.hpp"
+#include "http/HttpMethod.hpp"
+#include "utils/StringUtils.hpp"
 #include <cctype>
 #include <stdexcept>
 #include <set>
@@ -119,6 +121,36 @@ void ConfParser::validateDirectiveContext(const std::string& directive, const st
 		throwError("'" + directive + "' directive is only allowed in location context");
 	}
 	
+	if (directive == "fastcgi_pass" && context != "location") {
+		throwError("'" + directive + "' directive is only allowed in location context");
+	}
+	
+	if ((directive == "proxy_pass" || directive == "proxy_connect_timeout"
+		 || directive == "proxy_read_timeout" || directive == "proxy_send_timeout")
+		&& context != "location") {
+		throwError("'" + directive + "' directive is only allowed in location context");
+	}
+	
+	if (directive == "cgi_pool" && context != "location") {
+		throwError("'" + directive + "' directive is only allowed in location context");
+	}
+	
+	if (directive == "cgi_nph" && context != "location") {
+		throwError("'" + directive + "' directive is only allowed in location context");
+	}
+	
+	if ((directive == "cgi_max_concurrent" || directive == "cgi_queue_size" || directive == "cgi_queue_timeout"
+		 || directive == "cgi_timeout" || directive == "cgi_circuit_breaker")
+		&& context != "location") {
+		throwError("'" + directive + "' directive is only allowed in location context");
+	}
+	
+	if ((directive == "cache" || directive == "cache_valid" || directive == "cache_key_header"
+		 || directive == "cache_stale")
+		&& context != "location") {
+		throwError("'" + directive + "' directive is only allowed in location context");
+	}
+	
 	// server 컨텍스트에서만 사용 가능한 지시어들
 	if (directive == "server_name" && context != "server") {
 		throwError("'" + directive + "' directive is only allowed in server context");
@@ -128,6 +160,10 @@ void ConfParser::validateDirectiveContext(const std::string& directive, const st
 		throwError("'" + directive + "' directive is only allowed in server context");
 	}
 	
+	if ((directive == "ssl_certificate" || directive == "ssl_certificate_key") && context != "server") {
+		throwError("'" + directive + "' directive is only allowed in server context");
+	}
+	
 	// http 컨텍스트에서 사용 불가능한 지시어들
 	if (directive == "server_name" && context == "http") {
 		throwError("'" + directive + "' directive is not allowed in http context");
@@ -253,6 +289,23 @@ std::string ConfParser::readWord() {
 		return word;
 	}
 	
+	// 따옴표로 묶은 값: 공백, ';' 등을 포함해 닫는 따옴표까지 (따옴표는 빼고)
+	if (config_content[current_pos] == '"' || config_content[current_pos] == '\'') {
+		char quote = config_content[current_pos++];
+		while (current_pos < config_content.length() && config_content[current_pos] != quote) {
+			if (config_content[current_pos] == '\n') {
+				current_line++;
+			}
+			word += config_content[current_pos];
+			current_pos++;
+		}
+		if (current_pos >= config_content.length()) {
+			throwError("Unterminated quoted string");
+		}
+		current_pos++;
+		return word;
+	}
+
 	// 일반 단어 읽기
 	while (current_pos < config_content.length() &&
 		   !std::isspace(config_content[current_pos]) &&
@@ -304,6 +357,14 @@ HttpContext ConfParser::parseHttpContext() {
 		
 		if (directive == "server") {
 			httpCtx.serverContexts.push_back(parseServerContext());
+		} else if (directive == "upstream") {
+			UpstreamContext upstream = parseUpstreamContext();
+			for (size_t i = 0; i < httpCtx.upstreamContexts.size(); ++i) {
+				if (httpCtx.upstreamContexts[i].name == upstream.name) {
+					throwError("Duplicate upstream '" + upstream.name + "'");
+				}
+			}
+			httpCtx.upstreamContexts.push_back(upstream);
 		} else if (directive == "client_max_body_size") {
 			checkDuplicateDirective(httpCtx.opBodySizeDirective, "client_max_body_size", "http");
 			validateDirectiveContext(directive, "http");
@@ -319,15 +380,315 @@ HttpContext ConfParser::parseHttpContext() {
 		} else if (directive == "error_page") {
 			validateDirectiveContext(directive, "http");
 			httpCtx.opErrorPageDirective.push_back(parseErrorPageDirective());
-		} else {
+		} else if (directive == "types") {
+			checkDuplicateDirective(httpCtx.opTypesDirective, "types", "http");
+			httpCtx.opTypesDirective.push_back(parseTypesDirective());
+		} else if (directive == "default_type") {
+			checkDuplicateDirective(httpCtx.opDefaultTypeDirective, "default_type", "http");
+			httpCtx.opDefaultTypeDirective.push_back(parseDefaultTypeDirective());
+		} else if (directive == "cache_zone") {
+			CacheZoneDirective zone = parseCacheZoneDirective();
+			for (size_t i = 0; i < httpCtx.opCacheZoneDirective.size(); ++i) {
+				if (httpCtx.opCacheZoneDirective[i].name == zone.name) {
+					throwError("Duplicate cache_zone '" + zone.name + "'");
+				}
+			}
+			httpCtx.opCacheZoneDirective.push_back(zone);
+		} else if (!parseGzipDirective(directive, "http", httpCtx)
+				   && !parseHeaderDirective(directive, "http", httpCtx)) {
 			throwError("Unknown directive '" + directive + "' in http context");
 		}
 	}
 	
 	expectToken("}");
+	resolveUpstreams(httpCtx);
+	resolveCacheZones(httpCtx);
 	return httpCtx;
 }
 
+// cache 지시어가 선언된 cache_zone을 가리키는지 확인
+void ConfParser::resolveCacheZones(const HttpContext& httpCtx) {
+	for (size_t i = 0; i < httpCtx.serverContexts.size(); ++i) {
+		const std::vector<LocationContext>& locations = httpCtx.serverContexts[i].locationContexts;
+
+		for (size_t j = 0; j < locations.size(); ++j) {
+			if (locations[j].opCacheDirective.empty()) {
+				continue;
+			}
+			const std::string& zone = locations[j].opCacheDirective[0].zone;
+			bool found = false;
+			for (size_t k = 0; k < httpCtx.opCacheZoneDirective.size() && !found; ++k) {
+				found = (httpCtx.opCacheZoneDirective[k].name == zone);
+			}
+			if (!found) {
+				throwError("Unknown cache_zone '" + zone + "' in location " + locations[j].path);
+			}
+		}
+	}
+}
+
+// proxy_pass http://name 이 upstream 블록을 가리키는지 확인 (블록은 server 뒤에 와도 됨)
+void ConfParser::resolveUpstreams(HttpContext& httpCtx) {
+	for (size_t i = 0; i < httpCtx.serverContexts.size(); ++i) {
+		std::vector<LocationContext>& locations = httpCtx.serverContexts[i].locationContexts;
+
+		for (size_t j = 0; j < locations.size(); ++j) {
+			if (locations[j].opProxyPassDirective.empty()) {
+				continue;
+			}
+			ProxyPassDirective& proxyPass = locations[j].opProxyPassDirective[0];
+			bool found = false;
+			for (size_t k = 0; k < httpCtx.upstreamContexts.size() && !found; ++k) {
+				found = (httpCtx.upstreamContexts[k].name == proxyPass.upstream);
+			}
+			if (!found) {
+				proxyPass.upstream.clear();
+			}
+		}
+	}
+}
+
+UpstreamContext ConfParser::parseUpstreamContext() {
+	expectToken("upstream");
+	std::string name = getCurrentToken();
+	if (name.empty() || name == "{" || name == ";") {
+		throwError("upstream directive requires a name");
+	}
+	getNextToken();
+	expectToken("{");
+
+	UpstreamContext upstreamCtx(name);
+	bool hasPolicy = false;
+
+	while (!isCurrentToken("}") && !getCurrentToken().empty()) {
+		std::string directive = getCurrentToken();
+
+		if (directive == "server") {
+			upstreamCtx.servers.push_back(parseUpstreamServerDirective());
+		} else if (directive == "least_conn" || directive == "hash") {
+			if (hasPolicy) {
+				throwError("Duplicate load balancing method in upstream '" + name + "'");
+			}
+			hasPolicy = true;
+			getNextToken();
+			if (directive == "least_conn") {
+				upstreamCtx.policy = UPSTREAM_LEAST_CONN;
+			} else {
+				// hash $request_uri; 또는 hash $cookie_NAME;
+				std::string key = getCurrentToken();
+				if (key == "$request_uri") {
+					upstreamCtx.hashCookie.clear();
+				} else if (key.compare(0, 8, "$cookie_") == 0 && key.length() > 8) {
+					upstreamCtx.hashCookie = key.substr(8);
+				} else {
+					throwError("hash key must be $request_uri or $cookie_NAME: " + key);
+				}
+				upstreamCtx.policy = UPSTREAM_HASH;
+				getNextToken();
+			}
+			expectToken(";");
+		} else if (directive == "health_check") {
+			checkDuplicateDirective(upstreamCtx.opHealthCheckDirective, "health_check", "upstream");
+			upstreamCtx.opHealthCheckDirective.push_back(parseHealthCheckDirective());
+		} else {
+			throwError("Unknown directive '" + directive + "' in upstream context");
+		}
+	}
+
+	if (upstreamCtx.servers.empty()) {
+		throwError("upstream '" + name + "' has no server");
+	}
+	expectToken("}");
+	return upstreamCtx;
+}
+
+// server host[:port]|unix:/path [weight=N] [max_fails=N] [fail_timeout=N[s]];
+UpstreamServerDirective ConfParser::parseUpstreamServerDirective() {
+	expectToken("server");
+	std::string value = getCurrentToken();
+
+	if (value.empty() || value == ";") {
+		throwError("server directive in upstream requires an address (host:port or unix:/path)");
+	}
+	if (value.compare(0, 5, "unix:") == 0) {
+		if (value.length() < 7 || value[5] != '/') {
+			throwError("upstream server unix socket path must be absolute: " + value);
+		}
+	} else if (value.find("://") != std::string::npos) {
+		throwError("upstream server address must not have a scheme: " + value);
+	}
+	UpstreamServerDirective server(value.compare(0, 5, "unix:") == 0
+								   ? value : normalizeHostPort(value, "upstream server", value));
+	getNextToken();
+
+	while (!isCurrentToken(";") && !getCurrentToken().empty()) {
+		std::string param = getCurrentToken();
+		if (param.compare(0, 7, "weight=") == 0) {
+			server.weight = parseParameterValue(param, 7, 1, 100, false);
+		} else if (param.compare(0, 10, "max_fails=") == 0) {
+			server.maxFails = parseParameterValue(param, 10, 0, 1000, false);
+		} else if (param.compare(0, 13, "fail_timeout=") == 0) {
+			server.failTimeout = parseParameterValue(param, 13, 1, 3600, true);
+		} else {
+			throwError("Unknown parameter in upstream server directive: " + param);
+		}
+		getNextToken();
+	}
+	expectToken(";");
+	return server;
+}
+
+// health_check [interval=N[s]] [uri=/path];
+HealthCheckDirective ConfParser::parseHealthCheckDirective() {
+	expectToken("health_check");
+	HealthCheckDirective healthCheck;
+
+	while (!isCurrentToken(";") && !getCurrentToken().empty()) {
+		std::string param = getCurrentToken();
+		if (param.compare(0, 9, "interval=") == 0) {
+			healthCheck.interval = parseParameterValue(param, 9, 1, 3600, true);
+		} else if (param.compare(0, 4, "uri=") == 0 && param.length() > 4 && param[4] == '/') {
+			healthCheck.uri = param.substr(4);
+		} else {
+			throwError("Invalid parameter in health_check directive: " + param);
+		}
+		getNextToken();
+	}
+	expectToken(";");
+	return healthCheck;
+}
+
+// cache_zone name size [max_entry=size] [path=/dir] [disk=size];
+CacheZoneDirective ConfParser::parseCacheZoneDirective() {
+	expectToken("cache_zone");
+	std::string name = getCurrentToken();
+	if (name.empty() || name == ";") {
+		throwError("cache_zone directive requires a name and a size");
+	}
+	std::string size = getNextToken();
+	if (!isValidBodySize(size) || StringUtils::toBytes(size) == 0) {
+		throwError("Invalid size in cache_zone directive: " + size);
+	}
+	CacheZoneDirective zone(name, StringUtils::toBytes(size));
+	getNextToken();
+
+	while (!isCurrentToken(";") && !getCurrentToken().empty()) {
+		std::string param = getCurrentToken();
+		if (param.compare(0, 10, "max_entry=") == 0 && isValidBodySize(param.substr(10))) {
+			zone.maxEntry = StringUtils::toBytes(param.substr(10));
+		} else if (param.compare(0, 5, "disk=") == 0 && isValidBodySize(param.substr(5))) {
+			zone.diskSize = StringUtils::toBytes(param.substr(5));
+		} else if (param.compare(0, 5, "path=") == 0 && param.length() > 6 && param[5] == '/') {
+			zone.path = param.substr(5);
+		} else {
+			throwError("Invalid parameter in cache_zone directive: " + param);
+		}
+		getNextToken();
+	}
+	expectToken(";");
+
+	if (zone.maxEntry == 0 || zone.maxEntry > zone.size) {
+		throwError("cache_zone max_entry must be between 1 and the zone size");
+	}
+	// 디스크 크기를 따로 주지 않으면 메모리의 10배까지 내려 둠
+	if (!zone.path.empty() && zone.diskSize == 0) {
+		zone.diskSize = zone.size * 10;
+	}
+	return zone;
+}
+
+CacheDirective ConfParser::parseCacheDirective() {
+	expectToken("cache");
+	std::string zone = getCurrentToken();
+	if (zone.empty() || zone == ";") {
+		throwError("cache directive requires a cache_zone name");
+	}
+	getNextToken();
+	expectToken(";");
+	return CacheDirective(zone);
+}
+
+// cache_valid [code ...|any] time;  (코드를 생략하면 200 301 302)
+CacheValidDirective ConfParser::parseCacheValidDirective() {
+	expectToken("cache_valid");
+	std::vector<std::string> values;
+	while (!isCurrentToken(";") && !getCurrentToken().empty()) {
+		values.push_back(getCurrentToken());
+		getNextToken();
+	}
+	expectToken(";");
+	if (values.empty()) {
+		throwError("cache_valid directive requires a time");
+	}
+
+	std::string original = values.back();
+	std::string time = original;
+	values.pop_back();
+	if (time.length() > 1 && time[time.length() - 1] == 's') {
+		time.erase(time.length() - 1);
+	}
+	if (time.empty() || time.length() > 9 || time.find_first_not_of("0123456789") != std::string::npos
+		|| std::atol(time.c_str()) < 1) {
+		throwError("Invalid time in cache_valid directive: " + original);
+	}
+
+	std::vector<int> codes;
+	for (size_t i = 0; i < values.size(); ++i) {
+		if (values[i] == "any") {
+			codes.push_back(0);
+			continue;
+		}
+		int code = std::atoi(values[i].c_str());
+		if (values[i].find_first_not_of("0123456789") != std::string::npos || code < 200 || code > 599) {
+			throwError("Invalid status code in cache_valid directive: " + values[i]);
+		}
+		codes.push_back(code);
+	}
+	if (codes.empty()) {
+		codes.push_back(200);
+		codes.push_back(301);
+		codes.push_back(302);
+	}
+	return CacheValidDirective(codes, static_cast<size_t>(std::atol(time.c_str())));
+}
+
+std::vector<CacheKeyHeaderDirective> ConfParser::parseCacheKeyHeaderDirective() {
+	expectToken("cache_key_header");
+	std::vector<CacheKeyHeaderDirective> headers;
+	while (!isCurrentToken(";") && !getCurrentToken().empty()) {
+		std::string name = getCurrentToken();
+		std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+		headers.push_back(CacheKeyHeaderDirective(name));
+		getNextToken();
+	}
+	expectToken(";");
+	if (headers.empty()) {
+		throwError("cache_key_header directive requires at least one header name");
+	}
+	return headers;
+}
+
+// name=N 형식 파라미터의 숫자 (seconds면 's' 접미사 허용)
+size_t ConfParser::parseParameterValue(const std::string& param, size_t prefixLength,
+									   size_t minValue, size_t maxValue, bool seconds) {
+	std::string digits = param.substr(prefixLength);
+	if (seconds && digits.length() > 1 && digits[digits.length() - 1] == 's') {
+		digits.erase(digits.length() - 1);
+	}
+	if (digits.empty() || digits.length() > 9 || digits.find_first_not_of("0123456789") != std::string::npos) {
+		throwError("Invalid value in parameter: " + param);
+	}
+
+	size_t value = static_cast<size_t>(std::atol(digits.c_str()));
+	if (value < minValue || value > maxValue) {
+		std::stringstream ss;
+		ss << param.substr(0, prefixLength - 1) << " must be between " << minValue << " and " << maxValue
+		   << ": " << param;
+		throwError(ss.str());
+	}
+	return value;
+}
+
 ServerContext ConfParser::parseServerContext() {
 	ServerContext serverCtx;
 	
@@ -343,10 +704,19 @@ ServerContext ConfParser::parseServerContext() {
 			checkDuplicateDirective(serverCtx.opListenDirective, "listen", "server");
 			validateDirectiveContext(directive, "server");
 			serverCtx.opListenDirective.push_back(parseListenDirective());
+		} else if (directive == "ssl_certificate") {
+			checkDuplicateDirective(serverCtx.opSslCertificateDirective, "ssl_certificate", "server");
+			validateDirectiveContext(directive, "server");
+			serverCtx.opSslCertificateDirective.push_back(SslCertificateDirective(parseFileDirective(directive)));
+		} else if (directive == "ssl_certificate_key") {
+			checkDuplicateDirective(serverCtx.opSslCertificateKeyDirective, "ssl_certificate_key", "server");
+			validateDirectiveContext(directive, "server");
+			serverCtx.opSslCertificateKeyDirective.push_back(SslCertificateKeyDirective(parseFileDirective(directive)));
 		} else if (directive == "server_name") {
 			checkDuplicateDirective(serverCtx.opServerNameDirective, "server_name", "server");
 			validateDirectiveContext(directive, "server");
-			serverCtx.opServerNameDirective.push_back(parseServerNameDirective());
+			std::vector<ServerNameDirective> names = parseServerNameDirective();
+			serverCtx.opServerNameDirective.insert(serverCtx.opServerNameDirective.end(), names.begin(), names.end());
 		} else if (directive == "client_max_body_size") {
 			checkDuplicateDirective(serverCtx.opBodySizeDirective, "client_max_body_size", "server");
 			validateDirectiveContext(directive, "server");
@@ -370,7 +740,8 @@ ServerContext ConfParser::parseServerContext() {
 		} else if (directive == "error_page") {
 			validateDirectiveContext(directive, "server");
 			serverCtx.opErrorPageDirective.push_back(parseErrorPageDirective());
-		} else {
+		} else if (!parseGzipDirective(directive, "server", serverCtx)
+				   && !parseHeaderDirective(directive, "server", serverCtx)) {
 			throwError("Unknown directive '" + directive + "' in server context");
 		}
 	}
@@ -380,6 +751,10 @@ ServerContext ConfParser::parseServerContext() {
 		parseListenAddress(defaultListen);
 		serverCtx.opListenDirective.push_back(defaultListen);
 	}
+	if (serverCtx.opListenDirective[0].ssl
+		&& (serverCtx.opSslCertificateDirective.empty() || serverCtx.opSslCertificateKeyDirective.empty())) {
+		throwError("listen ... ssl requires ssl_certificate and ssl_certificate_key in the same server block");
+	}
 	expectToken("}");
 	return serverCtx;
 }
@@ -454,6 +829,78 @@ LocationContext ConfParser::parseLocationContext() {
 			checkDuplicateDirective(locationCtx.opCgiPassDirective, "cgi_pass", "location");
 			validateDirectiveContext(directive, "location");
 			locationCtx.opCgiPassDirective.push_back(parseCgiPassDirective());
+		} else if (directive == "fastcgi_pass") {
+			checkDuplicateDirective(locationCtx.opFastCgiPassDirective, "fastcgi_pass", "location");
+			validateDirectiveContext(directive, "location");
+			locationCtx.opFastCgiPassDirective.push_back(parseFastCgiPassDirective());
+		} else if (directive == "proxy_pass") {
+			checkDuplicateDirective(locationCtx.opProxyPassDirective, "proxy_pass", "location");
+			validateDirectiveContext(directive, "location");
+			locationCtx.opProxyPassDirective.push_back(parseProxyPassDirective());
+		} else if (directive == "proxy_connect_timeout") {
+			checkDuplicateDirective(locationCtx.opProxyConnectTimeoutDirective, "proxy_connect_timeout", "location");
+			validateDirectiveContext(directive, "location");
+			locationCtx.opProxyConnectTimeoutDirective.push_back(
+				ProxyTimeoutDirective(parseCountDirective("proxy_connect_timeout", 1, 3600)));
+		} else if (directive == "proxy_read_timeout") {
+			checkDuplicateDirective(locationCtx.opProxyReadTimeoutDirective, "proxy_read_timeout", "location");
+			validateDirectiveContext(directive, "location");
+			locationCtx.opProxyReadTimeoutDirective.push_back(
+				ProxyTimeoutDirective(parseCountDirective("proxy_read_timeout", 1, 3600)));
+		} else if (directive == "proxy_send_timeout") {
+			checkDuplicateDirective(locationCtx.opProxySendTimeoutDirective, "proxy_send_timeout", "location");
+			validateDirectiveContext(directive, "location");
+			locationCtx.opProxySendTimeoutDirective.push_back(
+				ProxyTimeoutDirective(parseCountDirective("proxy_send_timeout", 1, 3600)));
+		} else if (directive == "cgi_pool") {
+			checkDuplicateDirective(locationCtx.opCgiPoolDirective, "cgi_pool", "location");
+			validateDirectiveContext(directive, "location");
+			locationCtx.opCgiPoolDirective.push_back(parseCgiPoolDirective());
+		} else if (directive == "cgi_nph") {
+			checkDuplicateDirective(locationCtx.opCgiNphDirective, "cgi_nph", "location");
+			validateDirectiveContext(directive, "location");
+			locationCtx.opCgiNphDirective.push_back(parseCgiNphDirective());
+		} else if (directive == "cgi_max_concurrent") {
+			checkDuplicateDirective(locationCtx.opCgiMaxConcurrentDirective, "cgi_max_concurrent", "location");
+			validateDirectiveContext(directive, "location");
+			locationCtx.opCgiMaxConcurrentDirective.push_back(
+				CgiMaxConcurrentDirective(parseCountDirective("cgi_max_concurrent", 1, 4096)));
+		} else if (directive == "cgi_queue_size") {
+			checkDuplicateDirective(locationCtx.opCgiQueueSizeDirective, "cgi_queue_size", "location");
+			validateDirectiveContext(directive, "location");
+			locationCtx.opCgiQueueSizeDirective.push_back(
+				CgiQueueSizeDirective(parseCountDirective("cgi_queue_size", 0, 65536)));
+		} else if (directive == "cgi_queue_timeout") {
+			checkDuplicateDirective(locationCtx.opCgiQueueTimeoutDirective, "cgi_queue_timeout", "location");
+			validateDirectiveContext(directive, "location");
+			locationCtx.opCgiQueueTimeoutDirective.push_back(
+				CgiQueueTimeoutDirective(parseCountDirective("cgi_queue_timeout", 1, 3600)));
+		} else if (directive == "cgi_timeout") {
+			checkDuplicateDirective(locationCtx.opCgiTimeoutDirective, "cgi_timeout", "location");
+			validateDirectiveContext(directive, "location");
+			locationCtx.opCgiTimeoutDirective.push_back(
+				CgiTimeoutDirective(parseCountDirective("cgi_timeout", 1, 3600)));
+		} else if (directive == "cache") {
+			checkDuplicateDirective(locationCtx.opCacheDirective, "cache", "location");
+			validateDirectiveContext(directive, "location");
+			locationCtx.opCacheDirective.push_back(parseCacheDirective());
+		} else if (directive == "cache_valid") {
+			validateDirectiveContext(directive, "location");
+			locationCtx.opCacheValidDirective.push_back(parseCacheValidDirective());
+		} else if (directive == "cache_key_header") {
+			validateDirectiveContext(directive, "location");
+			std::vector<CacheKeyHeaderDirective> headers = parseCacheKeyHeaderDirective();
+			locationCtx.opCacheKeyHeaderDirective.insert(locationCtx.opCacheKeyHeaderDirective.end(),
+														 headers.begin(), headers.end());
+		} else if (directive == "cache_stale") {
+			checkDuplicateDirective(locationCtx.opCacheStaleDirective, "cache_stale", "location");
+			validateDirectiveContext(directive, "location");
+			locationCtx.opCacheStaleDirective.push_back(
+				CacheStaleDirective(parseCountDirective("cache_stale", 1, 86400)));
+		} else if (directive == "cgi_circuit_breaker") {
+			checkDuplicateDirective(locationCtx.opCgiCircuitBreakerDirective, "cgi_circuit_breaker", "location");
+			validateDirectiveContext(directive, "location");
+			locationCtx.opCgiCircuitBreakerDirective.push_back(parseCgiCircuitBreakerDirective());
 		} else if (directive == "client_max_body_size") {
 			checkDuplicateDirective(locationCtx.opBodySizeDirective, "client_max_body_size", "location");
 			validateDirectiveContext(directive, "location");
@@ -461,11 +908,70 @@ LocationContext ConfParser::parseLocationContext() {
 		} else if (directive == "error_page") {
 			validateDirectiveContext(directive, "location");
 			locationCtx.opErrorPageDirective.push_back(parseErrorPageDirective());
-		} else {
+		} else if (directive == "immutable_assets") {
+			checkDuplicateDirective(locationCtx.opImmutableAssetsDirective, "immutable_assets", "location");
+			locationCtx.opImmutableAssetsDirective.push_back(
+				ImmutableAssetsDirective(parseSwitchDirective("immutable_assets")));
+		} else if (directive == "stub_status") {
+			checkDuplicateDirective(locationCtx.opStubStatusDirective, "stub_status", "location");
+			expectToken("stub_status");
+			expectToken(";");
+			locationCtx.opStubStatusDirective.push_back(StubStatusDirective());
+		} else if (!parseGzipDirective(directive, "location", locationCtx)
+				   && !parseHeaderDirective(directive, "location", locationCtx)) {
 			throwError("Unknown directive '" + directive + "' in location context");
 		}
 	}
 
+	if (!locationCtx.opCgiPassDirective.empty() && !locationCtx.opFastCgiPassDirective.empty()) {
+		throwError("'cgi_pass' and 'fastcgi_pass' directives cannot be used together in the same location context");
+	}
+
+	// proxy_pass location은 요청을 업스트림 HTTP 서버로만 넘김
+	if (!locationCtx.opProxyPassDirective.empty()
+		&& (!locationCtx.opCgiPassDirective.empty() || !locationCtx.opFastCgiPassDirective.empty())) {
+		throwError("'proxy_pass' cannot be used together with 'cgi_pass' or 'fastcgi_pass' in the same location context");
+	}
+	if ((!locationCtx.opProxyConnectTimeoutDirective.empty() || !locationCtx.opProxyReadTimeoutDirective.empty()
+		 || !locationCtx.opProxySendTimeoutDirective.empty()) && locationCtx.opProxyPassDirective.empty()) {
+		throwError("proxy timeout directives require 'proxy_pass' in the same location context");
+	}
+
+	// cgi_pool은 cgi_pass로 실행하던 스크립트를 상주 워커로 옮기는 옵션
+	if (!locationCtx.opCgiPoolDirective.empty() && locationCtx.opCgiPassDirective.empty()) {
+		throwError("'cgi_pool' directive requires 'cgi_pass' in the same location context");
+	}
+
+	if (!locationCtx.opCgiNphDirective.empty() && locationCtx.opCgiPassDirective.empty()) {
+		throwError("'cgi_nph' directive requires 'cgi_pass' in the same location context");
+	}
+
+	// 대기열은 cgi_max_concurrent 한도를 넘은 요청에만 쓰임
+	if (!locationCtx.opCgiMaxConcurrentDirective.empty() && locationCtx.opCgiPassDirective.empty()) {
+		throwError("'cgi_max_concurrent' directive requires 'cgi_pass' in the same location context");
+	}
+	if ((!locationCtx.opCgiQueueSizeDirective.empty() || !locationCtx.opCgiQueueTimeoutDirective.empty())
+		&& locationCtx.opCgiMaxConcurrentDirective.empty()) {
+		throwError("'cgi_queue_size' and 'cgi_queue_timeout' directives require 'cgi_max_concurrent' in the same location context");
+	}
+	if (!locationCtx.opCgiTimeoutDirective.empty()
+		&& locationCtx.opCgiPassDirective.empty() && locationCtx.opFastCgiPassDirective.empty()) {
+		throwError("'cgi_timeout' directive requires 'cgi_pass' or 'fastcgi_pass' in the same location context");
+	}
+	if (!locationCtx.opCgiCircuitBreakerDirective.empty() && locationCtx.opCgiPassDirective.empty()) {
+		throwError("'cgi_circuit_breaker' directive requires 'cgi_pass' in the same location context");
+	}
+
+	// 캐시는 CGI/FastCGI/프록시 응답에만 적용됨
+	if (!locationCtx.opCacheDirective.empty() && locationCtx.opCgiPassDirective.empty()
+		&& locationCtx.opFastCgiPassDirective.empty() && locationCtx.opProxyPassDirective.empty()) {
+		throwError("'cache' directive requires 'cgi_pass', 'fastcgi_pass' or 'proxy_pass' in the same location context");
+	}
+	if ((!locationCtx.opCacheValidDirective.empty() || !locationCtx.opCacheKeyHeaderDirective.empty()
+		 || !locationCtx.opCacheStaleDirective.empty()) && locationCtx.opCacheDirective.empty()) {
+		throwError("cache_valid, cache_key_header and cache_stale directives require 'cache' in the same location context");
+	}
+
 	// root와 alias가 동시에 존재하는지 검증
 	if (!locationCtx.opRootDirective.empty() && !locationCtx.opAliasDirective.empty()) {
 		throwError("'root' and 'alias' directives cannot be used together in the same location context");
@@ -499,22 +1005,28 @@ ListenDirective ConfParser::parseListenDirective() {
 
     getNextToken();
     
+    // listen 443 ssl default_server; (파라미터 순서는 자유)
     bool default_server = false;
-    if (isCurrentToken("default_server")) {
-        default_server = true;
+    bool ssl = false;
+    while (isCurrentToken("default_server") || isCurrentToken("ssl")) {
+        bool& flag = isCurrentToken("ssl") ? ssl : default_server;
+        if (flag) {
+            throwError("Duplicate listen parameter: " + getCurrentToken());
+        }
+        flag = true;
         getNextToken();
     }
     
     expectToken(";");
     
     // 파싱 단계에서 address를 host/port로 분해후 할당
-    ListenDirective directive(address, default_server);
+    ListenDirective directive(address, default_server, ssl);
     parseListenAddress(directive);  // 파싱 함수 호출
 
     return directive;
 }
 
-ServerNameDirective ConfParser::parseServerNameDirective() {
+std::vector<ServerNameDirective> ConfParser::parseServerNameDirective() {
 	expectToken("server_name");
 	
 	std::string name = getCurrentToken();
@@ -522,16 +1034,27 @@ ServerNameDirective ConfParser::parseServerNameDirective() {
 		throwError("server_name directive requires a value");
 	}
 	
-	getNextToken();
-	
-	// 추가 server_name이 있으면 에러
-	if (!isCurrentToken(";")) {
-		std::string extra_name = getCurrentToken();
-		throwError("server_name directive accepts only one value, got: '" + extra_name + "'");
+	// server_name a.com *.a.com www.a.* ; (여러 이름 허용)
+	std::vector<ServerNameDirective> names;
+	while (!isCurrentToken(";") && !getCurrentToken().empty()) {
+		name = getCurrentToken();
+
+		// 와일드카드는 맨 앞("*.a.com") 또는 맨 뒤("www.a.*")에만 허용
+		size_t star = name.find('*');
+		if (star != std::string::npos) {
+			bool leading = (star == 0 && name.length() > 2 && name[1] == '.');
+			bool trailing = (star == name.length() - 1 && name.length() > 2 && name[star - 1] == '.');
+			if ((!leading && !trailing) || name.find('*', star + 1) != std::string::npos) {
+				throwError("Invalid server_name wildcard: '" + name + "'");
+			}
+		}
+
+		names.push_back(ServerNameDirective(name));
+		getNextToken();
 	}
 	
 	expectToken(";");
-	return ServerNameDirective(name);
+	return names;
 }
 
 ReturnDirective ConfParser::parseReturnDirective() {
@@ -561,6 +1084,19 @@ ReturnDirective ConfParser::parseReturnDirective() {
 	return ReturnDirective(code, url);
 }
 
+// ssl_certificate 등 파일 경로 하나를 받는 지시어 (상대 경로는 실행 디렉터리 기준)
+std::string ConfParser::parseFileDirective(const std::string& directive) {
+	expectToken(directive);
+	std::string path = getCurrentToken();
+
+	if (path.empty() || path == ";") {
+		throwError(directive + " directive requires a file path");
+	}
+	getNextToken();
+	expectToken(";");
+	return path;
+}
+
 RootDirective ConfParser::parseRootDirective() {
 	expectToken("root");
 	std::string path = getCurrentToken();
@@ -636,6 +1172,420 @@ CgiPassDirective ConfParser::parseCgiPassDirective() {
 	return CgiPassDirective(path);
 }
 
+FastCgiPassDirective ConfParser::parseFastCgiPassDirective() {
+	expectToken("fastcgi_pass");
+	std::string address = getCurrentToken();
+
+	if (address.empty() || address == ";") {
+		throwError("fastcgi_pass directive requires an address (unix:/path or host:port)");
+	}
+
+	if (address.compare(0, 5, "unix:") == 0) {
+		if (address.length() < 7 || address[5] != '/') {
+			throwError("fastcgi_pass unix socket path must be absolute: " + address);
+		}
+	} else {
+		size_t colon = address.rfind(':');
+		if (colon == std::string::npos || colon == 0 || colon + 1 == address.length()) {
+			throwError("fastcgi_pass address must be unix:/path or host:port: " + address);
+		}
+		for (size_t i = colon + 1; i < address.length(); ++i) {
+			if (!std::isdigit(address[i])) {
+				throwError("Invalid port in fastcgi_pass address: " + address);
+			}
+		}
+		int port = std::atoi(address.c_str() + colon + 1);
+		if (port <= 0 || port > 65535) {
+			throwError("Invalid port in fastcgi_pass address: " + address);
+		}
+	}
+
+	getNextToken();
+	expectToken(";");
+	return FastCgiPassDirective(address);
+}
+
+// proxy_pass http://host:port[/uri]; 또는 proxy_pass unix:/path;
+ProxyPassDirective ConfParser::parseProxyPassDirective() {
+	expectToken("proxy_pass");
+	std::string value = getCurrentToken();
+
+	if (value.empty() || value == ";") {
+		throwError("proxy_pass directive requires an address (http://host:port or unix:/path)");
+	}
+
+	std::string address;
+	std::string uri;
+	std::string upstream;
+	if (value.compare(0, 5, "unix:") == 0) {
+		if (value.length() < 7 || value[5] != '/') {
+			throwError("proxy_pass unix socket path must be absolute: " + value);
+		}
+		address = value;
+	} else {
+		if (value.compare(0, 7, "http://") != 0) {
+			throwError("proxy_pass address must start with http:// or unix: " + value);
+		}
+		std::string hostPort = value.substr(7);
+		size_t slash = hostPort.find('/');
+		if (slash != std::string::npos) {
+			uri = hostPort.substr(slash);
+			hostPort.erase(slash);
+		}
+		// 포트 없는 이름은 upstream 블록일 수 있음 (http 블록을 다 읽은 뒤 확인)
+		if (!hostPort.empty() && hostPort.find(':') == std::string::npos && hostPort[0] != '[') {
+			upstream = hostPort;
+		}
+		address = normalizeHostPort(hostPort, "proxy_pass", value);
+	}
+
+	getNextToken();
+	expectToken(";");
+	ProxyPassDirective directive(address, uri);
+	directive.upstream = upstream;
+	return directive;
+}
+
+// host[:port] 검증, 포트가 없으면 80 ([::1] 형식은 ']' 뒤의 ':'만 포트 구분자)
+std::string ConfParser::normalizeHostPort(const std::string& hostPort, const std::string& directive,
+										  const std::string& value) {
+	std::string address = hostPort;
+	size_t colon = address.rfind(':');
+	size_t bracket = address.rfind(']');
+	if (colon == std::string::npos || (bracket != std::string::npos && colon < bracket)) {
+		address += ":80";
+		colon = address.rfind(':');
+	}
+	if (colon == 0 || colon + 1 == address.length()) {
+		throwError("Invalid " + directive + " address: " + value);
+	}
+	for (size_t i = colon + 1; i < address.length(); ++i) {
+		if (!std::isdigit(address[i])) {
+			throwError("Invalid port in " + directive + " address: " + value);
+		}
+	}
+	int port = std::atoi(address.c_str() + colon + 1);
+	if (port <= 0 || port > 65535) {
+		throwError("Invalid port in " + directive + " address: " + value);
+	}
+	return address;
+}
+
+CgiPoolDirective ConfParser::parseCgiPoolDirective() {
+	expectToken("cgi_pool");
+	std::string workers = getCurrentToken();
+
+	if (workers.empty() || workers == ";") {
+		throwError("cgi_pool directive requires a worker count");
+	}
+	if (workers.find_first_not_of("0123456789") != std::string::npos) {
+		throwError("Invalid worker count in cgi_pool directive: " + workers);
+	}
+	int workerCount = std::atoi(workers.c_str());
+	if (workerCount < 1 || workerCount > 64) {
+		throwError("cgi_pool worker count must be between 1 and 64: " + workers);
+	}
+	getNextToken();
+
+	// 선택: 워커 교체 주기 (요청 수)
+	int maxRequests = 0;
+	std::string token = getCurrentToken();
+	if (token != ";") {
+		if (token.empty() || token.find_first_not_of("0123456789") != std::string::npos) {
+			throwError("Invalid max requests in cgi_pool directive: " + token);
+		}
+		maxRequests = std::atoi(token.c_str());
+		if (maxRequests < 1) {
+			throwError("cgi_pool max requests must be at least 1: " + token);
+		}
+		getNextToken();
+	}
+
+	expectToken(";");
+	return CgiPoolDirective(workerCount, maxRequests);
+}
+
+CgiNphDirective ConfParser::parseCgiNphDirective() {
+	expectToken("cgi_nph");
+	std::string value = getCurrentToken();
+
+	if (value.empty() || value == ";") {
+		throwError("cgi_nph directive requires a value (on/off)");
+	}
+
+	if (!isBooleanValue(value)) {
+		throwError("cgi_nph directive accepts only: on, off, true, false, 1, 0");
+	}
+
+	getNextToken();
+	expectToken(";");
+	return CgiNphDirective(parseBoolean(value));
+}
+
+// on/off 하나를 받는 지시어
+bool ConfParser::parseSwitchDirective(const std::string& directive) {
+	expectToken(directive);
+	std::string value = getCurrentToken();
+
+	if (value.empty() || value == ";") {
+		throwError(directive + " directive requires a value (on/off)");
+	}
+	if (!isBooleanValue(value)) {
+		throwError(directive + " directive accepts only: on, off, true, false, 1, 0");
+	}
+
+	getNextToken();
+	expectToken(";");
+	return parseBoolean(value);
+}
+
+// gzip_types mime/type ...;  ("*"이면 모든 타입)
+GzipTypesDirective ConfParser::parseGzipTypesDirective() {
+	expectToken("gzip_types");
+	std::vector<std::string> types;
+	types.push_back("text/html");
+
+	while (!isCurrentToken(";") && !getCurrentToken().empty()) {
+		std::string type = getCurrentToken();
+		std::transform(type.begin(), type.end(), type.begin(), ::tolower);
+		if (type != "*" && type.find('/') == std::string::npos) {
+			throwError("Invalid MIME type in gzip_types directive: " + type);
+		}
+		types.push_back(type);
+		getNextToken();
+	}
+	expectToken(";");
+	if (types.size() == 1) {
+		throwError("gzip_types directive requires at least one MIME type");
+	}
+	return GzipTypesDirective(types);
+}
+
+// expires off|epoch|max|[-]time;  (time은 초, 또는 s/m/h/d 단위)
+ExpiresDirective ConfParser::parseExpiresDirective() {
+	expectToken("expires");
+	std::string value = getCurrentToken();
+
+	if (value.empty() || value == ";") {
+		throwError("expires directive requires a value");
+	}
+	getNextToken();
+	expectToken(";");
+
+	if (value == "off") {
+		return ExpiresDirective(EXPIRES_OFF, 0);
+	}
+	if (value == "epoch") {
+		return ExpiresDirective(EXPIRES_EPOCH, 0);
+	}
+	if (value == "max") {
+		return ExpiresDirective(EXPIRES_MAX, 0);
+	}
+
+	std::string digits = value;
+	bool negative = (digits[0] == '-');
+	if (negative) {
+		digits.erase(0, 1);
+	}
+	long unit = 1;
+	if (!digits.empty()) {
+		switch (digits[digits.length() - 1]) {
+			case 's': unit = 1; break;
+			case 'm': unit = 60; break;
+			case 'h': unit = 3600; break;
+			case 'd': unit = 86400; break;
+			default: unit = 0; break;
+		}
+		if (unit != 0) {
+			digits.erase(digits.length() - 1);
+		} else {
+			unit = 1;
+		}
+	}
+	if (digits.empty() || digits.length() > 9 || digits.find_first_not_of("0123456789") != std::string::npos
+		|| std::atol(digits.c_str()) * unit > 10L * 365 * 86400) {
+		throwError("Invalid time in expires directive: " + value);
+	}
+	long seconds = std::atol(digits.c_str()) * unit;
+	return ExpiresDirective(EXPIRES_TIME, negative ? -seconds : seconds);
+}
+
+// add_header name value [always];
+AddHeaderDirective ConfParser::parseAddHeaderDirective() {
+	expectToken("add_header");
+	std::vector<std::string> values;
+	while (!isCurrentToken(";") && !getCurrentToken().empty()) {
+		values.push_back(getCurrentToken());
+		getNextToken();
+	}
+	expectToken(";");
+
+	if (values.size() < 2 || values.size() > 3 || (values.size() == 3 && values[2] != "always")) {
+		throwError("add_header directive requires: add_header name value [always]");
+	}
+	const std::string& name = values[0];
+	for (size_t i = 0; i < name.length(); ++i) {
+		if (!std::isalnum(static_cast<unsigned char>(name[i])) && name[i] != '-' && name[i] != '_') {
+			throwError("Invalid header name in add_header directive: " + name);
+		}
+	}
+	if (values[1].find_first_of("\r\n") != std::string::npos) {
+		throwError("Invalid header value in add_header directive");
+	}
+	return AddHeaderDirective(name, values[1], values.size() == 3);
+}
+
+// access_log off;
+// access_log path [combined|common|timed|binary] [buffer=size] [flush=time] [sample=N];
+AccessLogDirective ConfParser::parseAccessLogDirective() {
+	expectToken("access_log");
+	AccessLogDirective accessLog;
+	std::string path = getCurrentToken();
+
+	if (path.empty() || path == ";") {
+		throwError("access_log directive requires a path or 'off'");
+	}
+	getNextToken();
+	if (path == "off") {
+		expectToken(";");
+		return accessLog;
+	}
+	accessLog.path = path;
+
+	if (isCurrentToken("combined") || isCurrentToken("common") || isCurrentToken("timed")
+		|| isCurrentToken("binary")) {
+		std::string format = getCurrentToken();
+		accessLog.format = (format == "combined") ? ACCESS_LOG_COMBINED
+						 : (format == "common") ? ACCESS_LOG_COMMON
+						 : (format == "timed") ? ACCESS_LOG_TIMED : ACCESS_LOG_BINARY;
+		getNextToken();
+	}
+
+	while (!isCurrentToken(";") && !getCurrentToken().empty()) {
+		std::string param = getCurrentToken();
+		if (param.compare(0, 7, "buffer=") == 0 && isValidBodySize(param.substr(7))) {
+			accessLog.bufferSize = StringUtils::toBytes(param.substr(7));
+			if (accessLog.bufferSize < 4096 || accessLog.bufferSize > 64UL * 1024 * 1024) {
+				throwError("access_log buffer must be between 4k and 64m: " + param);
+			}
+		} else if (param.compare(0, 6, "flush=") == 0) {
+			accessLog.flush = parseParameterValue(param, 6, 1, 60, true);
+		} else if (param.compare(0, 7, "sample=") == 0) {
+			accessLog.sample = parseParameterValue(param, 7, 1, 1000000, false);
+		} else {
+			throwError("Invalid parameter in access_log directive: " + param);
+		}
+		getNextToken();
+	}
+	expectToken(";");
+	return accessLog;
+}
+
+// slow_request_log off | time;  (time은 500ms, 2s처럼 단위를 붙이고, 단위가 없으면 초)
+SlowRequestLogDirective ConfParser::parseSlowRequestLogDirective() {
+	expectToken("slow_request_log");
+	std::string value = getCurrentToken();
+
+	if (value.empty() || value == ";") {
+		throwError("slow_request_log directive requires a time or 'off'");
+	}
+	getNextToken();
+	expectToken(";");
+	if (value == "off") {
+		return SlowRequestLogDirective(0);
+	}
+
+	std::string digits = value;
+	long long unit = 1000000;
+	if (digits.length() > 2 && digits.compare(digits.length() - 2, 2, "ms") == 0) {
+		unit = 1000;
+		digits.erase(digits.length() - 2);
+	} else if (digits.length() > 1 && digits[digits.length() - 1] == 's') {
+		digits.erase(digits.length() - 1);
+	}
+	if (digits.empty() || digits.length() > 9 || digits.find_first_not_of("0123456789") != std::string::npos) {
+		throwError("Invalid time in slow_request_log directive: " + value);
+	}
+	long long threshold = std::atol(digits.c_str()) * unit;
+	if (threshold < 1000 || threshold > 3600LL * 1000000) {
+		throwError("slow_request_log must be between 1ms and 3600s: " + value);
+	}
+	return SlowRequestLogDirective(threshold);
+}
+
+// 숫자 하나를 받는 지시어 (시간 지시어는 10s처럼 초 단위 접미사 허용)
+size_t ConfParser::parseCountDirective(const std::string& directive, size_t minValue, size_t maxValue) {
+	expectToken(directive);
+	std::string value = getCurrentToken();
+
+	if (value.empty() || value == ";") {
+		throwError(directive + " directive requires a value");
+	}
+
+	std::string digits = value;
+	bool seconds = (directive == "cgi_queue_timeout" || directive == "cgi_timeout" || directive == "cache_stale"
+					|| directive.compare(0, 6, "proxy_") == 0);
+	if (seconds && digits.length() > 1 && digits[digits.length() - 1] == 's') {
+		digits.erase(digits.length() - 1);
+	}
+	if (digits.empty() || digits.length() > 9 || digits.find_first_not_of("0123456789") != std::string::npos) {
+		throwError("Invalid value in " + directive + " directive: " + value);
+	}
+
+	size_t count = static_cast<size_t>(std::atol(digits.c_str()));
+	if (count < minValue || count > maxValue) {
+		std::stringstream ss;
+		ss << directive << " must be between " << minValue << " and " << maxValue << ": " << value;
+		throwError(ss.str());
+	}
+
+	getNextToken();
+	expectToken(";");
+	return count;
+}
+
+// cgi_circuit_breaker <error_percent>[%] [open_time];  (open_time 기본 30초)
+CgiCircuitBreakerDirective ConfParser::parseCgiCircuitBreakerDirective() {
+	expectToken("cgi_circuit_breaker");
+	std::string value = getCurrentToken();
+
+	if (value.empty() || value == ";") {
+		throwError("cgi_circuit_breaker directive requires an error percentage");
+	}
+	std::string digits = value;
+	if (digits.length() > 1 && digits[digits.length() - 1] == '%') {
+		digits.erase(digits.length() - 1);
+	}
+	if (digits.empty() || digits.length() > 3 || digits.find_first_not_of("0123456789") != std::string::npos) {
+		throwError("Invalid error percentage in cgi_circuit_breaker directive: " + value);
+	}
+	size_t percent = static_cast<size_t>(std::atoi(digits.c_str()));
+	if (percent < 1 || percent > 100) {
+		throwError("cgi_circuit_breaker error percentage must be between 1 and 100: " + value);
+	}
+	getNextToken();
+
+	size_t openSeconds = 30;
+	value = getCurrentToken();
+	if (value != ";") {
+		digits = value;
+		if (digits.length() > 1 && digits[digits.length() - 1] == 's') {
+			digits.erase(digits.length() - 1);
+		}
+		if (digits.empty() || digits.length() > 4 || digits.find_first_not_of("0123456789") != std::string::npos) {
+			throwError("Invalid open time in cgi_circuit_breaker directive: " + value);
+		}
+		openSeconds = static_cast<size_t>(std::atoi(digits.c_str()));
+		if (openSeconds < 1 || openSeconds > 3600) {
+			throwError("cgi_circuit_breaker open time must be between 1 and 3600: " + value);
+		}
+		getNextToken();
+	}
+
+	expectToken(";");
+	return CgiCircuitBreakerDirective(percent, openSeconds);
+}
+
 ErrorPageDirective ConfParser::parseErrorPageDirective() {
 	expectToken("error_page");
 
@@ -706,6 +1656,7 @@ LimitExceptDirective ConfParser::parseLimitExceptDirective() {
 		}
 
 		limitExcept.allowed_methods.insert(method);
+		limitExcept.methodMask |= HttpMethod::toMask(method);
 		getNextToken();
 	}
 	
@@ -737,6 +1688,65 @@ LimitExceptDirective ConfParser::parseLimitExceptDirective() {
 	return limitExcept;
 }
 
+TypesDirective ConfParser::parseTypesDirective() {
+	expectToken("types");
+	expectToken("{");
+
+	TypesDirective types;
+
+	while (!isCurrentToken("}") && !getCurrentToken().empty()) {
+		std::string token = getCurrentToken();
+
+		// include /etc/mime.types; 형식의 외부 파일 (적용 시점에 로드)
+		if (token == "include") {
+			std::string path = getNextToken();
+			if (path.empty() || path == ";" || path == "}") {
+				throwError("include in types block requires a file path");
+			}
+			types.includeFiles.push_back(path);
+			getNextToken();
+			expectToken(";");
+			continue;
+		}
+
+		// type ext1 ext2 ...;
+		if (token.find('/') == std::string::npos) {
+			throwError("Invalid MIME type '" + token + "' in types block");
+		}
+		getNextToken();
+
+		size_t extCount = 0;
+		while (!isCurrentToken(";") && !isCurrentToken("}") && !getCurrentToken().empty()) {
+			types.extensionMap[getCurrentToken()] = token;
+			extCount++;
+			getNextToken();
+		}
+		if (extCount == 0) {
+			throwError("MIME type '" + token + "' requires at least one extension");
+		}
+		expectToken(";");
+	}
+
+	expectToken("}");
+	return types;
+}
+
+DefaultTypeDirective ConfParser::parseDefaultTypeDirective() {
+	expectToken("default_type");
+	std::string type = getCurrentToken();
+
+	if (type.empty() || type == ";") {
+		throwError("default_type directive requires a MIME type");
+	}
+	if (type.find('/') == std::string::npos) {
+		throwError("Invalid MIME type '" + type + "' in default_type directive");
+	}
+
+	getNextToken();
+	expectToken(";");
+	return DefaultTypeDirective(type);
+}
+
 bool ConfParser::parseBoolean(const std::string& value) const {
 	return value == "on" || value == "true" || value == "1";
 }
@@ -796,6 +1806,22 @@ void ConfParser::printConfig(const ConfigDTO& config) const {
 		}
 	}
 
+	if (!config.httpContext.opDefaultTypeDirective.empty()) {
+		std::cout << "  default_type: " << config.httpContext.opDefaultTypeDirective[0].type << std::endl;
+	}
+
+	if (!config.httpContext.opTypesDirective.empty()) {
+		const TypesDirective& types = config.httpContext.opTypesDirective[0];
+		std::cout << "  types:" << std::endl;
+		for (size_t i = 0; i < types.includeFiles.size(); i++) {
+			std::cout << "    include " << types.includeFiles[i] << std::endl;
+		}
+		for (std::map<std::string, std::string>::const_iterator it = types.extensionMap.begin();
+			 it != types.extensionMap.end(); ++it) {
+			std::cout << "    " << it->first << " -> " << it->second << std::endl;
+		}
+	}
+
 	// 서버 블록들 출력
 	for (size_t i = 0; i < config.httpContext.serverContexts.size(); i++) {
 		const ServerContext& server = config.httpContext.serverContexts[i];
@@ -806,11 +1832,22 @@ void ConfParser::printConfig(const ConfigDTO& config) const {
 			if (server.opListenDirective[0].default_server) {
 				std::cout << " default_server";
 			}
+			if (server.opListenDirective[0].ssl) {
+				std::cout << " ssl";
+			}
 			std::cout << std::endl;
 		}
+
+		if (!server.opSslCertificateDirective.empty()) {
+			std::cout << "    ssl_certificate: " << server.opSslCertificateDirective[0].path << std::endl;
+		}
 		
 		if (!server.opServerNameDirective.empty()) {
-			std::cout << "    server_name: " << server.opServerNameDirective[0].name << std::endl;
+			std::cout << "    server_name:";
+			for (size_t k = 0; k < server.opServerNameDirective.size(); k++) {
+				std::cout << " " << server.opServerNameDirective[k].name;
+			}
+			std::cout << std::endl;
 		}
 
 		// Server error_page 출력
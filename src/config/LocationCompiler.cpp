@@ -0,0 +1,255 @@
+#include "config/LocationCompiler.hpp"
+#include "cgi/CgiRunner.hpp"
+#include "cgi/CgiWorker.hpp"
+#include "proxy/ProxyClient.hpp"
+#include "http/ResponseCompressor.hpp"
+#include "http/HttpMethod.hpp"
+#include "log/AccessLog.hpp"
+#include "metrics/Metrics.hpp"
+#include "utils/FileManager.hpp"
+#include "utils/StringUtils.hpp"
+#include "utils/Common.hpp"
+
+const size_t LocationCompiler::DEFAULT_MAX_BODY_SIZE = 10UL * 1024 * 1024;
+const char* LocationCompiler::DEFAULT_ROOT = "/var/www/html";
+
+LocationCompiler::LocationCompiler() {}
+
+LocationCompiler::~LocationCompiler() {
+	for (size_t i = 0; i < _locations.size(); ++i) {
+		delete _locations[i];
+	}
+	for (std::map<std::string, std::string*>::iterator it = _errorPageBodies.begin();
+		 it != _errorPageBodies.end(); ++it) {
+		delete it->second;
+	}
+}
+
+void LocationCompiler::compile(ConfigDTO& config) {
+	HttpContext& http = config.httpContext;
+
+	for (size_t i = 0; i < http.serverContexts.size(); ++i) {
+		ServerContext& server = http.serverContexts[i];
+
+		for (size_t j = 0; j < server.locationContexts.size(); ++j) {
+			LocationContext& location = server.locationContexts[j];
+			location.compiled = compileLocation(http, server, location);
+		}
+	}
+
+	DEBUG_LOG("[LocationCompiler] compiled " << _locations.size() << " locations, "
+			  << _errorPageBodies.size() << " error pages");
+}
+
+CompiledLocation* LocationCompiler::compileLocation(const HttpContext& http,
+													const ServerContext& server,
+													const LocationContext& location) {
+	CompiledLocation* compiled = new CompiledLocation();
+	_locations.push_back(compiled);
+
+	// 1. client_max_body_size
+	if (!location.opBodySizeDirective.empty()) {
+		compiled->maxBodySize = StringUtils::toBytes(location.opBodySizeDirective[0].size);
+	} else {
+		compiled->maxBodySize = DEFAULT_MAX_BODY_SIZE;
+	}
+
+	// 2. limit_except
+	if (!location.opLimitExceptDirective.empty()) {
+		compiled->methodMask = location.opLimitExceptDirective[0].methodMask;
+	} else {
+		compiled->methodMask = METHOD_GET | METHOD_HEAD | METHOD_POST | METHOD_PUT | METHOD_DELETE;
+	}
+
+	// 3. root / alias (location > server > 기본값)
+	if (!location.opRootDirective.empty()) {
+		compiled->documentRoot = location.opRootDirective[0].path;
+	} else if (!server.opRootDirective.empty()) {
+		compiled->documentRoot = server.opRootDirective[0].path;
+	}
+	compiled->root = compiled->documentRoot.empty() ? DEFAULT_ROOT : compiled->documentRoot;
+
+	if (!location.opAliasDirective.empty()) {
+		compiled->hasAlias = true;
+		compiled->alias = location.opAliasDirective[0].path;
+	}
+
+	// 4. CGI 인터프리터
+	if (!location.opCgiPassDirective.empty()) {
+		compiled->isCgi = true;
+		compiled->cgiPass = location.opCgiPassDirective[0].path;
+	}
+	if (location.matchType == MATCH_EXTENSION) {
+		// 확장자 location은 스크립트 확장자가 고정이므로 인터프리터도 여기서 확정
+		compiled->interpreter = interpreterForExtension(location.path);
+		if (compiled->interpreter.empty()) {
+			compiled->interpreter = compiled->cgiPass;
+		}
+	}
+
+	if (!location.opFastCgiPassDirective.empty()) {
+		compiled->fastcgiPass = location.opFastCgiPassDirective[0].address;
+	}
+
+	if (!location.opProxyPassDirective.empty()) {
+		compiled->proxyPass = location.opProxyPassDirective[0].address;
+		compiled->proxyUri = location.opProxyPassDirective[0].uri;
+		for (size_t i = 0; i < http.upstreamContexts.size(); ++i) {
+			if (http.upstreamContexts[i].name == location.opProxyPassDirective[0].upstream) {
+				compiled->proxyUpstream = &http.upstreamContexts[i];
+				compiled->proxyPass = http.upstreamContexts[i].name;
+			}
+		}
+		compiled->proxyConnectTimeout = location.opProxyConnectTimeoutDirective.empty()
+			? ProxyClient::DEFAULT_CONNECT_TIMEOUT : location.opProxyConnectTimeoutDirective[0].seconds;
+		compiled->proxyReadTimeout = location.opProxyReadTimeoutDirective.empty()
+			? ProxyClient::DEFAULT_READ_TIMEOUT : location.opProxyReadTimeoutDirective[0].seconds;
+		compiled->proxySendTimeout = location.opProxySendTimeoutDirective.empty()
+			? ProxyClient::DEFAULT_SEND_TIMEOUT : location.opProxySendTimeoutDirective[0].seconds;
+	}
+
+	// cgi_pool: 상주 워커는 부트스트랩이 파이썬이므로 파이썬 인터프리터일 때만 사용
+	if (!location.opCgiPoolDirective.empty()) {
+		const CgiPoolDirective& pool = location.opCgiPoolDirective[0];
+		std::string interpreter = (location.matchType == MATCH_EXTENSION) ? compiled->interpreter : compiled->cgiPass;
+
+		if (CgiWorker::supportsInterpreter(interpreter)) {
+			compiled->cgiPoolWorkers = pool.workers;
+			compiled->cgiPoolMaxRequests = pool.maxRequests ? pool.maxRequests : CgiWorker::DEFAULT_MAX_REQUESTS;
+			compiled->cgiPoolInterpreter = interpreter;
+		} else {
+			ERROR_LOG("[LocationCompiler] cgi_pool ignored for location " << location.path
+					  << ": '" << interpreter << "' is not a Python interpreter");
+		}
+	}
+
+	compiled->cgiNph = !location.opCgiNphDirective.empty() && location.opCgiNphDirective[0].enabled;
+
+	// CGI 동시 실행 한도와 대기열
+	if (!location.opCgiMaxConcurrentDirective.empty()) {
+		compiled->cgiMaxConcurrent = location.opCgiMaxConcurrentDirective[0].count;
+		compiled->cgiQueueSize = location.opCgiQueueSizeDirective.empty()
+			? CgiRunner::DEFAULT_QUEUE_SIZE : location.opCgiQueueSizeDirective[0].size;
+		compiled->cgiQueueTimeout = location.opCgiQueueTimeoutDirective.empty()
+			? CgiRunner::DEFAULT_QUEUE_TIMEOUT : location.opCgiQueueTimeoutDirective[0].seconds;
+	}
+
+	compiled->cgiTimeout = location.opCgiTimeoutDirective.empty()
+		? CGI_TIMEOUT : location.opCgiTimeoutDirective[0].seconds;
+	if (!location.opCgiCircuitBreakerDirective.empty()) {
+		compiled->cgiBreakerPercent = location.opCgiCircuitBreakerDirective[0].errorPercent;
+		compiled->cgiBreakerOpenTime = location.opCgiCircuitBreakerDirective[0].openSeconds;
+	}
+
+	// 응답 캐시 (cache_valid는 먼저 적힌 것이 우선)
+	if (!location.opCacheDirective.empty()) {
+		for (size_t i = 0; i < http.opCacheZoneDirective.size(); ++i) {
+			if (http.opCacheZoneDirective[i].name == location.opCacheDirective[0].zone) {
+				compiled->cacheZone = &http.opCacheZoneDirective[i];
+			}
+		}
+		for (size_t i = 0; i < location.opCacheValidDirective.size(); ++i) {
+			const CacheValidDirective& valid = location.opCacheValidDirective[i];
+			for (size_t j = 0; j < valid.codes.size(); ++j) {
+				compiled->cacheValid.insert(std::make_pair(valid.codes[j], valid.seconds));
+			}
+		}
+		for (size_t i = 0; i < location.opCacheKeyHeaderDirective.size(); ++i) {
+			compiled->cacheKeyHeaders.push_back(location.opCacheKeyHeaderDirective[i].name);
+		}
+		compiled->cacheStale = location.opCacheStaleDirective.empty() ? 0 : location.opCacheStaleDirective[0].seconds;
+	}
+
+	// 응답 압축 (gzip_types 기본값은 text/html)
+	compiled->gzip = !location.opGzipDirective.empty() && location.opGzipDirective[0].enabled;
+	compiled->gzipStatic = !location.opGzipStaticDirective.empty() && location.opGzipStaticDirective[0].enabled;
+	if (location.opGzipTypesDirective.empty()) {
+		compiled->gzipTypes.push_back("text/html");
+	} else {
+		compiled->gzipTypes = location.opGzipTypesDirective[0].types;
+	}
+	compiled->gzipMinLength = location.opGzipMinLengthDirective.empty()
+		? ResponseCompressor::DEFAULT_MIN_LENGTH : location.opGzipMinLengthDirective[0].length;
+	compiled->gzipCompLevel = location.opGzipCompLevelDirective.empty()
+		? ResponseCompressor::DEFAULT_COMP_LEVEL : location.opGzipCompLevelDirective[0].level;
+
+	// 응답 캐시 헤더 (expires, add_header, immutable_assets)
+	if (!location.opExpiresDirective.empty() && location.opExpiresDirective[0].mode != EXPIRES_OFF) {
+		compiled->expires = &location.opExpiresDirective[0];
+	}
+	if (!location.opAddHeaderDirective.empty()) {
+		compiled->addHeaders = &location.opAddHeaderDirective;
+	}
+	compiled->immutableAssets = !location.opImmutableAssetsDirective.empty()
+		&& location.opImmutableAssetsDirective[0].enabled;
+
+	// access_log (같은 파일을 쓰는 location들은 로그 하나를 공유)
+	if (!location.opAccessLogDirective.empty()) {
+		compiled->accessLog = AccessLog::open(location.opAccessLogDirective[0]);
+	}
+	compiled->serverTiming = !location.opServerTimingDirective.empty()
+		&& location.opServerTimingDirective[0].enabled;
+	compiled->slowRequestLog = location.opSlowRequestLogDirective.empty()
+		? 0 : location.opSlowRequestLogDirective[0].threshold;
+
+	// 지표: 요청 시간은 server_name(없으면 listen 주소)과 location 경로로 묶음
+	std::string serverName = !server.opServerNameDirective.empty() ? server.opServerNameDirective[0].name
+		: !server.opListenDirective.empty() ? server.opListenDirective[0].address : "_";
+	compiled->metricsServer = serverName;
+	compiled->latency = Metrics::location(serverName, location.path);
+	compiled->stubStatus = !location.opStubStatusDirective.empty();
+
+	// 5. autoindex / index
+	compiled->autoindex = !location.opAutoindexDirective.empty() && location.opAutoindexDirective[0].enabled;
+	for (size_t i = 0; i < location.opIndexDirective.size(); ++i) {
+		compiled->indexFiles.push_back(location.opIndexDirective[i].filename);
+	}
+
+	// 6. error_page (location -> server -> http 순서, 먼저 찾은 것이 우선)
+	loadErrorPages(compiled, location.opErrorPageDirective);
+	loadErrorPages(compiled, server.opErrorPageDirective);
+	loadErrorPages(compiled, http.opErrorPageDirective);
+
+	return compiled;
+}
+
+void LocationCompiler::loadErrorPages(CompiledLocation* compiled,
+									  const std::vector<ErrorPageDirective>& directives) {
+	for (size_t i = 0; i < directives.size(); ++i) {
+		const std::map<int, std::string>& pages = directives[i].errorPageMap;
+
+		for (std::map<int, std::string>::const_iterator it = pages.begin(); it != pages.end(); ++it) {
+			if (compiled->errorPages.find(it->first) != compiled->errorPages.end()) {
+				continue;
+			}
+			compiled->errorPages[it->first] = loadErrorPageBody(it->second);
+		}
+	}
+}
+
+const std::string* LocationCompiler::loadErrorPageBody(const std::string& path) {
+	std::map<std::string, std::string*>::iterator it = _errorPageBodies.find(path);
+	if (it != _errorPageBodies.end()) {
+		return it->second;
+	}
+
+	// 로드 실패 시 빈 본문을 저장해 두고, 응답 시 기본 에러 페이지를 사용
+	std::string* body = new std::string();
+	if (!FileManager::readFile(path, *body)) {
+		ERROR_LOG("[LocationCompiler] Failed to load custom error page: " << path);
+		body->clear();
+	}
+	_errorPageBodies[path] = body;
+	return body;
+}
+
+std::string LocationCompiler::interpreterForExtension(const std::string& extension) {
+	if (extension == ".py") {
+		return "/usr/bin/python3";
+	} else if (extension == ".php") {
+		return "/usr/bin/php-cgi";
+	} else if (extension == ".sh") {
+		return "/bin/sh";
+	}
+	return "";
+}
@@ -0,0 +1,87 @@
+#include "http/ConditionalRequest.hpp"
+#include "http/HttpRequest.hpp"
+#include <sstream>
+#include <cstring>
+
+std::string ConditionalRequest::makeETag(const struct stat& st) {
+	std::ostringstream etag;
+	etag << std::hex << "\"" << st.st_ino << "-" << st.st_size << "-" << st.st_mtime << "\"";
+	return etag.str();
+}
+
+std::string ConditionalRequest::formatDate(time_t when) {
+	char buf[64];
+	struct tm tm;
+	::gmtime_r(&when, &tm);
+	::strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+	return buf;
+}
+
+bool ConditionalRequest::parseDate(const std::string& value, time_t& when) {
+	struct tm tm;
+	std::memset(&tm, 0, sizeof(tm));
+	const char* end = ::strptime(value.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+	if (end == NULL || *end != '\0') {
+		return false;
+	}
+	when = ::timegm(&tm);
+	return when != static_cast<time_t>(-1);
+}
+
+// W/ 접두사를 떼고 따옴표 포함 opaque 부분만 비교
+static std::string opaqueTag(const std::string& tag) {
+	return tag.compare(0, 2, "W/") == 0 ? tag.substr(2) : tag;
+}
+
+bool ConditionalRequest::matchesETag(const std::string& header, const std::string& etag) {
+	std::string target = opaqueTag(etag);
+
+	size_t pos = 0;
+	while (pos < header.length()) {
+		while (pos < header.length() && (header[pos] == ' ' || header[pos] == '\t' || header[pos] == ',')) {
+			++pos;
+		}
+		size_t end = header.find(',', pos);
+		if (end == std::string::npos) {
+			end = header.length();
+		}
+		size_t last = end;
+		while (last > pos && (header[last - 1] == ' ' || header[last - 1] == '\t')) {
+			--last;
+		}
+		if (last > pos) {
+			std::string tag = header.substr(pos, last - pos);
+			if (tag == "*" || opaqueTag(tag) == target) {
+				return true;
+			}
+		}
+		pos = end;
+	}
+	return false;
+}
+
+bool ConditionalRequest::isNotModified(const HttpRequest* request, const std::string& etag, time_t lastModified) {
+	std::string ifNoneMatch = request->getHeader("if-none-match");
+	if (!ifNoneMatch.empty()) {
+		return matchesETag(ifNoneMatch, etag);
+	}
+
+	std::string ifModifiedSince = request->getHeader("if-modified-since");
+	time_t since;
+	if (ifModifiedSince.empty() || !parseDate(ifModifiedSince, since)) {
+		return false;
+	}
+	return lastModified <= since;
+}
+
+bool ConditionalRequest::isRangeFresh(const HttpRequest* request, const std::string& etag, time_t lastModified) {
+	std::string ifRange = request->getHeader("if-range");
+	if (ifRange.empty()) {
+		return true;
+	}
+	if (ifRange[0] == '"' || ifRange.compare(0, 2, "W/") == 0) {
+		return ifRange == etag && etag.compare(0, 2, "W/") != 0;
+	}
+	time_t date;
+	return parseDate(ifRange, date) && date == lastModified;
+}
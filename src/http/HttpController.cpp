@@ -8,6 +8,7 @@
 #include "utils/PathResolver.hpp"
 #include "utils/FileManager.hpp"
 #include "cgi/CgiExecutor.hpp"
+#include "config/CompiledLocation.hpp"
 #include "cgi/CgiResponse.hpp"
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -68,7 +69,7 @@ HttpResponse* HttpController::processRequest(
 		return executeCgi(request, cgiPath, serverConf, locConf);
 	}
 
-	if (!locConf->opCgiPassDirective.empty()) {
+	if (locConf->compiled->isCgi) {
 		ERROR_LOG("[HttpController] CGI location but script not found or not executable");
 		return new HttpResponse(
 			HttpResponse::createErrorResponse(StatusCode::NOT_FOUND, serverConf, locConf)
@@ -78,7 +79,7 @@ HttpResponse* HttpController::processRequest(
 	// ========= HTTP 메서드별 처리 =======
 	const std::string& method = request->getMethod();
 
-    if (method == "GET") {
+    if (method == "GET" || method == "HEAD") {
 		DEBUG_LOG("[HttpController] Dispatching to GET handler");
 		return GetHandler::handle(request, serverConf, locConf);
 	}
@@ -134,7 +135,7 @@ std::string HttpController::getCgiPath(
 	DEBUG_LOG("[HttpController] Checking for CGI execution");
 
 	// cgi_pass가 설정되었는지 확인
-	if (!locConf || locConf->opCgiPassDirective.empty()) {
+	if (!locConf || !locConf->compiled->isCgi) {
 		DEBUG_LOG("[HttpController] No cgi_pass directive found");
 		return "";
 	}
@@ -0,0 +1,25 @@
+#include "http/HttpMethod.hpp"
+
+namespace HttpMethod {
+
+unsigned int toMask(const std::string& method) {
+	// 요청마다 불리므로 문자열 비교 전에 길이/첫 글자로 분기
+	switch (method.length()) {
+		case 3:
+			if (method == "GET") return METHOD_GET;
+			if (method == "PUT") return METHOD_PUT;
+			break;
+		case 4:
+			if (method == "HEAD") return METHOD_HEAD;
+			if (method == "POST") return METHOD_POST;
+			break;
+		case 6:
+			if (method == "DELETE") return METHOD_DELETE;
+			break;
+		default:
+			break;
+	}
+	return METHOD_NONE;
+}
+
+} // namespace HttpMethod
@@ -2,15 +2,40 @@
 #include "http/HttpRequest.hpp"
 #include "http/StatusCode.hpp"
 #include "config/ConfigManager.hpp"
+#include "config/CompiledLocation.hpp"
 #include "utils/FileManager.hpp"
 #include <sstream>
 #include <fstream>
 #include <ctime>
+#include <unistd.h>
 
 // ============ 생성자와 소멸자 ============
-HttpResponse::HttpResponse() : _statusCode(StatusCode::OK) {}
+HttpResponse::HttpResponse() : _statusCode(StatusCode::OK), _fileFd(-1) {}
 
-HttpResponse::~HttpResponse() {}
+// 파일 바디는 fd를 복제해 각자 닫음
+HttpResponse::HttpResponse(const HttpResponse& other)
+	: _statusCode(other._statusCode), _headers(other._headers), _body(other._body),
+	  _fileFd(other._fileFd == -1 ? -1 : ::dup(other._fileFd)), _fileSegments(other._fileSegments) {}
+
+HttpResponse& HttpResponse::operator=(const HttpResponse& other) {
+	if (this != &other) {
+		if (_fileFd != -1) {
+			::close(_fileFd);
+		}
+		_statusCode = other._statusCode;
+		_headers = other._headers;
+		_body = other._body;
+		_fileFd = (other._fileFd == -1) ? -1 : ::dup(other._fileFd);
+		_fileSegments = other._fileSegments;
+	}
+	return *this;
+}
+
+HttpResponse::~HttpResponse() {
+	if (_fileFd != -1) {
+		::close(_fileFd);
+	}
+}
 
 // ============ Setter 함수들 ============
 void HttpResponse::setStatus(int code) {
@@ -21,6 +46,10 @@ void HttpResponse::setHeader(const std::string& key, const std::string& value) {
 	_headers[key] = value;
 }
 
+void HttpResponse::removeHeader(const std::string& key) {
+	_headers.erase(key);
+}
+
 void HttpResponse::setBody(const std::string& body) {
 	_body = body;
 }
@@ -29,6 +58,15 @@ void HttpResponse::setContentType(const std::string& type) {
 	setHeader("Content-Type", type);
 }
 
+void HttpResponse::setFileBody(int fd, const std::vector<FileSegment>& segments) {
+	if (_fileFd != -1) {
+		::close(_fileFd);
+	}
+	_fileFd = fd;
+	_fileSegments = segments;
+	_body.clear();
+}
+
 // ============ Getter 함수들 ============
 int HttpResponse::getStatus() const {
 	return _statusCode;
@@ -42,6 +80,10 @@ std::string HttpResponse::getHeader(const std::string& key) const {
 	return "";
 }
 
+const std::map<std::string, std::string>& HttpResponse::getHeaders() const {
+	return _headers;
+}
+
 std::string HttpResponse::getBody() const {
 	return _body;
 }
@@ -50,6 +92,18 @@ std::string HttpResponse::getContentType() const {
 	return getHeader("Content-Type");
 }
 
+bool HttpResponse::hasFileBody() const {
+	return _fileFd != -1;
+}
+
+int HttpResponse::getFileFd() const {
+	return _fileFd;
+}
+
+const std::vector<FileSegment>& HttpResponse::getFileSegments() const {
+	return _fileSegments;
+}
+
 // ============ Cookie Management ============
 // void HttpResponse::addCookie(const std::string& name, const std::string& value, int maxAge, const std::string& path, bool httpOnly) {
 // 	std::stringstream cookie;
@@ -110,10 +164,16 @@ std::string HttpResponse::serialize(const HttpRequest* request) {
 	// 2. 기본 헤더 설정 (Date, Server, Connection)
 	setDefaultHeaders(request);
 	
-	// 3. Content-Length 자동 계산
-	if (_headers.find("Content-Length") == _headers.end()) {
+	// 3. Content-Length 자동 계산 (chunked로 스트리밍하는 응답, 바디가 없는 204/304 제외)
+	if (_statusCode != StatusCode::NO_CONTENT && _statusCode != StatusCode::NOT_MODIFIED
+		&& _headers.find("Content-Length") == _headers.end()
+		&& _headers.find("Transfer-Encoding") == _headers.end()) {
+		size_t length = _body.length();
+		for (size_t i = 0; i < _fileSegments.size(); ++i) {
+			length += _fileSegments[i].prefix.length() + _fileSegments[i].length;
+		}
 		std::stringstream len_ss;
-		len_ss << _body.length();
+		len_ss << length;
 		_headers["Content-Length"] = len_ss.str();
 	}
 	
@@ -130,7 +190,7 @@ std::string HttpResponse::serialize(const HttpRequest* request) {
 	// 5. 헤더와 바디 구분
 	ss << "\r\n";
 	
-	// 6. 바디 추가 (GET, HEAD 메서드는 바디가 없을 수 있음)
+	// 6. 바디 추가 (GET, HEAD 메서드는 바디가 없을 수 있음, 파일 바디는 Client가 sendfile로 보냄)
 	if (request == NULL || (request->getMethod() != "HEAD")) {
 		ss << _body;
 	}
@@ -145,7 +205,14 @@ HttpResponse HttpResponse::createErrorResponse(int code, const ServerContext* se
 	
 	std::string errorBody;
 
-	if (serverConf != NULL) {
+	if (locConf != NULL && locConf->compiled != NULL) {
+		// 1. location이 있으면 설정 적용 시 미리 읽어 둔 본문 사용 (로드 실패한 페이지는 빈 본문)
+		const std::map<int, const std::string*>& pages = locConf->compiled->errorPages;
+		std::map<int, const std::string*>::const_iterator it = pages.find(code);
+		if (it != pages.end()) {
+			errorBody = *it->second;
+		}
+	} else if (serverConf != NULL) {
 		// 1. 커스텀 에러 페이지 경로를 조회
 		std::string customErrorPagePath = ConfigManager::findErrorPagePath(code, serverConf, locConf);
 
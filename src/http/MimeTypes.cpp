@@ -0,0 +1,181 @@
+#include "http/MimeTypes.hpp"
+#include "utils/Common.hpp"
+#include <fstream>
+#include <sstream>
+
+const char* const MimeTypes::DEFAULT_TYPE = "application/octet-stream";
+
+StringHashTable<std::string> MimeTypes::_types(true);
+std::string MimeTypes::_defaultType = MimeTypes::DEFAULT_TYPE;
+bool MimeTypes::_initialized = false;
+
+struct BuiltinMimeType {
+	const char* ext;
+	const char* type;
+};
+
+// 설정이 없을 때 사용하는 기본 타입 (기존 FileUtils::getMimeType 목록과 동일)
+static const BuiltinMimeType BUILTIN_TYPES[] = {
+	// HTML/CSS/JavaScript
+	{ "html", "text/html" },
+	{ "htm", "text/html" },
+	{ "css", "text/css" },
+	{ "js", "application/javascript" },
+	{ "json", "application/json" },
+
+	// Images
+	{ "jpg", "image/jpeg" },
+	{ "jpeg", "image/jpeg" },
+	{ "png", "image/png" },
+	{ "gif", "image/gif" },
+	{ "svg", "image/svg+xml" },
+	{ "ico", "image/x-icon" },
+	{ "bmp", "image/bmp" },
+	{ "webp", "image/webp" },
+
+	// Text
+	{ "txt", "text/plain" },
+	{ "xml", "application/xml" },
+	{ "csv", "text/csv" },
+
+	// Video
+	{ "mp4", "video/mp4" },
+	{ "avi", "video/x-msvideo" },
+	{ "mov", "video/quicktime" },
+	{ "wmv", "video/x-ms-wmv" },
+	{ "webm", "video/webm" },
+
+	// Audio
+	{ "mp3", "audio/mpeg" },
+	{ "wav", "audio/wav" },
+	{ "ogg", "audio/ogg" },
+	{ "aac", "audio/aac" },
+
+	// Documents
+	{ "pdf", "application/pdf" },
+	{ "doc", "application/msword" },
+	{ "docx", "application/vnd.openxmlformats-officedocument.wordprocessingml.document" },
+	{ "xls", "application/vnd.ms-excel" },
+	{ "xlsx", "application/vnd.openxmlformats-officedocument.spreadsheetml.sheet" },
+	{ "ppt", "application/vnd.ms-powerpoint" },
+	{ "pptx", "application/vnd.openxmlformats-officedocument.presentationml.presentation" },
+
+	// Archives
+	{ "zip", "application/zip" },
+	{ "tar", "application/x-tar" },
+	{ "gz", "application/gzip" },
+	{ "rar", "application/vnd.rar" },
+	{ "7z", "application/x-7z-compressed" },
+
+	// Fonts
+	{ "woff", "font/woff" },
+	{ "woff2", "font/woff2" },
+	{ "ttf", "font/ttf" },
+	{ "eot", "application/vnd.ms-fontobject" },
+
+	// CGI scripts
+	{ "php", "application/x-httpd-php" },
+	{ "py", "text/x-python" },
+	{ "pl", "text/x-perl" },
+	{ "rb", "text/x-ruby" }
+};
+
+void MimeTypes::loadBuiltinTypes() {
+	_types.clear();
+	for (size_t i = 0; i < sizeof(BUILTIN_TYPES) / sizeof(BUILTIN_TYPES[0]); ++i) {
+		_types.set(BUILTIN_TYPES[i].ext, BUILTIN_TYPES[i].type);
+	}
+	_defaultType = DEFAULT_TYPE;
+	_initialized = true;
+}
+
+/**
+ * @brief mime.types 형식 파일 로드.
+ *
+ * "type ext1 ext2 ..." 한 줄에 한 타입이며 '#' 이후는 주석.
+ * nginx 형식(types { type ext; })도 그대로 읽을 수 있도록 '{', '}', ';'는 무시함.
+ */
+bool MimeTypes::loadMimeTypesFile(const std::string& path) {
+	std::ifstream file(path.c_str());
+	if (!file.is_open()) {
+		ERROR_LOG("[MimeTypes] Cannot open mime types file: " << path);
+		return false;
+	}
+
+	std::string line;
+	size_t loaded = 0;
+	while (std::getline(file, line)) {
+		size_t comment = line.find('#');
+		if (comment != std::string::npos) {
+			line.erase(comment);
+		}
+		for (size_t i = 0; i < line.length(); ++i) {
+			if (line[i] == ';' || line[i] == '{' || line[i] == '}') {
+				line[i] = ' ';
+			}
+		}
+
+		std::istringstream iss(line);
+		std::string type;
+		if (!(iss >> type) || type.find('/') == std::string::npos) {
+			continue;
+		}
+
+		std::string ext;
+		while (iss >> ext) {
+			_types.set(ext, type);
+			++loaded;
+		}
+	}
+
+	DEBUG_LOG("[MimeTypes] Loaded " << loaded << " extensions from " << path);
+	return true;
+}
+
+void MimeTypes::configure(const HttpContext& http) {
+	loadBuiltinTypes();
+
+	if (!http.opTypesDirective.empty()) {
+		const TypesDirective& types = http.opTypesDirective[0];
+
+		for (size_t i = 0; i < types.includeFiles.size(); ++i) {
+			loadMimeTypesFile(types.includeFiles[i]);
+		}
+		for (std::map<std::string, std::string>::const_iterator it = types.extensionMap.begin();
+			 it != types.extensionMap.end(); ++it) {
+			_types.set(it->first, it->second);
+		}
+	}
+
+	if (!http.opDefaultTypeDirective.empty()) {
+		_defaultType = http.opDefaultTypeDirective[0].type;
+	}
+
+	DEBUG_LOG("[MimeTypes] " << _types.size() << " types, default_type " << _defaultType);
+}
+
+const std::string& MimeTypes::lookup(const char* ext, size_t len) {
+	if (!_initialized) {
+		loadBuiltinTypes();
+	}
+
+	const std::string* type = _types.find(ext, len);
+	return type ? *type : _defaultType;
+}
+
+const std::string& MimeTypes::lookup(const std::string& ext) {
+	return lookup(ext.data(), ext.length());
+}
+
+const std::string& MimeTypes::fromPath(const std::string& path) {
+	size_t dotPos = path.find_last_of('.');
+	size_t slashPos = path.find_last_of('/');
+
+	// 확장자가 없거나, '.'이 디렉토리 이름에 있거나, 숨김 파일인 경우 (FileUtils::getExtension과 동일)
+	size_t filenameStart = (slashPos == std::string::npos) ? 0 : slashPos + 1;
+	if (dotPos == std::string::npos || (slashPos != std::string::npos && dotPos < slashPos)
+		|| dotPos == filenameStart) {
+		return lookup("", 0);
+	}
+	return lookup(path.data() + dotPos + 1, path.length() - dotPos - 1);
+}
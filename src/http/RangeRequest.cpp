@@ -0,0 +1,152 @@
+#include "http/RangeRequest.hpp"
+#include <algorithm>
+#include <sstream>
+#include <cctype>
+#include <ctime>
+#include <limits>
+
+const size_t RangeRequest::MAX_RANGES = 16;
+
+static bool compareFirst(const ByteRange& a, const ByteRange& b) {
+	return a.first < b.first;
+}
+
+// 10진수 하나를 읽음 (오버플로나 숫자가 없으면 false)
+static bool parseNumber(const std::string& value, size_t& pos, off_t& number) {
+	size_t start = pos;
+	number = 0;
+	while (pos < value.length() && std::isdigit(static_cast<unsigned char>(value[pos]))) {
+		off_t digit = value[pos] - '0';
+		if (number > (std::numeric_limits<off_t>::max() - digit) / 10) {
+			return false;
+		}
+		number = number * 10 + digit;
+		++pos;
+	}
+	return pos > start;
+}
+
+static void skipSpaces(const std::string& value, size_t& pos) {
+	while (pos < value.length() && (value[pos] == ' ' || value[pos] == '\t')) {
+		++pos;
+	}
+}
+
+// 정렬 후 겹치거나 맞닿은 범위를 합침
+static void coalesce(std::vector<ByteRange>& ranges) {
+	std::sort(ranges.begin(), ranges.end(), compareFirst);
+	std::vector<ByteRange> merged;
+	for (size_t i = 0; i < ranges.size(); ++i) {
+		if (!merged.empty() && ranges[i].first <= merged.back().last + 1) {
+			merged.back().last = std::max(merged.back().last, ranges[i].last);
+		} else {
+			merged.push_back(ranges[i]);
+		}
+	}
+	ranges.swap(merged);
+}
+
+RangeRequest::Result RangeRequest::parse(const std::string& header, off_t size, std::vector<ByteRange>& ranges) {
+	ranges.clear();
+
+	size_t pos = 0;
+	skipSpaces(header, pos);
+	if (header.length() - pos < 6) {
+		return RANGE_NONE;
+	}
+	std::string unit = header.substr(pos, 6);
+	for (size_t i = 0; i < unit.length(); ++i) {
+		unit[i] = std::tolower(static_cast<unsigned char>(unit[i]));
+	}
+	if (unit != "bytes=") {
+		return RANGE_NONE;
+	}
+	pos += 6;
+
+	bool any = false;
+	bool overlapping = false;
+	while (pos < header.length()) {
+		skipSpaces(header, pos);
+		if (pos < header.length() && header[pos] == ',') {
+			++pos;
+			continue;
+		}
+
+		off_t first = -1;
+		off_t last = -1;
+		if (pos < header.length() && header[pos] == '-') {
+			// suffix: 마지막 N바이트
+			++pos;
+			off_t suffix;
+			if (!parseNumber(header, pos, suffix)) {
+				return RANGE_NONE;
+			}
+			if (suffix > 0 && size > 0) {
+				first = (suffix >= size) ? 0 : size - suffix;
+				last = size - 1;
+			}
+		} else {
+			if (!parseNumber(header, pos, first) || pos >= header.length() || header[pos] != '-') {
+				return RANGE_NONE;
+			}
+			++pos;
+			if (pos < header.length() && std::isdigit(static_cast<unsigned char>(header[pos]))) {
+				if (!parseNumber(header, pos, last) || last < first) {
+					return RANGE_NONE;
+				}
+			} else {
+				last = size - 1;
+			}
+			if (first >= size) {
+				first = -1;
+			} else if (last >= size) {
+				last = size - 1;
+			}
+		}
+
+		skipSpaces(header, pos);
+		if (pos < header.length() && header[pos] != ',') {
+			return RANGE_NONE;
+		}
+		any = true;
+
+		// 만족할 수 없는 범위는 건너뜀 (하나라도 만족하면 206)
+		if (first < 0) {
+			continue;
+		}
+		for (size_t i = 0; i < ranges.size() && !overlapping; ++i) {
+			overlapping = (first <= ranges[i].last && ranges[i].first <= last);
+		}
+		ranges.push_back(ByteRange(first, last));
+	}
+
+	if (!any) {
+		return RANGE_NONE;
+	}
+	if (ranges.empty()) {
+		return RANGE_UNSATISFIABLE;
+	}
+	if (overlapping || ranges.size() > MAX_RANGES) {
+		coalesce(ranges);
+		if (ranges.size() > MAX_RANGES) {
+			ranges.clear();
+			return RANGE_NONE;
+		}
+	}
+	return RANGE_SATISFIABLE;
+}
+
+std::string RangeRequest::contentRange(const ByteRange& range, off_t size) {
+	std::ostringstream oss;
+	oss << "bytes " << range.first << "-" << range.last << "/" << size;
+	return oss.str();
+}
+
+std::string RangeRequest::makeBoundary() {
+	static unsigned long counter = 0;
+	std::ostringstream oss;
+	oss.fill('0');
+	oss.width(20);
+	oss << (static_cast<unsigned long>(::time(NULL)) * 1000003UL + ++counter);
+	return oss.str();
+}
@@ -1,5 +1,8 @@
 #include "http/RequestRouter.hpp"
 #include "config/ConfApplicator.hpp"
+#include "http/RouteTable.hpp"
+#include "http/VirtualHostTable.hpp"
+#include "http/HttpMethod.hpp"
 #include <algorithm>
 
 const ServerContext* RequestRouter::findServerForRequest(const HttpRequest* request, int connected_port) {
@@ -11,98 +14,28 @@ const ServerContext* RequestRouter::findServerForRequest(const HttpRequest* requ
 	DEBUG_LOG("[RequestRouter] ===== Finding server for request =====");
 	DEBUG_LOG("[RequestRouter] Connected port: " << connected_port);
 	
-	const ConfigDTO* global_config = ConfApplicator::getGlobalConfig();
-	if (global_config == NULL) {
+	const VirtualHostTable* vhosts = ConfApplicator::getVirtualHosts();
+	if (vhosts == NULL) {
 		ERROR_LOG("[RequestRouter] Global config is NULL");
 		return NULL;
 	}
 
-	if (request == NULL) {
-		ERROR_LOG("[RequestRouter] Request is NULL");
-		return NULL;
-	}
-
-	std::string host_header = request->getHeader("Host");
-	DEBUG_LOG("[RequestRouter] Host header: " << (host_header.empty() ? "(empty)" : host_header));
-	
-	std::string::size_type colon_pos = host_header.find(':');
-	if (colon_pos != std::string::npos) {
-		std::string original_host = host_header;
-		host_header = host_header.substr(0, colon_pos);
-	}
-
-	const std::vector<ServerContext>& servers = global_config->httpContext.serverContexts;
-	if (servers.empty()) {
-		ERROR_LOG("[RequestRouter] No servers configured");
-		return NULL;
-	}
-	
-	DEBUG_LOG("[RequestRouter] Total servers in config: " << servers.size());
-	
-	const ServerContext* default_server = NULL;
-	const ServerContext* first_port_match = NULL;
+	// 헤더 키는 파싱 시 소문자로 저장되므로 복사 없이 바로 조회
+	const std::map<std::string, std::string>& headers = request->getHeaders();
+	std::map<std::string, std::string>::const_iterator host_it = headers.find("host");
 
-	int server_index = 0;
-	for (std::vector<ServerContext>::const_iterator it = servers.begin(); it != servers.end(); ++it) {
-		const ServerContext& server = *it;
-		
-
-		if (server.opListenDirective.empty()) {
-			server_index++;
-			continue;
-		}
-
-		// listen 지시어 순회
-		int listen_index = 0;
-		for (std::vector<ListenDirective>::const_iterator listen_it = server.opListenDirective.begin(); 
-			 listen_it != server.opListenDirective.end(); ++listen_it) {
-			const ListenDirective& listen = *listen_it;
-			
-			if (listen.port != connected_port) {
-				listen_index++;
-				continue;
-			}
-
-			// 1. Host 헤더와 포트가 모두 일치하는 서버 우선 탐색
-			if (!server.opServerNameDirective.empty()) {
-				std::string server_name = server.opServerNameDirective[0].name;
-				
-				if (server_name == host_header) {
-					DEBUG_LOG("[RequestRouter] Exact match found! server #" << server_index << " name=" << server_name);
-					return &server; // 가장 정확한 매치
-				}
-			}
-
-			// 2. default_server 저장 (첫 번째 것만)
-			if (listen.default_server && default_server == NULL) {
-				DEBUG_LOG("[RequestRouter] Found default_server: server #" << server_index);
-				default_server = &server;
-			}
-			
-			// 3. 포트만 일치하는 첫 번째 서버 저장
-			if (first_port_match == NULL) {
-				first_port_match = &server;
-			}
-			
-			listen_index++;
-		}
-		
-		server_index++;
+	const ServerContext* server = NULL;
+	if (host_it != headers.end()) {
+		DEBUG_LOG("[RequestRouter] Host header: " << host_it->second);
+		server = vhosts->find(connected_port, host_it->second.data(), host_it->second.length());
+	} else {
+		server = vhosts->find(connected_port, "", 0);
 	}
 
-	// 4. 우선순위에 따라 반환
-	if (default_server != NULL) {
-		DEBUG_LOG("[RequestRouter] Using default_server");
-		return default_server;
-	}
-	
-	if (first_port_match != NULL) {
-		DEBUG_LOG("[RequestRouter] Using first port match");
-		return first_port_match;
+	if (server == NULL) {
+		ERROR_LOG("[RequestRouter] No matching server found for port=" << connected_port);
 	}
-
-	ERROR_LOG("[RequestRouter] No matching server found for port=" << connected_port << " host=" << host_header);
-	return NULL;
+	return server;
 }
 
 
@@ -119,159 +52,28 @@ const LocationContext* RequestRouter::findLocationForRequest(
 		return NULL;
 	}
 
-	// 쿼리 스트링 제거
-	std::string cleanUri = uri;
-	size_t queryPos = uri.find('?');
-	if (queryPos != std::string::npos) {
-		cleanUri = uri.substr(0, queryPos);
-	}
-
-	const LocationContext* exactMatch = NULL;
-	const LocationContext* longestPrefixMatch = NULL;
-	size_t longestPrefixLength = 0;
-	const LocationContext* extensionMatch = NULL;
-
-	const std::vector<LocationContext>& locations = server->locationContexts;
-	DEBUG_LOG("[RequestRouter] Total locations in server: " << locations.size());
-
-	// 모든 location을 순회하며 매칭
-	int loc_index = 0;
-	for (std::vector<LocationContext>::const_iterator it = locations.begin(); 
-		 it != locations.end(); ++it) {
-		const LocationContext& loc = *it;
-
-		// matchType에 따라 다른 매칭 로직
-		switch (loc.matchType) {
-			case MATCH_EXACT:
-				// 정확히 일치
-				if (cleanUri == loc.path) {
-					exactMatch = &loc;
-					// EXACT 찾으면 더 이상 검색 불필요 (최우선)
-					// 하지만 루프는 계속 (break로 switch만 빠져나감)
-				}
-				break;
-
-			case MATCH_EXTENSION:
-				// 확장자 매칭
-				if (cleanUri.length() >= loc.path.length()) {
-					std::string uriExtension = cleanUri.substr(
-						cleanUri.length() - loc.path.length()
-					);
-					if (uriExtension == loc.path) {
-						extensionMatch = &loc;
-					}
-				}
-				break;
-
-			case MATCH_PREFIX:
-				// PREFIX 매칭
-				{
-					bool prefix_match = false;
-					
-					// location path가 /로 끝나는 경우
-					if (!loc.path.empty() && loc.path[loc.path.length() - 1] == '/') {
-						if (cleanUri.compare(0, loc.path.length(), loc.path) == 0) {
-							prefix_match = true;
-						} else if (cleanUri + "/" == loc.path) {
-							prefix_match = true;
-						}
-					} 
-					// location path가 /로 끝나지 않는 경우
-					else {
-						if (cleanUri.compare(0, loc.path.length(), loc.path) == 0) {
-							// 정확히 일치하거나, 다음 문자가 /인 경우만
-							if (cleanUri.length() == loc.path.length() || 
-								(cleanUri.length() > loc.path.length() && 
-								 cleanUri[loc.path.length()] == '/')) {
-								prefix_match = true;
-							}
-						}
-					}
-					
-					if (prefix_match) {
-						// 가장 긴 PREFIX 저장
-						if (loc.path.length() > longestPrefixLength) {
-							longestPrefixLength = loc.path.length();
-							longestPrefixMatch = &loc;
-						}
-					}
-				}
-				break;
-
-			default:
-				ERROR_LOG("[RequestRouter] Unknown matchType: " << loc.matchType);
-				break;
-		}
-		
-		// EXACT 찾았으면 조기 종료 (더 이상 검색 의미 없음)
-		if (exactMatch != NULL) {
-			DEBUG_LOG("[RequestRouter] EXACT match found, stopping search");
-			break;
-		}
-		
-		loc_index++;
+	const RouteTable* table = ConfApplicator::getRouteTable(server);
+	if (table == NULL) {
+		ERROR_LOG("[RequestRouter] No route table for server");
+		return NULL;
 	}
 
-	// 우선순위 (메서드 고려):
-	const LocationContext* selected = NULL;
-
-	if (exactMatch) {
-		selected = exactMatch;
-		DEBUG_LOG("[RequestRouter] Selected EXACT match: " << selected->path);
-	}
-	else if (extensionMatch) {  // ← EXTENSION이 PREFIX보다 우선!
-		// EXTENSION 매칭이 있지만 메서드를 거부하면 PREFIX 시도
-		if (isMethodAllowedInLocation(method, *extensionMatch)) {
-			selected = extensionMatch;
-			DEBUG_LOG("[RequestRouter] Selected EXTENSION match: " << selected->path);
-		}
-		else if (longestPrefixMatch) {
-			// EXTENSION이 메서드를 거부하면 PREFIX로 폴백
-			selected = longestPrefixMatch;
-			DEBUG_LOG("[RequestRouter] EXTENSION method denied, falling back to PREFIX match: "
-					  << selected->path << " length=" << longestPrefixLength);
-		}
-		else {
-			// PREFIX도 없으면 EXTENSION 선택 (나중에 405 반환)
-			selected = extensionMatch;
-			DEBUG_LOG("[RequestRouter] Selected EXTENSION match (no PREFIX fallback): " << selected->path);
-		}
-	}
-	else if (longestPrefixMatch) {
-		selected = longestPrefixMatch;
-		DEBUG_LOG("[RequestRouter] Selected PREFIX match: " << selected->path
-				  << " length=" << longestPrefixLength);
+	// 쿼리 스트링 이전까지만 매칭 (복사 없이 길이만 계산)
+	size_t uriLength = uri.find('?');
+	if (uriLength == std::string::npos) {
+		uriLength = uri.length();
 	}
 
+	const LocationContext* selected = table->find(uri.data(), uriLength, HttpMethod::toMask(method));
 	if (!selected) {
-		ERROR_LOG("[RequestRouter] No matching location found for URI: " << cleanUri);
+		ERROR_LOG("[RequestRouter] No matching location found for URI: " << uri.substr(0, uriLength));
 		return NULL;
 	}
 
-	// 메서드 허용 여부 로깅
-	bool method_allowed = isMethodAllowedInLocation(method, *selected);
-	if (!method_allowed) {
-		DEBUG_LOG("[RequestRouter] Method " << method
-				  << " NOT allowed in location " << selected->path);
-	} else {
-		DEBUG_LOG("[RequestRouter] Method " << method
-				  << " allowed in location " << selected->path);
-	}
-
 	return selected;
 }
 
 
 bool RequestRouter::isMethodAllowedInLocation(const std::string& method, const LocationContext& loc) {
-	if (loc.opLimitExceptDirective.empty()) {
-		return true;
-	}
-
-	const std::set<std::string>& allowed = loc.opLimitExceptDirective[0].allowed_methods;
-
-	if (allowed.find(method) != allowed.end()) {
-		return true;
-	}
-
-	return false;
+	return RouteTable::isMethodAllowed(HttpMethod::toMask(method), loc);
 }
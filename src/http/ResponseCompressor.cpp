@@ -0,0 +1,320 @@
+#include "http/ResponseCompressor.hpp"
+#include "http/HttpRequest.hpp"
+#include "http/HttpResponse.hpp"
+#include "config/CompiledLocation.hpp"
+#include "utils/FileManager.hpp"
+#include "utils/StringUtils.hpp"
+#include "utils/Common.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <ctime>
+#include <sys/resource.h>
+
+const size_t ResponseCompressor::DEFAULT_MIN_LENGTH = 256;
+const int ResponseCompressor::DEFAULT_COMP_LEVEL = 6;
+const size_t ResponseCompressor::STATIC_CACHE_SIZE = 32UL * 1024 * 1024;
+const off_t ResponseCompressor::MAX_STATIC_SIZE = 1024 * 1024;
+
+std::map<std::string, ResponseCompressor::FileVariant> ResponseCompressor::_files;
+std::list<std::string> ResponseCompressor::_fileLru;
+size_t ResponseCompressor::_fileBytes = 0;
+double ResponseCompressor::_cpuLoad = 0;
+double ResponseCompressor::_lastCpu = 0;
+double ResponseCompressor::_lastWall = 0;
+
+static std::string lowerCase(const std::string& value) {
+	std::string lower = value;
+	std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+	return lower;
+}
+
+// CGI/업스트림 응답의 헤더 이름은 대소문자가 제각각이므로 실제 키를 찾음
+static std::string findHeaderKey(const HttpResponse& response, const std::string& name) {
+	const std::map<std::string, std::string>& headers = response.getHeaders();
+	for (std::map<std::string, std::string>::const_iterator it = headers.begin(); it != headers.end(); ++it) {
+		if (lowerCase(it->first) == name) {
+			return it->first;
+		}
+	}
+	return "";
+}
+
+static std::string findHeader(const HttpResponse& response, const std::string& name) {
+	std::string key = findHeaderKey(response, name);
+	return key.empty() ? "" : response.getHeader(key);
+}
+
+static void addVary(HttpResponse& response) {
+	std::string key = findHeaderKey(response, "vary");
+	if (key.empty()) {
+		response.setHeader("Vary", "Accept-Encoding");
+		return;
+	}
+	std::string vary = response.getHeader(key);
+	if (lowerCase(vary).find("accept-encoding") == std::string::npos) {
+		response.setHeader(key, vary + ", Accept-Encoding");
+	}
+}
+
+// 압축하면 바이트가 달라지므로 strong ETag는 weak로 바꾸고, 길이는 다시 계산
+static void markEncoded(HttpResponse& response, ResponseCompressor::Encoding encoding) {
+	std::string length = findHeaderKey(response, "content-length");
+	if (!length.empty()) {
+		response.removeHeader(length);
+	}
+	std::string etagKey = findHeaderKey(response, "etag");
+	if (!etagKey.empty()) {
+		std::string etag = response.getHeader(etagKey);
+		if (etag.compare(0, 2, "W/") != 0) {
+			response.setHeader(etagKey, "W/" + etag);
+		}
+	}
+	response.setHeader("Content-Encoding", ResponseCompressor::encodingName(encoding));
+}
+
+static double monotonicSeconds() {
+	struct timespec ts;
+	::clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// =========================================================================
+// CompressStream
+// =========================================================================
+
+CompressStream::CompressStream() : _ready(false) {
+	std::memset(&_zs, 0, sizeof(_zs));
+}
+
+CompressStream::~CompressStream() {
+	if (_ready) {
+		::deflateEnd(&_zs);
+	}
+}
+
+bool CompressStream::init(bool gzip, int level) {
+	// windowBits 15 + 16: gzip 형식
+	_ready = (::deflateInit2(&_zs, level, Z_DEFLATED, gzip ? 15 + 16 : 15, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+	return _ready;
+}
+
+bool CompressStream::compress(const char* data, size_t len, std::string& out, bool finish) {
+	if (!_ready) {
+		return false;
+	}
+	char buffer[16384];
+	_zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+	_zs.avail_in = static_cast<uInt>(len);
+
+	int flush = finish ? Z_FINISH : Z_SYNC_FLUSH;
+	int result;
+	do {
+		_zs.next_out = reinterpret_cast<Bytef*>(buffer);
+		_zs.avail_out = sizeof(buffer);
+		result = ::deflate(&_zs, flush);
+		if (result == Z_STREAM_ERROR) {
+			return false;
+		}
+		out.append(buffer, sizeof(buffer) - _zs.avail_out);
+	} while (_zs.avail_out == 0 || (finish && result != Z_STREAM_END));
+	return true;
+}
+
+// =========================================================================
+// ResponseCompressor
+// =========================================================================
+
+ResponseCompressor::Encoding ResponseCompressor::negotiate(const HttpRequest* request) {
+	std::string accept = lowerCase(request->getHeader("accept-encoding"));
+	double gzip = -1;
+	double deflate = -1;
+	double any = -1;
+
+	size_t pos = 0;
+	while (pos < accept.length()) {
+		size_t end = accept.find(',', pos);
+		if (end == std::string::npos) {
+			end = accept.length();
+		}
+		std::string item = accept.substr(pos, end - pos);
+		pos = end + 1;
+
+		double q = 1;
+		size_t semicolon = item.find(';');
+		if (semicolon != std::string::npos) {
+			std::string param = StringUtils::trim(item.substr(semicolon + 1));
+			if (param.compare(0, 2, "q=") == 0) {
+				q = std::atof(param.c_str() + 2);
+			}
+			item.erase(semicolon);
+		}
+		item = StringUtils::trim(item);
+		if (item == "gzip" || item == "x-gzip") {
+			gzip = q;
+		} else if (item == "deflate") {
+			deflate = q;
+		} else if (item == "*") {
+			any = q;
+		}
+	}
+
+	if (gzip < 0) {
+		gzip = any;
+	}
+	if (deflate < 0) {
+		deflate = any;
+	}
+	if (gzip > 0 && gzip >= deflate) {
+		return GZIP;
+	}
+	return deflate > 0 ? DEFLATE : IDENTITY;
+}
+
+const char* ResponseCompressor::encodingName(Encoding encoding) {
+	return encoding == GZIP ? "gzip" : encoding == DEFLATE ? "deflate" : "identity";
+}
+
+ResponseCompressor::Encoding ResponseCompressor::select(HttpResponse& response, const HttpRequest* request,
+														 const CompiledLocation* location, size_t length) {
+	if (location == NULL || !location->gzip || request == NULL) {
+		return IDENTITY;
+	}
+	int status = response.getStatus();
+	if (status < 200 || status == 204 || status == 206 || status == 304) {
+		return IDENTITY;
+	}
+	if (!findHeaderKey(response, "content-encoding").empty()
+		|| lowerCase(findHeader(response, "cache-control")).find("no-transform") != std::string::npos) {
+		return IDENTITY;
+	}
+
+	std::string type = lowerCase(findHeader(response, "content-type"));
+	type = StringUtils::trim(type.substr(0, type.find(';')));
+	const std::vector<std::string>& types = location->gzipTypes;
+	if (std::find(types.begin(), types.end(), type) == types.end()
+		&& std::find(types.begin(), types.end(), "*") == types.end()) {
+		return IDENTITY;
+	}
+
+	addVary(response);
+	if (length < location->gzipMinLength) {
+		return IDENTITY;
+	}
+	return negotiate(request);
+}
+
+bool ResponseCompressor::compressBody(const std::string& body, Encoding encoding, int level, std::string& out) {
+	CompressStream stream;
+	out.clear();
+	out.reserve(body.size() / 3 + 64);
+	return stream.init(encoding == GZIP, level) && stream.compress(body.data(), body.size(), out, true);
+}
+
+void ResponseCompressor::compressResponse(HttpResponse& response, const HttpRequest* request,
+										  const CompiledLocation* location) {
+	const std::string body = response.getBody();
+	if (body.empty()) {
+		return;
+	}
+	Encoding encoding = select(response, request, location, body.size());
+	if (encoding == IDENTITY) {
+		return;
+	}
+
+	std::string compressed;
+	if (!compressBody(body, encoding, level(location->gzipCompLevel), compressed)) {
+		ERROR_LOG("[ResponseCompressor] deflate failed, sending uncompressed response");
+		return;
+	}
+	response.setBody(compressed);
+	markEncoded(response, encoding);
+}
+
+CompressStream* ResponseCompressor::startStream(HttpResponse& head, const HttpRequest* request,
+												const CompiledLocation* location) {
+	std::string length = findHeader(head, "content-length");
+	size_t expected = length.empty() ? static_cast<size_t>(-1) : static_cast<size_t>(std::atol(length.c_str()));
+
+	Encoding encoding = select(head, request, location, expected);
+	if (encoding == IDENTITY) {
+		return NULL;
+	}
+
+	CompressStream* stream = new CompressStream();
+	if (!stream->init(encoding == GZIP, level(location->gzipCompLevel))) {
+		delete stream;
+		return NULL;
+	}
+	markEncoded(head, encoding);
+	return stream;
+}
+
+const std::string* ResponseCompressor::compressFile(const std::string& path, const struct stat& st,
+													Encoding encoding, int level) {
+	std::string key = path + "\n" + encodingName(encoding);
+	std::map<std::string, FileVariant>::iterator it = _files.find(key);
+	if (it != _files.end()) {
+		FileVariant& variant = it->second;
+		if (variant.mtime == st.st_mtime && variant.size == st.st_size && variant.inode == st.st_ino) {
+			_fileLru.splice(_fileLru.begin(), _fileLru, variant.lru);
+			return &variant.body;
+		}
+		_fileBytes -= variant.body.size();
+		_fileLru.erase(variant.lru);
+		_files.erase(it);
+	}
+
+	std::string content;
+	std::string compressed;
+	if (!FileManager::readFile(path, content) || !compressBody(content, encoding, level, compressed)) {
+		return NULL;
+	}
+
+	// MAX_STATIC_SIZE 이하만 받으므로 결과는 항상 캐시에 들어감 (방금 넣은 항목은 밀려나지 않음)
+	FileVariant& variant = _files[key];
+	variant.body.swap(compressed);
+	variant.mtime = st.st_mtime;
+	variant.size = st.st_size;
+	variant.inode = st.st_ino;
+	_fileLru.push_front(key);
+	variant.lru = _fileLru.begin();
+	_fileBytes += variant.body.size();
+
+	while (_fileBytes > STATIC_CACHE_SIZE) {
+		std::map<std::string, FileVariant>::iterator oldest = _files.find(_fileLru.back());
+		_fileBytes -= oldest->second.body.size();
+		_files.erase(oldest);
+		_fileLru.pop_back();
+	}
+	return &variant.body;
+}
+
+// 최근 CPU 사용률이 50% 미만이면 최대 레벨, 90% 이상이면 1, 그 사이는 선형으로 낮춤
+int ResponseCompressor::level(int maxLevel) {
+	if (_cpuLoad < 0.5) {
+		return maxLevel;
+	}
+	if (_cpuLoad >= 0.9) {
+		return 1;
+	}
+	int level = maxLevel - static_cast<int>((maxLevel - 1) * (_cpuLoad - 0.5) / 0.4 + 0.5);
+	return level < 1 ? 1 : level;
+}
+
+void ResponseCompressor::updateLoad() {
+	struct rusage usage;
+	if (::getrusage(RUSAGE_SELF, &usage) != 0) {
+		return;
+	}
+	double cpu = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6
+			   + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+	double wall = monotonicSeconds();
+
+	if (_lastWall > 0 && wall > _lastWall) {
+		_cpuLoad = (cpu - _lastCpu) / (wall - _lastWall);
+	}
+	_lastCpu = cpu;
+	_lastWall = wall;
+}
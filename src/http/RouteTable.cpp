@@ -0,0 +1,231 @@
+#include "http/RouteTable.hpp"
+#include "config/CompiledLocation.hpp"
+#include "utils/Common.hpp"
+#include <cstring>
+
+// ========= Radix 노드 =======
+RouteTable::RadixNode::~RadixNode() {
+	for (size_t i = 0; i < children.size(); ++i) {
+		delete children[i];
+	}
+}
+
+RouteTable::RadixNode* RouteTable::RadixNode::findChild(char c) const {
+	if (firstBytes.empty()) {
+		return NULL;
+	}
+	const void* hit = std::memchr(firstBytes.data(), c, firstBytes.length());
+	if (hit == NULL) {
+		return NULL;
+	}
+	return children[static_cast<const char*>(hit) - firstBytes.data()];
+}
+
+void RouteTable::RadixNode::addChild(RadixNode* child) {
+	firstBytes += child->label[0];
+	children.push_back(child);
+}
+
+// ========= 생성자 및 소멸자 =======
+RouteTable::RouteTable()
+	: _exact(false), _extensions(false), _maxExtensionLength(0), _prefixRoot(new RadixNode("")) {}
+
+RouteTable::~RouteTable() {
+	delete _prefixRoot;
+}
+
+// ========= 테이블 구성 =======
+void RouteTable::build(const ServerContext& server) {
+	const std::vector<LocationContext>& locations = server.locationContexts;
+
+	for (size_t i = 0; i < locations.size(); ++i) {
+		const LocationContext& loc = locations[i];
+
+		switch (loc.matchType) {
+			case MATCH_EXACT:
+				// 같은 경로가 여러 번 나오면 먼저 나온 것이 우선
+				_exact.insert(loc.path, &loc);
+				break;
+
+			case MATCH_EXTENSION:
+				// 같은 확장자는 나중 것이 우선 (기존 순회 방식과 동일)
+				_extensions.set(loc.path, ExtensionEntry(&loc, i));
+				if (loc.path.length() > _maxExtensionLength) {
+					_maxExtensionLength = loc.path.length();
+				}
+				break;
+
+			case MATCH_PREFIX:
+				insertPrefix(&loc);
+				break;
+
+			default:
+				ERROR_LOG("[RouteTable] Unknown matchType: " << loc.matchType);
+				break;
+		}
+	}
+
+	DEBUG_LOG("[RouteTable] compiled " << locations.size() << " locations (exact="
+			  << _exact.size() << " ext=" << _extensions.size() << ")");
+}
+
+void RouteTable::insertPrefix(const LocationContext* loc) {
+	const std::string& path = loc->path;
+	RadixNode* node = _prefixRoot;
+	size_t pos = 0;
+
+	while (pos < path.length()) {
+		RadixNode* child = node->findChild(path[pos]);
+
+		if (child == NULL) {
+			RadixNode* leaf = new RadixNode(path.substr(pos));
+			leaf->loc = loc;
+			node->addChild(leaf);
+			return;
+		}
+
+		// 공통 prefix 길이 계산
+		const std::string& label = child->label;
+		size_t common = 0;
+		while (common < label.length() && pos + common < path.length()
+			   && label[common] == path[pos + common]) {
+			common++;
+		}
+
+		if (common < label.length()) {
+			// 간선 분할: child를 중간 노드 아래로 내림
+			RadixNode* middle = new RadixNode(label.substr(0, common));
+			size_t idx = node->firstBytes.find(label[0]);
+			node->children[idx] = middle;
+
+			child->label = label.substr(common);
+			middle->addChild(child);
+			child = middle;
+		}
+
+		node = child;
+		pos += common;
+	}
+
+	// 같은 prefix가 중복되면 먼저 나온 것이 우선
+	if (node->loc == NULL) {
+		node->loc = loc;
+	}
+}
+
+// ========= 조회 =======
+bool RouteTable::isMethodAllowed(unsigned int methodMask, const LocationContext& loc) {
+	if (loc.compiled != NULL) {
+		return (loc.compiled->methodMask & methodMask) != 0;
+	}
+	if (loc.opLimitExceptDirective.empty()) {
+		return true;
+	}
+	return (loc.opLimitExceptDirective[0].methodMask & methodMask) != 0;
+}
+
+const LocationContext* RouteTable::findExact(const char* uri, size_t len) const {
+	const LocationContext* const* hit = _exact.find(uri, len);
+	return hit ? *hit : NULL;
+}
+
+const LocationContext* RouteTable::findExtension(const char* uri, size_t len) const {
+	if (_extensions.empty()) {
+		return NULL;
+	}
+
+	// 마지막 경로 세그먼트 안의 '.' 위치들만 후보 (최대 확장자 길이까지만 역방향 탐색)
+	const ExtensionEntry* best = NULL;
+	size_t limit = (len > _maxExtensionLength) ? len - _maxExtensionLength : 0;
+
+	for (size_t i = len; i > limit; --i) {
+		char c = uri[i - 1];
+		if (c == '/') {
+			break;
+		}
+		if (c != '.') {
+			continue;
+		}
+		const ExtensionEntry* entry = _extensions.find(uri + i - 1, len - i + 1);
+		if (entry && (best == NULL || entry->order > best->order)) {
+			best = entry;
+		}
+	}
+	return best ? best->loc : NULL;
+}
+
+const LocationContext* RouteTable::findPrefix(const char* uri, size_t len) const {
+	const LocationContext* best = NULL;
+	const RadixNode* node = _prefixRoot;
+	size_t pos = 0;
+
+	while (true) {
+		// 노드 깊이 == location path 길이. 더 깊은 매칭이 항상 더 긴 prefix.
+		// path가 '/'로 끝나지 않으면 경계(URI 끝 또는 다음 문자 '/')에서만 매칭
+		if (node->loc != NULL &&
+			(uri[pos - 1] == '/' || pos == len || uri[pos] == '/')) {
+			best = node->loc;
+		}
+
+		if (pos == len) {
+			// "/dir" 요청이 "/dir/" location에 매칭되는 경우
+			const RadixNode* slash = node->findChild('/');
+			if (slash && slash->label.length() == 1 && slash->loc) {
+				best = slash->loc;
+			}
+			break;
+		}
+
+		const RadixNode* child = node->findChild(uri[pos]);
+		if (child == NULL) {
+			break;
+		}
+
+		const std::string& label = child->label;
+		size_t remain = len - pos;
+
+		if (remain < label.length()) {
+			// URI가 간선 중간에서 끝남: URI + "/" == path 인 경우만 매칭
+			if (label.length() == remain + 1 && label[remain] == '/' && child->loc
+				&& std::memcmp(label.data(), uri + pos, remain) == 0) {
+				best = child->loc;
+			}
+			break;
+		}
+
+		if (std::memcmp(label.data(), uri + pos, label.length()) != 0) {
+			break;
+		}
+
+		pos += label.length();
+		node = child;
+	}
+
+	return best;
+}
+
+const LocationContext* RouteTable::find(const char* uri, size_t len, unsigned int methodMask) const {
+	const LocationContext* exact = findExact(uri, len);
+	if (exact) {
+		DEBUG_LOG("[RouteTable] Selected EXACT match: " << exact->path);
+		return exact;
+	}
+
+	const LocationContext* prefix = findPrefix(uri, len);
+	const LocationContext* extension = findExtension(uri, len);
+
+	if (extension) {
+		// EXTENSION이 메서드를 거부하면 PREFIX로 폴백, PREFIX도 없으면 EXTENSION (나중에 405)
+		if (isMethodAllowed(methodMask, *extension) || prefix == NULL) {
+			DEBUG_LOG("[RouteTable] Selected EXTENSION match: " << extension->path);
+			return extension;
+		}
+		DEBUG_LOG("[RouteTable] EXTENSION method denied, falling back to PREFIX match: " << prefix->path);
+		return prefix;
+	}
+
+	if (prefix) {
+		DEBUG_LOG("[RouteTable] Selected PREFIX match: " << prefix->path);
+	}
+	return prefix;
+}
@@ -7,6 +7,7 @@ std::string StatusCode::getReasonPhrase(int code) {
 		case 201: return "Created";
 		case 202: return "Accepted";
 		case 204: return "No Content";
+		case 206: return "Partial Content";
 
 		// 3xx Redirection
 		case 301: return "Moved Permanently";
@@ -24,6 +25,7 @@ std::string StatusCode::getReasonPhrase(int code) {
 		case 410: return "Gone";
 		case 413: return "Payload Too Large";
 		case 414: return "URI Too Long";
+		case 416: return "Range Not Satisfiable";
 		case 431: return "Request Header Fields Too Large";  // ← 추가!
 
 		// 5xx Server Error
@@ -60,6 +62,8 @@ std::string StatusCode::getErrorDescription(int code) {
 			return "The request body is too large.";
 		case 414:
 			return "The request URI is too long.";
+		case 416:
+			return "The requested range cannot be satisfied.";
 		case 431:
 			return "The request header fields are too large.";  // ← 추가!
 		case 500:
@@ -81,10 +85,10 @@ std::string StatusCode::getErrorDescription(int code) {
 
 bool StatusCode::isValidStatusCode(int code) {
 	switch (code) {
-		case 200: case 201: case 202: case 204:
+		case 200: case 201: case 202: case 204: case 206:
 		case 301: case 302: case 304:
 		case 400: case 401: case 403: case 404: case 405:
-		case 408: case 409: case 410: case 413: case 414: case 431:
+		case 408: case 409: case 410: case 413: case 414: case 416: case 431:
 		case 500: case 501: case 502: case 503: case 504: case 505:
 			return true;
 		default:
@@ -0,0 +1,113 @@
+#include "http/VirtualHostTable.hpp"
+#include "utils/Common.hpp"
+
+VirtualHostTable::VirtualHostTable() {}
+
+VirtualHostTable::~VirtualHostTable() {
+	for (std::map<int, PortHosts*>::iterator it = _ports.begin(); it != _ports.end(); ++it) {
+		delete it->second;
+	}
+}
+
+void VirtualHostTable::addName(PortHosts* hosts, const std::string& name, const ServerContext* server) {
+	// 같은 포트에서 이름이 겹치면 먼저 정의된 server가 우선
+	if (name.length() > 2 && name[0] == '*' && name[1] == '.') {
+		hosts->leading.insert(name.substr(1), server);
+	} else if (name.length() > 1 && name[0] == '.') {
+		// ".example.com" = "example.com" + "*.example.com"
+		hosts->exact.insert(name.substr(1), server);
+		hosts->leading.insert(name, server);
+	} else if (name.length() > 2 && name[name.length() - 1] == '*') {
+		hosts->trailing.insert(name.substr(0, name.length() - 1), server);
+	} else {
+		hosts->exact.insert(name, server);
+	}
+}
+
+void VirtualHostTable::build(const std::vector<ServerContext>& servers) {
+	for (size_t i = 0; i < servers.size(); ++i) {
+		const ServerContext& server = servers[i];
+
+		for (size_t j = 0; j < server.opListenDirective.size(); ++j) {
+			const ListenDirective& listen = server.opListenDirective[j];
+
+			PortHosts*& hosts = _ports[listen.port];
+			if (hosts == NULL) {
+				hosts = new PortHosts();
+				hosts->defaultServer = &server;  // 포트의 첫 번째 server
+			}
+
+			// 명시적 default_server는 포트당 첫 번째 것만 인정
+			if (listen.default_server && !hosts->explicitDefault) {
+				hosts->defaultServer = &server;
+				hosts->explicitDefault = true;
+			}
+
+			for (size_t k = 0; k < server.opServerNameDirective.size(); ++k) {
+				addName(hosts, server.opServerNameDirective[k].name, &server);
+			}
+		}
+	}
+
+	DEBUG_LOG("[VirtualHostTable] compiled " << servers.size() << " servers on " << _ports.size() << " ports");
+}
+
+const ServerContext* VirtualHostTable::find(int port, const char* host, size_t len) const {
+	std::map<int, PortHosts*>::const_iterator pit = _ports.find(port);
+	if (pit == _ports.end()) {
+		return NULL;
+	}
+	const PortHosts* hosts = pit->second;
+
+	// 포트 제거 ("[::1]:8080", "example.com:8080") 및 끝의 '.' 제거
+	size_t end = len;
+	if (len > 0 && host[0] == '[') {
+		for (size_t i = 0; i < len; ++i) {
+			if (host[i] == ']') {
+				end = i + 1;
+				break;
+			}
+		}
+	} else {
+		for (size_t i = 0; i < len; ++i) {
+			if (host[i] == ':') {
+				end = i;
+				break;
+			}
+		}
+	}
+	if (end > 0 && host[end - 1] == '.') {
+		end--;
+	}
+
+	if (end == 0) {
+		return hosts->defaultServer;
+	}
+
+	// 1. 정확한 이름
+	const ServerContext* const* hit = hosts->exact.find(host, end);
+	if (hit) {
+		return *hit;
+	}
+
+	// 2. 앞쪽 와일드카드: 왼쪽 '.'부터 검사하면 가장 긴 suffix가 먼저 나옴
+	if (!hosts->leading.empty()) {
+		for (size_t i = 0; i < end; ++i) {
+			if (host[i] == '.' && (hit = hosts->leading.find(host + i, end - i)) != NULL) {
+				return *hit;
+			}
+		}
+	}
+
+	// 3. 뒤쪽 와일드카드: 오른쪽 '.'부터 검사하면 가장 긴 prefix가 먼저 나옴
+	if (!hosts->trailing.empty()) {
+		for (size_t i = end; i > 0; --i) {
+			if (host[i - 1] == '.' && (hit = hosts->trailing.find(host, i)) != NULL) {
+				return *hit;
+			}
+		}
+	}
+
+	// 4. default_server
+	return hosts->defaultServer;
+}
@@ -1,9 +1,34 @@
 #include "http/handler/GetHandler.hpp"
 #include "http/StatusCode.hpp"
+#include "http/MimeTypes.hpp"
+#include "http/ResponseCompressor.hpp"
+#include "http/ConditionalRequest.hpp"
+#include "http/RangeRequest.hpp"
+#include "config/CompiledLocation.hpp"
 #include "utils/PathResolver.hpp"
 #include "utils/FileUtils.hpp"
 #include "utils/FileManager.hpp"
 #include "utils/Common.hpp"
+#include <sstream>
+#include <fcntl.h>
+#include <strings.h>
+#include <ctime>
+
+static std::string lengthString(off_t length) {
+    std::ostringstream oss;
+    oss << length;
+    return oss.str();
+}
+
+// 파일 전체를 조각 하나로: 메모리에 읽지 않고 Client가 sendfile(TLS면 SSL_sendfile)로 보냄
+static bool setWholeFileBody(HttpResponse* response, const std::string& path, off_t size) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return false;
+    }
+    response->setFileBody(fd, std::vector<FileSegment>(1, FileSegment("", 0, size)));
+    return true;
+}
 
 
 HttpResponse* GetHandler::handle(const HttpRequest* request,
@@ -30,11 +55,23 @@ HttpResponse* GetHandler::handle(const HttpRequest* request,
 
     DEBUG_LOG("[GetHandler] ===== Handling GET request =====");
 
+    HttpResponse* response = serveResource(request, serverConf, locConf);
+    applyCacheHeaders(response, request, locConf);
+    return response;
+}
+
+
+HttpResponse* GetHandler::serveResource(const HttpRequest* request,
+                                        const ServerContext* serverConf,
+                                        const LocationContext* locConf) {
+
     std::string uri = request->getUri();
     std::string resourcePath = PathResolver::resolvePath(serverConf, locConf, uri);
     DEBUG_LOG("[GetHandler] Resolved path: " << resourcePath);
 
-    if (!FileUtils::pathExists(resourcePath)) {
+    // 존재 여부, 종류, 검증자를 stat 한 번으로 확인
+    struct stat st;
+    if (::stat(resourcePath.c_str(), &st) != 0) {
         ERROR_LOG("[GetHandler] Path not found: " << resourcePath);
         return new HttpResponse(
             HttpResponse::createErrorResponse(StatusCode::NOT_FOUND, serverConf, locConf)
@@ -42,7 +79,7 @@ HttpResponse* GetHandler::handle(const HttpRequest* request,
     }
 
     // 디렉토리 trailing slash 리다이렉트
-    if (FileUtils::isDirectory(resourcePath)) {
+    if (S_ISDIR(st.st_mode)) {
         if (!uri.empty() && uri[uri.length() - 1] != '/') {
             DEBUG_LOG("[GetHandler] Directory without trailing slash, redirecting: " << uri << " -> " << uri << "/");
             HttpResponse* response = new HttpResponse();
@@ -56,13 +93,12 @@ HttpResponse* GetHandler::handle(const HttpRequest* request,
         DEBUG_LOG("[GetHandler] Path is directory: " << resourcePath);
 
         std::string indexPath = PathResolver::findIndexFile(resourcePath, locConf);
-        if (!indexPath.empty()) {
+        if (!indexPath.empty() && ::stat(indexPath.c_str(), &st) == 0) {
             DEBUG_LOG("[GetHandler] Index file found: " << indexPath);
-            return serveStaticFile(indexPath, locConf);
+            return serveStaticFile(request, indexPath, st, locConf);
         }
 
-        if (!locConf->opAutoindexDirective.empty() &&
-            locConf->opAutoindexDirective[0].enabled) {
+        if (locConf->compiled->autoindex) {
             DEBUG_LOG("[GetHandler] Serving directory listing (autoindex enabled)");
             return serveDirectoryListing(resourcePath, uri);
         }
@@ -74,28 +110,20 @@ HttpResponse* GetHandler::handle(const HttpRequest* request,
     }
 
     DEBUG_LOG("[GetHandler] Serving static file: " << resourcePath);
-    return serveStaticFile(resourcePath, locConf);
+    return serveStaticFile(request, resourcePath, st, locConf);
 }
 
 
-HttpResponse* GetHandler::serveStaticFile(const std::string& filePath,
+HttpResponse* GetHandler::serveStaticFile(const HttpRequest* request,
+                                          const std::string& filePath,
+                                          const struct stat& st,
                                           const LocationContext* locConf) {
-    DEBUG_LOG("[GetHandler] Reading static file: " << filePath);
+    DEBUG_LOG("[GetHandler] Serving static file: " << filePath);
 
-    std::string content;
-
-    if (!FileManager::readFile(filePath, content)) {
-        ERROR_LOG("[GetHandler] Failed to read file: " << filePath);
-        return new HttpResponse(
-            HttpResponse::createErrorResponse(StatusCode::INTERNAL_SERVER_ERROR, NULL, locConf)
-        );
-    }
-
-    std::string mimeType = FileUtils::getMimeTypeFromPath(filePath);
+    const std::string& mimeType = MimeTypes::fromPath(filePath);
 
     HttpResponse* response = new HttpResponse();
     response->setStatus(StatusCode::OK);
-    response->setBody(content);
     response->setContentType(mimeType);
 
     if (mimeType.find("text/") == 0 || mimeType.find("image/") == 0 ||
@@ -108,10 +136,241 @@ HttpResponse* GetHandler::serveStaticFile(const std::string& filePath,
         response->setHeader("Content-Disposition", "attachment; filename=\"" + filename + "\"");
     }
 
+    // 보낼 표현(원본/압축)을 먼저 정해야 ETag가 정해짐. 압축본은 바이트가 다르므로 weak
+    std::string precompressed;
+    ResponseCompressor::Encoding encoding = selectEncoding(response, request, filePath, st, locConf, precompressed);
+
+    std::string etag = ConditionalRequest::makeETag(st);
+    if (encoding != ResponseCompressor::IDENTITY) {
+        etag = "W/" + etag;
+    }
+    response->setHeader("ETag", etag);
+    response->setHeader("Last-Modified", ConditionalRequest::formatDate(st.st_mtime));
+
+    // 304: 파일을 열지 않고 헤더만 보냄
+    if (ConditionalRequest::isNotModified(request, etag, st.st_mtime)) {
+        DEBUG_LOG("[GetHandler] Not modified: " << filePath);
+        response->setStatus(StatusCode::NOT_MODIFIED);
+        response->removeHeader("Content-Disposition");
+        return response;
+    }
+
+    if (encoding != ResponseCompressor::IDENTITY) {
+        response->setHeader("Content-Encoding", ResponseCompressor::encodingName(encoding));
+    } else {
+        // 범위는 원본 바이트 기준이므로 압축하지 않는 표현에만 적용
+        response->setHeader("Accept-Ranges", "bytes");
+        std::string range = request->getHeader("range");
+        if (!range.empty() && request->getMethod() == "GET"
+            && ConditionalRequest::isRangeFresh(request, etag, st.st_mtime)) {
+            std::vector<ByteRange> ranges;
+            RangeRequest::Result result = RangeRequest::parse(range, st.st_size, ranges);
+            if (result == RangeRequest::RANGE_UNSATISFIABLE) {
+                DEBUG_LOG("[GetHandler] Unsatisfiable range: " << range);
+                delete response;
+                response = new HttpResponse(
+                    HttpResponse::createErrorResponse(StatusCode::RANGE_NOT_SATISFIABLE, NULL, locConf)
+                );
+                response->setHeader("Content-Range", "bytes */" + lengthString(st.st_size));
+                return response;
+            }
+            if (result == RangeRequest::RANGE_SATISFIABLE) {
+                return serveRanges(response, filePath, st, ranges, locConf);
+            }
+        }
+    }
+
+    if (!loadBody(response, request, filePath, st, encoding, precompressed, locConf)) {
+        ERROR_LOG("[GetHandler] Failed to read file: " << filePath);
+        delete response;
+        return new HttpResponse(
+            HttpResponse::createErrorResponse(StatusCode::INTERNAL_SERVER_ERROR, NULL, locConf)
+        );
+    }
     return response;
 }
 
 
+HttpResponse* GetHandler::serveRanges(HttpResponse* response,
+                                      const std::string& filePath,
+                                      const struct stat& st,
+                                      const std::vector<ByteRange>& ranges,
+                                      const LocationContext* locConf) {
+    int fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        ERROR_LOG("[GetHandler] Failed to open file: " << filePath);
+        delete response;
+        return new HttpResponse(
+            HttpResponse::createErrorResponse(StatusCode::INTERNAL_SERVER_ERROR, NULL, locConf)
+        );
+    }
+
+    std::vector<FileSegment> segments;
+    response->setStatus(StatusCode::PARTIAL_CONTENT);
+
+    if (ranges.size() == 1) {
+        response->setHeader("Content-Range", RangeRequest::contentRange(ranges[0], st.st_size));
+        segments.push_back(FileSegment("", ranges[0].first, ranges[0].length()));
+    } else {
+        // multipart/byteranges: 파트마다 경계와 헤더를 앞에 붙이고 마지막에 닫는 경계
+        std::string boundary = RangeRequest::makeBoundary();
+        std::string partType = "\r\nContent-Type: " + response->getContentType() + "\r\nContent-Range: ";
+        for (size_t i = 0; i < ranges.size(); ++i) {
+            segments.push_back(FileSegment(
+                "\r\n--" + boundary + partType + RangeRequest::contentRange(ranges[i], st.st_size) + "\r\n\r\n",
+                ranges[i].first, ranges[i].length()));
+        }
+        segments.push_back(FileSegment("\r\n--" + boundary + "--\r\n", 0, 0));
+        response->setContentType("multipart/byteranges; boundary=" + boundary);
+    }
+
+    DEBUG_LOG("[GetHandler] Serving " << ranges.size() << " range(s) of " << filePath);
+    response->setFileBody(fd, segments);
+    return response;
+}
+
+
+ResponseCompressor::Encoding GetHandler::selectEncoding(HttpResponse* response,
+                                                        const HttpRequest* request,
+                                                        const std::string& filePath,
+                                                        const struct stat& st,
+                                                        const LocationContext* locConf,
+                                                        std::string& precompressed) {
+    const CompiledLocation* compiled = locConf->compiled;
+
+    // gzip_static: 미리 압축해 둔 <파일>.gz가 있으면 그대로 보냄
+    if (compiled->gzipStatic && ResponseCompressor::negotiate(request) == ResponseCompressor::GZIP
+        && FileUtils::isReadable(filePath + ".gz")) {
+        DEBUG_LOG("[GetHandler] Using precompressed " << filePath << ".gz");
+        precompressed = filePath + ".gz";
+        response->setHeader("Vary", "Accept-Encoding");
+        return ResponseCompressor::GZIP;
+    }
+
+    // 큰 파일은 이벤트 루프에서 통째로 압축하지 않고 원본을 sendfile로 보냄
+    if (!compiled->gzip || st.st_size > ResponseCompressor::MAX_STATIC_SIZE) {
+        return ResponseCompressor::IDENTITY;
+    }
+    return ResponseCompressor::select(*response, request, compiled, static_cast<size_t>(st.st_size));
+}
+
+
+bool GetHandler::loadBody(HttpResponse* response,
+                          const HttpRequest* request,
+                          const std::string& filePath,
+                          const struct stat& st,
+                          ResponseCompressor::Encoding encoding,
+                          const std::string& precompressed,
+                          const LocationContext* locConf) {
+    bool head = (request->getMethod() == "HEAD");
+
+    if (!precompressed.empty()) {
+        struct stat gzStat;
+        if (::stat(precompressed.c_str(), &gzStat) != 0) {
+            return false;
+        }
+        if (head) {
+            response->setHeader("Content-Length", lengthString(gzStat.st_size));
+            return true;
+        }
+        return setWholeFileBody(response, precompressed, gzStat.st_size);
+    }
+
+    if (encoding != ResponseCompressor::IDENTITY) {
+        // 파일마다 한 번만 압축하므로 부하와 관계없이 gzip_comp_level 그대로 사용
+        const std::string* body =
+            ResponseCompressor::compressFile(filePath, st, encoding, locConf->compiled->gzipCompLevel);
+        if (body == NULL) {
+            return false;
+        }
+        if (head) {
+            response->setHeader("Content-Length", lengthString(static_cast<off_t>(body->size())));
+        } else {
+            response->setBody(*body);
+        }
+        return true;
+    }
+
+    // HEAD는 바디를 보내지 않으므로 크기만 알리고 파일은 읽지 않음
+    if (head) {
+        response->setHeader("Content-Length", lengthString(st.st_size));
+        return true;
+    }
+    return setWholeFileBody(response, filePath, st.st_size);
+}
+
+
+// 파일명에 콘텐츠 해시가 있으면(app.3f9a2c.js, index-9b1c04e2.css) 내용이 바뀌면 이름도 바뀜
+bool GetHandler::isFingerprinted(const std::string& uri) {
+    std::string path = uri.substr(0, uri.find('?'));
+    std::string name = path.substr(path.find_last_of('/') + 1);
+
+    size_t ext = name.find_last_of('.');
+    if (ext == std::string::npos || ext == 0) {
+        return false;
+    }
+    size_t start = name.find_last_of(".-", ext - 1);
+    if (start == std::string::npos) {
+        return false;
+    }
+    std::string hash = name.substr(start + 1, ext - start - 1);
+    if (hash.length() < 6 || hash.length() > 64 || hash.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos) {
+        return false;
+    }
+    // 10자리 날짜나 "facade" 같은 단어를 해시로 보지 않도록 숫자와 문자가 모두 있어야 함
+    return hash.find_first_of("0123456789") != std::string::npos
+        && hash.find_first_of("abcdefABCDEF") != std::string::npos;
+}
+
+
+void GetHandler::applyCacheHeaders(HttpResponse* response,
+                                   const HttpRequest* request,
+                                   const LocationContext* locConf) {
+    const CompiledLocation* compiled = locConf->compiled;
+    int status = response->getStatus();
+    bool success = (status >= 200 && status < 400);
+    time_t now = ::time(NULL);
+
+    if (success && compiled->immutableAssets && isFingerprinted(request->getUri())) {
+        response->setHeader("Cache-Control", "public, max-age=31536000, immutable");
+        response->setHeader("Expires", ConditionalRequest::formatDate(now + 31536000));
+    } else if (success && compiled->expires != NULL) {
+        const ExpiresDirective& expires = *compiled->expires;
+        if (expires.mode == EXPIRES_EPOCH) {
+            response->setHeader("Expires", "Thu, 01 Jan 1970 00:00:01 GMT");
+            response->setHeader("Cache-Control", "no-cache");
+        } else if (expires.mode == EXPIRES_MAX) {
+            response->setHeader("Expires", "Thu, 31 Dec 2037 23:55:55 GMT");
+            response->setHeader("Cache-Control", "max-age=315360000");
+        } else {
+            response->setHeader("Expires", ConditionalRequest::formatDate(now + expires.seconds));
+            response->setHeader("Cache-Control",
+                                expires.seconds < 0 ? "no-cache" : "max-age=" + lengthString(expires.seconds));
+        }
+    }
+
+    if (compiled->addHeaders == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < compiled->addHeaders->size(); ++i) {
+        const AddHeaderDirective& header = (*compiled->addHeaders)[i];
+        if (!success && !header.always) {
+            continue;
+        }
+        // 헤더 키는 대소문자를 구분해 저장되므로 같은 이름의 기존 헤더를 지우고 설정
+        const std::map<std::string, std::string>& headers = response->getHeaders();
+        for (std::map<std::string, std::string>::const_iterator it = headers.begin(); it != headers.end(); ++it) {
+            if (it->first.length() == header.name.length()
+                && ::strncasecmp(it->first.c_str(), header.name.c_str(), header.name.length()) == 0) {
+                response->removeHeader(it->first);
+                break;
+            }
+        }
+        response->setHeader(header.name, header.value);
+    }
+}
+
+
 HttpResponse* GetHandler::serveDirectoryListing(const std::string& dirPath,
                                                 const std::string& uri) {
     DEBUG_LOG("[GetHandler] Generating directory listing for: " << dirPath);
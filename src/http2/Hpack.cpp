@@ -0,0 +1,478 @@
+#include "http2/Hpack.hpp"
+#include <stdint.h>
+
+const size_t HpackTable::STATIC_COUNT = 61;
+const size_t HpackTable::ENTRY_OVERHEAD = 32;
+const size_t HpackEncoder::DEFAULT_TABLE_SIZE = 4096;
+
+// RFC 7541 Appendix A
+static const char* const STATIC_TABLE[61][2] = {
+	{ ":authority", "" },
+	{ ":method", "GET" },
+	{ ":method", "POST" },
+	{ ":path", "/" },
+	{ ":path", "/index.html" },
+	{ ":scheme", "http" },
+	{ ":scheme", "https" },
+	{ ":status", "200" },
+	{ ":status", "204" },
+	{ ":status", "206" },
+	{ ":status", "304" },
+	{ ":status", "400" },
+	{ ":status", "404" },
+	{ ":status", "500" },
+	{ "accept-charset", "" },
+	{ "accept-encoding", "gzip, deflate" },
+	{ "accept-language", "" },
+	{ "accept-ranges", "" },
+	{ "accept", "" },
+	{ "access-control-allow-origin", "" },
+	{ "age", "" },
+	{ "allow", "" },
+	{ "authorization", "" },
+	{ "cache-control", "" },
+	{ "content-disposition", "" },
+	{ "content-encoding", "" },
+	{ "content-language", "" },
+	{ "content-length", "" },
+	{ "content-location", "" },
+	{ "content-range", "" },
+	{ "content-type", "" },
+	{ "cookie", "" },
+	{ "date", "" },
+	{ "etag", "" },
+	{ "expect", "" },
+	{ "expires", "" },
+	{ "from", "" },
+	{ "host", "" },
+	{ "if-match", "" },
+	{ "if-modified-since", "" },
+	{ "if-none-match", "" },
+	{ "if-range", "" },
+	{ "if-unmodified-since", "" },
+	{ "last-modified", "" },
+	{ "link", "" },
+	{ "location", "" },
+	{ "max-forwards", "" },
+	{ "proxy-authenticate", "" },
+	{ "proxy-authorization", "" },
+	{ "range", "" },
+	{ "referer", "" },
+	{ "refresh", "" },
+	{ "retry-after", "" },
+	{ "server", "" },
+	{ "set-cookie", "" },
+	{ "strict-transport-security", "" },
+	{ "transfer-encoding", "" },
+	{ "user-agent", "" },
+	{ "vary", "" },
+	{ "via", "" },
+	{ "www-authenticate", "" }
+};
+
+// RFC 7541 Appendix B (256번은 EOS)
+static const uint32_t HUFFMAN_CODES[257] = {
+	0x1ff8, 0x7fffd8, 0xfffffe2, 0xfffffe3, 0xfffffe4, 0xfffffe5, 0xfffffe6, 0xfffffe7,
+	0xfffffe8, 0xffffea, 0x3ffffffc, 0xfffffe9, 0xfffffea, 0x3ffffffd, 0xfffffeb, 0xfffffec,
+	0xfffffed, 0xfffffee, 0xfffffef, 0xffffff0, 0xffffff1, 0xffffff2, 0x3ffffffe, 0xffffff3,
+	0xffffff4, 0xffffff5, 0xffffff6, 0xffffff7, 0xffffff8, 0xffffff9, 0xffffffa, 0xffffffb,
+	0x14, 0x3f8, 0x3f9, 0xffa, 0x1ff9, 0x15, 0xf8, 0x7fa,
+	0x3fa, 0x3fb, 0xf9, 0x7fb, 0xfa, 0x16, 0x17, 0x18,
+	0x0, 0x1, 0x2, 0x19, 0x1a, 0x1b, 0x1c, 0x1d,
+	0x1e, 0x1f, 0x5c, 0xfb, 0x7ffc, 0x20, 0xffb, 0x3fc,
+	0x1ffa, 0x21, 0x5d, 0x5e, 0x5f, 0x60, 0x61, 0x62,
+	0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a,
+	0x6b, 0x6c, 0x6d, 0x6e, 0x6f, 0x70, 0x71, 0x72,
+	0xfc, 0x73, 0xfd, 0x1ffb, 0x7fff0, 0x1ffc, 0x3ffc, 0x22,
+	0x7ffd, 0x3, 0x23, 0x4, 0x24, 0x5, 0x25, 0x26,
+	0x27, 0x6, 0x74, 0x75, 0x28, 0x29, 0x2a, 0x7,
+	0x2b, 0x76, 0x2c, 0x8, 0x9, 0x2d, 0x77, 0x78,
+	0x79, 0x7a, 0x7b, 0x7ffe, 0x7fc, 0x3ffd, 0x1ffd, 0xffffffc,
+	0xfffe6, 0x3fffd2, 0xfffe7, 0xfffe8, 0x3fffd3, 0x3fffd4, 0x3fffd5, 0x7fffd9,
+	0x3fffd6, 0x7fffda, 0x7fffdb, 0x7fffdc, 0x7fffdd, 0x7fffde, 0xffffeb, 0x7fffdf,
+	0xffffec, 0xffffed, 0x3fffd7, 0x7fffe0, 0xffffee, 0x7fffe1, 0x7fffe2, 0x7fffe3,
+	0x7fffe4, 0x1fffdc, 0x3fffd8, 0x7fffe5, 0x3fffd9, 0x7fffe6, 0x7fffe7, 0xffffef,
+	0x3fffda, 0x1fffdd, 0xfffe9, 0x3fffdb, 0x3fffdc, 0x7fffe8, 0x7fffe9, 0x1fffde,
+	0x7fffea, 0x3fffdd, 0x3fffde, 0xfffff0, 0x1fffdf, 0x3fffdf, 0x7fffeb, 0x7fffec,
+	0x1fffe0, 0x1fffe1, 0x3fffe0, 0x1fffe2, 0x7fffed, 0x3fffe1, 0x7fffee, 0x7fffef,
+	0xfffea, 0x3fffe2, 0x3fffe3, 0x3fffe4, 0x7ffff0, 0x3fffe5, 0x3fffe6, 0x7ffff1,
+	0x3ffffe0, 0x3ffffe1, 0xfffeb, 0x7fff1, 0x3fffe7, 0x7ffff2, 0x3fffe8, 0x1ffffec,
+	0x3ffffe2, 0x3ffffe3, 0x3ffffe4, 0x7ffffde, 0x7ffffdf, 0x3ffffe5, 0xfffff1, 0x1ffffed,
+	0x7fff2, 0x1fffe3, 0x3ffffe6, 0x7ffffe0, 0x7ffffe1, 0x3ffffe7, 0x7ffffe2, 0xfffff2,
+	0x1fffe4, 0x1fffe5, 0x3ffffe8, 0x3ffffe9, 0xffffffd, 0x7ffffe3, 0x7ffffe4, 0x7ffffe5,
+	0xfffec, 0xfffff3, 0xfffed, 0x1fffe6, 0x3fffe9, 0x1fffe7, 0x1fffe8, 0x7ffff3,
+	0x3fffea, 0x3fffeb, 0x1ffffee, 0x1ffffef, 0xfffff4, 0xfffff5, 0x3ffffea, 0x7ffff4,
+	0x3ffffeb, 0x7ffffe6, 0x3ffffec, 0x3ffffed, 0x7ffffe7, 0x7ffffe8, 0x7ffffe9, 0x7ffffea,
+	0x7ffffeb, 0xffffffe, 0x7ffffec, 0x7ffffed, 0x7ffffee, 0x7ffffef, 0x7fffff0, 0x3ffffee,
+	0x3fffffff
+};
+
+static const unsigned char HUFFMAN_LENGTHS[257] = {
+	13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28, 28, 30, 28, 28,
+	28, 28, 28, 28, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+	6, 10, 10, 12, 13, 6, 8, 11, 10, 10, 8, 11, 8, 6, 6, 6,
+	5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 7, 8, 15, 6, 12, 10,
+	13, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+	7, 7, 7, 7, 7, 7, 7, 7, 8, 7, 8, 13, 19, 13, 14, 6,
+	15, 5, 6, 5, 6, 5, 6, 6, 6, 5, 7, 7, 6, 6, 6, 5,
+	6, 7, 6, 5, 5, 6, 7, 7, 7, 7, 7, 15, 11, 14, 13, 28,
+	20, 22, 20, 20, 22, 22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23,
+	24, 24, 22, 23, 24, 23, 23, 23, 23, 21, 22, 23, 22, 23, 23, 24,
+	22, 21, 20, 22, 22, 23, 23, 21, 23, 22, 22, 24, 21, 22, 23, 23,
+	21, 21, 22, 21, 23, 22, 23, 23, 20, 22, 22, 22, 23, 22, 22, 23,
+	26, 26, 20, 19, 22, 23, 22, 25, 26, 26, 26, 27, 27, 26, 24, 25,
+	19, 21, 26, 27, 27, 26, 27, 24, 21, 21, 26, 26, 28, 27, 27, 27,
+	20, 24, 20, 21, 22, 21, 21, 23, 22, 22, 25, 25, 24, 24, 26, 23,
+	26, 27, 26, 26, 27, 27, 27, 27, 27, 28, 27, 27, 27, 27, 27, 26,
+	30
+};
+
+// =========================================================================
+// Huffman
+// =========================================================================
+
+struct HuffmanNode {
+	int		child[2];	// 0이면 없음 (루트는 자식이 될 수 없음)
+	int		symbol;		// 내부 노드는 -1
+
+	HuffmanNode() : symbol(-1) { child[0] = 0; child[1] = 0; }
+};
+
+// 코드 테이블로 디코딩 트리를 처음 한 번만 만듦
+static const std::vector<HuffmanNode>& huffmanTree() {
+	static std::vector<HuffmanNode> tree;
+
+	if (tree.empty()) {
+		tree.push_back(HuffmanNode());
+		for (int symbol = 0; symbol < 257; ++symbol) {
+			size_t node = 0;
+			for (int bit = HUFFMAN_LENGTHS[symbol] - 1; bit >= 0; --bit) {
+				int branch = (HUFFMAN_CODES[symbol] >> bit) & 1;
+				if (tree[node].child[branch] == 0) {
+					tree[node].child[branch] = static_cast<int>(tree.size());
+					tree.push_back(HuffmanNode());
+				}
+				node = tree[node].child[branch];
+			}
+			tree[node].symbol = symbol;
+		}
+	}
+	return tree;
+}
+
+// EOS가 나오거나, 끝의 패딩이 7비트를 넘거나 1로만 되어 있지 않으면 실패 (RFC 7541 5.2)
+static bool huffmanDecode(const unsigned char* data, size_t len, std::string& out) {
+	const std::vector<HuffmanNode>& tree = huffmanTree();
+	size_t node = 0;
+	int depth = 0;
+	bool allOnes = true;
+
+	for (size_t i = 0; i < len; ++i) {
+		for (int bit = 7; bit >= 0; --bit) {
+			int branch = (data[i] >> bit) & 1;
+			node = tree[node].child[branch];
+			if (node == 0) {
+				return false;
+			}
+			++depth;
+			allOnes = allOnes && branch == 1;
+			if (tree[node].symbol >= 0) {
+				if (tree[node].symbol == 256) {
+					return false;
+				}
+				out += static_cast<char>(tree[node].symbol);
+				node = 0;
+				depth = 0;
+				allOnes = true;
+			}
+		}
+	}
+	return depth < 8 && allOnes;
+}
+
+static size_t huffmanLength(const std::string& value) {
+	size_t bits = 0;
+	for (size_t i = 0; i < value.size(); ++i) {
+		bits += HUFFMAN_LENGTHS[static_cast<unsigned char>(value[i])];
+	}
+	return (bits + 7) / 8;
+}
+
+static void huffmanEncode(const std::string& value, std::string& out) {
+	uint64_t bits = 0;
+	int count = 0;
+
+	for (size_t i = 0; i < value.size(); ++i) {
+		unsigned char symbol = static_cast<unsigned char>(value[i]);
+		bits = (bits << HUFFMAN_LENGTHS[symbol]) | HUFFMAN_CODES[symbol];
+		count += HUFFMAN_LENGTHS[symbol];
+		while (count >= 8) {
+			count -= 8;
+			out += static_cast<char>((bits >> count) & 0xff);
+		}
+		bits &= (static_cast<uint64_t>(1) << count) - 1;
+	}
+	// 남은 비트는 EOS의 앞부분(1)으로 채움
+	if (count > 0) {
+		out += static_cast<char>(((bits << (8 - count)) | (0xff >> count)) & 0xff);
+	}
+}
+
+// =========================================================================
+// 정수 / 문자열 표현 (RFC 7541 5.1, 5.2)
+// =========================================================================
+
+static void encodeInteger(std::string& out, unsigned char pattern, int prefixBits, size_t value) {
+	size_t max = (static_cast<size_t>(1) << prefixBits) - 1;
+	if (value < max) {
+		out += static_cast<char>(pattern | value);
+		return;
+	}
+	out += static_cast<char>(pattern | max);
+	value -= max;
+	while (value >= 128) {
+		out += static_cast<char>((value & 0x7f) | 0x80);
+		value >>= 7;
+	}
+	out += static_cast<char>(value);
+}
+
+// 너무 긴 연속 바이트는 size_t를 넘치게 할 수 있으므로 28비트 이상 이동하기 전에 실패
+static bool decodeInteger(const unsigned char* data, size_t len, size_t& pos, int prefixBits, size_t& value) {
+	if (pos >= len) {
+		return false;
+	}
+	size_t max = (static_cast<size_t>(1) << prefixBits) - 1;
+	value = data[pos++] & max;
+	if (value < max) {
+		return true;
+	}
+	for (int shift = 0; pos < len && shift <= 28; shift += 7) {
+		unsigned char byte = data[pos++];
+		value += static_cast<size_t>(byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static void encodeString(std::string& out, const std::string& value) {
+	size_t huffman = huffmanLength(value);
+	if (huffman < value.size()) {
+		encodeInteger(out, 0x80, 7, huffman);
+		huffmanEncode(value, out);
+	} else {
+		encodeInteger(out, 0, 7, value.size());
+		out += value;
+	}
+}
+
+static bool decodeString(const unsigned char* data, size_t len, size_t& pos, std::string& out) {
+	if (pos >= len) {
+		return false;
+	}
+	bool huffman = (data[pos] & 0x80) != 0;
+	size_t length;
+	if (!decodeInteger(data, len, pos, 7, length) || length > len - pos) {
+		return false;
+	}
+	out.clear();
+	if (huffman) {
+		if (!huffmanDecode(data + pos, length, out)) {
+			return false;
+		}
+	} else {
+		out.assign(reinterpret_cast<const char*>(data + pos), length);
+	}
+	pos += length;
+	return true;
+}
+
+// =========================================================================
+// HpackTable
+// =========================================================================
+
+HpackTable::HpackTable(size_t maxSize) : _size(0), _maxSize(maxSize) {}
+
+void HpackTable::evict(size_t limit) {
+	while (_size > limit && !_entries.empty()) {
+		_size -= _entries.back().first.size() + _entries.back().second.size() + ENTRY_OVERHEAD;
+		_entries.pop_back();
+	}
+}
+
+// 항목 하나가 테이블보다 크면 테이블을 비우기만 함 (RFC 7541 4.4)
+void HpackTable::add(const std::string& name, const std::string& value) {
+	size_t entrySize = name.size() + value.size() + ENTRY_OVERHEAD;
+	if (entrySize > _maxSize) {
+		evict(0);
+		return;
+	}
+	evict(_maxSize - entrySize);
+	_entries.push_front(std::make_pair(name, value));
+	_size += entrySize;
+}
+
+void HpackTable::setMaxSize(size_t maxSize) {
+	_maxSize = maxSize;
+	evict(maxSize);
+}
+
+size_t HpackTable::getMaxSize() const {
+	return _maxSize;
+}
+
+bool HpackTable::get(size_t index, std::string& name, std::string& value) const {
+	if (index == 0) {
+		return false;
+	}
+	if (index <= STATIC_COUNT) {
+		name = STATIC_TABLE[index - 1][0];
+		value = STATIC_TABLE[index - 1][1];
+		return true;
+	}
+	index -= STATIC_COUNT + 1;
+	if (index >= _entries.size()) {
+		return false;
+	}
+	name = _entries[index].first;
+	value = _entries[index].second;
+	return true;
+}
+
+size_t HpackTable::find(const std::string& name, const std::string& value, bool& exact) const {
+	size_t nameIndex = 0;
+
+	exact = false;
+	for (size_t i = 0; i < STATIC_COUNT; ++i) {
+		if (name == STATIC_TABLE[i][0]) {
+			if (value == STATIC_TABLE[i][1]) {
+				exact = true;
+				return i + 1;
+			}
+			if (nameIndex == 0) {
+				nameIndex = i + 1;
+			}
+		}
+	}
+	for (size_t i = 0; i < _entries.size(); ++i) {
+		if (name == _entries[i].first) {
+			if (value == _entries[i].second) {
+				exact = true;
+				return STATIC_COUNT + 1 + i;
+			}
+			if (nameIndex == 0) {
+				nameIndex = STATIC_COUNT + 1 + i;
+			}
+		}
+	}
+	return nameIndex;
+}
+
+// =========================================================================
+// HpackDecoder
+// =========================================================================
+
+HpackDecoder::HpackDecoder(size_t maxTableSize) : _table(maxTableSize), _maxTableSize(maxTableSize) {}
+
+bool HpackDecoder::decode(const char* buf, size_t len, HeaderList& headers) {
+	const unsigned char* data = reinterpret_cast<const unsigned char*>(buf);
+	size_t pos = 0;
+	bool fieldSeen = false;
+
+	while (pos < len) {
+		unsigned char first = data[pos];
+		size_t index;
+		std::string name;
+		std::string value;
+
+		if (first & 0x80) {
+			// Indexed Header Field
+			if (!decodeInteger(data, len, pos, 7, index) || !_table.get(index, name, value)) {
+				return false;
+			}
+		} else if ((first & 0xe0) == 0x20) {
+			// Dynamic Table Size Update: 블록 맨 앞에서만, 알린 상한 이하로만
+			if (fieldSeen || !decodeInteger(data, len, pos, 5, index) || index > _maxTableSize) {
+				return false;
+			}
+			_table.setMaxSize(index);
+			continue;
+		} else {
+			// Literal Header Field (with incremental indexing / without indexing / never indexed)
+			bool indexing = (first & 0xc0) == 0x40;
+			if (!decodeInteger(data, len, pos, indexing ? 6 : 4, index)) {
+				return false;
+			}
+			if (index == 0 ? !decodeString(data, len, pos, name) : !_table.get(index, name, value)) {
+				return false;
+			}
+			if (!decodeString(data, len, pos, value)) {
+				return false;
+			}
+			if (indexing) {
+				_table.add(name, value);
+			}
+		}
+		fieldSeen = true;
+		headers.push_back(std::make_pair(name, value));
+	}
+	return true;
+}
+
+// =========================================================================
+// HpackEncoder
+// =========================================================================
+
+// 응답마다 값이 달라 동적 테이블을 채워도 다시 쓰이지 않는 헤더
+static bool isVaryingHeader(const std::string& name) {
+	return name == "date" || name == "content-length" || name == "etag" || name == "last-modified"
+		|| name == "expires" || name == "content-range" || name == "age";
+}
+
+HpackEncoder::HpackEncoder() : _table(DEFAULT_TABLE_SIZE), _sizeChanged(false) {}
+
+// 줄어든 테이블은 바로 적용하고, 다음 블록 앞에서 디코더에 알림
+void HpackEncoder::setMaxTableSize(size_t size) {
+	if (size < _table.getMaxSize()) {
+		_table.setMaxSize(size);
+		_sizeChanged = true;
+	}
+}
+
+void HpackEncoder::encode(const HeaderList& headers, std::string& out) {
+	if (_sizeChanged) {
+		encodeInteger(out, 0x20, 5, _table.getMaxSize());
+		_sizeChanged = false;
+	}
+
+	for (size_t i = 0; i < headers.size(); ++i) {
+		const std::string& name = headers[i].first;
+		const std::string& value = headers[i].second;
+		bool exact;
+		size_t index = _table.find(name, value, exact);
+
+		if (exact) {
+			encodeInteger(out, 0x80, 7, index);
+			continue;
+		}
+
+		bool indexing = false;
+		if (name == "set-cookie") {
+			encodeInteger(out, 0x10, 4, index);
+		} else if (isVaryingHeader(name)) {
+			encodeInteger(out, 0x00, 4, index);
+		} else {
+			encodeInteger(out, 0x40, 6, index);
+			indexing = true;
+		}
+		if (index == 0) {
+			encodeString(out, name);
+		}
+		encodeString(out, value);
+		if (indexing) {
+			_table.add(name, value);
+		}
+	}
+}
@@ -0,0 +1,1128 @@
+#include "http2/Http2Connection.hpp"
+#include "http/HttpRequest.hpp"
+#include "http/HttpResponse.hpp"
+#include "http/HttpController.hpp"
+#include "http/RequestRouter.hpp"
+#include "http/StatusCode.hpp"
+#include "http/ConditionalRequest.hpp"
+#include "http/ResponseCompressor.hpp"
+#include "config/CompiledLocation.hpp"
+#include "config/LocationCompiler.hpp"
+#include "tls/TlsConnection.hpp"
+#include "log/AccessLog.hpp"
+#include "metrics/Metrics.hpp"
+#include <algorithm>
+
+const uint32_t Http2Connection::MAX_CONCURRENT_STREAMS = 100;
+const uint32_t Http2Connection::INITIAL_WINDOW_SIZE = 1024 * 1024;
+const size_t Http2Connection::MAX_HEADER_LIST_SIZE = 16384;
+const size_t Http2Connection::MAX_HEADER_BLOCK_SIZE = 65536;
+const size_t Http2Connection::OUTPUT_HIGH_WATERMARK = 256 * 1024;
+
+// GOAWAY 뒤 닫기 전에 상대가 보내던 입력을 읽어 버리는 시간 (바로 닫으면 RST로 GOAWAY가 유실될 수 있음)
+static const time_t LINGER_TIMEOUT = 2;
+
+// PRIORITY로만 알려진 스트림(Firefox의 그룹 노드 등)까지 포함한 우선순위 노드 상한
+static const size_t MAX_PRIORITY_NODES = 256;
+
+static std::string toLower(const std::string& value) {
+	std::string lower(value);
+	for (size_t i = 0; i < lower.size(); ++i) {
+		if (lower[i] >= 'A' && lower[i] <= 'Z') {
+			lower[i] = static_cast<char>(lower[i] - 'A' + 'a');
+		}
+	}
+	return lower;
+}
+
+// 쉼표로 나눈 목록에 token이 있는지 (대소문자 무시)
+static bool containsToken(const std::string& list, const std::string& token) {
+	std::string lower = toLower(list);
+	size_t pos = 0;
+	while (pos <= lower.size()) {
+		size_t end = lower.find(',', pos);
+		if (end == std::string::npos) {
+			end = lower.size();
+		}
+		size_t first = lower.find_first_not_of(" \t", pos);
+		size_t last = lower.find_last_not_of(" \t", end == 0 ? 0 : end - 1);
+		if (first != std::string::npos && first < end && last != std::string::npos && last >= first
+			&& lower.compare(first, last - first + 1, token) == 0) {
+			return true;
+		}
+		pos = end + 1;
+	}
+	return false;
+}
+
+// HTTP/2에서는 쓸 수 없는 연결 단위 헤더 (RFC 9113 8.2.2)
+static bool isConnectionHeader(const std::string& name) {
+	return name == "connection" || name == "keep-alive" || name == "proxy-connection"
+		|| name == "transfer-encoding" || name == "upgrade";
+}
+
+// 소문자 token 문자만 허용 (가상 헤더는 맨 앞의 ':'만)
+static bool isValidName(const std::string& name) {
+	if (name.empty()) {
+		return false;
+	}
+	for (size_t i = (name[0] == ':') ? 1 : 0; i < name.size(); ++i) {
+		unsigned char c = static_cast<unsigned char>(name[i]);
+		if (c <= 0x20 || c >= 0x7f || (c >= 'A' && c <= 'Z') || c == ':') {
+			return false;
+		}
+	}
+	return name.size() > 1 || name[0] != ':';
+}
+
+// PADDED 플래그가 있으면 앞의 Pad Length와 뒤의 패딩을 떼어 냄
+static bool stripPadding(const Http2::FrameHeader& header, const char*& data, size_t& len) {
+	len = header.length;
+	if ((header.flags & Http2::FLAG_PADDED) == 0) {
+		return true;
+	}
+	if (len < 1) {
+		return false;
+	}
+	size_t padding = static_cast<unsigned char>(data[0]);
+	++data;
+	--len;
+	if (padding > len) {
+		return false;
+	}
+	len -= padding;
+	return true;
+}
+
+static size_t maxBodySize(const LocationContext* locConf) {
+	if (!locConf || !locConf->compiled) {
+		return LocationCompiler::DEFAULT_MAX_BODY_SIZE;
+	}
+	return locConf->compiled->maxBodySize;
+}
+
+// =========================================================================
+// Http2Stream
+// =========================================================================
+
+Http2Stream::Http2Stream(uint32_t streamId, long initialSendWindow, long initialRecvWindow)
+	: id(streamId), state(OPEN), request(NULL), serverConf(NULL), locConf(NULL),
+	  response(NULL), responded(false), outOffset(0), segment(0), segmentSent(0),
+	  sendWindow(initialSendWindow), recvWindow(initialRecvWindow), currentWeight(0),
+	  status(0), bytesSent(0) {
+	trace.reset(AccessLog::now());
+}
+
+Http2Stream::~Http2Stream() {
+	delete request;
+	delete response;
+}
+
+bool Http2Stream::hasPendingData() const {
+	return outOffset < out.size() || response != NULL;
+}
+
+// =========================================================================
+// Http2Connection
+// =========================================================================
+
+Http2Connection::Http2Connection(int fd, int port, TlsConnection* tls, const std::string& remoteAddr)
+	: _fd(fd), _port(port), _tls(tls), _remoteAddr(remoteAddr), _inOffset(0), _prefaceReceived(false), _outOffset(0),
+	  _decoder(HpackEncoder::DEFAULT_TABLE_SIZE),
+	  _peerMaxFrameSize(Http2::DEFAULT_MAX_FRAME_SIZE), _peerInitialWindow(Http2::DEFAULT_WINDOW_SIZE),
+	  _sendWindow(Http2::DEFAULT_WINDOW_SIZE), _recvWindow(Http2::DEFAULT_WINDOW_SIZE),
+	  _lastStreamId(0), _headerStream(0), _headerEndStream(false), _headerTrailers(false),
+	  _headerError(0), _continuationStream(0), _goawaySent(false), _peerGoaway(false),
+	  _lingering(false), _lastActivity(::time(NULL)) {}
+
+Http2Connection::~Http2Connection() {
+	for (std::map<uint32_t, Http2Stream*>::iterator it = _streams.begin(); it != _streams.end(); ++it) {
+		recordStream(it->second);
+		delete it->second;
+	}
+	delete _tls;
+}
+
+bool Http2Connection::wantsUpgrade(const HttpRequest* request) {
+	std::string settings;
+
+	return containsToken(request->getHeader("upgrade"), "h2c")
+		&& containsToken(request->getHeader("connection"), "http2-settings")
+		&& request->hasHeader("http2-settings")
+		&& Http2::decodeSettingsHeader(request->getHeader("http2-settings"), settings)
+		&& request->getContentLength() == 0 && !request->isChunkedEncoding();
+}
+
+bool Http2Connection::requiresHttp1(const LocationContext* locConf) {
+	if (!locConf || !locConf->compiled || !locConf->opReturnDirective.empty()) {
+		return false;
+	}
+	const CompiledLocation* compiled = locConf->compiled;
+	return compiled->isCgi || !compiled->fastcgiPass.empty() || !compiled->proxyPass.empty()
+		|| compiled->cacheZone != NULL || compiled->cgiPoolWorkers > 0 || compiled->stubStatus;
+}
+
+// 서버 프리페이스: SETTINGS + 연결 수신 창을 스트림 창과 같은 크기로 늘림
+void Http2Connection::sendServerPreface() {
+	std::string settings;
+	Http2::appendSetting(settings, Http2::SETTINGS_MAX_CONCURRENT_STREAMS, MAX_CONCURRENT_STREAMS);
+	Http2::appendSetting(settings, Http2::SETTINGS_INITIAL_WINDOW_SIZE, INITIAL_WINDOW_SIZE);
+	Http2::appendSetting(settings, Http2::SETTINGS_MAX_HEADER_LIST_SIZE, MAX_HEADER_LIST_SIZE);
+	Http2::appendFrame(_out, Http2::SETTINGS, 0, 0, settings.data(), settings.size());
+	Http2::appendWindowUpdate(_out, 0, INITIAL_WINDOW_SIZE - Http2::DEFAULT_WINDOW_SIZE);
+	_recvWindow = INITIAL_WINDOW_SIZE;
+}
+
+bool Http2Connection::start(const std::string& input) {
+	sendServerPreface();
+	_in = input;
+	processInput();
+	return flush();
+}
+
+bool Http2Connection::startUpgrade(const HttpRequest* request, const std::string& input) {
+	_out = "HTTP/1.1 101 Switching Protocols\r\nConnection: Upgrade\r\nUpgrade: h2c\r\n\r\n";
+	sendServerPreface();
+
+	// HTTP2-Settings는 클라이언트의 첫 SETTINGS로 취급 (ACK는 보내지 않음)
+	std::string settings;
+	Http2::decodeSettingsHeader(request->getHeader("http2-settings"), settings);
+	if (!applySettings(settings.data(), settings.size())) {
+		return flush();
+	}
+
+	// 업그레이드한 요청은 half-closed (remote) 상태의 스트림 1
+	Http2Stream* stream = new Http2Stream(1, _peerInitialWindow, INITIAL_WINDOW_SIZE);
+	stream->state = Http2Stream::HALF_CLOSED_REMOTE;
+	stream->request = new HttpRequest(*request);
+	_streams[1] = stream;
+	_priorities[1] = PriorityNode();
+	_lastStreamId = 1;
+
+	routeRequest(stream);
+	if (isOpen(1) && !stream->responded) {
+		processStream(stream);
+	}
+
+	_in = input;
+	processInput();
+	return flush();
+}
+
+bool Http2Connection::onReadable() {
+	char buffer[BUFFER_SIZE];
+	ssize_t bytes = _tls ? _tls->read(buffer, BUFFER_SIZE) : ::recv(_fd, buffer, BUFFER_SIZE, 0);
+	if (bytes < 0 && errno == EAGAIN) {
+		return true;	// TLS 레코드가 아직 다 오지 않음
+	}
+	if (bytes <= 0) {
+		return false;
+	}
+	Metrics::counters().bytesIn += bytes;
+	if (_lingering) {
+		return true;
+	}
+
+	_in.append(buffer, bytes);
+	// TLS 안에 복호화해 둔 바이트는 소켓 이벤트가 다시 오지 않으므로 지금 읽음
+	while (_tls && _tls->hasPendingInput() && (bytes = _tls->read(buffer, BUFFER_SIZE)) > 0) {
+		Metrics::counters().bytesIn += bytes;
+		_in.append(buffer, bytes);
+	}
+	_lastActivity = ::time(NULL);
+	processInput();
+	return flush();
+}
+
+bool Http2Connection::onWritable() {
+	return flush();
+}
+
+bool Http2Connection::needsWriteEvent() const {
+	return _outOffset < _out.size();
+}
+
+bool Http2Connection::isExpired(time_t now) const {
+	return (now - _lastActivity) > (_lingering ? LINGER_TIMEOUT : CLIENT_TIMEOUT);
+}
+
+bool Http2Connection::isIdle() const {
+	return _streams.empty();
+}
+
+// =========================================================================
+// 프레임 처리
+// =========================================================================
+
+void Http2Connection::processInput() {
+	if (!_prefaceReceived) {
+		size_t length = std::min(_in.size(), Http2::PREFACE_LEN);
+		if (_in.compare(0, length, Http2::PREFACE, length) != 0) {
+			connectionError(Http2::PROTOCOL_ERROR);
+			return;
+		}
+		if (length < Http2::PREFACE_LEN) {
+			return;
+		}
+		_inOffset = Http2::PREFACE_LEN;
+		_prefaceReceived = true;
+	}
+
+	while (!_goawaySent) {
+		Http2::FrameHeader header;
+		if (!Http2::parseHeader(_in.data() + _inOffset, _in.size() - _inOffset, header)) {
+			break;
+		}
+		// SETTINGS_MAX_FRAME_SIZE를 알리지 않았으므로 기본값이 상한
+		if (header.length > Http2::DEFAULT_MAX_FRAME_SIZE) {
+			connectionError(Http2::FRAME_SIZE_ERROR);
+			break;
+		}
+		if (_in.size() - _inOffset < Http2::FRAME_HEADER_LEN + header.length) {
+			break;
+		}
+		const char* payload = _in.data() + _inOffset + Http2::FRAME_HEADER_LEN;
+		_inOffset += Http2::FRAME_HEADER_LEN + header.length;
+		if (!handleFrame(header, payload)) {
+			break;
+		}
+	}
+
+	_in.erase(0, _inOffset);
+	_inOffset = 0;
+}
+
+bool Http2Connection::handleFrame(const Http2::FrameHeader& header, const char* payload) {
+	// 헤더 블록 중간에는 같은 스트림의 CONTINUATION만 올 수 있음
+	if (_continuationStream != 0
+		&& (header.type != Http2::CONTINUATION || header.streamId != _continuationStream)) {
+		return connectionError(Http2::PROTOCOL_ERROR);
+	}
+
+	switch (header.type) {
+		case Http2::DATA:			return handleData(header, payload);
+		case Http2::HEADERS:		return handleHeaders(header, payload);
+		case Http2::PRIORITY:		return handlePriority(header, payload);
+		case Http2::RST_STREAM:		return handleRstStream(header, payload);
+		case Http2::SETTINGS:		return handleSettings(header, payload);
+		case Http2::PUSH_PROMISE:	return connectionError(Http2::PROTOCOL_ERROR);
+		case Http2::PING:			return handlePing(header, payload);
+		case Http2::GOAWAY:			return handleGoaway(header, payload);
+		case Http2::WINDOW_UPDATE:	return handleWindowUpdate(header, payload);
+		case Http2::CONTINUATION:	return handleContinuation(header, payload);
+		default:					return true;	// 모르는 타입은 무시
+	}
+}
+
+bool Http2Connection::handleData(const Http2::FrameHeader& header, const char* payload) {
+	if (header.streamId == 0) {
+		return connectionError(Http2::PROTOCOL_ERROR);
+	}
+	const char* data = payload;
+	size_t length;
+	if (!stripPadding(header, data, length)) {
+		return connectionError(Http2::PROTOCOL_ERROR);
+	}
+
+	// 흐름 제어는 패딩을 포함한 payload 전체로 셈. 연결 창은 절반 아래로 내려가면 채워 줌
+	if (static_cast<long>(header.length) > _recvWindow) {
+		return connectionError(Http2::FLOW_CONTROL_ERROR);
+	}
+	_recvWindow -= header.length;
+	if (_recvWindow < static_cast<long>(INITIAL_WINDOW_SIZE / 2)) {
+		Http2::appendWindowUpdate(_out, 0, INITIAL_WINDOW_SIZE - _recvWindow);
+		_recvWindow = INITIAL_WINDOW_SIZE;
+	}
+
+	std::map<uint32_t, Http2Stream*>::iterator it = _streams.find(header.streamId);
+	if (it == _streams.end()) {
+		// 닫힌 스트림(이미 RST_STREAM을 보냈을 수 있음)에 남아 있던 DATA는 버림
+		return header.streamId <= _lastStreamId || connectionError(Http2::PROTOCOL_ERROR);
+	}
+	Http2Stream* stream = it->second;
+	if (stream->state != Http2Stream::OPEN) {
+		streamError(stream->id, Http2::STREAM_CLOSED);
+		return true;
+	}
+	if (static_cast<long>(header.length) > stream->recvWindow) {
+		streamError(stream->id, Http2::FLOW_CONTROL_ERROR);
+		return true;
+	}
+	stream->recvWindow -= header.length;
+
+	bool endStream = (header.flags & Http2::FLAG_END_STREAM) != 0;
+	if (!stream->responded) {
+		if (stream->body.size() + length > maxBodySize(stream->locConf)) {
+			sendErrorResponse(stream, StatusCode::PAYLOAD_TOO_LARGE);
+			if (!isOpen(header.streamId)) {
+				return true;
+			}
+		} else {
+			stream->body.append(data, length);
+		}
+	}
+	if (endStream) {
+		stream->state = Http2Stream::HALF_CLOSED_REMOTE;
+		processStream(stream);
+	} else if (stream->recvWindow < static_cast<long>(INITIAL_WINDOW_SIZE / 2)) {
+		// 바디 크기는 client_max_body_size로 막으므로 받은 만큼 창을 돌려줌
+		Http2::appendWindowUpdate(_out, stream->id, INITIAL_WINDOW_SIZE - stream->recvWindow);
+		stream->recvWindow = INITIAL_WINDOW_SIZE;
+	}
+	return true;
+}
+
+bool Http2Connection::handleHeaders(const Http2::FrameHeader& header, const char* payload) {
+	uint32_t streamId = header.streamId;
+	if (streamId == 0) {
+		return connectionError(Http2::PROTOCOL_ERROR);
+	}
+	const char* data = payload;
+	size_t length;
+	if (!stripPadding(header, data, length)) {
+		return connectionError(Http2::PROTOCOL_ERROR);
+	}
+
+	_headerError = 0;
+	_headerTrailers = false;
+	if (header.flags & Http2::FLAG_PRIORITY) {
+		if (length < 5) {
+			return connectionError(Http2::FRAME_SIZE_ERROR);
+		}
+		uint32_t dependency = Http2::readUint32(data);
+		if ((dependency & 0x7fffffff) == streamId) {
+			_headerError = Http2::PROTOCOL_ERROR;
+		} else {
+			setPriority(streamId, dependency & 0x7fffffff, static_cast<unsigned char>(data[4]) + 1,
+						(dependency & 0x80000000) != 0);
+		}
+		data += 5;
+		length -= 5;
+	}
+
+	std::map<uint32_t, Http2Stream*>::iterator it = _streams.find(streamId);
+	if (it != _streams.end()) {
+		// 이미 열린 스트림의 두 번째 블록은 트레일러 (END_STREAM이 있어야 함)
+		_headerTrailers = true;
+		if (it->second->state != Http2Stream::OPEN) {
+			_headerError = Http2::STREAM_CLOSED;
+		} else if ((header.flags & Http2::FLAG_END_STREAM) == 0) {
+			_headerError = Http2::PROTOCOL_ERROR;
+		}
+	} else {
+		// 새 스트림은 클라이언트가 여는 홀수 번호이고 이전 번호보다 커야 함
+		if ((streamId & 1) == 0 || streamId <= _lastStreamId) {
+			return connectionError(Http2::PROTOCOL_ERROR);
+		}
+		_lastStreamId = streamId;
+		if (_headerError == 0 && (_peerGoaway || _streams.size() >= MAX_CONCURRENT_STREAMS)) {
+			_headerError = Http2::REFUSED_STREAM;
+		}
+		if (_headerError == 0) {
+			_streams[streamId] = new Http2Stream(streamId, _peerInitialWindow, INITIAL_WINDOW_SIZE);
+			if (_priorities.find(streamId) == _priorities.end()) {
+				_priorities[streamId] = PriorityNode();
+			}
+		}
+	}
+
+	_headerBlock.assign(data, length);
+	_headerStream = streamId;
+	_headerEndStream = (header.flags & Http2::FLAG_END_STREAM) != 0;
+	if (header.flags & Http2::FLAG_END_HEADERS) {
+		return endHeaderBlock();
+	}
+	_continuationStream = streamId;
+	return true;
+}
+
+bool Http2Connection::handleContinuation(const Http2::FrameHeader& header, const char* payload) {
+	if (_continuationStream == 0) {
+		return connectionError(Http2::PROTOCOL_ERROR);
+	}
+	if (_headerBlock.size() + header.length > MAX_HEADER_BLOCK_SIZE) {
+		return connectionError(Http2::ENHANCE_YOUR_CALM);
+	}
+	_headerBlock.append(payload, header.length);
+	if (header.flags & Http2::FLAG_END_HEADERS) {
+		return endHeaderBlock();
+	}
+	return true;
+}
+
+bool Http2Connection::endHeaderBlock() {
+	uint32_t streamId = _headerStream;
+	HeaderList headers;
+
+	_continuationStream = 0;
+	if (!_decoder.decode(_headerBlock.data(), _headerBlock.size(), headers)) {
+		return connectionError(Http2::COMPRESSION_ERROR);
+	}
+	_headerBlock.clear();
+
+	if (_headerError != 0) {
+		streamError(streamId, _headerError);
+		return true;
+	}
+	Http2Stream* stream = _streams[streamId];
+
+	// 트레일러는 HttpRequest로 넘길 곳이 없으므로 요청 끝으로만 씀
+	if (_headerTrailers) {
+		stream->state = Http2Stream::HALF_CLOSED_REMOTE;
+		processStream(stream);
+		return true;
+	}
+
+	if (_headerEndStream) {
+		stream->state = Http2Stream::HALF_CLOSED_REMOTE;
+	}
+	if (!buildRequest(stream, headers)) {
+		streamError(streamId, Http2::PROTOCOL_ERROR);
+		return true;
+	}
+	stream->trace.mark(RequestTrace::MARK_HEADERS);
+	if (stream->request != NULL) {
+		routeRequest(stream);
+	}
+	if (isOpen(streamId) && !stream->responded && stream->state == Http2Stream::HALF_CLOSED_REMOTE) {
+		processStream(stream);
+	}
+	return true;
+}
+
+bool Http2Connection::handlePriority(const Http2::FrameHeader& header, const char* payload) {
+	if (header.streamId == 0) {
+		return connectionError(Http2::PROTOCOL_ERROR);
+	}
+	if (header.length != 5) {
+		streamError(header.streamId, Http2::FRAME_SIZE_ERROR);
+		return true;
+	}
+	uint32_t dependency = Http2::readUint32(payload);
+	if ((dependency & 0x7fffffff) == header.streamId) {
+		streamError(header.streamId, Http2::PROTOCOL_ERROR);
+		return true;
+	}
+	setPriority(header.streamId, dependency & 0x7fffffff, static_cast<unsigned char>(payload[4]) + 1,
+				(dependency & 0x80000000) != 0);
+	return true;
+}
+
+bool Http2Connection::handleRstStream(const Http2::FrameHeader& header, const char* payload) {
+	(void)payload;
+	if (header.streamId == 0 || header.streamId > _lastStreamId) {
+		return connectionError(Http2::PROTOCOL_ERROR);
+	}
+	if (header.length != 4) {
+		return connectionError(Http2::FRAME_SIZE_ERROR);
+	}
+	closeStream(header.streamId);
+	return true;
+}
+
+bool Http2Connection::handleSettings(const Http2::FrameHeader& header, const char* payload) {
+	if (header.streamId != 0) {
+		return connectionError(Http2::PROTOCOL_ERROR);
+	}
+	if (header.flags & Http2::FLAG_ACK) {
+		return header.length == 0 || connectionError(Http2::FRAME_SIZE_ERROR);
+	}
+	if (header.length % 6 != 0) {
+		return connectionError(Http2::FRAME_SIZE_ERROR);
+	}
+	if (!applySettings(payload, header.length)) {
+		return false;
+	}
+	Http2::appendFrame(_out, Http2::SETTINGS, Http2::FLAG_ACK, 0, NULL, 0);
+	return true;
+}
+
+bool Http2Connection::applySettings(const char* payload, size_t len) {
+	for (size_t i = 0; i + 6 <= len; i += 6) {
+		uint16_t id = static_cast<uint16_t>((static_cast<unsigned char>(payload[i]) << 8)
+											| static_cast<unsigned char>(payload[i + 1]));
+		uint32_t value = Http2::readUint32(payload + i + 2);
+
+		switch (id) {
+			case Http2::SETTINGS_HEADER_TABLE_SIZE:
+				_encoder.setMaxTableSize(value);
+				break;
+			case Http2::SETTINGS_ENABLE_PUSH:
+				if (value > 1) {
+					return connectionError(Http2::PROTOCOL_ERROR);
+				}
+				break;
+			case Http2::SETTINGS_INITIAL_WINDOW_SIZE: {
+				if (value > Http2::MAX_WINDOW_SIZE) {
+					return connectionError(Http2::FLOW_CONTROL_ERROR);
+				}
+				// 열린 스트림들의 송신 창도 차이만큼 바뀜 (음수가 될 수 있음)
+				long delta = static_cast<long>(value) - _peerInitialWindow;
+				for (std::map<uint32_t, Http2Stream*>::iterator it = _streams.begin(); it != _streams.end(); ++it) {
+					if (it->second->sendWindow + delta > static_cast<long>(Http2::MAX_WINDOW_SIZE)) {
+						return connectionError(Http2::FLOW_CONTROL_ERROR);
+					}
+					it->second->sendWindow += delta;
+				}
+				_peerInitialWindow = value;
+				break;
+			}
+			case Http2::SETTINGS_MAX_FRAME_SIZE:
+				if (value < Http2::DEFAULT_MAX_FRAME_SIZE || value > Http2::MAX_FRAME_SIZE_LIMIT) {
+					return connectionError(Http2::PROTOCOL_ERROR);
+				}
+				_peerMaxFrameSize = value;
+				break;
+			default:
+				break;	// MAX_CONCURRENT_STREAMS(푸시를 하지 않으므로 무관) 등
+		}
+	}
+	return true;
+}
+
+bool Http2Connection::handlePing(const Http2::FrameHeader& header, const char* payload) {
+	if (header.streamId != 0) {
+		return connectionError(Http2::PROTOCOL_ERROR);
+	}
+	if (header.length != 8) {
+		return connectionError(Http2::FRAME_SIZE_ERROR);
+	}
+	if ((header.flags & Http2::FLAG_ACK) == 0) {
+		Http2::appendFrame(_out, Http2::PING, Http2::FLAG_ACK, 0, payload, 8);
+	}
+	return true;
+}
+
+// 진행 중인 스트림은 끝까지 보내고, 새 스트림은 받지 않음
+bool Http2Connection::handleGoaway(const Http2::FrameHeader& header, const char* payload) {
+	if (header.streamId != 0) {
+		return connectionError(Http2::PROTOCOL_ERROR);
+	}
+	if (header.length < 8) {
+		return connectionError(Http2::FRAME_SIZE_ERROR);
+	}
+	uint32_t errorCode = Http2::readUint32(payload + 4);
+	if (errorCode != Http2::NO_ERROR) {
+		DEBUG_LOG("[Http2] GOAWAY from client: fd=" << _fd << " error=" << errorCode);
+	}
+	_peerGoaway = true;
+	return true;
+}
+
+bool Http2Connection::handleWindowUpdate(const Http2::FrameHeader& header, const char* payload) {
+	if (header.length != 4) {
+		return connectionError(Http2::FRAME_SIZE_ERROR);
+	}
+	long increment = Http2::readUint32(payload) & 0x7fffffff;
+
+	if (header.streamId == 0) {
+		if (increment == 0) {
+			return connectionError(Http2::PROTOCOL_ERROR);
+		}
+		if (_sendWindow + increment > static_cast<long>(Http2::MAX_WINDOW_SIZE)) {
+			return connectionError(Http2::FLOW_CONTROL_ERROR);
+		}
+		_sendWindow += increment;
+		return true;
+	}
+
+	std::map<uint32_t, Http2Stream*>::iterator it = _streams.find(header.streamId);
+	if (it == _streams.end()) {
+		return header.streamId <= _lastStreamId || connectionError(Http2::PROTOCOL_ERROR);
+	}
+	if (increment == 0) {
+		streamError(header.streamId, Http2::PROTOCOL_ERROR);
+	} else if (it->second->sendWindow + increment > static_cast<long>(Http2::MAX_WINDOW_SIZE)) {
+		streamError(header.streamId, Http2::FLOW_CONTROL_ERROR);
+	} else {
+		it->second->sendWindow += increment;
+	}
+	return true;
+}
+
+bool Http2Connection::connectionError(uint32_t errorCode) {
+	DEBUG_LOG("[Http2] connection error: fd=" << _fd << " error=" << errorCode);
+	Http2::appendGoaway(_out, _lastStreamId, errorCode);
+	_goawaySent = true;
+	return false;
+}
+
+void Http2Connection::streamError(uint32_t streamId, uint32_t errorCode) {
+	DEBUG_LOG("[Http2] stream error: fd=" << _fd << " stream=" << streamId << " error=" << errorCode);
+	Http2::appendRstStream(_out, streamId, errorCode);
+	closeStream(streamId);
+}
+
+// =========================================================================
+// 요청 처리
+// =========================================================================
+
+// 가상 헤더와 헤더 목록을 HTTP/1.1 요청 헤더로 바꿔 HttpRequest로 파싱. 형식 오류면 false
+bool Http2Connection::buildRequest(Http2Stream* stream, const HeaderList& headers) {
+	std::string method;
+	std::string scheme;
+	std::string path;
+	std::string authority;
+	std::string cookie;
+	std::string fields;
+	size_t listSize = 0;
+	bool regularSeen = false;
+
+	for (size_t i = 0; i < headers.size(); ++i) {
+		const std::string& name = headers[i].first;
+		const std::string& value = headers[i].second;
+
+		listSize += name.size() + value.size() + HpackTable::ENTRY_OVERHEAD;
+		if (!isValidName(name) || value.find_first_of("\r\n", 0) != std::string::npos
+			|| value.find('\0') != std::string::npos) {
+			return false;
+		}
+
+		if (name[0] == ':') {
+			std::string* target = NULL;
+			if (name == ":method") {
+				target = &method;
+			} else if (name == ":scheme") {
+				target = &scheme;
+			} else if (name == ":path") {
+				target = &path;
+			} else if (name == ":authority") {
+				target = &authority;
+			}
+			// 가상 헤더는 일반 헤더보다 앞에 한 번씩만
+			if (target == NULL || regularSeen || !target->empty() || value.empty()) {
+				return false;
+			}
+			*target = value;
+			continue;
+		}
+
+		regularSeen = true;
+		if (isConnectionHeader(name) || (name == "te" && value != "trailers")) {
+			return false;
+		}
+		if (name == "cookie") {
+			// 나눠 보낸 cookie는 HTTP/1.1처럼 하나로 합침 (RFC 9113 8.2.3)
+			cookie += (cookie.empty() ? "" : "; ") + value;
+		} else if (name != "host" || authority.empty()) {
+			fields += name + ": " + value + "\r\n";
+		}
+	}
+
+	// CONNECT는 지원하지 않음
+	if (method.empty() || scheme.empty() || path.empty()) {
+		return false;
+	}
+	if (listSize > MAX_HEADER_LIST_SIZE) {
+		sendErrorResponse(stream, StatusCode::REQUEST_HEADER_FIELDS_TOO_LARGE);
+		return true;
+	}
+
+	std::string head = method + " " + path + " HTTP/1.1\r\n";
+	if (!authority.empty()) {
+		head += "host: " + authority + "\r\n";
+	}
+	if (!cookie.empty()) {
+		head += "cookie: " + cookie + "\r\n";
+	}
+	head += fields + "\r\n";
+
+	HttpRequest* request = new HttpRequest();
+	if (!request->parseHeaders(head)) {
+		int code = request->getStatusCodeForError();
+		delete request;
+		sendErrorResponse(stream, code);
+		return true;
+	}
+	stream->request = request;
+	return true;
+}
+
+void Http2Connection::routeRequest(Http2Stream* stream) {
+	HttpRequest* request = stream->request;
+	RequestTrace::Scope traceScope(stream->trace);
+	RequestTrace::Timer routeTimer(RequestTrace::PHASE_ROUTE);
+
+	stream->serverConf = RequestRouter::findServerForRequest(request, _port);
+	if (stream->serverConf) {
+		stream->locConf = RequestRouter::findLocationForRequest(
+			stream->serverConf, request->getUri(), request->getMethod());
+	}
+
+	if (stream->serverConf && stream->locConf
+		&& !RequestRouter::isMethodAllowedInLocation(request->getMethod(), *stream->locConf)) {
+		sendErrorResponse(stream, StatusCode::METHOD_NOT_ALLOWED);
+		return;
+	}
+	if (requiresHttp1(stream->locConf)) {
+		DEBUG_LOG("[Http2] " << request->getUri() << " requires HTTP/1.1: stream=" << stream->id);
+		streamError(stream->id, Http2::HTTP_1_1_REQUIRED);
+		return;
+	}
+	if (request->getContentLength() > maxBodySize(stream->locConf)) {
+		sendErrorResponse(stream, StatusCode::PAYLOAD_TOO_LARGE);
+	}
+}
+
+// 요청을 다 받은 스트림의 응답을 만듦
+void Http2Connection::processStream(Http2Stream* stream) {
+	if (stream->responded) {
+		return;
+	}
+	stream->trace.mark(RequestTrace::MARK_READY);
+	RequestTrace::Scope traceScope(stream->trace);
+	HttpRequest* request = stream->request;
+
+	// content-length는 실제로 받은 DATA 길이와 같아야 함 (RFC 9113 8.1.1)
+	if (request->hasHeader("content-length") && request->getContentLength() != stream->body.size()) {
+		streamError(stream->id, Http2::PROTOCOL_ERROR);
+		return;
+	}
+	request->setDecodedBody(stream->body);
+	std::string().swap(stream->body);
+
+	HttpResponse* response;
+	if (!stream->serverConf) {
+		response = new HttpResponse(
+			HttpResponse::createErrorResponse(StatusCode::INTERNAL_SERVER_ERROR, NULL, NULL)
+		);
+	} else {
+		response = HttpController::processRequest(request, _port, stream->serverConf, stream->locConf);
+		if (stream->locConf) {
+			ResponseCompressor::compressResponse(*response, request, stream->locConf->compiled);
+		}
+	}
+	sendResponse(stream, response);
+}
+
+void Http2Connection::sendErrorResponse(Http2Stream* stream, int code) {
+	sendResponse(stream, new HttpResponse(
+		HttpResponse::createErrorResponse(code, stream->serverConf, stream->locConf)
+	));
+}
+
+// HEADERS(+CONTINUATION)를 바로 보내고 바디는 scheduleData가 DATA로 나눠 보냄 (response 소유권을 가져감)
+void Http2Connection::sendResponse(Http2Stream* stream, HttpResponse* response) {
+	stream->trace.mark(RequestTrace::MARK_RESPONDED);
+	if (stream->locConf && stream->locConf->compiled->serverTiming) {
+		response->setHeader("Server-Timing", stream->trace.serverTiming(AccessLog::now()));
+	}
+	int status = response->getStatus();
+	bool head = stream->request != NULL && stream->request->getMethod() == "HEAD";
+	bool bodyless = status == StatusCode::NO_CONTENT || status == StatusCode::NOT_MODIFIED;
+
+	std::string body = response->getBody();
+	const std::vector<FileSegment>& segments = response->getFileSegments();
+	size_t length = body.size();
+	for (size_t i = 0; i < segments.size(); ++i) {
+		length += segments[i].prefix.size() + segments[i].length;
+	}
+
+	std::ostringstream statusText;
+	statusText << status;
+	HeaderList headers;
+	headers.push_back(std::make_pair(std::string(":status"), statusText.str()));
+
+	bool hasDate = false;
+	bool hasServer = false;
+	bool hasLength = false;
+	const std::map<std::string, std::string>& fields = response->getHeaders();
+	for (std::map<std::string, std::string>::const_iterator it = fields.begin(); it != fields.end(); ++it) {
+		std::string name = toLower(it->first);
+		if (name.compare(0, 10, "set-cookie") == 0) {
+			name = "set-cookie";	// Set-Cookie-N 임시 키
+		}
+		if (isConnectionHeader(name)) {
+			continue;
+		}
+		hasDate = hasDate || name == "date";
+		hasServer = hasServer || name == "server";
+		hasLength = hasLength || name == "content-length";
+		headers.push_back(std::make_pair(name, it->second));
+	}
+	if (!hasDate) {
+		headers.push_back(std::make_pair(std::string("date"), ConditionalRequest::formatDate(::time(NULL))));
+	}
+	if (!hasServer) {
+		headers.push_back(std::make_pair(std::string("server"), std::string("webserv/1.0")));
+	}
+	if (!hasLength && !bodyless) {
+		std::ostringstream lengthText;
+		lengthText << length;
+		headers.push_back(std::make_pair(std::string("content-length"), lengthText.str()));
+	}
+
+	std::string block;
+	_encoder.encode(headers, block);
+
+	bool endStream = head || bodyless || length == 0;
+	size_t offset = 0;
+	do {
+		size_t chunk = std::min(block.size() - offset, static_cast<size_t>(_peerMaxFrameSize));
+		unsigned char flags = (offset + chunk == block.size()) ? Http2::FLAG_END_HEADERS : 0;
+		if (offset == 0 && endStream) {
+			flags |= Http2::FLAG_END_STREAM;
+		}
+		Http2::appendFrame(_out, offset == 0 ? Http2::HEADERS : Http2::CONTINUATION, flags, stream->id,
+						   block.data() + offset, chunk);
+		offset += chunk;
+	} while (offset < block.size());
+	stream->responded = true;
+	stream->status = status;
+	stream->bytesSent += block.size();
+
+	if (endStream) {
+		delete response;
+		finishStream(stream);
+		return;
+	}
+
+	stream->out.swap(body);
+	if (response->hasFileBody()) {
+		stream->out += segments[0].prefix;
+		stream->response = response;
+	} else {
+		delete response;
+	}
+}
+
+// =========================================================================
+// 우선순위 (RFC 7540 5.3)
+// =========================================================================
+
+void Http2Connection::setPriority(uint32_t streamId, uint32_t parent, int weight, bool exclusive) {
+	if (_priorities.find(streamId) == _priorities.end() && _priorities.size() >= MAX_PRIORITY_NODES) {
+		return;
+	}
+	// 모르는 스트림에 의존하면 기본 우선순위
+	if (parent != 0 && _priorities.find(parent) == _priorities.end()) {
+		parent = 0;
+		weight = 16;
+		exclusive = false;
+	}
+	// 자기 자손에 의존하게 되면 그 자손을 먼저 이 스트림의 원래 부모 아래로 옮김
+	if (parent != 0 && isAncestor(streamId, parent)) {
+		_priorities[parent].parent = _priorities[streamId].parent;
+	}
+	if (exclusive) {
+		for (std::map<uint32_t, PriorityNode>::iterator it = _priorities.begin(); it != _priorities.end(); ++it) {
+			if (it->second.parent == parent && it->first != streamId) {
+				it->second.parent = streamId;
+			}
+		}
+	}
+	PriorityNode& node = _priorities[streamId];
+	node.parent = parent;
+	node.weight = weight;
+}
+
+bool Http2Connection::isAncestor(uint32_t ancestor, uint32_t streamId) const {
+	std::map<uint32_t, PriorityNode>::const_iterator it = _priorities.find(streamId);
+	for (size_t depth = 0; it != _priorities.end() && it->second.parent != 0 && depth < _priorities.size(); ++depth) {
+		if (it->second.parent == ancestor) {
+			return true;
+		}
+		it = _priorities.find(it->second.parent);
+	}
+	return false;
+}
+
+// 조상 중에 지금 보낼 수 있는 스트림이 있으면 그 스트림이 먼저
+bool Http2Connection::isBlocked(uint32_t streamId) const {
+	std::map<uint32_t, PriorityNode>::const_iterator it = _priorities.find(streamId);
+	for (size_t depth = 0; it != _priorities.end() && it->second.parent != 0 && depth < _priorities.size(); ++depth) {
+		std::map<uint32_t, Http2Stream*>::const_iterator parent = _streams.find(it->second.parent);
+		if (parent != _streams.end() && parent->second->hasPendingData() && parent->second->sendWindow > 0) {
+			return true;
+		}
+		it = _priorities.find(it->second.parent);
+	}
+	return false;
+}
+
+// 닫힌 스트림의 자식들은 그 부모 아래로 옮김
+void Http2Connection::closeStream(uint32_t streamId) {
+	std::map<uint32_t, Http2Stream*>::iterator stream = _streams.find(streamId);
+	if (stream != _streams.end()) {
+		recordStream(stream->second);
+		delete stream->second;
+		_streams.erase(stream);
+	}
+
+	std::map<uint32_t, PriorityNode>::iterator node = _priorities.find(streamId);
+	if (node != _priorities.end()) {
+		for (std::map<uint32_t, PriorityNode>::iterator it = _priorities.begin(); it != _priorities.end(); ++it) {
+			if (it->second.parent == streamId) {
+				it->second.parent = node->second.parent;
+			}
+		}
+		_priorities.erase(node);
+	}
+}
+
+// 응답을 보낸 스트림만 (RST_STREAM으로 중간에 끊겨도 보낸 만큼)
+void Http2Connection::recordStream(const Http2Stream* stream) const {
+	if (!stream->responded) {
+		return;
+	}
+	const CompiledLocation* compiled = stream->locConf ? stream->locConf->compiled : NULL;
+	long long end = AccessLog::now();
+	Metrics::recordRequest(compiled ? compiled->latency : NULL, stream->status, stream->bytesSent, stream->trace, end);
+
+	AccessLog* log = compiled ? compiled->accessLog : AccessLog::defaultLog();
+	if (log) {
+		log->write(_remoteAddr, stream->request, "HTTP/2.0", stream->status, stream->bytesSent, stream->trace, end);
+	}
+	if (compiled && compiled->slowRequestLog > 0 && stream->request != NULL
+		&& stream->trace.total(end) >= compiled->slowRequestLog) {
+		INFO_LOG("[SlowRequest] " << stream->request->getMethod() << " " << stream->request->getUri()
+				 << " " << stream->status << " " << stream->trace.describe(end)
+				 << " | fd=" << _fd << " port=" << _port << " client=" << _remoteAddr
+				 << " tls=" << (_tls ? "on" : "off") << " h2 stream=" << stream->id
+				 << " streams=" << _streams.size() << " sent=" << stream->bytesSent
+				 << " unsent=" << (_out.size() - _outOffset)
+				 << " send_window=" << stream->sendWindow << "/" << _sendWindow);
+	}
+}
+
+// 응답을 다 보냄. 요청을 아직 받는 중이면 (413 등) 더 보내지 않도록 RST_STREAM(NO_ERROR)
+void Http2Connection::finishStream(Http2Stream* stream) {
+	if (stream->state == Http2Stream::OPEN) {
+		Http2::appendRstStream(_out, stream->id, Http2::NO_ERROR);
+	}
+	closeStream(stream->id);
+}
+
+bool Http2Connection::isOpen(uint32_t streamId) const {
+	return _streams.find(streamId) != _streams.end();
+}
+
+// =========================================================================
+// 출력
+// =========================================================================
+
+// 보낼 수 있는 스트림들 사이에서 weight로 smooth weighted round-robin. 한 번에 DATA 프레임 하나씩
+void Http2Connection::scheduleData() {
+	while (!_goawaySent && _sendWindow > 0 && _out.size() - _outOffset < OUTPUT_HIGH_WATERMARK) {
+		Http2Stream* best = NULL;
+		int total = 0;
+
+		for (std::map<uint32_t, Http2Stream*>::iterator it = _streams.begin(); it != _streams.end(); ++it) {
+			Http2Stream* stream = it->second;
+			if (!stream->hasPendingData() || stream->sendWindow <= 0 || isBlocked(stream->id)) {
+				continue;
+			}
+			std::map<uint32_t, PriorityNode>::const_iterator node = _priorities.find(stream->id);
+			int weight = (node != _priorities.end()) ? node->second.weight : 16;
+			stream->currentWeight += weight;
+			total += weight;
+			if (best == NULL || stream->currentWeight > best->currentWeight) {
+				best = stream;
+			}
+		}
+		if (best == NULL) {
+			break;
+		}
+		best->currentWeight -= total;
+		writeDataFrame(best);
+	}
+}
+
+// 창과 프레임 크기만큼 메모리 바디, 파일 조각 순으로 채워 DATA 하나를 만듦. 마지막이면 스트림을 닫음
+void Http2Connection::writeDataFrame(Http2Stream* stream) {
+	size_t limit = std::min(static_cast<size_t>(_peerMaxFrameSize),
+							static_cast<size_t>(std::min(stream->sendWindow, _sendWindow)));
+	std::string chunk;
+
+	while (chunk.size() < limit) {
+		if (stream->outOffset < stream->out.size()) {
+			size_t length = std::min(limit - chunk.size(), stream->out.size() - stream->outOffset);
+			chunk.append(stream->out, stream->outOffset, length);
+			stream->outOffset += length;
+			if (stream->outOffset == stream->out.size()) {
+				stream->out.clear();
+				stream->outOffset = 0;
+			}
+			continue;
+		}
+		if (stream->response == NULL) {
+			break;
+		}
+
+		const std::vector<FileSegment>& segments = stream->response->getFileSegments();
+		const FileSegment& segment = segments[stream->segment];
+		size_t length = std::min(limit - chunk.size(), segment.length - stream->segmentSent);
+		if (length > 0) {
+			size_t used = chunk.size();
+			chunk.resize(used + length);
+			ssize_t bytes = ::pread(stream->response->getFileFd(), &chunk[used], length,
+									segment.offset + static_cast<off_t>(stream->segmentSent));
+			if (bytes <= 0) {
+				ERROR_LOG("[Http2] failed to read file body: stream=" << stream->id);
+				streamError(stream->id, Http2::INTERNAL_ERROR);
+				return;
+			}
+			chunk.resize(used + bytes);
+			stream->segmentSent += bytes;
+		}
+		if (stream->segmentSent == segment.length) {
+			stream->segmentSent = 0;
+			if (++stream->segment < segments.size()) {
+				stream->out += segments[stream->segment].prefix;
+			} else {
+				delete stream->response;
+				stream->response = NULL;
+			}
+		}
+	}
+
+	bool last = !stream->hasPendingData();
+	Http2::appendFrame(_out, Http2::DATA, last ? Http2::FLAG_END_STREAM : 0, stream->id,
+					   chunk.data(), chunk.size());
+	stream->sendWindow -= chunk.size();
+	stream->bytesSent += chunk.size();
+	_sendWindow -= chunk.size();
+	if (last) {
+		finishStream(stream);
+	}
+}
+
+// false면 연결을 닫음 (전송 실패)
+bool Http2Connection::flush() {
+	scheduleData();
+	while (_outOffset < _out.size()) {
+		const char* data = _out.data() + _outOffset;
+		size_t len = _out.size() - _outOffset;
+		ssize_t sent = _tls ? _tls->write(data, len) : ::send(_fd, data, len, MSG_NOSIGNAL);
+		if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			break;
+		}
+		if (sent <= 0) {
+			return false;
+		}
+		_outOffset += sent;
+		_lastActivity = ::time(NULL);
+		if (_outOffset == _out.size()) {
+			_out.clear();
+			_outOffset = 0;
+			scheduleData();
+		}
+	}
+	if (_outOffset > 0 && _outOffset >= _out.size() / 2) {
+		_out.erase(0, _outOffset);
+		_outOffset = 0;
+	}
+	if (isFinished() && _out.empty() && !_lingering) {
+		if (_tls) {
+			_tls->shutdown();
+		}
+		::shutdown(_fd, SHUT_WR);
+		_lingering = true;
+		_lastActivity = ::time(NULL);
+	}
+	return true;
+}
+
+bool Http2Connection::isFinished() const {
+	return _goawaySent || (_peerGoaway && _streams.empty());
+}
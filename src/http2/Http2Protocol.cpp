@@ -0,0 +1,100 @@
+#include "http2/Http2Protocol.hpp"
+
+namespace Http2 {
+
+static void appendUint32(std::string& out, uint32_t value) {
+	out += static_cast<char>((value >> 24) & 0xff);
+	out += static_cast<char>((value >> 16) & 0xff);
+	out += static_cast<char>((value >> 8) & 0xff);
+	out += static_cast<char>(value & 0xff);
+}
+
+bool parseHeader(const char* buf, size_t len, FrameHeader& header) {
+	if (len < FRAME_HEADER_LEN) {
+		return false;
+	}
+	const unsigned char* data = reinterpret_cast<const unsigned char*>(buf);
+	header.length = (static_cast<uint32_t>(data[0]) << 16) | (static_cast<uint32_t>(data[1]) << 8) | data[2];
+	header.type = data[3];
+	header.flags = data[4];
+	header.streamId = readUint32(buf + 5) & 0x7fffffff;
+	return true;
+}
+
+uint32_t readUint32(const char* data) {
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+	return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16)
+		| (static_cast<uint32_t>(bytes[2]) << 8) | static_cast<uint32_t>(bytes[3]);
+}
+
+void appendFrame(std::string& out, unsigned char type, unsigned char flags, uint32_t streamId,
+				 const char* data, size_t len) {
+	out += static_cast<char>((len >> 16) & 0xff);
+	out += static_cast<char>((len >> 8) & 0xff);
+	out += static_cast<char>(len & 0xff);
+	out += static_cast<char>(type);
+	out += static_cast<char>(flags);
+	appendUint32(out, streamId & 0x7fffffff);
+	if (len > 0) {
+		out.append(data, len);
+	}
+}
+
+void appendSetting(std::string& payload, uint16_t id, uint32_t value) {
+	payload += static_cast<char>((id >> 8) & 0xff);
+	payload += static_cast<char>(id & 0xff);
+	appendUint32(payload, value);
+}
+
+void appendRstStream(std::string& out, uint32_t streamId, uint32_t errorCode) {
+	std::string payload;
+	appendUint32(payload, errorCode);
+	appendFrame(out, RST_STREAM, 0, streamId, payload.data(), payload.size());
+}
+
+void appendGoaway(std::string& out, uint32_t lastStreamId, uint32_t errorCode) {
+	std::string payload;
+	appendUint32(payload, lastStreamId & 0x7fffffff);
+	appendUint32(payload, errorCode);
+	appendFrame(out, GOAWAY, 0, 0, payload.data(), payload.size());
+}
+
+void appendWindowUpdate(std::string& out, uint32_t streamId, uint32_t increment) {
+	std::string payload;
+	appendUint32(payload, increment & 0x7fffffff);
+	appendFrame(out, WINDOW_UPDATE, 0, streamId, payload.data(), payload.size());
+}
+
+static int base64UrlValue(char c) {
+	if (c >= 'A' && c <= 'Z') return c - 'A';
+	if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+	if (c >= '0' && c <= '9') return c - '0' + 52;
+	if (c == '-') return 62;
+	if (c == '_') return 63;
+	return -1;
+}
+
+bool decodeSettingsHeader(const std::string& value, std::string& payload) {
+	// 패딩('=')을 붙여 보내는 클라이언트도 있으므로 끝의 '='는 허용
+	size_t end = value.find_last_not_of('=');
+	end = (end == std::string::npos) ? 0 : end + 1;
+
+	uint32_t bits = 0;
+	int count = 0;
+	payload.clear();
+	for (size_t i = 0; i < end; ++i) {
+		int digit = base64UrlValue(value[i]);
+		if (digit < 0) {
+			return false;
+		}
+		bits = (bits << 6) | static_cast<uint32_t>(digit);
+		count += 6;
+		if (count >= 8) {
+			count -= 8;
+			payload += static_cast<char>((bits >> count) & 0xff);
+		}
+	}
+	return count < 6 && payload.size() % 6 == 0;
+}
+
+} // namespace Http2
@@ -0,0 +1,399 @@
+#include "log/AccessLog.hpp"
+#include "http/HttpRequest.hpp"
+#include "log/RequestTrace.hpp"
+#include "webserv.hpp"
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+
+const size_t AccessLog::MAX_FIELD = 2048;
+
+// writer가 깨어나는 간격 (flush 간격은 초 단위이므로 1초마다 확인)
+static const int WRITER_TICK_MS = 1000;
+
+std::map<std::string, AccessLog*> AccessLog::_logs;
+AccessLog* AccessLog::_default = NULL;
+bool AccessLog::_failed = false;
+pthread_t AccessLog::_writer;
+bool AccessLog::_running = false;
+int AccessLog::_wakeFd = -1;
+
+static const char* MONTHS[] = {
+	"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+};
+
+// 레코드를 만드는 버퍼 (이벤트 루프에서만 씀, 용량을 재사용)
+static std::string g_record;
+
+// [18/Oct/2026:09:30:00 +0000] 부분. 같은 초 안에서는 다시 만들지 않음
+static const char* timeLocal(time_t now) {
+	static time_t cachedAt = -1;
+	static char cached[32];
+
+	if (now != cachedAt) {
+		struct tm tm;
+		::gmtime_r(&now, &tm);
+		std::snprintf(cached, sizeof(cached), "%02d/%s/%04d:%02d:%02d:%02d +0000",
+					  tm.tm_mday, MONTHS[tm.tm_mon], tm.tm_year + 1900, tm.tm_hour, tm.tm_min, tm.tm_sec);
+		cachedAt = now;
+	}
+	return cached;
+}
+
+static void appendNumber(std::string& out, unsigned long long value) {
+	char digits[24];
+	size_t len = 0;
+
+	do {
+		digits[len++] = static_cast<char>('0' + value % 10);
+		value /= 10;
+	} while (value > 0);
+	while (len > 0) {
+		out += digits[--len];
+	}
+}
+
+// 마이크로초를 밀리초 소수 셋째 자리까지 (12345 -> 12.345)
+static void appendMillis(std::string& out, long long usec) {
+	if (usec < 0) {
+		usec = 0;
+	}
+	appendNumber(out, usec / 1000);
+	out += '.';
+	long long fraction = usec % 1000;
+	out += static_cast<char>('0' + fraction / 100);
+	out += static_cast<char>('0' + fraction / 10 % 10);
+	out += static_cast<char>('0' + fraction % 10);
+}
+
+// 따옴표, 역슬래시, 제어 문자, 0x7f 이상은 \xHH로 (로그 한 줄을 깨거나 터미널을 조작하지 못하게)
+static void appendEscaped(std::string& out, const std::string& value) {
+	static const char HEX[] = "0123456789ABCDEF";
+
+	if (value.empty()) {
+		out += '-';
+		return;
+	}
+	size_t len = std::min(value.size(), AccessLog::MAX_FIELD);
+	for (size_t i = 0; i < len; ++i) {
+		unsigned char c = static_cast<unsigned char>(value[i]);
+		if (c < 0x20 || c >= 0x7f || c == '"' || c == '\\') {
+			out += "\\x";
+			out += HEX[c >> 4];
+			out += HEX[c & 0x0f];
+		} else {
+			out += static_cast<char>(c);
+		}
+	}
+}
+
+static void appendLittleEndian(std::string& out, unsigned long long value, size_t bytes) {
+	for (size_t i = 0; i < bytes; ++i) {
+		out += static_cast<char>((value >> (8 * i)) & 0xff);
+	}
+}
+
+static void appendField(std::string& out, const std::string& value) {
+	size_t len = std::min(value.size(), AccessLog::MAX_FIELD);
+	appendLittleEndian(out, len, 2);
+	out.append(value, 0, len);
+}
+
+static const std::string& headerOf(const HttpRequest* request, const char* name) {
+	static const std::string empty;
+
+	if (request == NULL) {
+		return empty;
+	}
+	const std::map<std::string, std::string>& headers = request->getHeaders();
+	std::map<std::string, std::string>::const_iterator it = headers.find(name);
+	return it == headers.end() ? empty : it->second;
+}
+
+// =========================================================================
+// AccessLog
+// =========================================================================
+
+AccessLog::AccessLog(const std::string& path, int fd, const AccessLogDirective& config)
+	: _path(path), _fd(fd), _config(config), _ring(config.bufferSize),
+	  _requests(0), _dropped(0), _wakeSent(false), _lastFlush(::time(NULL)) {}
+
+AccessLog::~AccessLog() {
+	::close(_fd);
+}
+
+AccessLog* AccessLog::open(const AccessLogDirective& config) {
+	if (config.path.empty()) {
+		return NULL;
+	}
+
+	std::map<std::string, AccessLog*>::iterator it = _logs.find(config.path);
+	if (it != _logs.end()) {
+		const AccessLogDirective& existing = it->second->_config;
+		if (existing.format != config.format || existing.bufferSize != config.bufferSize
+			|| existing.flush != config.flush || existing.sample != config.sample) {
+			ERROR_LOG("[AccessLog] " << config.path << " is used with different parameters");
+			_failed = true;
+		}
+		return it->second;
+	}
+
+	int fd = ::open(config.path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+	if (fd == -1) {
+		ERROR_LOG("[AccessLog] failed to open " << config.path << ": " << std::strerror(errno));
+		_failed = true;
+		return NULL;
+	}
+	AccessLog* log = new AccessLog(config.path, fd, config);
+	_logs[config.path] = log;
+	return log;
+}
+
+bool AccessLog::start(const std::vector<AccessLogDirective>& httpLog) {
+	if (!httpLog.empty()) {
+		_default = open(httpLog[0]);
+	}
+	if (_failed) {
+		return false;
+	}
+	if (_logs.empty() || _running) {
+		return true;
+	}
+
+	_wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (_wakeFd == -1) {
+		ERROR_LOG("[AccessLog] eventfd failed: " << std::strerror(errno));
+		return false;
+	}
+
+	// 시그널은 모두 이벤트 루프 스레드가 받도록 writer에서는 막아 둠
+	sigset_t all;
+	sigset_t previous;
+	sigfillset(&all);
+	pthread_sigmask(SIG_SETMASK, &all, &previous);
+	_running = true;
+	int error = pthread_create(&_writer, NULL, run, NULL);
+	pthread_sigmask(SIG_SETMASK, &previous, NULL);
+	if (error != 0) {
+		ERROR_LOG("[AccessLog] failed to start writer thread: " << std::strerror(error));
+		_running = false;
+		::close(_wakeFd);
+		_wakeFd = -1;
+		return false;
+	}
+	INFO_LOG("[AccessLog] writing " << _logs.size() << " access log(s)");
+	return true;
+}
+
+void AccessLog::closeAll() {
+	if (_running) {
+		__atomic_store_n(&_running, false, __ATOMIC_RELEASE);
+		wakeWriter();
+		pthread_join(_writer, NULL);
+	}
+	if (_wakeFd != -1) {
+		::close(_wakeFd);
+		_wakeFd = -1;
+	}
+
+	time_t now = ::time(NULL);
+	for (std::map<std::string, AccessLog*>::iterator it = _logs.begin(); it != _logs.end(); ++it) {
+		it->second->drain(now, true);
+		delete it->second;
+	}
+	_logs.clear();
+	_default = NULL;
+	_failed = false;
+}
+
+void AccessLog::onTick() {
+	for (std::map<std::string, AccessLog*>::iterator it = _logs.begin(); it != _logs.end(); ++it) {
+		if (it->second->_dropped > 0) {
+			ERROR_LOG("[AccessLog] " << it->first << ": dropped " << it->second->_dropped
+					  << " entries (buffer full)");
+			it->second->_dropped = 0;
+		}
+	}
+}
+
+AccessLog* AccessLog::defaultLog() {
+	return _default;
+}
+
+long long AccessLog::now() {
+	struct timespec ts;
+	::clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+void AccessLog::wakeWriter() {
+	if (_wakeFd != -1) {
+		uint64_t one = 1;
+		ssize_t ignored = ::write(_wakeFd, &one, sizeof(one));
+		(void)ignored;
+	}
+}
+
+void AccessLog::write(const std::string& addr, const HttpRequest* request, const char* protocol,
+					  int status, size_t bytes, const RequestTrace& trace, long long end) {
+	// sample=N: N개 중 첫 번째만 (에러는 놓치지 않도록 5xx는 항상)
+	if (_requests++ % _config.sample != 0 && status < 500) {
+		return;
+	}
+	long long spent[RequestTrace::PHASE_COUNT];
+	trace.phases(end, spent);
+
+	g_record.clear();
+	if (_config.format == ACCESS_LOG_BINARY) {
+		formatBinary(g_record, addr, request, protocol != NULL, status, bytes, trace.total(end), spent);
+	} else {
+		formatText(g_record, addr, request, protocol, status, bytes, trace.total(end), spent);
+	}
+
+	if (!_ring.push(g_record.data(), g_record.size())) {
+		++_dropped;
+		wakeWriter();
+		return;
+	}
+	// 절반을 넘으면 flush 간격을 기다리지 않고 쓰게 함 (넘을 때 한 번만 깨움)
+	if (_ring.size() >= _ring.capacity() / 2) {
+		if (!_wakeSent) {
+			_wakeSent = true;
+			wakeWriter();
+		}
+	} else {
+		_wakeSent = false;
+	}
+}
+
+// addr - - [time] "method uri protocol" status bytes ["referer" "user-agent"]
+// timed: 뒤에 rt=전체 header=... send=... (밀리초)
+void AccessLog::formatText(std::string& line, const std::string& addr, const HttpRequest* request,
+						   const char* protocol, int status, size_t bytes, long long usec,
+						   const long long* phases) const {
+	line += addr.empty() ? "-" : addr;
+	line += " - - [";
+	line += timeLocal(::time(NULL));
+	line += "] \"";
+	if (request != NULL && !request->getMethod().empty()) {
+		appendEscaped(line, request->getMethod());
+		line += ' ';
+		appendEscaped(line, request->getUri());
+		line += ' ';
+		if (protocol != NULL) {
+			line += protocol;
+		} else {
+			appendEscaped(line, request->getVersion());
+		}
+	} else {
+		line += '-';
+	}
+	line += "\" ";
+	appendNumber(line, status);
+	line += ' ';
+	appendNumber(line, bytes);
+	if (_config.format == ACCESS_LOG_COMBINED || _config.format == ACCESS_LOG_TIMED) {
+		line += " \"";
+		appendEscaped(line, headerOf(request, "referer"));
+		line += "\" \"";
+		appendEscaped(line, headerOf(request, "user-agent"));
+		line += '"';
+	}
+	if (_config.format == ACCESS_LOG_TIMED) {
+		line += " rt=";
+		appendMillis(line, usec);
+		for (int phase = 0; phase < RequestTrace::PHASE_COUNT; ++phase) {
+			line += ' ';
+			line += RequestTrace::phaseName(static_cast<RequestTrace::Phase>(phase));
+			line += '=';
+			appendMillis(line, phases[phase]);
+		}
+	}
+	line += '\n';
+}
+
+void AccessLog::formatBinary(std::string& record, const std::string& addr, const HttpRequest* request,
+							 bool http2, int status, size_t bytes, long long usec,
+							 const long long* phases) const {
+	static const std::string empty;
+
+	record.append(2, '\0');		// 길이는 마지막에 채움
+	record += static_cast<char>(2);
+	record += static_cast<char>(http2 ? 2 : 1);
+	appendLittleEndian(record, static_cast<unsigned long long>(::time(NULL)), 4);
+	appendLittleEndian(record, static_cast<unsigned long long>(std::min(usec, 0xffffffffLL)), 4);
+	appendLittleEndian(record, status, 2);
+	appendLittleEndian(record, bytes, 8);
+	appendField(record, addr);
+	appendField(record, request != NULL ? request->getMethod() : empty);
+	appendField(record, request != NULL ? request->getUri() : empty);
+	appendField(record, headerOf(request, "referer"));
+	appendField(record, headerOf(request, "user-agent"));
+	record += static_cast<char>(RequestTrace::PHASE_COUNT);
+	for (int phase = 0; phase < RequestTrace::PHASE_COUNT; ++phase) {
+		appendLittleEndian(record, static_cast<unsigned long long>(std::min(phases[phase], 0xffffffffLL)), 4);
+	}
+
+	record[0] = static_cast<char>(record.size() & 0xff);
+	record[1] = static_cast<char>(record.size() >> 8);
+}
+
+// writer: flush 간격이 지났거나 절반 넘게 찼으면 (force면 항상) 쌓인 레코드를 모두 씀
+bool AccessLog::drain(time_t now, bool force) {
+	size_t pending = _ring.size();
+	if (pending == 0) {
+		_lastFlush = now;
+		return false;
+	}
+	if (!force && pending < _ring.capacity() / 2
+		&& now - _lastFlush < static_cast<time_t>(_config.flush)) {
+		return false;
+	}
+
+	struct iovec iov[2];
+	int count;
+	while ((count = _ring.readable(iov)) > 0) {
+		ssize_t written = ::writev(_fd, iov, count);
+		if (written < 0 && errno == EINTR) {
+			continue;
+		}
+		if (written <= 0) {
+			// 디스크가 가득 찼거나 파일 오류: 쌓아 두면 이벤트 루프가 계속 버리게 되므로 이번 분량은 버림
+			ERROR_LOG("[AccessLog] failed to write " << _path << ": " << std::strerror(errno));
+			_ring.consume(iov[0].iov_len + (count == 2 ? iov[1].iov_len : 0));
+			break;
+		}
+		_ring.consume(written);
+	}
+	_lastFlush = now;
+	return true;
+}
+
+void* AccessLog::run(void* arg) {
+	(void)arg;
+
+	while (__atomic_load_n(&_running, __ATOMIC_ACQUIRE)) {
+		struct pollfd wake;
+		wake.fd = _wakeFd;
+		wake.events = POLLIN;
+		wake.revents = 0;
+		if (::poll(&wake, 1, WRITER_TICK_MS) > 0 && (wake.revents & POLLIN)) {
+			uint64_t count;
+			ssize_t ignored = ::read(_wakeFd, &count, sizeof(count));
+			(void)ignored;
+		}
+
+		time_t now = ::time(NULL);
+		for (std::map<std::string, AccessLog*>::iterator it = _logs.begin(); it != _logs.end(); ++it) {
+			it->second->drain(now, false);
+		}
+	}
+	return NULL;
+}
@@ -0,0 +1,135 @@
+#include "log/RequestTrace.hpp"
+#include "log/AccessLog.hpp"
+#include <cstdio>
+#include <cstring>
+
+RequestTrace* RequestTrace::_current = NULL;
+
+static const char* PHASE_NAMES[] = {
+	"header", "body", "route", "resolve", "handler", "upstream", "send"
+};
+
+static long long clampTime(long long value, long long low, long long high) {
+	if (value < low) {
+		return low;
+	}
+	return value > high ? high : value;
+}
+
+static long long positive(long long value) {
+	return value > 0 ? value : 0;
+}
+
+static void appendMillis(std::string& out, long long usec) {
+	char buffer[32];
+	std::snprintf(buffer, sizeof(buffer), "%.3f", usec / 1000.0);
+	out += buffer;
+}
+
+RequestTrace::RequestTrace() {
+	reset(0);
+}
+
+void RequestTrace::reset(long long start) {
+	std::memset(_marks, 0, sizeof(_marks));
+	std::memset(_spent, 0, sizeof(_spent));
+	_marks[MARK_START] = start;
+}
+
+void RequestTrace::mark(Mark which) {
+	if (_marks[which] == 0) {
+		_marks[which] = AccessLog::now();
+	}
+}
+
+long long RequestTrace::at(Mark which) const {
+	return _marks[which];
+}
+
+bool RequestTrace::started() const {
+	return _marks[MARK_START] != 0;
+}
+
+void RequestTrace::add(Phase phase, long long usec) {
+	_spent[phase] += usec;
+}
+
+// 지나지 않은 시각은 다음 시각과 같다고 봄 (400처럼 헤더 없이 응답했으면 header 단계가 응답까지)
+void RequestTrace::phases(long long end, long long out[PHASE_COUNT]) const {
+	long long responded = _marks[MARK_RESPONDED] ? clampTime(_marks[MARK_RESPONDED], 0, end) : end;
+	long long start = _marks[MARK_START] ? clampTime(_marks[MARK_START], 0, responded) : responded;
+	long long headers = _marks[MARK_HEADERS] ? clampTime(_marks[MARK_HEADERS], start, responded) : responded;
+	long long ready = _marks[MARK_READY] ? clampTime(_marks[MARK_READY], headers, responded) : responded;
+	long long dispatched = _marks[MARK_DISPATCHED];
+
+	out[PHASE_HEADER] = headers - start;
+	out[PHASE_ROUTE] = _spent[PHASE_ROUTE];
+	out[PHASE_RESOLVE] = _spent[PHASE_RESOLVE];
+	out[PHASE_BODY] = positive(ready - headers - _spent[PHASE_ROUTE]);
+	// 바디를 받는 동안 시작한 CGI/프록시는 바디를 다 받은 뒤부터 upstream
+	out[PHASE_UPSTREAM] = dispatched ? positive(responded - (dispatched > ready ? dispatched : ready)) : 0;
+	out[PHASE_HANDLER] = positive(responded - ready - _spent[PHASE_RESOLVE] - out[PHASE_UPSTREAM]);
+	out[PHASE_SEND] = end - responded;
+}
+
+long long RequestTrace::total(long long end) const {
+	return _marks[MARK_START] ? positive(end - _marks[MARK_START]) : 0;
+}
+
+std::string RequestTrace::serverTiming(long long now) const {
+	long long spent[PHASE_COUNT];
+	std::string value;
+
+	phases(now, spent);
+	for (int phase = 0; phase < PHASE_SEND; ++phase) {
+		value += PHASE_NAMES[phase];
+		value += ";dur=";
+		appendMillis(value, spent[phase]);
+		value += ", ";
+	}
+	value += "total;dur=";
+	appendMillis(value, total(now));
+	return value;
+}
+
+std::string RequestTrace::describe(long long end) const {
+	long long spent[PHASE_COUNT];
+	std::string line;
+
+	phases(end, spent);
+	for (int phase = 0; phase < PHASE_COUNT; ++phase) {
+		line += PHASE_NAMES[phase];
+		line += '=';
+		appendMillis(line, spent[phase]);
+		line += "ms ";
+	}
+	line += "total=";
+	appendMillis(line, total(end));
+	line += "ms";
+	return line;
+}
+
+const char* RequestTrace::phaseName(Phase phase) {
+	return PHASE_NAMES[phase];
+}
+
+RequestTrace* RequestTrace::current() {
+	return _current;
+}
+
+RequestTrace::Scope::Scope(RequestTrace& trace) : _previous(_current) {
+	_current = &trace;
+}
+
+RequestTrace::Scope::~Scope() {
+	_current = _previous;
+}
+
+RequestTrace::Timer::Timer(Phase phase)
+	: _trace(_current), _phase(phase), _start(_current ? AccessLog::now() : 0) {}
+
+RequestTrace::Timer::~Timer() {
+	if (_trace != NULL) {
+		_trace->add(_phase, AccessLog::now() - _start);
+	}
+}
@@ -0,0 +1,63 @@
+#include "log/RingBuffer.hpp"
+#include <cstring>
+#include <algorithm>
+
+RingBuffer::RingBuffer(size_t capacity) : _data(NULL), _capacity(1), _mask(0), _head(0), _tail(0) {
+	while (_capacity < capacity) {
+		_capacity <<= 1;
+	}
+	_mask = _capacity - 1;
+	_data = new char[_capacity];
+}
+
+RingBuffer::~RingBuffer() {
+	delete[] _data;
+}
+
+size_t RingBuffer::capacity() const {
+	return _capacity;
+}
+
+size_t RingBuffer::size() const {
+	return __atomic_load_n(&_head, __ATOMIC_ACQUIRE) - __atomic_load_n(&_tail, __ATOMIC_ACQUIRE);
+}
+
+bool RingBuffer::push(const char* data, size_t len) {
+	size_t head = _head;
+	size_t tail = __atomic_load_n(&_tail, __ATOMIC_ACQUIRE);
+
+	if (len > _capacity - (head - tail)) {
+		return false;
+	}
+	size_t offset = head & _mask;
+	size_t first = std::min(len, _capacity - offset);
+	std::memcpy(_data + offset, data, first);
+	std::memcpy(_data, data + first, len - first);
+	// 데이터를 다 쓴 뒤에 위치를 공개해야 소비자가 덜 쓴 바이트를 읽지 않음
+	__atomic_store_n(&_head, head + len, __ATOMIC_RELEASE);
+	return true;
+}
+
+int RingBuffer::readable(struct iovec iov[2]) const {
+	size_t tail = _tail;
+	size_t used = __atomic_load_n(&_head, __ATOMIC_ACQUIRE) - tail;
+
+	if (used == 0) {
+		return 0;
+	}
+	size_t offset = tail & _mask;
+	size_t first = std::min(used, _capacity - offset);
+	iov[0].iov_base = _data + offset;
+	iov[0].iov_len = first;
+	if (first == used) {
+		return 1;
+	}
+	iov[1].iov_base = _data;
+	iov[1].iov_len = used - first;
+	return 2;
+}
+
+void RingBuffer::consume(size_t len) {
+	// 읽기를 끝낸 뒤에 공간을 돌려줘야 생산자가 아직 쓰는 중인 바이트를 덮지 않음
+	__atomic_store_n(&_tail, _tail + len, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,86 @@
+#include "metrics/LatencyHistogram.hpp"
+#include <cstring>
+#include <cmath>
+
+const int LatencyHistogram::SUB_BITS;
+const size_t LatencyHistogram::SUB_BUCKETS;
+const int LatencyHistogram::MAX_BITS;
+const size_t LatencyHistogram::BUCKETS;
+
+LatencyHistogram::LatencyHistogram() : _count(0), _sum(0), _max(0) {
+	std::memset(_counts, 0, sizeof(_counts));
+}
+
+// 0 ~ SUB_BUCKETS-1은 값 그대로, 그 위는 (최상위 비트 위치, 그 아래 SUB_BITS 비트)로 버킷을 고름
+size_t LatencyHistogram::bucketOf(unsigned long long value) {
+	if (value < SUB_BUCKETS) {
+		return static_cast<size_t>(value);
+	}
+	int msb = 63 - __builtin_clzll(value);
+	if (msb > MAX_BITS) {
+		return BUCKETS - 1;
+	}
+	int shift = msb - SUB_BITS;
+	return static_cast<size_t>(msb - SUB_BITS + 1) * SUB_BUCKETS
+		+ static_cast<size_t>((value >> shift) - SUB_BUCKETS);
+}
+
+long long LatencyHistogram::upperBound(size_t bucket) {
+	if (bucket < SUB_BUCKETS) {
+		return static_cast<long long>(bucket);
+	}
+	int shift = static_cast<int>(bucket / SUB_BUCKETS) - 1;
+	long long lower = static_cast<long long>(SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+	return lower + (1LL << shift) - 1;
+}
+
+void LatencyHistogram::record(long long usec) {
+	if (usec < 0) {
+		usec = 0;
+	}
+	++_counts[bucketOf(static_cast<unsigned long long>(usec))];
+	++_count;
+	_sum += static_cast<unsigned long long>(usec);
+	if (usec > _max) {
+		_max = usec;
+	}
+}
+
+unsigned long long LatencyHistogram::count() const {
+	return _count;
+}
+
+unsigned long long LatencyHistogram::sum() const {
+	return _sum;
+}
+
+long long LatencyHistogram::max() const {
+	return _max;
+}
+
+unsigned long long LatencyHistogram::countAtOrBelow(long long usec) const {
+	unsigned long long total = 0;
+	for (size_t i = 0; i < BUCKETS && upperBound(i) <= usec; ++i) {
+		total += _counts[i];
+	}
+	return total;
+}
+
+long long LatencyHistogram::quantile(double q) const {
+	if (_count == 0) {
+		return 0;
+	}
+	unsigned long long target = static_cast<unsigned long long>(std::ceil(q * _count));
+	if (target == 0) {
+		target = 1;
+	}
+	unsigned long long seen = 0;
+	for (size_t i = 0; i < BUCKETS; ++i) {
+		seen += _counts[i];
+		if (seen >= target) {
+			long long bound = upperBound(i);
+			return bound < _max ? bound : _max;
+		}
+	}
+	return _max;
+}
@@ -0,0 +1,196 @@
+#include "metrics/Metrics.hpp"
+#include <cstring>
+#include <sstream>
+
+const int Metrics::MAX_STATUS;
+
+Metrics::Counters Metrics::_counters;
+LatencyHistogram Metrics::_phases[RequestTrace::PHASE_COUNT];
+std::map<std::pair<std::string, std::string>, LatencyHistogram*> Metrics::_locations;
+
+// Prometheus 히스토그램으로 내보낼 경계 (초)
+static const double BUCKET_BOUNDS[] = {
+	0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10
+};
+static const double QUANTILES[] = { 0.5, 0.99, 0.999 };
+
+static const char* TIMEOUT_NAMES[] = { "client", "cgi", "fastcgi", "proxy" };
+
+Metrics::Counters::Counters()
+	: accepts(0), requests(0), bytesIn(0), bytesOut(0), cgiSpawns(0) {
+	std::memset(timeouts, 0, sizeof(timeouts));
+	std::memset(responses, 0, sizeof(responses));
+}
+
+LatencyHistogram* Metrics::location(const std::string& server, const std::string& path) {
+	std::pair<std::string, std::string> key(server, path);
+	std::map<std::pair<std::string, std::string>, LatencyHistogram*>::iterator it = _locations.find(key);
+	if (it != _locations.end()) {
+		return it->second;
+	}
+	LatencyHistogram* histogram = new LatencyHistogram();
+	_locations[key] = histogram;
+	return histogram;
+}
+
+void Metrics::recordRequest(LatencyHistogram* latency, int status, size_t bytesSent,
+							const RequestTrace& trace, long long end) {
+	++_counters.requests;
+	++_counters.responses[(status > 0 && status < MAX_STATUS) ? status : 0];
+	_counters.bytesOut += bytesSent;
+
+	if (!trace.started()) {
+		return;
+	}
+	long long spent[RequestTrace::PHASE_COUNT];
+	trace.phases(end, spent);
+	for (int phase = 0; phase < RequestTrace::PHASE_COUNT; ++phase) {
+		_phases[phase].record(spent[phase]);
+	}
+	if (latency != NULL) {
+		latency->record(trace.total(end));
+	}
+}
+
+// 라벨 값의 \, ", 줄바꿈을 이스케이프
+static std::string labelValue(const std::string& value) {
+	std::string escaped;
+	for (size_t i = 0; i < value.size(); ++i) {
+		if (value[i] == '\\' || value[i] == '"') {
+			escaped += '\\';
+			escaped += value[i];
+		} else if (value[i] == '\n') {
+			escaped += "\\n";
+		} else {
+			escaped += value[i];
+		}
+	}
+	return escaped;
+}
+
+static void writeHeader(std::ostringstream& out, const char* name, const char* type, const char* help) {
+	out << "# HELP " << name << " " << help << "\n";
+	out << "# TYPE " << name << " " << type << "\n";
+}
+
+static void writeHistogram(std::ostringstream& out, const char* name, const std::string& labels,
+						   const LatencyHistogram& histogram) {
+	std::string prefix = labels.empty() ? "" : labels + ",";
+
+	for (size_t i = 0; i < sizeof(BUCKET_BOUNDS) / sizeof(BUCKET_BOUNDS[0]); ++i) {
+		long long usec = static_cast<long long>(BUCKET_BOUNDS[i] * 1000000);
+		out << name << "_bucket{" << prefix << "le=\"" << BUCKET_BOUNDS[i] << "\"} "
+			<< histogram.countAtOrBelow(usec) << "\n";
+	}
+	out << name << "_bucket{" << prefix << "le=\"+Inf\"} " << histogram.count() << "\n";
+	out << name << "_sum{" << labels << "} " << histogram.sum() / 1000000.0 << "\n";
+	out << name << "_count{" << labels << "} " << histogram.count() << "\n";
+}
+
+std::string Metrics::render(const Connections& connections, const std::vector<CacheZone::Stats>& zones,
+							const std::vector<CgiRunner::QueueStats>& queues) {
+	std::ostringstream out;
+
+	writeHeader(out, "webserv_connections", "gauge", "Client connections by state.");
+	out << "webserv_connections{state=\"active\"} " << connections.active << "\n";
+	out << "webserv_connections{state=\"reading\"} " << connections.reading << "\n";
+	out << "webserv_connections{state=\"writing\"} " << connections.writing << "\n";
+	out << "webserv_connections{state=\"idle\"} " << connections.idle << "\n";
+
+	writeHeader(out, "webserv_connections_accepted_total", "counter", "Accepted client connections.");
+	out << "webserv_connections_accepted_total " << _counters.accepts << "\n";
+
+	writeHeader(out, "webserv_http_requests_total", "counter", "Requests answered (HTTP/1.x and HTTP/2 streams).");
+	out << "webserv_http_requests_total " << _counters.requests << "\n";
+
+	writeHeader(out, "webserv_http_received_bytes_total", "counter", "Bytes read from client sockets.");
+	out << "webserv_http_received_bytes_total " << _counters.bytesIn << "\n";
+
+	writeHeader(out, "webserv_http_sent_bytes_total", "counter", "Response bytes written to client sockets.");
+	out << "webserv_http_sent_bytes_total " << _counters.bytesOut << "\n";
+
+	writeHeader(out, "webserv_http_responses_total", "counter", "Responses by status code.");
+	for (int code = 0; code < MAX_STATUS; ++code) {
+		if (_counters.responses[code] > 0) {
+			out << "webserv_http_responses_total{code=\"" << code << "\"} " << _counters.responses[code] << "\n";
+		}
+	}
+
+	writeHeader(out, "webserv_cgi_spawns_total", "counter", "CGI processes and cgi_pool workers started.");
+	out << "webserv_cgi_spawns_total " << _counters.cgiSpawns << "\n";
+
+	writeHeader(out, "webserv_timeouts_total", "counter", "Timed out connections and upstream requests.");
+	for (int kind = 0; kind < TIMEOUT_COUNT; ++kind) {
+		out << "webserv_timeouts_total{kind=\"" << TIMEOUT_NAMES[kind] << "\"} " << _counters.timeouts[kind] << "\n";
+	}
+
+	writeHeader(out, "webserv_cache_requests_total", "counter", "Response cache lookups by result.");
+	for (size_t i = 0; i < zones.size(); ++i) {
+		std::string zone = "zone=\"" + labelValue(zones[i].zone) + "\"";
+		out << "webserv_cache_requests_total{" << zone << ",result=\"hit\"} " << zones[i].hits << "\n";
+		out << "webserv_cache_requests_total{" << zone << ",result=\"stale\"} " << zones[i].stale << "\n";
+		out << "webserv_cache_requests_total{" << zone << ",result=\"miss\"} " << zones[i].misses << "\n";
+		out << "webserv_cache_requests_total{" << zone << ",result=\"bypass\"} " << zones[i].bypass << "\n";
+	}
+
+	// cgi_max_concurrent location별 실행 수와 대기열
+	std::vector<std::string> queueLabels;
+	for (size_t i = 0; i < queues.size(); ++i) {
+		queueLabels.push_back("server=\"" + labelValue(queues[i].server) + "\",location=\""
+							  + labelValue(queues[i].location) + "\"");
+	}
+	writeHeader(out, "webserv_cgi_running", "gauge", "CGI processes running in cgi_max_concurrent locations.");
+	for (size_t i = 0; i < queues.size(); ++i) {
+		out << "webserv_cgi_running{" << queueLabels[i] << "} " << queues[i].running << "\n";
+	}
+	writeHeader(out, "webserv_cgi_queue_depth", "gauge", "Requests waiting for a CGI slot.");
+	for (size_t i = 0; i < queues.size(); ++i) {
+		out << "webserv_cgi_queue_depth{" << queueLabels[i] << "} " << queues[i].depth << "\n";
+	}
+	writeHeader(out, "webserv_cgi_queue_max_depth", "gauge", "Largest CGI queue depth since start.");
+	for (size_t i = 0; i < queues.size(); ++i) {
+		out << "webserv_cgi_queue_max_depth{" << queueLabels[i] << "} " << queues[i].maxDepth << "\n";
+	}
+	writeHeader(out, "webserv_cgi_queue_wait_seconds", "summary", "Time queued requests waited for a CGI slot.");
+	for (size_t i = 0; i < queues.size(); ++i) {
+		out << "webserv_cgi_queue_wait_seconds_sum{" << queueLabels[i] << "} " << queues[i].totalWaitMs / 1000.0 << "\n";
+		out << "webserv_cgi_queue_wait_seconds_count{" << queueLabels[i] << "} " << queues[i].waited << "\n";
+	}
+	writeHeader(out, "webserv_cgi_queue_rejected_total", "counter", "Requests answered 503 because the CGI queue was full.");
+	for (size_t i = 0; i < queues.size(); ++i) {
+		out << "webserv_cgi_queue_rejected_total{" << queueLabels[i] << "} " << queues[i].rejected << "\n";
+	}
+	writeHeader(out, "webserv_cgi_queue_expired_total", "counter", "Requests answered 503 after cgi_queue_timeout.");
+	for (size_t i = 0; i < queues.size(); ++i) {
+		out << "webserv_cgi_queue_expired_total{" << queueLabels[i] << "} " << queues[i].expired << "\n";
+	}
+
+	writeHeader(out, "webserv_request_phase_seconds", "histogram", "Request time by phase.");
+	for (int phase = 0; phase < RequestTrace::PHASE_COUNT; ++phase) {
+		writeHistogram(out, "webserv_request_phase_seconds",
+					   std::string("phase=\"") + RequestTrace::phaseName(static_cast<RequestTrace::Phase>(phase)) + "\"",
+					   _phases[phase]);
+	}
+
+	writeHeader(out, "webserv_request_duration_seconds", "histogram", "Request time by location.");
+	std::map<std::pair<std::string, std::string>, LatencyHistogram*>::const_iterator it;
+	for (it = _locations.begin(); it != _locations.end(); ++it) {
+		writeHistogram(out, "webserv_request_duration_seconds",
+					   "server=\"" + labelValue(it->first.first) + "\",location=\"" + labelValue(it->first.second) + "\"",
+					   *it->second);
+	}
+
+	writeHeader(out, "webserv_request_duration_quantile_seconds", "gauge",
+				"Request time quantiles by location since start.");
+	for (it = _locations.begin(); it != _locations.end(); ++it) {
+		if (it->second->count() == 0) {
+			continue;	// 기록이 없으면 분위수도 없음
+		}
+		for (size_t i = 0; i < sizeof(QUANTILES) / sizeof(QUANTILES[0]); ++i) {
+			out << "webserv_request_duration_quantile_seconds{server=\"" << labelValue(it->first.first)
+				<< "\",location=\"" << labelValue(it->first.second) << "\",quantile=\"" << QUANTILES[i] << "\"} "
+				<< it->second->quantile(QUANTILES[i]) / 1000000.0 << "\n";
+		}
+	}
+	return out.str();
+}
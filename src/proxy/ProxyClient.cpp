@@ -0,0 +1,1013 @@
+#include "proxy/ProxyClient.hpp"
+#include "proxy/UpstreamGroup.hpp"
+#include "config/CompiledLocation.hpp"
+#include "metrics/Metrics.hpp"
+#include "server/EventLoop.hpp"
+#include "server/Client.hpp"
+#include "http/HttpRequest.hpp"
+#include "http/HttpResponse.hpp"
+#include "http/StatusCode.hpp"
+#include "utils/StringUtils.hpp"
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <algorithm>
+#include <cstdlib>
+
+const size_t ProxyRequest::OUTPUT_HIGH_WATERMARK = 1024 * 1024;
+const size_t ProxyRequest::MAX_HEAD_SIZE = 64 * 1024;
+
+const size_t ProxyClient::DEFAULT_CONNECT_TIMEOUT = 5;
+const size_t ProxyClient::DEFAULT_READ_TIMEOUT = 60;
+const size_t ProxyClient::DEFAULT_SEND_TIMEOUT = 60;
+const size_t ProxyClient::MAX_IDLE_CONNECTIONS = 32;
+const time_t ProxyClient::IDLE_TIMEOUT = 60;
+
+// 이벤트 하나에서 응답을 읽어 처리할 최대 횟수 (BUFFER_SIZE 단위)
+static const int READ_ROUNDS = 16;
+
+static std::string toLower(const std::string& value) {
+	std::string lower = value;
+	std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+	return lower;
+}
+
+static std::string toString(size_t value) {
+	std::ostringstream oss;
+	oss << value;
+	return oss.str();
+}
+
+// 다음 홉에 넘기지 않는 헤더 (RFC 9110 7.6.1)
+static bool isHopByHop(const std::string& name) {
+	return name == "connection" || name == "keep-alive" || name == "proxy-connection"
+		|| name == "te" || name == "trailer" || name == "transfer-encoding" || name == "upgrade";
+}
+
+// =========================================================================
+// ProxyRequest
+// =========================================================================
+
+ProxyRequest::ProxyRequest(ProxyClient* owner, Client* client,
+						   const ServerContext* serverConf, const LocationContext* locConf)
+	: _owner(owner), _upstream(NULL), _group(NULL), _peer(NULL), _client(client), _serverConf(serverConf), _locConf(locConf),
+	  _fd(-1), _reused(false), _state(CONNECTING), _outOffset(0), _body(NULL), _bodyLength(0), _bodySent(0),
+	  _streamBody(false), _inputEnded(false), _bodyPaused(false), _sendClosed(false),
+	  _inOffset(0), _upstreamClosed(false), _responseStarted(false), _headSent(false), _outputPaused(false),
+	  _bodyMode(BODY_NONE), _chunkState(CHUNK_SIZE), _remaining(0), _keepAlive(true),
+	  _connectStartedAt(0), _lastSendAt(0), _lastReadAt(0) {}
+
+ProxyRequest::~ProxyRequest() {}
+
+// 업스트림에 보낼 요청 헤더. Host는 클라이언트가 보낸 값을 그대로 넘김
+void ProxyRequest::buildHead(const HttpRequest* request, int clientFd, bool https) {
+	const CompiledLocation* compiled = _locConf->compiled;
+	std::string uri = request->getUri();
+	if (!compiled->proxyUri.empty() && _locConf->matchType != MATCH_EXTENSION
+		&& uri.compare(0, _locConf->path.length(), _locConf->path) == 0) {
+		uri = compiled->proxyUri + uri.substr(_locConf->path.length());
+	}
+
+	_method = request->getMethod();
+	_out = _method + " " + uri + " HTTP/1.1\r\n";
+
+	// Connection 헤더에 나열된 헤더도 hop-by-hop
+	std::vector<std::string> connectionTokens;
+	std::istringstream connection(toLower(request->getHeader("connection")));
+	std::string token;
+	while (std::getline(connection, token, ',')) {
+		connectionTokens.push_back(StringUtils::trim(token));
+	}
+
+	const std::map<std::string, std::string>& headers = request->getHeaders();
+	for (std::map<std::string, std::string>::const_iterator it = headers.begin(); it != headers.end(); ++it) {
+		const std::string& name = it->first;
+		if (isHopByHop(name) || name == "content-length" || name == "expect" || name == "x-forwarded-for"
+			|| std::find(connectionTokens.begin(), connectionTokens.end(), name) != connectionTokens.end()) {
+			continue;
+		}
+		_out += name + ": " + it->second + "\r\n";
+	}
+	if (!request->hasHeader("host")) {
+		std::string host = (_group != NULL) ? _group->name() : _upstream->address;
+		_out += "host: " + (host.compare(0, 5, "unix:") == 0 ? "localhost" : host) + "\r\n";
+	}
+
+	std::string forwardedFor = request->getHeader("x-forwarded-for");
+	struct sockaddr_storage peer;
+	socklen_t peerLen = sizeof(peer);
+	char ip[INET6_ADDRSTRLEN] = "";
+	if (::getpeername(clientFd, reinterpret_cast<struct sockaddr*>(&peer), &peerLen) == 0) {
+		if (peer.ss_family == AF_INET) {
+			::inet_ntop(AF_INET, &reinterpret_cast<struct sockaddr_in*>(&peer)->sin_addr, ip, sizeof(ip));
+		} else if (peer.ss_family == AF_INET6) {
+			::inet_ntop(AF_INET6, &reinterpret_cast<struct sockaddr_in6*>(&peer)->sin6_addr, ip, sizeof(ip));
+		}
+	}
+	if (ip[0] != '\0') {
+		forwardedFor = forwardedFor.empty() ? ip : forwardedFor + ", " + ip;
+	}
+	if (!forwardedFor.empty()) {
+		_out += "x-forwarded-for: " + forwardedFor + "\r\n";
+	}
+	_out += std::string("x-forwarded-proto: ") + (https ? "https" : "http") + "\r\n";
+
+	// chunked 요청은 다 받아 디코딩했으므로 길이를 알려 줌
+	if (_bodyLength > 0 || request->hasHeader("content-length") || request->isChunkedEncoding()) {
+		_out += "content-length: " + toString(_bodyLength) + "\r\n";
+	}
+	_out += "\r\n";
+}
+
+void ProxyRequest::abort() {
+	_client = NULL;
+	if (_state != DONE) {
+		_state = DONE;
+		_keepAlive = false;
+		_owner->release(this);
+	}
+}
+
+bool ProxyRequest::writeBody(const char* data, size_t len) {
+	// 업스트림이 먼저 응답하고 닫았으면 남은 바디는 버림
+	if (_state == DONE || _sendClosed) {
+		return true;
+	}
+
+	size_t written = 0;
+	if (_state == CONNECTED && !hasPendingOutput()) {
+		while (written < len) {
+			ssize_t n = ::send(_fd, data + written, len - written, MSG_NOSIGNAL);
+			if (n > 0) {
+				written += n;
+				_lastSendAt = ::time(NULL);
+				continue;
+			}
+			if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+				break;
+			}
+			onSendError();
+			return true;
+		}
+	}
+
+	if (written < len) {
+		_out.append(data + written, len - written);
+		updateEvents();
+	}
+	if (_out.size() - _outOffset >= OUTPUT_HIGH_WATERMARK) {
+		_bodyPaused = true;
+		return false;
+	}
+	return true;
+}
+
+int ProxyRequest::bodyPipe() const {
+	return -1;
+}
+
+void ProxyRequest::waitBodyWritable() {
+	updateEvents();
+}
+
+void ProxyRequest::endBody() {
+	_inputEnded = true;
+	if (_state == CONNECTED && !hasPendingOutput()) {
+		_lastReadAt = ::time(NULL);
+	}
+	processResponse();
+	if (_state != DONE) {
+		updateEvents();
+	}
+}
+
+void ProxyRequest::resumeOutput() {
+	if (!_outputPaused || _state == DONE) {
+		return;
+	}
+	_outputPaused = false;
+	_lastReadAt = ::time(NULL);
+	processResponse();
+	if (_state != DONE) {
+		updateEvents();
+	}
+}
+
+bool ProxyRequest::hasPendingOutput() const {
+	return _outOffset < _out.size() || (_body != NULL && _bodySent < _bodyLength);
+}
+
+// 요청 헤더와 바디를 보낼 수 있는 만큼 보냄. 오류면 false
+bool ProxyRequest::flush() {
+	while (_outOffset < _out.size()) {
+		ssize_t n = ::send(_fd, _out.data() + _outOffset, _out.size() - _outOffset, MSG_NOSIGNAL);
+		if (n > 0) {
+			_outOffset += n;
+			_lastSendAt = ::time(NULL);
+			continue;
+		}
+		return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+	}
+	while (_body != NULL && _bodySent < _bodyLength) {
+		ssize_t n = ::send(_fd, _body + _bodySent, _bodyLength - _bodySent, MSG_NOSIGNAL);
+		if (n > 0) {
+			_bodySent += n;
+			_lastSendAt = ::time(NULL);
+			continue;
+		}
+		return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+	}
+
+	// 스트리밍 바디는 보낸 만큼 버림 (다 받은 요청은 재시도를 위해 남겨 둠)
+	if (_streamBody) {
+		_out.clear();
+		_outOffset = 0;
+	}
+	if (_inputEnded) {
+		_lastReadAt = ::time(NULL);
+	}
+	if (_bodyPaused && _client != NULL) {
+		_bodyPaused = false;
+		_client->resumeBody();
+	}
+	return true;
+}
+
+void ProxyRequest::onSendError() {
+	// 재사용한 연결이 이미 끊겨 있었음: 새 연결로 처음부터 다시 보냄
+	if (retry()) {
+		return;
+	}
+	if (_responseStarted) {
+		// 업스트림이 바디를 다 받기 전에 응답함: 나머지 바디는 버리고 응답을 마저 읽음
+		_sendClosed = true;
+		_keepAlive = false;
+		_out.clear();
+		_outOffset = 0;
+		_body = NULL;
+		if (_bodyPaused && _client != NULL) {
+			_bodyPaused = false;
+			_client->resumeBody();
+		}
+		return;
+	}
+	ERROR_LOG("[Proxy] send to " << _upstream->address << " failed: " << std::strerror(errno));
+	fail(StatusCode::BAD_GATEWAY);
+}
+
+// 연결 실패: 그룹이면 다른 서버로 다시 연결 (아직 아무것도 보내지 않았음)
+void ProxyRequest::onConnectError(int statusCode) {
+	if (!_owner->failover(this)) {
+		fail(statusCode);
+	}
+}
+
+// 응답 바이트를 읽어 처리. Client 버퍼가 차면 멈추고, 이벤트 하나에서 읽는 양을 제한함
+void ProxyRequest::readResponse() {
+	char buffer[BUFFER_SIZE];
+
+	for (int round = 0; round < READ_ROUNDS && _state == CONNECTED && !_outputPaused; ++round) {
+		// 클라이언트 바디를 아직 받는 중이면 응답은 헤더 크기만큼만 미리 받아 둠
+		if (!_inputEnded && _in.size() - _inOffset > MAX_HEAD_SIZE) {
+			break;
+		}
+		ssize_t n = ::recv(_fd, buffer, sizeof(buffer), 0);
+		if (n > 0) {
+			_in.append(buffer, n);
+			_responseStarted = true;
+			_lastReadAt = ::time(NULL);
+			processResponse();
+			continue;
+		}
+		if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			break;
+		}
+		if (!_responseStarted && retry()) {
+			return;
+		}
+		_upstreamClosed = true;
+		_keepAlive = false;
+		processResponse();
+		break;
+	}
+}
+
+void ProxyRequest::updateEvents() {
+	if (_state == DONE || _fd == -1) {
+		return;
+	}
+	uint32_t events = 0;
+	if (_state == CONNECTING || (hasPendingOutput() && !_sendClosed)) {
+		events |= EPOLLOUT;
+	}
+	if (_state == CONNECTED && !_outputPaused && !_upstreamClosed) {
+		events |= EPOLLIN;
+	}
+	_owner->_event_loop->modifyHandler(_fd, events);
+}
+
+// 클라이언트 바디를 다 받았으면 받아 둔 응답을 처리
+void ProxyRequest::processResponse() {
+	if (!_inputEnded || _state != CONNECTED) {
+		return;
+	}
+	if (!_headSent && !parseHead()) {
+		return;
+	}
+	processBody();
+}
+
+// 응답 헤더를 파싱해 Client에 넘김. 헤더가 아직 다 오지 않았거나 실패하면 false
+bool ProxyRequest::parseHead() {
+	while (true) {
+		size_t headEnd = _in.find("\r\n\r\n", _inOffset);
+		if (headEnd == std::string::npos) {
+			if (_in.size() - _inOffset > MAX_HEAD_SIZE) {
+				ERROR_LOG("[Proxy] response header from " << _upstream->address << " too large");
+				fail(StatusCode::BAD_GATEWAY);
+			} else if (_upstreamClosed) {
+				ERROR_LOG("[Proxy] " << _upstream->address << " closed connection before sending a response");
+				fail(StatusCode::BAD_GATEWAY);
+			}
+			return false;
+		}
+
+		std::istringstream lines(_in.substr(_inOffset, headEnd - _inOffset));
+		_inOffset = headEnd + 4;
+
+		// 상태 줄: HTTP/1.x <code> <reason>
+		std::string line;
+		std::getline(lines, line);
+		if (line.compare(0, 7, "HTTP/1.") != 0 || line.length() < 12 || line[8] != ' ') {
+			ERROR_LOG("[Proxy] invalid status line from " << _upstream->address << ": " << line);
+			fail(StatusCode::BAD_GATEWAY);
+			return false;
+		}
+		bool http10 = (line[7] == '0');
+		int status = std::atoi(line.c_str() + 9);
+		if (status < 100 || status > 999) {
+			ERROR_LOG("[Proxy] invalid status code from " << _upstream->address << ": " << line);
+			fail(StatusCode::BAD_GATEWAY);
+			return false;
+		}
+		// 1xx 중간 응답은 건너뜀 (프로토콜 업그레이드는 지원하지 않음)
+		if (status < 200 && status != 101) {
+			continue;
+		}
+		if (status == 101) {
+			ERROR_LOG("[Proxy] " << _upstream->address << " tried to switch protocols");
+			fail(StatusCode::BAD_GATEWAY);
+			return false;
+		}
+
+		if (_peer != NULL) {
+			_group->recordSuccess(_peer);
+		}
+
+		HttpResponse* head = new HttpResponse();
+		head->setStatus(status);
+		bool chunked = false;
+		bool hasLength = false;
+		size_t contentLength = 0;
+		int cookies = 0;
+		_keepAlive = !http10;
+
+		while (std::getline(lines, line)) {
+			if (!line.empty() && line[line.length() - 1] == '\r') {
+				line.erase(line.length() - 1);
+			}
+			size_t colon = line.find(':');
+			if (colon == std::string::npos || colon == 0) {
+				continue;
+			}
+			std::string name = StringUtils::trim(line.substr(0, colon));
+			std::string value = StringUtils::trim(line.substr(colon + 1));
+			std::string lower = toLower(name);
+
+			if (lower == "connection") {
+				std::string tokens = toLower(value);
+				if (tokens.find("close") != std::string::npos) {
+					_keepAlive = false;
+				} else if (tokens.find("keep-alive") != std::string::npos) {
+					_keepAlive = true;
+				}
+			} else if (lower == "transfer-encoding") {
+				chunked = (toLower(value).find("chunked") != std::string::npos);
+			} else if (lower == "content-length") {
+				char* end = NULL;
+				contentLength = std::strtoul(value.c_str(), &end, 10);
+				hasLength = (end != value.c_str() && *end == '\0');
+			} else if (lower == "set-cookie") {
+				// HttpResponse는 Set-Cookie-N 키를 Set-Cookie로 내보냄
+				std::ostringstream key;
+				key << "Set-Cookie";
+				if (cookies > 0) {
+					key << "-" << cookies;
+				}
+				++cookies;
+				head->setHeader(key.str(), value);
+			} else if (!isHopByHop(lower)) {
+				head->setHeader(name, value);
+			}
+		}
+
+		_headSent = true;
+		if (_method == "HEAD" || status == 204 || status == 304) {
+			_bodyMode = BODY_NONE;
+		} else if (chunked) {
+			_bodyMode = BODY_CHUNKED;		// Client가 다시 chunked로 보냄
+		} else if (hasLength) {
+			_bodyMode = BODY_LENGTH;
+			_remaining = contentLength;
+			head->setHeader("Content-Length", toString(contentLength));
+		} else {
+			_bodyMode = BODY_UNTIL_CLOSE;	// 업스트림이 닫을 때까지
+			_keepAlive = false;
+		}
+		if (_bodyMode == BODY_NONE && hasLength) {
+			head->setHeader("Content-Length", toString(contentLength));
+		}
+
+		DEBUG_LOG("[Proxy] " << _upstream->address << " responded " << status
+				  << (_reused ? " (reused connection)" : ""));
+
+		Client* client = _client;
+		if (_bodyMode == BODY_NONE) {
+			_client = NULL;
+			client->completeAsync(head);
+			complete();
+			return false;
+		}
+		client->startResponseStream(head, this);
+		return true;
+	}
+}
+
+// 응답 바디를 Client에 넘김
+void ProxyRequest::processBody() {
+	while (_state == CONNECTED && !_outputPaused) {
+		size_t available = _in.size() - _inOffset;
+		const char* data = _in.data() + _inOffset;
+		size_t forward = 0;
+
+		if (_bodyMode == BODY_LENGTH) {
+			forward = std::min(available, _remaining);
+			_remaining -= forward;
+		} else if (_bodyMode == BODY_UNTIL_CLOSE) {
+			forward = available;
+		} else if (_chunkState == CHUNK_DATA) {
+			forward = std::min(available, _remaining);
+			_remaining -= forward;
+			if (_remaining == 0) {
+				_chunkState = CHUNK_DATA_END;
+			}
+		} else {
+			// 청크 크기 줄, 청크 뒤 CRLF, 트레일러는 줄 단위로 처리
+			size_t lineEnd = _in.find("\r\n", _inOffset);
+			if (lineEnd == std::string::npos) {
+				if (available > MAX_HEAD_SIZE) {
+					fail(StatusCode::BAD_GATEWAY);
+					return;
+				}
+				break;
+			}
+			std::string line = _in.substr(_inOffset, lineEnd - _inOffset);
+			_inOffset = lineEnd + 2;
+
+			if (_chunkState == CHUNK_SIZE) {
+				char* end = NULL;
+				_remaining = std::strtoul(line.c_str(), &end, 16);
+				if (end == line.c_str()) {
+					ERROR_LOG("[Proxy] invalid chunk size from " << _upstream->address);
+					fail(StatusCode::BAD_GATEWAY);
+					return;
+				}
+				_chunkState = (_remaining == 0) ? CHUNK_TRAILER : CHUNK_DATA;
+			} else if (_chunkState == CHUNK_DATA_END) {
+				_chunkState = CHUNK_SIZE;
+			} else if (line.empty()) {
+				complete();
+				return;
+			}
+			continue;
+		}
+
+		if (forward > 0) {
+			_inOffset += forward;
+			if (_client != NULL && !_client->appendResponseBody(data, forward)) {
+				_outputPaused = true;
+			}
+		}
+		if (_bodyMode == BODY_LENGTH && _remaining == 0) {
+			complete();
+			return;
+		}
+		if (_inOffset == _in.size()) {
+			break;
+		}
+	}
+
+	// 처리한 바이트 정리
+	if (_inOffset == _in.size()) {
+		_in.clear();
+		_inOffset = 0;
+	} else if (_inOffset > BUFFER_SIZE) {
+		_in.erase(0, _inOffset);
+		_inOffset = 0;
+	}
+
+	if (_state == CONNECTED && _upstreamClosed && _inOffset == _in.size()) {
+		if (_bodyMode == BODY_UNTIL_CLOSE) {
+			complete();
+		} else {
+			ERROR_LOG("[Proxy] " << _upstream->address << " closed connection mid-response");
+			fail(StatusCode::BAD_GATEWAY);
+		}
+	}
+}
+
+// 풀에서 꺼낸 연결이 응답 전에 끊김: 다 받은 요청이면 새 연결로 다시 보냄
+bool ProxyRequest::retry() {
+	if (!_reused || _responseStarted || _streamBody || _state == DONE) {
+		return false;
+	}
+	DEBUG_LOG("[Proxy] reused connection to " << _upstream->address << " was closed, reconnecting");
+	_owner->_event_loop->remove(_fd);
+	::close(_fd);
+	_fd = -1;
+	_outOffset = 0;
+	_bodySent = 0;
+	_in.clear();
+	_inOffset = 0;
+	_upstreamClosed = false;
+
+	if (!_owner->connect(this, false)) {
+		_state = DONE;
+		_keepAlive = false;
+		Client* client = _client;
+		_client = NULL;
+		if (client != NULL) {
+			client->completeAsync(new HttpResponse(
+				HttpResponse::createErrorResponse(StatusCode::BAD_GATEWAY, _serverConf, _locConf)
+			));
+		}
+		_owner->release(this);
+	}
+	return true;
+}
+
+void ProxyRequest::fail(int statusCode) {
+	if (_state == DONE) {
+		return;
+	}
+	_state = DONE;
+	_keepAlive = false;
+	if (_peer != NULL && !_headSent) {
+		_group->recordFailure(_peer);
+	}
+
+	Client* client = _client;
+	_client = NULL;
+	if (client != NULL && _headSent) {
+		// 헤더를 이미 보냄: 잘린 응답임을 알 수 있게 연결을 끊음
+		client->endResponseStream(false);
+	} else if (client != NULL) {
+		client->completeAsync(new HttpResponse(
+			HttpResponse::createErrorResponse(statusCode, _serverConf, _locConf)
+		));
+	}
+	_owner->release(this);
+}
+
+void ProxyRequest::complete() {
+	if (_state == DONE) {
+		return;
+	}
+	_state = DONE;
+
+	Client* client = _client;
+	_client = NULL;
+	if (client != NULL) {
+		client->endResponseStream(true);
+	}
+	_owner->release(this);
+}
+
+void ProxyRequest::onIoEvent(int fd, uint32_t events) {
+	(void)fd;
+	if (_state == DONE) {
+		return;
+	}
+
+	// 비동기 connect 완료 확인
+	if (_state == CONNECTING) {
+		if (!(events & (EPOLLOUT | EPOLLERR | EPOLLHUP))) {
+			return;
+		}
+		int err = 0;
+		socklen_t len = sizeof(err);
+		if (::getsockopt(_fd, SOL_SOCKET, SO_ERROR, &err, &len) == -1 || err != 0) {
+			ERROR_LOG("[Proxy] connect to " << _upstream->address << " failed: " << std::strerror(err));
+			onConnectError(StatusCode::BAD_GATEWAY);
+			return;
+		}
+		_state = CONNECTED;
+		_lastSendAt = ::time(NULL);
+		DEBUG_LOG("[Proxy] connected to " << _upstream->address << " fd=" << _fd);
+	}
+
+	if ((events & EPOLLOUT) && hasPendingOutput() && !_sendClosed) {
+		if (!flush()) {
+			onSendError();
+			if (_state == DONE) {
+				return;
+			}
+		}
+	}
+
+	if (events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+		readResponse();
+	}
+	updateEvents();
+}
+
+// =========================================================================
+// ProxyClient
+// =========================================================================
+
+ProxyClient::ProxyClient(EventLoop* eventLoop) : _event_loop(eventLoop) {}
+
+ProxyClient::~ProxyClient() {
+	for (std::map<const UpstreamContext*, UpstreamGroup*>::iterator it = _groups.begin(); it != _groups.end(); ++it) {
+		delete it->second;
+	}
+	for (size_t i = 0; i < _active.size(); ++i) {
+		_active[i]->_client = NULL;
+		_event_loop->remove(_active[i]->_fd);
+		::close(_active[i]->_fd);
+		delete _active[i];
+	}
+	for (size_t i = 0; i < _finished.size(); ++i) {
+		delete _finished[i];
+	}
+	for (std::map<int, ProxyUpstream*>::iterator it = _idleFds.begin(); it != _idleFds.end(); ++it) {
+		_event_loop->remove(it->first);
+		::close(it->first);
+	}
+	for (std::map<std::string, ProxyUpstream*>::iterator it = _upstreams.begin(); it != _upstreams.end(); ++it) {
+		delete it->second;
+	}
+}
+
+bool ProxyClient::submit(Client* client, bool streamBody) {
+	const LocationContext* locConf = client->getLocationContext();
+	const CompiledLocation* compiled = locConf->compiled;
+	const HttpRequest* request = client->getRequest();
+
+	ProxyRequest* proxyRequest = new ProxyRequest(this, client, client->getServerContext(), locConf);
+	if (compiled->proxyUpstream != NULL) {
+		proxyRequest->_group = getGroup(compiled->proxyUpstream);
+		proxyRequest->_hashKey = proxyRequest->_group->hashKey(request);
+	} else {
+		std::map<std::string, ProxyUpstream*>::iterator it = _upstreams.find(compiled->proxyPass);
+		if (it == _upstreams.end()) {
+			ERROR_LOG("[Proxy] proxy_pass " << compiled->proxyPass << " was not resolved at startup");
+			delete proxyRequest;
+			return false;
+		}
+		proxyRequest->_upstream = it->second;
+	}
+	proxyRequest->_streamBody = streamBody;
+	if (streamBody) {
+		proxyRequest->_bodyLength = request->getContentLength();
+	} else {
+		proxyRequest->_body = request->getBodyData();
+		proxyRequest->_bodyLength = request->getBodyLength();
+		proxyRequest->_inputEnded = true;
+	}
+	proxyRequest->buildHead(request, client->getFd(), client->getTls() != NULL);
+
+	if (!start(proxyRequest)) {
+		delete proxyRequest;
+		return false;
+	}
+	_active.push_back(proxyRequest);
+
+	client->attachAsync(proxyRequest);
+	if (streamBody) {
+		client->startBodyStream(proxyRequest);
+	}
+	return true;
+}
+
+ProxyUpstream* ProxyClient::getUpstream(const std::string& address) {
+	std::map<std::string, ProxyUpstream*>::iterator it = _upstreams.find(address);
+	if (it != _upstreams.end()) {
+		// 이전 설정에서 해석하지 못한 주소는 다시 시도
+		if (!it->second->valid) {
+			it->second->valid = resolveAddress(it->second);
+		}
+		return it->second;
+	}
+
+	ProxyUpstream* upstream = new ProxyUpstream();
+	upstream->address = address;
+	upstream->valid = resolveAddress(upstream);
+	_upstreams[address] = upstream;
+	return upstream;
+}
+
+UpstreamGroup* ProxyClient::getGroup(const UpstreamContext* config) {
+	std::map<const UpstreamContext*, UpstreamGroup*>::iterator it = _groups.find(config);
+	if (it != _groups.end()) {
+		return it->second;
+	}
+
+	std::vector<ProxyUpstream*> upstreams;
+	for (size_t i = 0; i < config->servers.size(); ++i) {
+		upstreams.push_back(getUpstream(config->servers[i].address));
+	}
+	UpstreamGroup* group = new UpstreamGroup(config, upstreams);
+	_groups[config] = group;
+	return group;
+}
+
+bool ProxyClient::prepare(const CompiledLocation* compiled) {
+	if (compiled->proxyUpstream == NULL) {
+		return getUpstream(compiled->proxyPass)->valid;
+	}
+	bool valid = true;
+	const std::vector<UpstreamServerDirective>& servers = compiled->proxyUpstream->servers;
+	for (size_t i = 0; i < servers.size(); ++i) {
+		valid = getUpstream(servers[i].address)->valid && valid;
+	}
+	getGroup(compiled->proxyUpstream);
+	return valid;
+}
+
+bool ProxyClient::resolveAddress(ProxyUpstream* upstream) {
+	const std::string& address = upstream->address;
+	std::memset(&upstream->sockaddr, 0, sizeof(upstream->sockaddr));
+
+	// unix:/path
+	if (address.compare(0, 5, "unix:") == 0) {
+		std::string path = address.substr(5);
+		struct sockaddr_un* un = reinterpret_cast<struct sockaddr_un*>(&upstream->sockaddr);
+		if (path.length() >= sizeof(un->sun_path)) {
+			ERROR_LOG("[Proxy] unix socket path too long: " << path);
+			return false;
+		}
+		un->sun_family = AF_UNIX;
+		std::memcpy(un->sun_path, path.c_str(), path.length() + 1);
+		upstream->sockaddrLen = sizeof(struct sockaddr_un);
+		return true;
+	}
+
+	// host:port ([::1]:8000 형식 포함)
+	size_t colon = address.rfind(':');
+	std::string host = address.substr(0, colon);
+	std::string port = address.substr(colon + 1);
+	if (host.length() >= 2 && host[0] == '[' && host[host.length() - 1] == ']') {
+		host = host.substr(1, host.length() - 2);
+	}
+
+	struct addrinfo hints;
+	struct addrinfo* result = NULL;
+	std::memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+
+	int rc = ::getaddrinfo(host.c_str(), port.c_str(), &hints, &result);
+	if (rc != 0 || result == NULL) {
+		ERROR_LOG("[Proxy] cannot resolve " << address << ": " << ::gai_strerror(rc));
+		return false;
+	}
+	std::memcpy(&upstream->sockaddr, result->ai_addr, result->ai_addrlen);
+	upstream->sockaddrLen = result->ai_addrlen;
+	::freeaddrinfo(result);
+	return true;
+}
+
+// 그룹이면 연결을 시작할 수 있는 서버가 나올 때까지 고름
+bool ProxyClient::start(ProxyRequest* request) {
+	while (true) {
+		if (request->_group != NULL) {
+			request->_peer = request->_group->select(request->_hashKey, request->_tried);
+			if (request->_peer == NULL) {
+				ERROR_LOG("[Proxy] no live servers in upstream " << request->_group->name());
+				return false;
+			}
+			request->_upstream = request->_peer->upstream;
+		}
+		if (connect(request, true)) {
+			if (request->_peer != NULL) {
+				++request->_peer->active;
+			}
+			return true;
+		}
+		if (request->_group == NULL) {
+			return false;
+		}
+		request->_group->recordFailure(request->_peer);
+		request->_tried.push_back(request->_peer);
+		request->_peer = NULL;
+	}
+}
+
+// 비동기 connect가 실패하거나 시간을 넘긴 요청을 그룹의 다른 서버로 옮김
+bool ProxyClient::failover(ProxyRequest* request) {
+	if (request->_group == NULL || request->_state != ProxyRequest::CONNECTING) {
+		return false;
+	}
+	UpstreamPeer* peer = request->_peer;
+	request->_group->recordFailure(peer);
+	--peer->active;
+	request->_tried.push_back(peer);
+	request->_peer = NULL;
+
+	_event_loop->remove(request->_fd);
+	::close(request->_fd);
+	request->_fd = -1;
+	request->_outOffset = 0;
+	request->_bodySent = 0;
+
+	if (!start(request)) {
+		return false;
+	}
+	DEBUG_LOG("[Proxy] upstream " << request->_group->name() << ": retrying on " << request->_upstream->address);
+	request->updateEvents();
+	return true;
+}
+
+// 유휴 연결을 꺼내거나(reuse) 새로 연결해 요청에 붙임
+bool ProxyClient::connect(ProxyRequest* request, bool reuse) {
+	ProxyUpstream* upstream = request->_upstream;
+	time_t now = ::time(NULL);
+	int fd = -1;
+
+	if (!upstream->valid) {
+		return false;
+	}
+
+	while (reuse && fd == -1 && !upstream->idle.empty()) {
+		ProxyUpstream::IdleConnection idle = upstream->idle.back();
+		upstream->idle.pop_back();
+		_idleFds.erase(idle.fd);
+		_event_loop->remove(idle.fd);
+		if (now - idle.since > IDLE_TIMEOUT) {
+			::close(idle.fd);
+			continue;
+		}
+		fd = idle.fd;
+		request->_reused = true;
+		request->_state = ProxyRequest::CONNECTED;
+	}
+
+	if (fd == -1) {
+		fd = ::socket(upstream->sockaddr.ss_family, SOCK_STREAM, 0);
+		if (fd == -1) {
+			ERROR_LOG("[Proxy] socket() failed: " << std::strerror(errno));
+			return false;
+		}
+		if (::fcntl(fd, F_SETFL, O_NONBLOCK) < 0) {
+			ERROR_LOG("[Proxy] fcntl failed");
+			::close(fd);
+			return false;
+		}
+		int rc = ::connect(fd, reinterpret_cast<struct sockaddr*>(&upstream->sockaddr), upstream->sockaddrLen);
+		if (rc == -1 && errno != EINPROGRESS) {
+			ERROR_LOG("[Proxy] connect to " << upstream->address << " failed: " << std::strerror(errno));
+			::close(fd);
+			return false;
+		}
+		request->_reused = false;
+		request->_state = (rc == 0) ? ProxyRequest::CONNECTED : ProxyRequest::CONNECTING;
+	}
+
+	request->_fd = fd;
+	request->_connectStartedAt = now;
+	request->_lastSendAt = now;
+	request->_lastReadAt = now;
+	if (!_event_loop->addHandler(fd, EPOLLIN | EPOLLOUT, request)) {
+		::close(fd);
+		request->_fd = -1;
+		return false;
+	}
+	return true;
+}
+
+// 끝난 요청의 연결을 풀에 돌려주거나 닫고, 요청은 삭제 대기열로 옮김
+void ProxyClient::release(ProxyRequest* request) {
+	if (request->_fd != -1) {
+		ProxyUpstream* upstream = request->_upstream;
+		_event_loop->remove(request->_fd);
+
+		bool reusable = request->_keepAlive && !request->_upstreamClosed && !request->_sendClosed
+			&& request->_inputEnded && !request->hasPendingOutput()
+			&& request->_headSent && request->_inOffset == request->_in.size()
+			&& upstream->idle.size() < MAX_IDLE_CONNECTIONS;
+		if (reusable && _event_loop->addHandler(request->_fd, EPOLLIN, this)) {
+			upstream->idle.push_back(ProxyUpstream::IdleConnection(request->_fd, ::time(NULL)));
+			_idleFds[request->_fd] = upstream;
+		} else {
+			::close(request->_fd);
+		}
+		request->_fd = -1;
+	}
+	if (request->_peer != NULL) {
+		--request->_peer->active;
+		request->_peer = NULL;
+	}
+
+	for (size_t i = 0; i < _active.size(); ++i) {
+		if (_active[i] == request) {
+			_active.erase(_active.begin() + i);
+			break;
+		}
+	}
+	_finished.push_back(request);
+}
+
+void ProxyClient::closeIdle(int fd) {
+	std::map<int, ProxyUpstream*>::iterator it = _idleFds.find(fd);
+	if (it == _idleFds.end()) {
+		return;
+	}
+	std::vector<ProxyUpstream::IdleConnection>& idle = it->second->idle;
+	for (size_t i = 0; i < idle.size(); ++i) {
+		if (idle[i].fd == fd) {
+			idle.erase(idle.begin() + i);
+			break;
+		}
+	}
+	_idleFds.erase(it);
+	_event_loop->remove(fd);
+	::close(fd);
+}
+
+void ProxyClient::onIoEvent(int fd, uint32_t events) {
+	(void)events;
+	DEBUG_LOG("[Proxy] idle connection fd=" << fd << " closed by upstream");
+	closeIdle(fd);
+}
+
+void ProxyClient::onTick() {
+	time_t now = ::time(NULL);
+
+	// 1. 연결/송신/수신이 제한 시간 동안 진전이 없는 요청
+	std::vector<ProxyRequest*> connectTimedOut;
+	std::vector<ProxyRequest*> timedOut;
+	for (size_t i = 0; i < _active.size(); ++i) {
+		ProxyRequest* request = _active[i];
+		const CompiledLocation* compiled = request->_locConf->compiled;
+
+		if (request->_state == ProxyRequest::CONNECTING) {
+			if (now - request->_connectStartedAt > static_cast<time_t>(compiled->proxyConnectTimeout)) {
+				ERROR_LOG("[Proxy] connect to " << request->_upstream->address << " timed out");
+				connectTimedOut.push_back(request);
+			}
+		} else if (request->hasPendingOutput() && !request->_sendClosed) {
+			if (now - request->_lastSendAt > static_cast<time_t>(compiled->proxySendTimeout)) {
+				ERROR_LOG("[Proxy] send to " << request->_upstream->address << " timed out");
+				timedOut.push_back(request);
+			}
+		} else if (request->_inputEnded && !request->_outputPaused) {
+			if (now - request->_lastReadAt > static_cast<time_t>(compiled->proxyReadTimeout)) {
+				ERROR_LOG("[Proxy] read from " << request->_upstream->address << " timed out");
+				timedOut.push_back(request);
+			}
+		}
+	}
+	Metrics::counters().timeouts[Metrics::TIMEOUT_PROXY] += connectTimedOut.size() + timedOut.size();
+	for (size_t i = 0; i < connectTimedOut.size(); ++i) {
+		connectTimedOut[i]->onConnectError(StatusCode::GATEWAY_TIMEOUT);
+	}
+	for (size_t i = 0; i < timedOut.size(); ++i) {
+		timedOut[i]->fail(StatusCode::GATEWAY_TIMEOUT);
+	}
+
+	// 2. 오래된 유휴 연결
+	std::vector<int> expired;
+	for (std::map<int, ProxyUpstream*>::iterator it = _idleFds.begin(); it != _idleFds.end(); ++it) {
+		const std::vector<ProxyUpstream::IdleConnection>& idle = it->second->idle;
+		for (size_t i = 0; i < idle.size(); ++i) {
+			if (idle[i].fd == it->first && now - idle[i].since > IDLE_TIMEOUT) {
+				expired.push_back(it->first);
+			}
+		}
+	}
+	for (size_t i = 0; i < expired.size(); ++i) {
+		closeIdle(expired[i]);
+	}
+
+	// 3. health_check
+	for (std::map<const UpstreamContext*, UpstreamGroup*>::iterator it = _groups.begin(); it != _groups.end(); ++it) {
+		it->second->runHealthChecks(_event_loop);
+	}
+
+	for (size_t i = 0; i < _finished.size(); ++i) {
+		delete _finished[i];
+	}
+	_finished.clear();
+}
@@ -0,0 +1,310 @@
+#include "proxy/UpstreamGroup.hpp"
+#include "proxy/ProxyClient.hpp"
+#include "server/EventLoop.hpp"
+#include "http/HttpRequest.hpp"
+#include "utils/StringUtils.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+const size_t UpstreamGroup::HASH_POINTS = 100;
+
+// FNV-1a 32bit + murmur3 finalizer (끝 글자만 다른 URI도 링 전체에 고르게 퍼지도록)
+static uint32_t hashString(const std::string& value) {
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < value.length(); ++i) {
+		hash ^= static_cast<unsigned char>(value[i]);
+		hash *= 16777619u;
+	}
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6bu;
+	hash ^= hash >> 13;
+	hash *= 0xc2b2ae35u;
+	hash ^= hash >> 16;
+	return hash;
+}
+
+// =========================================================================
+// HealthProbe
+// =========================================================================
+
+HealthProbe::HealthProbe(UpstreamGroup* group, UpstreamPeer* peer, EventLoop* eventLoop)
+	: _group(group), _peer(peer), _event_loop(eventLoop), _fd(-1), _outOffset(0), _startedAt(::time(NULL)) {}
+
+HealthProbe::~HealthProbe() {
+	if (_fd != -1) {
+		_event_loop->remove(_fd);
+		::close(_fd);
+	}
+}
+
+bool HealthProbe::start(const std::string& uri, const std::string& host) {
+	const ProxyUpstream* upstream = _peer->upstream;
+
+	_fd = ::socket(upstream->sockaddr.ss_family, SOCK_STREAM, 0);
+	if (_fd == -1) {
+		return false;
+	}
+	if (::fcntl(_fd, F_SETFL, O_NONBLOCK) < 0
+		|| (::connect(_fd, reinterpret_cast<const struct sockaddr*>(&upstream->sockaddr), upstream->sockaddrLen) == -1
+			&& errno != EINPROGRESS)
+		|| !_event_loop->addHandler(_fd, EPOLLOUT, this)) {
+		::close(_fd);
+		_fd = -1;
+		return false;
+	}
+
+	_out = "GET " + uri + " HTTP/1.1\r\nhost: " + host + "\r\nconnection: close\r\n"
+		   "user-agent: webserv-health-check\r\n\r\n";
+	return true;
+}
+
+void HealthProbe::onIoEvent(int fd, uint32_t events) {
+	(void)fd;
+
+	if (_outOffset < _out.size()) {
+		if (events & EPOLLERR) {
+			finish(false);
+			return;
+		}
+		ssize_t n = ::send(_fd, _out.data() + _outOffset, _out.size() - _outOffset, MSG_NOSIGNAL);
+		if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			return;
+		}
+		if (n <= 0) {
+			finish(false);
+			return;
+		}
+		_outOffset += n;
+		if (_outOffset == _out.size()) {
+			_event_loop->modifyHandler(_fd, EPOLLIN);
+		}
+		return;
+	}
+
+	char buffer[1024];
+	ssize_t n = ::recv(_fd, buffer, sizeof(buffer), 0);
+	if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+		return;
+	}
+	if (n > 0) {
+		_in.append(buffer, n);
+	}
+
+	// 상태 줄만 보면 됨: HTTP/1.x 2xx/3xx
+	size_t lineEnd = _in.find("\r\n");
+	if (lineEnd == std::string::npos) {
+		if (n <= 0 || _in.size() > sizeof(buffer)) {
+			finish(false);
+		}
+		return;
+	}
+	int status = (lineEnd >= 12 && _in.compare(0, 7, "HTTP/1.") == 0) ? std::atoi(_in.c_str() + 9) : 0;
+	finish(status >= 200 && status < 400);
+}
+
+void HealthProbe::finish(bool healthy) {
+	if (_fd != -1) {
+		_event_loop->remove(_fd);
+		::close(_fd);
+		_fd = -1;
+	}
+
+	if (healthy != _peer->healthy) {
+		if (healthy) {
+			INFO_LOG("[Upstream] " << _group->name() << " server " << _peer->upstream->address
+					 << " passed health check");
+		} else {
+			ERROR_LOG("[Upstream] " << _group->name() << " server " << _peer->upstream->address
+					  << " failed health check");
+		}
+	}
+	_peer->healthy = healthy;
+	_peer->probe = NULL;
+	_group->_finishedProbes.push_back(this);
+}
+
+// =========================================================================
+// UpstreamGroup
+// =========================================================================
+
+UpstreamGroup::UpstreamGroup(const UpstreamContext* config, const std::vector<ProxyUpstream*>& upstreams)
+	: _config(config) {
+	for (size_t i = 0; i < config->servers.size(); ++i) {
+		_peers.push_back(UpstreamPeer(upstreams[i], config->servers[i]));
+	}
+
+	if (config->policy == UPSTREAM_HASH) {
+		for (size_t i = 0; i < _peers.size(); ++i) {
+			for (size_t point = 0; point < _peers[i].weight * HASH_POINTS; ++point) {
+				std::ostringstream node;
+				node << _peers[i].upstream->address << "#" << point;
+				_ring.push_back(std::make_pair(hashString(node.str()), i));
+			}
+		}
+		std::sort(_ring.begin(), _ring.end());
+	}
+}
+
+UpstreamGroup::~UpstreamGroup() {
+	for (size_t i = 0; i < _peers.size(); ++i) {
+		delete _peers[i].probe;
+	}
+	for (size_t i = 0; i < _finishedProbes.size(); ++i) {
+		delete _finishedProbes[i];
+	}
+}
+
+const std::string& UpstreamGroup::name() const {
+	return _config->name;
+}
+
+std::string UpstreamGroup::hashKey(const HttpRequest* request) const {
+	if (_config->policy != UPSTREAM_HASH) {
+		return "";
+	}
+	if (_config->hashCookie.empty()) {
+		return request->getUri();
+	}
+
+	// Cookie: a=1; b=2
+	std::string cookies = request->getHeader("cookie");
+	size_t pos = 0;
+	while (pos < cookies.length()) {
+		size_t end = cookies.find(';', pos);
+		if (end == std::string::npos) {
+			end = cookies.length();
+		}
+		std::string pair = StringUtils::trim(cookies.substr(pos, end - pos));
+		size_t equal = pair.find('=');
+		if (equal != std::string::npos && pair.compare(0, equal, _config->hashCookie) == 0
+			&& equal == _config->hashCookie.length()) {
+			return pair.substr(equal + 1);
+		}
+		pos = end + 1;
+	}
+	return "";
+}
+
+bool UpstreamGroup::isAvailable(const UpstreamPeer& peer, time_t now,
+								const std::vector<UpstreamPeer*>& tried) const {
+	return peer.healthy && peer.downUntil <= now
+		&& std::find(tried.begin(), tried.end(), &peer) == tried.end();
+}
+
+UpstreamPeer* UpstreamGroup::select(const std::string& key, const std::vector<UpstreamPeer*>& tried) {
+	time_t now = ::time(NULL);
+
+	// 쿠키가 없는 요청은 한 서버에 몰리지 않도록 round-robin
+	if (_config->policy == UPSTREAM_HASH && !key.empty()) {
+		return selectHash(key, now, tried);
+	}
+	return selectRoundRobin(now, tried, _config->policy == UPSTREAM_LEAST_CONN);
+}
+
+// smooth weighted round-robin. least_conn이면 active/weight가 가장 작은 서버들 중에서 돌아가며 고름
+UpstreamPeer* UpstreamGroup::selectRoundRobin(time_t now, const std::vector<UpstreamPeer*>& tried, bool leastConn) {
+	UpstreamPeer* least = NULL;
+	if (leastConn) {
+		for (size_t i = 0; i < _peers.size(); ++i) {
+			UpstreamPeer& peer = _peers[i];
+			if (isAvailable(peer, now, tried)
+				&& (least == NULL || peer.active * least->weight < least->active * peer.weight)) {
+				least = &peer;
+			}
+		}
+	}
+
+	UpstreamPeer* best = NULL;
+	int total = 0;
+	for (size_t i = 0; i < _peers.size(); ++i) {
+		UpstreamPeer& peer = _peers[i];
+		if (!isAvailable(peer, now, tried)
+			|| (least != NULL && peer.active * least->weight != least->active * peer.weight)) {
+			continue;
+		}
+		peer.currentWeight += peer.weight;
+		total += peer.weight;
+		if (best == NULL || peer.currentWeight > best->currentWeight) {
+			best = &peer;
+		}
+	}
+	if (best != NULL) {
+		best->currentWeight -= total;
+	}
+	return best;
+}
+
+// 키 해시 다음의 가상 노드부터 시계 방향으로 사용할 수 있는 서버를 찾음
+UpstreamPeer* UpstreamGroup::selectHash(const std::string& key, time_t now, const std::vector<UpstreamPeer*>& tried) {
+	std::vector<std::pair<uint32_t, size_t> >::const_iterator start =
+		std::lower_bound(_ring.begin(), _ring.end(), std::make_pair(hashString(key), static_cast<size_t>(0)));
+
+	for (size_t i = 0; i < _ring.size(); ++i) {
+		if (start == _ring.end()) {
+			start = _ring.begin();
+		}
+		UpstreamPeer& peer = _peers[start->second];
+		if (isAvailable(peer, now, tried)) {
+			return &peer;
+		}
+		++start;
+	}
+	return NULL;
+}
+
+// passive health check: fail_timeout 구간 안에서 max_fails번 실패하면 fail_timeout 동안 제외
+void UpstreamGroup::recordFailure(UpstreamPeer* peer) {
+	if (peer->maxFails == 0) {
+		return;
+	}
+	time_t now = ::time(NULL);
+	if (peer->fails == 0 || now - peer->firstFailAt >= peer->failTimeout) {
+		peer->fails = 0;
+		peer->firstFailAt = now;
+	}
+	if (++peer->fails >= peer->maxFails) {
+		peer->fails = 0;
+		peer->downUntil = now + peer->failTimeout;
+		ERROR_LOG("[Upstream] " << name() << " server " << peer->upstream->address
+				  << " marked down for " << peer->failTimeout << "s");
+	}
+}
+
+void UpstreamGroup::recordSuccess(UpstreamPeer* peer) {
+	peer->fails = 0;
+}
+
+void UpstreamGroup::runHealthChecks(EventLoop* eventLoop) {
+	for (size_t i = 0; i < _finishedProbes.size(); ++i) {
+		delete _finishedProbes[i];
+	}
+	_finishedProbes.clear();
+
+	if (_config->opHealthCheckDirective.empty()) {
+		return;
+	}
+	const HealthCheckDirective& healthCheck = _config->opHealthCheckDirective[0];
+	time_t now = ::time(NULL);
+
+	for (size_t i = 0; i < _peers.size(); ++i) {
+		UpstreamPeer& peer = _peers[i];
+
+		// 응답이 주기보다 늦으면 실패
+		if (peer.probe != NULL) {
+			if (now - peer.probe->_startedAt >= static_cast<time_t>(healthCheck.interval)) {
+				peer.probe->finish(false);
+			}
+			continue;
+		}
+		if (now < peer.nextCheckAt) {
+			continue;
+		}
+
+		peer.nextCheckAt = now + healthCheck.interval;
+		const std::string& address = peer.upstream->address;
+		peer.probe = new HealthProbe(this, &peer, eventLoop);
+		if (!peer.probe->start(healthCheck.uri, address.compare(0, 5, "unix:") == 0 ? "localhost" : address)) {
+			peer.probe->finish(false);
+		}
+	}
+}
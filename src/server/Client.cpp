@@ -5,28 +5,57 @@
 #include "http/RequestRouter.hpp"
 #include "http/HttpController.hpp"
 #include "http/StatusCode.hpp"
-#include "utils/StringUtils.hpp"
+#include "config/LocationCompiler.hpp"
+#include "server/EventLoop.hpp"
+#include "server/AsyncTask.hpp"
+#include "server/BodySink.hpp"
+#include "server/BodySource.hpp"
+#include "server/ResponseTap.hpp"
+#include "http/ResponseCompressor.hpp"
+#include "config/CompiledLocation.hpp"
+#include "http2/Http2Protocol.hpp"
+#include "tls/TlsConnection.hpp"
+#include "log/AccessLog.hpp"
+#include "metrics/Metrics.hpp"
 #include <cstring>
+#include <cstdio>
 #include <cerrno>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/socket.h>
+#include <sys/sendfile.h>
 #include <sstream>
+#include <algorithm>
 
 // ========= 정적 상수 정의 =======
 const size_t Client::MAX_REQUEST_SIZE = 10UL * 1024 * 1024 * 1024;
 const size_t Client::MAX_HEADER_SIZE = 8192;
 const size_t Client::BUFFER_COMPACT_THRESHOLD = 1024 * 1024;
+const size_t Client::OUTPUT_HIGH_WATERMARK = 256 * 1024;
 
 
 // ========= 생성자 및 소멸자 =======
-Client::Client(int fd, int port)
-    : _fd(fd), _port(port), _state(READING_REQUEST),
+Client::Client(int fd, int port, EventLoop* eventLoop)
+    : _fd(fd), _port(port), _event_loop(eventLoop), _tls(NULL), _state(READING_REQUEST),
     _headerState(HEADER_INCOMPLETE),
     _request(new HttpRequest()), _response(NULL), _response_sent(0),
     _last_activity(0),
+    _bytes_sent(0),
     _headerEnd(0),
     _serverConf(NULL),
     _locConf(NULL),
+    _task(NULL),
+    _bodySink(NULL),
+    _bodyRemaining(0),
+    _bodyPaused(false),
+    _responseSource(NULL),
+    _responseStream(false),
+    _responseChunked(false),
+    _closeAfterStream(false),
+    _compressor(NULL),
+    _fileSegment(0),
+    _fileSent(0),
+    _responseTap(NULL),
     _buffer_read_offset(0),
     _lastBodyLength(0) // 초기화
 {
@@ -36,8 +65,17 @@ Client::Client(int fd, int port)
 
 Client::~Client(void)
 {
+    // 작업이 더 이상 이 Client에 응답을 넘기지 않도록 먼저 끊음
+    if (_task) {
+        _task->abort();
+        _task = NULL;
+    }
+    finishRequest();
+    endTap(false);
+    delete _compressor;
     delete _request;
     delete _response;
+    delete _tls;
 }
 
 
@@ -81,6 +119,11 @@ void Client::updateActivity(void)
 
 void Client::setState(ClientState new_state)
 {
+    if (new_state == PROCESSING_REQUEST) {
+        _trace.mark(RequestTrace::MARK_READY);
+    } else if (new_state == WRITING_RESPONSE) {
+        _trace.mark(RequestTrace::MARK_RESPONDED);
+    }
     _state = new_state;
 }
 
@@ -88,10 +131,18 @@ void Client::setState(ClientState new_state)
 bool Client::isExpired(time_t now) const
 {
     if (_headerState == BODY_RECEIVING) return false;
+    // 비동기 작업은 자체 타임아웃으로 정리됨 (스트리밍 응답은 전송이 멈추면 만료)
+    if (_task && !_responseStream) return false;
     return (now - _last_activity) > CLIENT_TIMEOUT;
 }
 
 
+bool Client::isIdle(void) const
+{
+    return _state == READING_REQUEST && getBufferLength() == 0;
+}
+
+
 // ========= 접근자 =======
 int Client::getFd(void) const { return _fd; }
 int Client::getPort(void) const { return _port; }
@@ -104,17 +155,97 @@ const LocationContext* Client::getLocationContext(void) const { return _locConf;
 
 size_t Client::getMaxBodySize(void) const
 {
-    if (!_locConf || _locConf->opBodySizeDirective.empty()) {
-        return 10UL * 1024 * 1024;
+    if (!_locConf || !_locConf->compiled) {
+        return LocationCompiler::DEFAULT_MAX_BODY_SIZE;
     }
-    return StringUtils::toBytes(_locConf->opBodySizeDirective[0].size);
+    return _locConf->compiled->maxBodySize;
 }
 
 
 void Client::setServerContext(const ServerContext* conf) { _serverConf = conf; }
 void Client::setLocationContext(const LocationContext* conf) { _locConf = conf; }
-void Client::appendRawBuffer(const char* data, size_t len) { _raw_buffer.append(data, len); }
-bool Client::needsWriteEvent(void) const { return _state == WRITING_RESPONSE && _response != NULL; }
+void Client::appendRawBuffer(const char* data, size_t len)
+{
+    if (!_trace.started()) {
+        _trace.mark(RequestTrace::MARK_START);
+    }
+    _raw_buffer.append(data, len);
+}
+
+void Client::setRemoteAddress(const std::string& addr) { _remote_addr = addr; }
+const std::string& Client::getRemoteAddress(void) const { return _remote_addr; }
+void Client::addBytesSent(size_t bytes) { _bytes_sent += bytes; }
+RequestTrace& Client::trace(void) { return _trace; }
+
+
+void Client::setTls(TlsConnection* tls) { _tls = tls; }
+TlsConnection* Client::getTls(void) const { return _tls; }
+
+
+TlsConnection* Client::releaseTls(void)
+{
+    TlsConnection* tls = _tls;
+    _tls = NULL;
+    return tls;
+}
+
+
+ssize_t Client::readSocket(char* buffer, size_t len)
+{
+    ssize_t bytes = _tls ? _tls->read(buffer, len) : ::recv(_fd, buffer, len, 0);
+    if (bytes > 0) {
+        Metrics::counters().bytesIn += bytes;
+    }
+    return bytes;
+}
+
+
+bool Client::hasPendingInput(void) const
+{
+    return _tls && _tls->hasPendingInput();
+}
+
+
+ssize_t Client::writeSocket(const char* data, size_t len)
+{
+    ssize_t bytes = _tls ? _tls->write(data, len) : ::send(_fd, data, len, MSG_NOSIGNAL);
+    if (bytes > 0) {
+        _bytes_sent += bytes;
+    }
+    return bytes;
+}
+
+
+bool Client::canWriteSocketDirectly(void) const
+{
+    return !_tls || _tls->canWriteSocket();
+}
+
+
+int Client::detectHttp2Preface(void) const
+{
+    size_t length = std::min(getBufferLength(), Http2::PREFACE_LEN);
+    if (std::memcmp(getBufferData(), Http2::PREFACE, length) != 0) {
+        return -1;
+    }
+    return length == Http2::PREFACE_LEN ? 1 : 0;
+}
+
+
+std::string Client::takeBufferedInput(void)
+{
+    size_t start = (_headerState == HEADER_INCOMPLETE) ? _buffer_read_offset : _headerEnd;
+    std::string input = _raw_buffer.substr(start);
+    _raw_buffer.clear();
+    _buffer_read_offset = 0;
+    return input;
+}
+bool Client::needsWriteEvent(void) const
+{
+    if (_state != WRITING_RESPONSE || _response == NULL) return false;
+    // 스트리밍 중 보낼 데이터가 없으면 source가 바디를 넘길 때까지 쓰기 이벤트를 끔
+    return !_responseSource || _response_sent < _response_buffer.size();
+}
 
 
 // ========= I/O 처리 =======
@@ -122,26 +253,63 @@ bool Client::handleWrite(void)
 {
     if (_state != WRITING_RESPONSE || !_response) return true;
     
-    if (_response_buffer.empty()) {
+    if (_response_buffer.empty() && !_responseStream) {
+        if (_locConf) {
+            ResponseCompressor::compressResponse(*_response, _request, _locConf->compiled);
+        }
         _response_buffer = _response->serialize(_request);
+        if (_response->hasFileBody() && _request->getMethod() != "HEAD") {
+            _response_buffer += _response->getFileSegments()[0].prefix;
+        }
     }
     
     size_t remaining = _response_buffer.size() - _response_sent;
-    ssize_t bytes = ::send(_fd, _response_buffer.c_str() + _response_sent, remaining, 0);
-    updateActivity();
-
-    if (bytes > 0) {
-        _response_sent += bytes;
-    } else {
-        // bytes == 0 (비정상) 또는 bytes == -1 (모든 오류)
-        setState(DISCONNECTED);
-        return false;
+    if (remaining > 0) {
+        ssize_t bytes = writeSocket(_response_buffer.c_str() + _response_sent, remaining);
+        updateActivity();
+
+        if (bytes > 0) {
+            _response_sent += bytes;
+        } else if (bytes < 0 && errno == EAGAIN) {
+            // TLS 레코드가 일부만 나감: 다음 쓰기 이벤트에서 같은 데이터로 이어 씀
+            return true;
+        } else {
+            // bytes == 0 (비정상) 또는 bytes == -1 (모든 오류)
+            setState(DISCONNECTED);
+            return false;
+        }
     }
 
     // 아직 보낼 데이터가 남았는지 확인
     if (_response_sent < _response_buffer.size()) {
         return true;
     }
+
+    // 파일 바디: 헤더(와 첫 조각의 prefix)를 보낸 뒤 파일 내용은 sendfile로
+    if (_response->hasFileBody() && _request->getMethod() != "HEAD") {
+        int sent = sendFileBody();
+        if (sent < 0) {
+            setState(DISCONNECTED);
+            return false;
+        }
+        if (sent == 0) {
+            return true;
+        }
+    }
+
+    // 스트리밍 응답: 보낸 데이터는 버리고, 바디가 더 오면 source에 다시 읽게 함
+    if (_responseStream) {
+        _response_buffer.clear();
+        _response_sent = 0;
+        if (_responseSource) {
+            _responseSource->resumeOutput();
+            return true;
+        }
+        if (_closeAfterStream) {
+            setState(DISCONNECTED);
+            return false;
+        }
+    }
     
     // 에러 응답 처리
     if (_response) {
@@ -177,12 +345,301 @@ bool Client::handleWrite(void)
 }
 
 
+// 현재 조각의 파일 내용을 보내고, 끝나면 다음 조각의 prefix를 응답 버퍼에 채움
+int Client::sendFileBody(void)
+{
+    const std::vector<FileSegment>& segments = _response->getFileSegments();
+
+    while (_fileSegment < segments.size()) {
+        const FileSegment& segment = segments[_fileSegment];
+
+        if (_fileSent < segment.length) {
+            off_t offset = segment.offset + static_cast<off_t>(_fileSent);
+            // TLS: kTLS면 sendfile 그대로, 아니면 읽어서 암호화
+            ssize_t bytes = _tls ? _tls->sendFile(_response->getFileFd(), offset, segment.length - _fileSent)
+                                 : ::sendfile(_fd, _response->getFileFd(), &offset, segment.length - _fileSent);
+            if (bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return 0;
+            }
+            if (bytes <= 0) {
+                // 파일이 그 사이 줄어들었거나 소켓 오류: 길이를 맞출 수 없으므로 끊음
+                return -1;
+            }
+            updateActivity();
+            _fileSent += bytes;
+            _bytes_sent += bytes;
+            if (_fileSent < segment.length) {
+                return 0;
+            }
+        }
+
+        ++_fileSegment;
+        _fileSent = 0;
+        if (_fileSegment < segments.size() && !segments[_fileSegment].prefix.empty()) {
+            _response_buffer = segments[_fileSegment].prefix;
+            _response_sent = 0;
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
 void Client::setResponse(HttpResponse* response)
 {
     delete _response;
     _response = response;
     _response_sent = 0;
+    _fileSegment = 0;
+    _fileSent = 0;
     setState(WRITING_RESPONSE);
+    if (_locConf && _locConf->compiled->serverTiming) {
+        _response->setHeader("Server-Timing", _trace.serverTiming(AccessLog::now()));
+    }
+}
+
+
+// ========= 비동기 처리 =======
+void Client::attachAsync(AsyncTask* task)
+{
+    _task = task;
+}
+
+
+void Client::completeAsync(HttpResponse* response)
+{
+    _task = NULL;
+    if (_responseTap) {
+        _responseTap->tapHead(*response);
+        endTap(true);
+    }
+    setResponse(response);
+    updateActivity();
+    if (_event_loop) {
+        _event_loop->setWritable(_fd, true);
+    }
+}
+
+
+bool Client::hasAsyncTask(void) const
+{
+    return _task != NULL;
+}
+
+
+// ========= 응답 스트리밍 =======
+void Client::startResponseStream(HttpResponse* head, BodySource* source)
+{
+    setResponse(head);
+
+    if (_responseTap) {
+        _responseTap->tapHead(*head);
+    }
+    delete _compressor;
+    _compressor = _locConf ? ResponseCompressor::startStream(*head, _request, _locConf->compiled) : NULL;
+    _responseChunked = head->getHeader("Content-Length").empty();
+    if (_responseChunked) {
+        head->setHeader("Transfer-Encoding", "chunked");
+    }
+    _response_buffer = head->serialize(_request);
+    _responseSource = source;
+    _responseStream = true;
+    _closeAfterStream = false;
+
+    updateActivity();
+    _event_loop->setWritable(_fd, true);
+}
+
+
+bool Client::appendResponseBody(const char* data, size_t len)
+{
+    if (_responseTap && len > 0) {
+        _responseTap->tapBody(data, len);
+    }
+    if (len > 0 && _request->getMethod() != "HEAD") {
+        if (_compressor) {
+            std::string compressed;
+            _compressor->compress(data, len, compressed, false);
+            appendFramed(compressed.data(), compressed.size());
+        } else {
+            appendFramed(data, len);
+        }
+        _event_loop->setWritable(_fd, true);
+    }
+    return _response_buffer.size() - _response_sent < OUTPUT_HIGH_WATERMARK;
+}
+
+
+void Client::appendFramed(const char* data, size_t len)
+{
+    if (len == 0) {
+        return;
+    }
+    if (_responseChunked) {
+        char size[20];
+        std::sprintf(size, "%lx\r\n", static_cast<unsigned long>(len));
+        _response_buffer.append(size);
+        _response_buffer.append(data, len);
+        _response_buffer.append("\r\n", 2);
+    } else {
+        _response_buffer.append(data, len);
+    }
+}
+
+
+void Client::endResponseStream(bool complete)
+{
+    _task = NULL;
+    _responseSource = NULL;
+    endTap(complete);
+    if (!complete) {
+        _closeAfterStream = true;  // 마지막 청크 없이 끊어 클라이언트가 잘린 응답임을 알게 함
+    } else if (_responseChunked && _request->getMethod() != "HEAD") {
+        if (_compressor) {
+            std::string tail;
+            _compressor->compress(NULL, 0, tail, true);
+            appendFramed(tail.data(), tail.size());
+        }
+        _response_buffer.append("0\r\n\r\n");
+    }
+    _event_loop->setWritable(_fd, true);
+}
+
+
+void Client::startResponseRelay(BodySource* source)
+{
+    // 응답 헤더와 바디는 source가 직접 보내므로 상태(keep-alive 판정)용 빈 응답만 둠
+    endTap(false);
+    setResponse(new HttpResponse());
+    _responseSource = source;
+    _responseStream = true;
+    _responseChunked = false;
+    _closeAfterStream = true;  // 스크립트가 쓴 응답의 길이를 알 수 없음
+    updateActivity();
+}
+
+
+void Client::waitRelayWritable(void)
+{
+    _event_loop->setWritable(_fd, true);
+}
+
+
+void Client::setResponseTap(ResponseTap* tap)
+{
+    _responseTap = tap;
+}
+
+
+void Client::endTap(bool complete)
+{
+    // tapEnd에서 tap이 해제될 수 있으므로 먼저 끊음
+    ResponseTap* tap = _responseTap;
+    _responseTap = NULL;
+    if (tap) {
+        tap->tapEnd(complete);
+    }
+}
+
+
+// ========= 바디 스트리밍 =======
+void Client::startBodyStream(BodySink* sink)
+{
+    // 헤더는 이미 파싱했으므로 버퍼에서 제거하고, 남은 바이트는 모두 바디로 취급
+    consumeBuffer(_headerEnd - _buffer_read_offset);
+    _headerEnd = _buffer_read_offset;
+
+    _bodySink = sink;
+    _bodyRemaining = _request->getContentLength();
+    _bodyPaused = false;
+    _headerState = BODY_RECEIVING;
+    pumpBody();
+}
+
+
+bool Client::isStreamingBody(void) const
+{
+    return _bodySink != NULL;
+}
+
+
+void Client::pumpBody(void)
+{
+    if (!_bodySink || _bodyPaused) return;
+
+    size_t available = std::min(getBufferLength(), _bodyRemaining);
+    if (available > 0) {
+        bool more = _bodySink->writeBody(getBufferData(), available);
+        _bodyRemaining -= available;
+        consumeBuffer(available);
+        _headerEnd = _buffer_read_offset;
+        if (!more && _bodyRemaining > 0) {
+            pauseBody();
+            return;
+        }
+    }
+
+    if (_bodyRemaining == 0) {
+        finishBodyStream();
+    }
+}
+
+
+void Client::resumeBody(void)
+{
+    if (!_bodySink || !_bodyPaused) return;
+
+    _bodyPaused = false;
+    _event_loop->setReadable(_fd, true);
+    pumpBody();
+}
+
+
+int Client::spliceBody(void)
+{
+    // 버퍼에 남은 바디가 있으면 순서를 지키기 위해 recv 경로로 처리 (TLS는 복호화해야 하므로 항상 recv 경로)
+    if (!_bodySink || _bodyPaused || getBufferLength() > 0 || _tls) return 0;
+
+    int pipeFd = _bodySink->bodyPipe();
+    if (pipeFd == -1) return 0;
+
+    ssize_t moved = ::splice(_fd, NULL, pipeFd, NULL, _bodyRemaining,
+                             SPLICE_F_NONBLOCK | SPLICE_F_MOVE);
+    if (moved > 0) {
+        _bodyRemaining -= moved;
+        updateActivity();
+        if (_bodyRemaining == 0) {
+            finishBodyStream();
+        }
+        return 1;
+    }
+    if (moved == 0) return -1;
+    if (errno == EAGAIN) {
+        // 소켓이 비었는지 파이프가 찼는지 알 수 없으므로 파이프 쓰기 가능을 기다림
+        pauseBody();
+        _bodySink->waitBodyWritable();
+        return 1;
+    }
+    return 0;  // splice를 지원하지 않는 경우 등: recv로 처리
+}
+
+
+void Client::pauseBody(void)
+{
+    _bodyPaused = true;
+    _event_loop->setReadable(_fd, false);
+}
+
+
+void Client::finishBodyStream(void)
+{
+    BodySink* sink = _bodySink;
+
+    _bodySink = NULL;
+    _lastBodyLength = 0;  // 바디는 이미 버퍼에서 제거됨
+    _headerState = REQUEST_COMPLETE;
+    setState(PROCESSING_REQUEST);
+    sink->endBody();
 }
 
 
@@ -223,6 +680,7 @@ bool Client::tryParseHeaders(void)
     
     _headerEnd = headerEnd + 4;
     _headerState = HEADER_COMPLETE;
+    _trace.mark(RequestTrace::MARK_HEADERS);
     return true;
 }
 
@@ -367,9 +825,49 @@ bool Client::tryParseContentLengthBody(size_t bodyStart, size_t maxBodySize, siz
 }
 
 
+// ========= access_log, 지표 =======
+void Client::finishRequest(void)
+{
+    if (!_response) return;
+
+    const CompiledLocation* compiled = _locConf ? _locConf->compiled : NULL;
+    long long end = AccessLog::now();
+    Metrics::recordRequest(compiled ? compiled->latency : NULL, _response->getStatus(), _bytes_sent, _trace, end);
+
+    // location을 정하기 전에 끝난 응답 (400, 431 등)은 http 블록의 access_log
+    AccessLog* log = compiled ? compiled->accessLog : AccessLog::defaultLog();
+    if (log) {
+        log->write(_remote_addr, _request, NULL, _response->getStatus(), _bytes_sent, _trace, end);
+    }
+    if (compiled && compiled->slowRequestLog > 0 && _trace.total(end) >= compiled->slowRequestLog) {
+        logSlowRequest(end);
+    }
+}
+
+
+// 단계별 시간과 끝날 때의 연결 상태 (소멸자에서 부르면 응답 중에 끊긴 연결)
+void Client::logSlowRequest(long long end) const
+{
+    static const char* STATES[] = { "reading", "processing", "writing", "disconnected" };
+
+    INFO_LOG("[SlowRequest] " << _request->getMethod() << " " << _request->getUri()
+             << " " << _response->getStatus() << " " << _trace.describe(end)
+             << " | fd=" << _fd << " port=" << _port << " client=" << _remote_addr
+             << " tls=" << (!_tls ? "off" : canWriteSocketDirectly() ? "ktls" : "on")
+             << " state=" << STATES[_state]
+             << " sent=" << _bytes_sent
+             << " unsent=" << (_response_buffer.size() > _response_sent ? _response_buffer.size() - _response_sent : 0)
+             << " body_stream=" << (_bodySink ? (_bodyPaused ? "paused" : "on") : "off")
+             << " response_stream=" << (_responseStream ? (_responseSource ? "on" : "done") : "off")
+             << " close=" << (_closeAfterStream ? "yes" : "no"));
+}
+
+
 // ========= 다음 요청 준비 =======
 void Client::resetForNextRequest(void)
 {
+    finishRequest();
+    endTap(false);
     delete _response;
     _response = NULL;
     delete _request;
@@ -393,10 +891,24 @@ void Client::resetForNextRequest(void)
     
     _response_buffer.clear();
     _response_sent = 0;
+    _fileSegment = 0;
+    _fileSent = 0;
     _headerEnd = 0;
     _lastBodyLength = 0; // (이전 수정 사항) _lastBodyLength 리셋
+    _bodySink = NULL;
+    _bodyRemaining = 0;
+    _bodyPaused = false;
+    _responseSource = NULL;
+    _responseStream = false;
+    _responseChunked = false;
+    _closeAfterStream = false;
+    delete _compressor;
+    _compressor = NULL;
     _headerState = HEADER_INCOMPLETE;
     _serverConf = NULL;
     _locConf = NULL;
+    _bytes_sent = 0;
+    // 파이프라이닝으로 다음 요청을 이미 받았으면 지금부터 잼
+    _trace.reset(getBufferLength() > 0 ? AccessLog::now() : 0);
     setState(READING_REQUEST);
 }
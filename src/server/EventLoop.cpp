@@ -1,5 +1,6 @@
 #include "server/EventLoop.hpp"
 #include "server/Server.hpp"
+#include "server/IoHandler.hpp"
 
 
 EventLoop::EventLoop() : _epfd(-1), _timeout_ms(1000) {}
@@ -104,7 +105,27 @@ bool EventLoop::setWritable(int fd, bool enable) {
 }
 
 
+bool EventLoop::setReadable(int fd, bool enable) {
+	std::map<int, uint32_t>::iterator it = _interests.find(fd);
+	if (it == _interests.end()) {
+		ERROR_LOG("[EventLoop] fd=" << fd << " not found in interests map");
+		return false;
+	}
+
+	uint32_t old_events = it->second;
+	uint32_t new_events = enable ? (old_events | EPOLLIN) : (old_events & ~EPOLLIN);
+
+	if (old_events == new_events) {
+		return true;  // 변경 없음
+	}
+
+	return ctl(EPOLL_CTL_MOD, fd, new_events);
+}
+
+
 bool EventLoop::remove(int fd) {
+	_handlers.erase(fd);
+
 	std::map<int, uint32_t>::iterator it = _interests.find(fd);
 	if (it == _interests.end()) {
 		return true;  // 이미 제거됨
@@ -114,6 +135,32 @@ bool EventLoop::remove(int fd) {
 }
 
 
+bool EventLoop::addHandler(int fd, uint32_t events, IoHandler* handler) {
+	if (!setNonBlocking(fd)) {
+		return false;
+	}
+	if (!ctl(EPOLL_CTL_ADD, fd, events)) {
+		ERROR_LOG("[EventLoop] epoll_ctl ADD failed for handler fd=" << fd << ": " << std::strerror(errno));
+		return false;
+	}
+	_handlers[fd] = handler;
+	return true;
+}
+
+
+bool EventLoop::modifyHandler(int fd, uint32_t events) {
+	std::map<int, uint32_t>::iterator it = _interests.find(fd);
+	if (it == _interests.end()) {
+		ERROR_LOG("[EventLoop] fd=" << fd << " not found in interests map");
+		return false;
+	}
+	if (it->second == events) {
+		return true;  // 변경 없음
+	}
+	return ctl(EPOLL_CTL_MOD, fd, events);
+}
+
+
 void EventLoop::run(Server& server) {
 	struct epoll_event events[MAX_EVENTS];
 	INFO_LOG("[EventLoop] started with timeout=" << _timeout_ms << "ms");
@@ -134,6 +181,14 @@ void EventLoop::run(Server& server) {
 			int fd = events[i].data.fd;
 			uint32_t ev = events[i].events;
 
+			// 핸들러가 등록된 fd는 이벤트 처리를 핸들러에 위임
+			// (같은 배치에서 앞선 이벤트가 제거한 fd는 map에 없으므로 건너뜀)
+			std::map<int, IoHandler*>::iterator handler = _handlers.find(fd);
+			if (handler != _handlers.end()) {
+				handler->second->onIoEvent(fd, ev);
+				continue;
+			}
+
 			// EPOLLERR는 진짜 에러이므로 즉시 종료
 			if (ev & EPOLLERR) {
 				DEBUG_LOG("[EventLoop] fd=" << fd << " error detected");
@@ -6,20 +6,44 @@
 #include "http/HttpController.hpp"
 #include "http/RequestRouter.hpp"
 #include "http/StatusCode.hpp"
+#include "cgi/FastCgiClient.hpp"
+#include "cgi/CgiExecutor.hpp"
+#include "cgi/CgiRunner.hpp"
+#include "proxy/ProxyClient.hpp"
+#include "cache/ResponseCache.hpp"
+#include "http/ResponseCompressor.hpp"
+#include "http2/Http2Connection.hpp"
+#include "tls/TlsContext.hpp"
+#include "tls/TlsConnection.hpp"
+#include "log/AccessLog.hpp"
+#include "metrics/Metrics.hpp"
+#include "config/CompiledLocation.hpp"
+#include "utils/PathResolver.hpp"
+#include "utils/FileUtils.hpp"
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <fcntl.h>
 #include <cstring>
 #include <cerrno>
+#include <signal.h>
 
 // 생성자 및 소멸자
 Server::Server(void)
-	: _event_loop(NULL), _running(false) {
+	: _event_loop(NULL), _fastcgi(NULL), _cgi(NULL), _proxy(NULL), _cache(NULL), _running(false) {
 	_event_loop = new EventLoop();
+	_fastcgi = new FastCgiClient(_event_loop);
+	_cgi = new CgiRunner(_event_loop);
+	_proxy = new ProxyClient(_event_loop);
+	_cache = new ResponseCache(this);
 }
 
 Server::~Server(void) {
 	stop();
+	// Client가 먼저 정리되어 진행 중인 작업이 모두 abort된 뒤 해제
+	delete _fastcgi;
+	delete _cgi;
+	delete _proxy;
+	delete _cache;
 	if (_event_loop) delete _event_loop;
 }
 
@@ -88,6 +112,11 @@ void Server::cleanupClient(int client_fd) {
 		delete it->second;
 		_clients.erase(it);
 	}
+	std::map<int, Http2Connection*>::iterator connection = _http2.find(client_fd);
+	if (connection != _http2.end()) {
+		delete connection->second;
+		_http2.erase(connection);
+	}
 	_event_loop->remove(client_fd);
 	::close(client_fd);
 }
@@ -101,6 +130,12 @@ void Server::cleanupExpiredClients(void) {
 			expired_fds.push_back(it->first);
 		}
 	}
+	for (std::map<int, Http2Connection*>::iterator it = _http2.begin(); it != _http2.end(); ++it) {
+		if (it->second->isExpired(now)) {
+			expired_fds.push_back(it->first);
+		}
+	}
+	Metrics::counters().timeouts[Metrics::TIMEOUT_CLIENT] += expired_fds.size();
 
 	for (size_t i = 0; i < expired_fds.size(); ++i) {
 		cleanupClient(expired_fds[i]);
@@ -113,11 +148,13 @@ bool Server::init(void) {
 		ERROR_LOG("[Server] EventLoop init failed");
 		return false;
 	}
+	// 종료된 CGI의 stdin 파이프나 끊긴 소켓에 쓰면 EPIPE로 처리
+	::signal(SIGPIPE, SIG_IGN);
 	INFO_LOG("[Server] initialized");
 	return true;
 }
 
-bool Server::addListenPort(const std::string& host, int port) {
+bool Server::addListenPort(const std::string& host, int port, TlsContext* tls) {
 	int fd = createServerSocket();
 	if (fd == -1) return false;
 
@@ -134,11 +171,34 @@ bool Server::addListenPort(const std::string& host, int port) {
 
 	_server_fds.push_back(fd);
 	_server_ports[fd] = port;
+	if (tls) {
+		_server_tls[fd] = tls;
+	}
 
-	INFO_LOG("[Server] listening on " << host << ":" << port);
+	INFO_LOG("[Server] listening on " << host << ":" << port << (tls ? " (ssl)" : ""));
 	return true;
 }
 
+void Server::startCgiPool(const CompiledLocation* compiled) {
+	_fastcgi->startWorkerPool(compiled);
+}
+
+void Server::startCgiQueue(const LocationContext* location) {
+	_cgi->addQueue(location);
+}
+
+bool Server::startUpstream(const CompiledLocation* compiled) {
+	return _proxy->prepare(compiled);
+}
+
+bool Server::startFastCgiUpstream(const CompiledLocation* compiled) {
+	return _fastcgi->prepare(compiled);
+}
+
+void Server::startCacheZone(const CacheZoneDirective* zone) {
+	_cache->getZone(zone);
+}
+
 void Server::run(void) {
 	if (_server_fds.empty()) {
 		ERROR_LOG("[Server] no listen ports");
@@ -159,11 +219,17 @@ void Server::stop(void) {
 	}
 	_clients.clear();
 
+	for (std::map<int, Http2Connection*>::iterator it = _http2.begin(); it != _http2.end(); ++it) {
+		delete it->second;
+	}
+	_http2.clear();
+
 	for (size_t i = 0; i < _server_fds.size(); ++i) {
 		::close(_server_fds[i]);
 	}
 	_server_fds.clear();
 	_server_ports.clear();
+	_server_tls.clear();
 
 	INFO_LOG("[Server] stopped");
 }
@@ -171,9 +237,13 @@ void Server::stop(void) {
 // EventLoop callback functions
 
 void Server::onReadable(int fd) {
+    std::map<int, Http2Connection*>::iterator connection = _http2.find(fd);
+
     if (isServerSocket(fd)) {
         // 새 연결 처리 함수 호출
         handleNewConnection(fd);
+    } else if (connection != _http2.end()) {
+        updateHttp2(fd, connection->second->onReadable());
     } else {
         // 기존 클라이언트 데이터 처리 함수 호출
         handleClientData(fd);
@@ -204,10 +274,28 @@ void Server::handleNewConnection(int server_fd) {
         return;
     }
 
+    // listen ... ssl: 첫 읽기 이벤트부터 TLS 핸드셰이크를 진행
+    TlsConnection* tls = NULL;
+    std::map<int, TlsContext*>::iterator context = _server_tls.find(server_fd);
+    if (context != _server_tls.end()) {
+        tls = context->second->accept(client_fd);
+        if (!tls) {
+            _event_loop->remove(client_fd);
+            ::close(client_fd);
+            return;
+        }
+    }
+
     // server_fd를 키로 사용하여 해당 리슨 포트를 검색
     int listen_port = _server_ports[server_fd];
-    Client* client = new Client(client_fd, listen_port);
+    Client* client = new Client(client_fd, listen_port, _event_loop);
+    client->setTls(tls);
+    char addr[INET_ADDRSTRLEN];
+    if (::inet_ntop(AF_INET, &client_addr.sin_addr, addr, sizeof(addr)) != NULL) {
+        client->setRemoteAddress(addr);
+    }
     _clients[client_fd] = client;
+    ++Metrics::counters().accepts;
     
     DEBUG_LOG("[Server] client connected: fd=" << client_fd);
 }
@@ -217,10 +305,28 @@ void Server::handleClientData(int client_fd) {
     if (it == _clients.end()) return;
 
     Client* client = it->second;
+
+    if (client->getTls() && !client->getTls()->isEstablished()) {
+        continueHandshake(client);
+        return;
+    }
+
+    // 스트리밍 중인 CGI 바디는 가능하면 소켓에서 stdin 파이프로 바로 옮김
+    if (client->isStreamingBody()) {
+        int spliced = client->spliceBody();
+        if (spliced < 0) {
+            onHangup(client_fd);
+            return;
+        }
+        if (spliced > 0) return;
+    }
     
     // Data Reception
     char buffer[BUFFER_SIZE];
-    ssize_t bytes = ::recv(client_fd, buffer, BUFFER_SIZE, 0);
+    ssize_t bytes = client->readSocket(buffer, BUFFER_SIZE);
+    if (bytes < 0 && errno == EAGAIN) {
+        return;  // TLS 레코드가 아직 다 오지 않음
+    }
 
 	// Before code
     // if (bytes <= 0) {
@@ -238,8 +344,31 @@ void Server::handleClientData(int client_fd) {
     }
 
     client->appendRawBuffer(buffer, bytes);
+    // TLS 안에 복호화해 둔 바이트는 소켓 이벤트가 다시 오지 않으므로 지금 읽음
+    while (client->hasPendingInput() && (bytes = client->readSocket(buffer, BUFFER_SIZE)) > 0) {
+        client->appendRawBuffer(buffer, bytes);
+    }
     client->updateActivity();
 
+    // 이 요청의 라우팅, 경로 계산 시간을 Client의 trace에 더함
+    RequestTrace::Scope traceScope(client->trace());
+
+    // HTTP/2 prior knowledge: 요청 자리에 프리페이스가 오면 연결을 Http2Connection으로 넘김
+    if (client->getHeaderState() == HEADER_INCOMPLETE) {
+        int preface = client->detectHttp2Preface();
+        if (preface == 0) return;
+        if (preface > 0) {
+            startHttp2(client, false);
+            return;
+        }
+    }
+
+    // 비동기 작업이 응답을 만드는 중이면 스트리밍 중인 바디만 넘기고 나머지는 버퍼에 쌓아 둠
+    if (client->hasAsyncTask()) {
+        client->pumpBody();
+        return;
+    }
+
     // Step 1: Parse Headers
     if (client->getHeaderState() == HEADER_INCOMPLETE) {
         if (!client->tryParseHeaders()) return;
@@ -257,6 +386,7 @@ void Server::handleClientData(int client_fd) {
     // Step 2: Find Config
     if (!client->getServerContext()) {
         HttpRequest* request = client->getRequest();
+        RequestTrace::Timer routeTimer(RequestTrace::PHASE_ROUTE);
         
         const ServerContext* serverConf =
             RequestRouter::findServerForRequest(request, client->getPort());
@@ -282,6 +412,23 @@ void Server::handleClientData(int client_fd) {
         }
     }
 
+    // Upgrade: h2c (평문 연결에서 바디가 없는 요청만, TLS는 ALPN으로 고름). 이 요청의 응답은 HTTP/2 스트림 1로 보냄
+    if (client->getState() == READING_REQUEST && client->getHeaderState() == HEADER_COMPLETE
+        && client->getTls() == NULL
+        && Http2Connection::wantsUpgrade(client->getRequest())
+        && !Http2Connection::requiresHttp1(client->getLocationContext())) {
+        startHttp2(client, true);
+        return;
+    }
+
+    // Step 2.5: CGI/프록시는 바디를 기다리지 않고 바로 시작해 받는 대로 넘김
+    if (client->getState() == READING_REQUEST && client->getHeaderState() == HEADER_COMPLETE
+        && canStreamBody(client)
+        && ((usesProxy(client) && startProxy(client, true)) || startCgiStream(client))) {
+        client->trace().mark(RequestTrace::MARK_DISPATCHED);
+        return;
+    }
+
     // Step 3: Parse Body
     if (client->getState() != PROCESSING_REQUEST &&
         client->getState() != WRITING_RESPONSE) {
@@ -293,23 +440,8 @@ void Server::handleClientData(int client_fd) {
 
     // Step 4: Process Request
     if (client->getState() == PROCESSING_REQUEST) {
-        HttpRequest* request = client->getRequest();
-        const ServerContext* serverConf = client->getServerContext();
-        const LocationContext* locConf = client->getLocationContext();
-
-        if (!serverConf) {
-            HttpResponse* response = new HttpResponse(
-                HttpResponse::createErrorResponse(StatusCode::INTERNAL_SERVER_ERROR, NULL, NULL)
-            );
-            client->setResponse(response);
-        } else {
-            HttpResponse* response = HttpController::processRequest(
-                request, client->getPort(), serverConf, locConf
-            );
-            client->setResponse(response);
-        }
-        
-        DEBUG_LOG("[Server] response ready");
+        processRequest(client);
+        return;
     }
 
     // Set Write Event
@@ -318,12 +450,265 @@ void Server::handleClientData(int client_fd) {
     }
 }
 
+void Server::processRequest(Client* client) {
+    RequestTrace::Scope traceScope(client->trace());
+
+    // FastCGI 등 업스트림으로 넘기는 요청은 응답이 준비되면 쓰기 이벤트가 켜짐
+    if (dispatchAsync(client)) {
+        client->trace().mark(RequestTrace::MARK_DISPATCHED);
+        return;
+    }
+
+    HttpRequest* request = client->getRequest();
+    const ServerContext* serverConf = client->getServerContext();
+    const LocationContext* locConf = client->getLocationContext();
+
+    if (!serverConf) {
+        HttpResponse* response = new HttpResponse(
+            HttpResponse::createErrorResponse(StatusCode::INTERNAL_SERVER_ERROR, NULL, NULL)
+        );
+        client->setResponse(response);
+    } else if (locConf && locConf->opReturnDirective.empty() && locConf->compiled->stubStatus) {
+        client->setResponse(createStatusResponse());
+    } else {
+        HttpResponse* response = HttpController::processRequest(
+            request, client->getPort(), serverConf, locConf
+        );
+        client->setResponse(response);
+    }
+
+    DEBUG_LOG("[Server] response ready");
+
+    if (client->needsWriteEvent()) {
+        _event_loop->setWritable(client->getFd(), true);
+    }
+}
+
+// stub_status: 연결 수는 지금 상태로 세고, 나머지는 Metrics가 모아 둔 값
+HttpResponse* Server::createStatusResponse(void) {
+    Metrics::Connections connections;
+
+    for (std::map<int, Client*>::iterator it = _clients.begin(); it != _clients.end(); ++it) {
+        if (it->second->isIdle()) {
+            ++connections.idle;
+        } else if (it->second->getState() == READING_REQUEST) {
+            ++connections.reading;
+        } else {
+            ++connections.writing;
+        }
+    }
+    for (std::map<int, Http2Connection*>::iterator it = _http2.begin(); it != _http2.end(); ++it) {
+        if (it->second->isIdle()) {
+            ++connections.idle;
+        } else {
+            ++connections.writing;
+        }
+    }
+    connections.active = _clients.size() + _http2.size();
+
+    HttpResponse* response = new HttpResponse();
+    response->setStatus(StatusCode::OK);
+    response->setBody(Metrics::render(connections, _cache->zoneStats(), _cgi->queueStats()));
+    response->setContentType("text/plain; version=0.0.4; charset=utf-8");
+    response->setHeader("Cache-Control", "no-store");
+    return response;
+}
+
+bool Server::dispatchAsync(Client* client) {
+    const ServerContext* serverConf = client->getServerContext();
+    const LocationContext* locConf = client->getLocationContext();
+    std::string scriptPath;
+
+    if (usesProxy(client)) {
+        return checkCache(client) || startProxy(client, false);
+    }
+    if (!resolveCgiScript(client, scriptPath)) {
+        return false;
+    }
+    if (checkCache(client)) {
+        return true;
+    }
+
+    const CompiledLocation* compiled = locConf->compiled;
+    bool pooled = usesCgiPool(locConf, scriptPath);
+
+    // fork-exec CGI: 이벤트 루프를 막지 않도록 비동기로 실행하고, 받은 바디를 한 번에 넘김
+    if (compiled->fastcgiPass.empty() && !pooled) {
+        if (!_cgi->submit(client, scriptPath, false)) {
+            return false;
+        }
+        DEBUG_LOG("[Server] request dispatched to CGI " << scriptPath);
+        return true;
+    }
+
+    if (!_fastcgi->submit(client, scriptPath, false)) {
+        ERROR_LOG("[Server] " << (compiled->fastcgiPass.empty() ? "cgi_pool " + compiled->cgiPoolInterpreter
+                                                                 : "fastcgi_pass " + compiled->fastcgiPass)
+                  << " unavailable");
+        client->setResponse(new HttpResponse(
+            HttpResponse::createErrorResponse(StatusCode::BAD_GATEWAY, serverConf, locConf)
+        ));
+        _event_loop->setWritable(client->getFd(), true);
+        return true;
+    }
+
+    DEBUG_LOG("[Server] request dispatched to " << (compiled->fastcgiPass.empty() ? "cgi_pool" : "fastcgi_pass"));
+    return true;
+}
+
+bool Server::startCgiStream(Client* client) {
+    std::string scriptPath;
+    if (!resolveCgiScript(client, scriptPath)) {
+        return false;
+    }
+    const LocationContext* locConf = client->getLocationContext();
+    if (locConf->compiled->fastcgiPass.empty() && !usesCgiPool(locConf, scriptPath)) {
+        return _cgi->submit(client, scriptPath, true);
+    }
+
+    // 업스트림에 연결하지 못하면 바디를 받지 않고 502 (Step 3에서 다시 시도하지 않도록 true)
+    if (!_fastcgi->submit(client, scriptPath, true)) {
+        ERROR_LOG("[Server] " << (locConf->compiled->fastcgiPass.empty()
+                                  ? "cgi_pool " + locConf->compiled->cgiPoolInterpreter
+                                  : "fastcgi_pass " + locConf->compiled->fastcgiPass) << " unavailable");
+        client->setResponse(new HttpResponse(
+            HttpResponse::createErrorResponse(StatusCode::BAD_GATEWAY, client->getServerContext(), locConf)
+        ));
+        _event_loop->setWritable(client->getFd(), true);
+    }
+    return true;
+}
+
+// 업스트림에 연결하지 못하면 바로 502로 응답
+bool Server::startProxy(Client* client, bool streamBody) {
+    const LocationContext* locConf = client->getLocationContext();
+
+    if (!_proxy->submit(client, streamBody)) {
+        ERROR_LOG("[Server] proxy_pass " << locConf->compiled->proxyPass << " unavailable");
+        client->setResponse(new HttpResponse(
+            HttpResponse::createErrorResponse(StatusCode::BAD_GATEWAY, client->getServerContext(), locConf)
+        ));
+        _event_loop->setWritable(client->getFd(), true);
+        return true;
+    }
+    DEBUG_LOG("[Server] request dispatched to proxy_pass " << locConf->compiled->proxyPass);
+    return true;
+}
+
+// 캐시가 응답했거나 같은 키를 채우는 요청을 기다리면 true (채우는 요청은 평소대로 처리)
+bool Server::checkCache(Client* client) {
+    if (client->getLocationContext()->compiled->cacheZone == NULL) {
+        return false;
+    }
+    ResponseCache::Result result = _cache->lookup(client);
+    return result == ResponseCache::HIT || result == ResponseCache::WAIT;
+}
+
+// chunked 바디는 길이를 미리 알 수 없으므로 다 받아서 디코딩한 뒤 넘김
+bool Server::canStreamBody(Client* client) const {
+    HttpRequest* request = client->getRequest();
+
+    return !request->isChunkedEncoding() && request->getContentLength() > 0
+        && request->getContentLength() <= client->getMaxBodySize();
+}
+
+bool Server::usesProxy(Client* client) const {
+    const LocationContext* locConf = client->getLocationContext();
+
+    return client->getServerContext() && locConf && locConf->opReturnDirective.empty()
+        && !locConf->compiled->proxyPass.empty();
+}
+
+// 비동기로 처리할 CGI/FastCGI 요청이면 스크립트 경로를 채움 (404 등은 HttpController가 처리)
+bool Server::resolveCgiScript(Client* client, std::string& scriptPath) const {
+    const ServerContext* serverConf = client->getServerContext();
+    const LocationContext* locConf = client->getLocationContext();
+
+    if (!serverConf || !locConf || !locConf->opReturnDirective.empty()) {
+        return false;
+    }
+
+    const CompiledLocation* compiled = locConf->compiled;
+    if (compiled->fastcgiPass.empty() && !compiled->isCgi) {
+        return false;
+    }
+
+    const std::string& uri = client->getRequest()->getUri();
+    scriptPath = PathResolver::resolvePath(serverConf, locConf, uri.substr(0, uri.find('?')));
+
+    if (!compiled->fastcgiPass.empty()) {
+        return true;
+    }
+    if (FileUtils::pathExists(scriptPath) && FileUtils::isDirectory(scriptPath)) {
+        return false;
+    }
+    return CgiExecutor::canExecute(scriptPath, locConf);
+}
+
+// cgi_pool: 풀 인터프리터로 실행되는 기존 스크립트만 워커로 보냄 (nph 스크립트는 relay를 위해 제외)
+bool Server::usesCgiPool(const LocationContext* locConf, const std::string& scriptPath) const {
+    const CompiledLocation* compiled = locConf->compiled;
+
+    return compiled->cgiPoolWorkers > 0 && FileUtils::pathExists(scriptPath)
+        && CgiExecutor::resolveInterpreter(scriptPath, locConf) == compiled->cgiPoolInterpreter
+        && !CgiExecutor::isNph(scriptPath, locConf);
+}
+
+// TLS 핸드셰이크를 진행. 끝나면 ALPN으로 h2를 고른 연결은 바로 HTTP/2로 넘김
+void Server::continueHandshake(Client* client) {
+    int fd = client->getFd();
+    TlsConnection* tls = client->getTls();
+    int result = tls->handshake();
+
+    if (result < 0) {
+        onHangup(fd);
+        return;
+    }
+    client->updateActivity();
+    _event_loop->setWritable(fd, result == 0 && tls->wantsWrite());
+    if (result > 0 && tls->getProtocol() == "h2") {
+        startHttp2(client, false);
+    }
+}
+
+// Client를 지우고 같은 fd를 Http2Connection이 이어 씀 (Client는 fd를 닫지 않음, TLS 상태는 넘겨받음)
+void Server::startHttp2(Client* client, bool upgrade) {
+    int fd = client->getFd();
+    Http2Connection* connection = new Http2Connection(fd, client->getPort(), client->releaseTls(),
+                                                      client->getRemoteAddress());
+    std::string input = client->takeBufferedInput();
+
+    _http2[fd] = connection;
+    bool alive = upgrade ? connection->startUpgrade(client->getRequest(), input) : connection->start(input);
+    _clients.erase(fd);
+    delete client;
+
+    DEBUG_LOG("[Server] HTTP/2 " << (upgrade ? "upgrade" : "prior knowledge") << ": fd=" << fd);
+    updateHttp2(fd, alive);
+}
+
+void Server::updateHttp2(int fd, bool alive) {
+    if (!alive) {
+        onHangup(fd);
+        return;
+    }
+    _event_loop->setWritable(fd, _http2[fd]->needsWriteEvent());
+}
+
 void Server::onWritable(int fd) {
+	std::map<int, Http2Connection*>::iterator connection = _http2.find(fd);
+	if (connection != _http2.end()) {
+		updateHttp2(fd, connection->second->onWritable());
+		return;
+	}
+
 	std::map<int, Client*>::iterator it = _clients.find(fd);
 	if (it != _clients.end()) {
 		Client* client = it->second;
 
-		if (!client->handleWrite()) {
+		if (client->getTls() && !client->getTls()->isEstablished()) {
+			continueHandshake(client);
+		} else if (!client->handleWrite()) {
 			onHangup(fd);
 		} else if (!client->needsWriteEvent()) {
 			_event_loop->setWritable(fd, false);
@@ -338,4 +723,10 @@ void Server::onHangup(int fd) {
 
 void Server::onTick(void) {
 	cleanupExpiredClients();
+	_fastcgi->onTick();
+	_cgi->onTick();
+	_proxy->onTick();
+	_cache->onTick();
+	ResponseCompressor::updateLoad();
+	AccessLog::onTick();
 }
@@ -0,0 +1,133 @@
+#include "tls/TlsConnection.hpp"
+#include "webserv.hpp"
+#include <openssl/err.h>
+#include <openssl/bio.h>
+#include <algorithm>
+#include <climits>
+#include <cerrno>
+
+const size_t TlsConnection::FILE_CHUNK = 16384;
+
+TlsConnection::TlsConnection(SSL* ssl)
+	: _ssl(ssl), _established(false), _failed(false), _wantWrite(false), _ktlsSend(false) {}
+
+TlsConnection::~TlsConnection() {
+	shutdown();
+	SSL_free(_ssl);
+}
+
+// SSL 에러를 recv/send 식으로 바꿈: 소켓을 기다려야 하면 -1 + EAGAIN, close_notify면 0
+ssize_t TlsConnection::fail(int ret) {
+	int error = SSL_get_error(_ssl, ret);
+
+	if (error == SSL_ERROR_WANT_READ || error == SSL_ERROR_WANT_WRITE) {
+		_wantWrite = (error == SSL_ERROR_WANT_WRITE);
+		errno = EAGAIN;
+		return -1;
+	}
+	if (error == SSL_ERROR_ZERO_RETURN) {
+		return 0;
+	}
+	DEBUG_LOG("[Tls] error " << error << ": " << ERR_reason_error_string(ERR_peek_error()));
+	ERR_clear_error();
+	_failed = true;
+	errno = ECONNRESET;
+	return -1;
+}
+
+int TlsConnection::handshake() {
+	ERR_clear_error();
+	int ret = SSL_do_handshake(_ssl);
+	if (ret != 1) {
+		return fail(ret) < 0 && errno == EAGAIN ? 0 : -1;
+	}
+
+	_established = true;
+	_wantWrite = false;
+	_ktlsSend = BIO_get_ktls_send(SSL_get_wbio(_ssl)) != 0;
+	DEBUG_LOG("[Tls] handshake done: " << SSL_get_version(_ssl)
+			  << (SSL_session_reused(_ssl) ? " (resumed)" : "")
+			  << " alpn=" << (getProtocol().empty() ? "-" : getProtocol())
+			  << (_ktlsSend ? " ktls" : ""));
+	return 1;
+}
+
+bool TlsConnection::isEstablished() const {
+	return _established;
+}
+
+bool TlsConnection::wantsWrite() const {
+	return _wantWrite;
+}
+
+std::string TlsConnection::getProtocol() const {
+	const unsigned char* name = NULL;
+	unsigned int len = 0;
+	SSL_get0_alpn_selected(_ssl, &name, &len);
+	return std::string(reinterpret_cast<const char*>(name), len);
+}
+
+// 레코드 단위로 복호화된 바이트를 len까지 채움
+ssize_t TlsConnection::read(char* buffer, size_t len) {
+	size_t total = 0;
+
+	ERR_clear_error();
+	while (total < len) {
+		int ret = SSL_read(_ssl, buffer + total, static_cast<int>(std::min(len - total, static_cast<size_t>(INT_MAX))));
+		if (ret <= 0) {
+			ssize_t result = fail(ret);
+			return total > 0 ? static_cast<ssize_t>(total) : result;
+		}
+		total += ret;
+		if (SSL_pending(_ssl) == 0) {
+			break;
+		}
+	}
+	return total;
+}
+
+bool TlsConnection::hasPendingInput() const {
+	return SSL_pending(_ssl) > 0;
+}
+
+ssize_t TlsConnection::write(const char* data, size_t len) {
+	ERR_clear_error();
+	int ret = SSL_write(_ssl, data, static_cast<int>(std::min(len, static_cast<size_t>(INT_MAX))));
+	if (ret > 0) {
+		return ret;
+	}
+	return fail(ret);
+}
+
+// kTLS면 커널이 파일을 바로 암호화해 보냄. 아니면 FILE_CHUNK씩 읽어 SSL_write
+// (EAGAIN 뒤에는 같은 offset으로 다시 불려 같은 크기의 데이터를 다시 씀)
+ssize_t TlsConnection::sendFile(int fd, off_t offset, size_t len) {
+	if (_ktlsSend) {
+		ERR_clear_error();
+		ossl_ssize_t sent = SSL_sendfile(_ssl, fd, offset, len, 0);
+		if (sent >= 0) {
+			return sent;
+		}
+		return fail(static_cast<int>(sent));
+	}
+
+	char buffer[FILE_CHUNK];
+	ssize_t bytes = ::pread(fd, buffer, std::min(len, FILE_CHUNK), offset);
+	if (bytes <= 0) {
+		return bytes;
+	}
+	return write(buffer, bytes);
+}
+
+bool TlsConnection::canWriteSocket() const {
+	return _ktlsSend;
+}
+
+void TlsConnection::shutdown() {
+	if (!_established || _failed || (SSL_get_shutdown(_ssl) & SSL_SENT_SHUTDOWN)) {
+		return;
+	}
+	ERR_clear_error();
+	SSL_shutdown(_ssl);
+	ERR_clear_error();
+}
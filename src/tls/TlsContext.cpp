@@ -0,0 +1,183 @@
+#include "tls/TlsContext.hpp"
+#include "tls/TlsConnection.hpp"
+#include "config/ConfApplicator.hpp"
+#include "http/VirtualHostTable.hpp"
+#include "http2/Http2Connection.hpp"
+#include "dto/ConfigDTO.hpp"
+#include "webserv.hpp"
+#include <openssl/err.h>
+#include <cstring>
+
+const long TlsContext::SESSION_CACHE_SIZE = 20480;
+const long TlsContext::SESSION_TIMEOUT = 300;
+
+std::map<const ServerContext*, TlsContext*> TlsContext::_contexts;
+
+// ALPN 선호 순서 (길이 + 이름 목록)
+static const unsigned char ALPN_PROTOCOLS[] = {
+	2, 'h', '2',
+	8, 'h', 't', 't', 'p', '/', '1', '.', '1'
+};
+static const unsigned char ALPN_HTTP1_ONLY[] = {
+	8, 'h', 't', 't', 'p', '/', '1', '.', '1'
+};
+
+TlsContext::TlsContext(SSL_CTX* ctx, int port, bool http2) : _ctx(ctx), _port(port), _http2(http2) {}
+
+// 진행 중인 연결은 SSL_CTX 참조를 가지고 있으므로 그대로 끝까지 동작함
+TlsContext::~TlsContext() {
+	SSL_CTX_free(_ctx);
+}
+
+std::string TlsContext::lastError() {
+	unsigned long code = ERR_get_error();
+	ERR_clear_error();
+	if (code == 0) {
+		return "unknown error";
+	}
+	char buffer[256];
+	ERR_error_string_n(code, buffer, sizeof(buffer));
+	return buffer;
+}
+
+TlsContext* TlsContext::create(const ServerContext* server, int port) {
+	TlsContext* existing = find(server);
+	if (existing != NULL) {
+		return existing;
+	}
+
+	const std::string& certificate = server->opSslCertificateDirective[0].path;
+	const std::string& key = server->opSslCertificateKeyDirective[0].path;
+
+	SSL_CTX* ctx = SSL_CTX_new(TLS_server_method());
+	if (ctx == NULL) {
+		ERROR_LOG("[Tls] SSL_CTX_new failed: " << lastError());
+		return NULL;
+	}
+	if (SSL_CTX_use_certificate_chain_file(ctx, certificate.c_str()) != 1
+		|| SSL_CTX_use_PrivateKey_file(ctx, key.c_str(), SSL_FILETYPE_PEM) != 1
+		|| SSL_CTX_check_private_key(ctx) != 1) {
+		ERROR_LOG("[Tls] failed to load " << certificate << " / " << key << ": " << lastError());
+		SSL_CTX_free(ctx);
+		return NULL;
+	}
+
+	SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
+	// 레코드가 일부만 나가면 다음 write에서 이어 보냄 (그 사이 버퍼가 옮겨져도 됨)
+	SSL_CTX_set_mode(ctx, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER
+						  | SSL_MODE_RELEASE_BUFFERS);
+	SSL_CTX_set_options(ctx, SSL_OP_NO_RENEGOTIATION | SSL_OP_CIPHER_SERVER_PREFERENCE);
+#ifdef SSL_OP_IGNORE_UNEXPECTED_EOF
+	// close_notify 없이 끊는 클라이언트도 정상 종료로 처리
+	SSL_CTX_set_options(ctx, SSL_OP_IGNORE_UNEXPECTED_EOF);
+#endif
+#ifdef SSL_OP_ENABLE_KTLS
+	// 커널이 지원하지 않으면 OpenSSL이 그대로 사용자 공간에서 암호화함
+	SSL_CTX_set_options(ctx, SSL_OP_ENABLE_KTLS);
+#endif
+
+	// 세션 재사용: 세션 ID(서버 캐시)와 세션 티켓 모두 허용
+	SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+	SSL_CTX_sess_set_cache_size(ctx, SESSION_CACHE_SIZE);
+	SSL_CTX_set_timeout(ctx, SESSION_TIMEOUT);
+	SSL_CTX_set_session_id_context(ctx, reinterpret_cast<const unsigned char*>("webserv"), 7);
+	SSL_CTX_clear_options(ctx, SSL_OP_NO_TICKET);
+
+	TlsContext* context = new TlsContext(ctx, port, supportsHttp2(port));
+	SSL_CTX_set_tlsext_servername_callback(ctx, selectServerName);
+	SSL_CTX_set_tlsext_servername_arg(ctx, context);
+	SSL_CTX_set_alpn_select_cb(ctx, selectProtocol, context);
+
+	_contexts[server] = context;
+	INFO_LOG("[Tls] loaded certificate " << certificate);
+	return context;
+}
+
+// h2 연결의 요청은 :authority에 따라 포트의 어느 server로도 갈 수 있으므로,
+// HTTP/1.1로만 처리하는 location(CGI, 프록시 등)이 하나라도 있으면 그 포트에서는 h2를 고르지 않음
+bool TlsContext::supportsHttp2(int port) {
+	const ConfigDTO* config = ConfApplicator::getGlobalConfig();
+	if (config == NULL) {
+		return true;
+	}
+	const std::vector<ServerContext>& servers = config->httpContext.serverContexts;
+	for (size_t i = 0; i < servers.size(); ++i) {
+		bool listens = false;
+		for (size_t j = 0; j < servers[i].opListenDirective.size(); ++j) {
+			listens = listens || servers[i].opListenDirective[j].port == port;
+		}
+		if (!listens) {
+			continue;
+		}
+		const std::vector<LocationContext>& locations = servers[i].locationContexts;
+		for (size_t j = 0; j < locations.size(); ++j) {
+			if (Http2Connection::requiresHttp1(&locations[j])) {
+				INFO_LOG("[Tls] port " << port << ": h2 disabled, location " << locations[j].path
+						 << " requires HTTP/1.1");
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+TlsContext* TlsContext::find(const ServerContext* server) {
+	std::map<const ServerContext*, TlsContext*>::const_iterator it = _contexts.find(server);
+	return it == _contexts.end() ? NULL : it->second;
+}
+
+void TlsContext::clear() {
+	for (std::map<const ServerContext*, TlsContext*>::iterator it = _contexts.begin(); it != _contexts.end(); ++it) {
+		delete it->second;
+	}
+	_contexts.clear();
+}
+
+TlsConnection* TlsContext::accept(int fd) const {
+	SSL* ssl = SSL_new(_ctx);
+	if (ssl == NULL) {
+		ERROR_LOG("[Tls] SSL_new failed: " << lastError());
+		return NULL;
+	}
+	if (SSL_set_fd(ssl, fd) != 1) {
+		ERROR_LOG("[Tls] SSL_set_fd failed: " << lastError());
+		SSL_free(ssl);
+		return NULL;
+	}
+	SSL_set_accept_state(ssl);
+	return new TlsConnection(ssl);
+}
+
+// SNI: 이름에 맞는 server 블록의 인증서로 바꿈 (TLS가 아닌 server면 기본 인증서 유지)
+int TlsContext::selectServerName(SSL* ssl, int* alert, void* arg) {
+	(void)alert;
+	const TlsContext* self = static_cast<const TlsContext*>(arg);
+	const char* name = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+	const VirtualHostTable* hosts = ConfApplicator::getVirtualHosts();
+
+	if (name == NULL || hosts == NULL) {
+		return SSL_TLSEXT_ERR_OK;
+	}
+	TlsContext* target = find(hosts->find(self->_port, name, std::strlen(name)));
+	if (target != NULL && target->_ctx != SSL_get_SSL_CTX(ssl)) {
+		SSL_set_SSL_CTX(ssl, target->_ctx);
+	}
+	return SSL_TLSEXT_ERR_OK;
+}
+
+// ALPN: 클라이언트가 h2를 보내면 h2, 아니면 http/1.1 (겹치는 게 없으면 ALPN 없이 진행)
+// SNI로 컨텍스트를 바꿨으면 arg는 바꾼 server의 컨텍스트
+int TlsContext::selectProtocol(SSL* ssl, const unsigned char** out, unsigned char* outlen,
+							   const unsigned char* in, unsigned int inlen, void* arg) {
+	(void)ssl;
+	const TlsContext* self = static_cast<const TlsContext*>(arg);
+	const unsigned char* protocols = self->_http2 ? ALPN_PROTOCOLS : ALPN_HTTP1_ONLY;
+	unsigned int length = self->_http2 ? sizeof(ALPN_PROTOCOLS) : sizeof(ALPN_HTTP1_ONLY);
+	unsigned char* selected = NULL;
+	if (SSL_select_next_proto(&selected, outlen, protocols, length, in, inlen)
+		!= OPENSSL_NPN_NEGOTIATED) {
+		return SSL_TLSEXT_ERR_NOACK;
+	}
+	*out = selected;
+	return SSL_TLSEXT_ERR_OK;
+}
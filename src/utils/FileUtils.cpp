@@ -1,4 +1,5 @@
 #include "utils/FileUtils.hpp"
+#include "http/MimeTypes.hpp"
 #include <algorithm>
 #include <cctype>
 #include <cstdlib>
@@ -6,75 +7,11 @@
 #include <unistd.h>
 
 std::string FileUtils::getMimeType(const std::string& extension) {
-    std::string ext = toLowerCase(extension);
-
-    // HTML/CSS/JavaScript
-    if (ext == "html" || ext == "htm") return "text/html";
-    if (ext == "css") return "text/css";
-    if (ext == "js") return "application/javascript";
-    if (ext == "json") return "application/json";
-
-    // Images
-    if (ext == "jpg" || ext == "jpeg") return "image/jpeg";
-    if (ext == "png") return "image/png";
-    if (ext == "gif") return "image/gif";
-    if (ext == "svg") return "image/svg+xml";
-    if (ext == "ico") return "image/x-icon";
-    if (ext == "bmp") return "image/bmp";
-    if (ext == "webp") return "image/webp";
-
-    // Text
-    if (ext == "txt") return "text/plain";
-    if (ext == "xml") return "application/xml";
-    if (ext == "csv") return "text/csv";
-
-    // Video
-    if (ext == "mp4") return "video/mp4";
-    if (ext == "avi") return "video/x-msvideo";
-    if (ext == "mov") return "video/quicktime";
-    if (ext == "wmv") return "video/x-ms-wmv";
-    if (ext == "webm") return "video/webm";
-
-    // Audio
-    if (ext == "mp3") return "audio/mpeg";
-    if (ext == "wav") return "audio/wav";
-    if (ext == "ogg") return "audio/ogg";
-    if (ext == "aac") return "audio/aac";
-
-    // Documents
-    if (ext == "pdf") return "application/pdf";
-    if (ext == "doc") return "application/msword";
-    if (ext == "docx") return "application/vnd.openxmlformats-officedocument.wordprocessingml.document";
-    if (ext == "xls") return "application/vnd.ms-excel";
-    if (ext == "xlsx") return "application/vnd.openxmlformats-officedocument.spreadsheetml.sheet";
-    if (ext == "ppt") return "application/vnd.ms-powerpoint";
-    if (ext == "pptx") return "application/vnd.openxmlformats-officedocument.presentationml.presentation";
-
-    // Archives
-    if (ext == "zip") return "application/zip";
-    if (ext == "tar") return "application/x-tar";
-    if (ext == "gz") return "application/gzip";
-    if (ext == "rar") return "application/vnd.rar";
-    if (ext == "7z") return "application/x-7z-compressed";
-
-    // Fonts
-    if (ext == "woff") return "font/woff";
-    if (ext == "woff2") return "font/woff2";
-    if (ext == "ttf") return "font/ttf";
-    if (ext == "eot") return "application/vnd.ms-fontobject";
-
-    // CGI scripts
-    if (ext == "php") return "application/x-httpd-php";
-    if (ext == "py") return "text/x-python";
-    if (ext == "pl") return "text/x-perl";
-    if (ext == "rb") return "text/x-ruby";
-
-    return "application/octet-stream";
+    return MimeTypes::lookup(extension);
 }
 
 std::string FileUtils::getMimeTypeFromPath(const std::string& filepath) {
-    std::string ext = getExtension(filepath);
-    return getMimeType(ext);
+    return MimeTypes::fromPath(filepath);
 }
 
 bool FileUtils::isPathSecure(const std::string& path) {
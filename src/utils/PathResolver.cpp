@@ -1,6 +1,8 @@
 #include "utils/PathResolver.hpp"
 #include "utils/FileUtils.hpp"
+#include "config/CompiledLocation.hpp"
 #include "utils/Common.hpp"
+#include "log/RequestTrace.hpp"
 
 
 // 메인 경로 해석 함수
@@ -9,9 +11,10 @@ std::string PathResolver::resolvePath(
 	const LocationContext* loc, 
 	const std::string& uri) 
 {
+	RequestTrace::Timer timer(RequestTrace::PHASE_RESOLVE);
 	DEBUG_LOG("[PathResolver] Input URI: " << uri);
 	
-	if (server == NULL || loc == NULL) {
+	if (server == NULL || loc == NULL || loc->compiled == NULL) {
 		ERROR_LOG("[PathResolver] NULL server or location context");
 		return "";
 	}
@@ -25,10 +28,10 @@ std::string PathResolver::resolvePath(
 			return resolveExactPath(loc, uri);
 			
 		case MATCH_EXTENSION:
-			return resolveExtensionPath(server, loc, uri);
+			return resolveExtensionPath(loc, uri);
 			
 		case MATCH_PREFIX:
-			return resolvePrefixPath(server, loc, uri);
+			return resolvePrefixPath(loc, uri);
 			
 		default:
 			ERROR_LOG("[PathResolver] Unknown match type: " << loc->matchType);
@@ -43,16 +46,17 @@ std::string PathResolver::resolveExactPath(
 {
 	DEBUG_LOG("[PathResolver] EXACT match - URI: " << uri);
 	
+	const CompiledLocation* compiled = loc->compiled;
+
 	// EXACT 매칭: alias가 정확한 파일/디렉토리를 가리킴
-	if (!loc->opAliasDirective.empty()) {
-		std::string resolved = loc->opAliasDirective[0].path;
-		DEBUG_LOG("[PathResolver] Using alias: " << resolved);
-		return FileUtils::normalizePath(resolved);
+	if (compiled->hasAlias) {
+		DEBUG_LOG("[PathResolver] Using alias: " << compiled->alias);
+		return FileUtils::normalizePath(compiled->alias);
 	}
 	
 	// alias 없으면 root 사용
-	if (!loc->opRootDirective.empty()) {
-		std::string resolved = loc->opRootDirective[0].path + uri;
+	if (!compiled->documentRoot.empty()) {
+		std::string resolved = compiled->documentRoot + uri;
 		DEBUG_LOG("[PathResolver] Using root: " << resolved);
 		return FileUtils::normalizePath(resolved);
 	}
@@ -63,7 +67,6 @@ std::string PathResolver::resolveExactPath(
 
 // MATCH_EXTENSION 처리
 std::string PathResolver::resolveExtensionPath(
-	const ServerContext* server,
 	const LocationContext* loc,
 	const std::string& uri)
 {
@@ -80,18 +83,9 @@ std::string PathResolver::resolveExtensionPath(
 		DEBUG_LOG("[PathResolver] EXTENSION: Extracted filename: " << filename);
 	}
 
-	std::string root_path;
-
-	if (!loc->opRootDirective.empty()) {
-		root_path = loc->opRootDirective[0].path;
-		DEBUG_LOG("[PathResolver] Using root from location: " << root_path);
-	} else if (server != NULL && !server->opRootDirective.empty()) {
-		root_path = server->opRootDirective[0].path;
-		DEBUG_LOG("[PathResolver] Using root from server: " << root_path);
-	} else {
-		root_path = "/var/www/html";
-		DEBUG_LOG("[PathResolver] Using default root: " << root_path);
-	}
+	// root 우선순위(location > server > default)는 컴파일 시 확정됨
+	const std::string& root_path = loc->compiled->root;
+	DEBUG_LOG("[PathResolver] Using root: " << root_path);
 
 	// root + filename 조합
 	// filename이 /로 시작하면 제거 (root_path와 중복 방지)
@@ -108,7 +102,6 @@ std::string PathResolver::resolveExtensionPath(
 
 // MATCH_PREFIX 처리
 std::string PathResolver::resolvePrefixPath(
-	const ServerContext* server,
 	const LocationContext* loc, 
 	const std::string& uri) 
 {
@@ -116,12 +109,12 @@ std::string PathResolver::resolvePrefixPath(
 			  << " Location: " << loc->path);
 	
 	// 1. alias 우선 처리
-	if (!loc->opAliasDirective.empty()) {
+	if (loc->compiled->hasAlias) {
 		return resolveWithAlias(loc, uri);
 	}
 	
 	// 2. alias 없으면 root 사용
-	return resolveWithRoot(server, loc, uri);
+	return resolveWithRoot(loc, uri);
 }
 
 // alias를 사용한 경로 해석
@@ -129,7 +122,7 @@ std::string PathResolver::resolveWithAlias(
 	const LocationContext* loc,
 	const std::string& uri)
 {
-	const std::string& alias_path = loc->opAliasDirective[0].path;
+	const std::string& alias_path = loc->compiled->alias;
 	const std::string& location_path = loc->path;
 	
 	DEBUG_LOG("[PathResolver] Using alias: " << alias_path);
@@ -158,23 +151,12 @@ std::string PathResolver::resolveWithAlias(
 
 // root를 사용한 경로 해석
 std::string PathResolver::resolveWithRoot(
-	const ServerContext* server,
 	const LocationContext* loc,
 	const std::string& uri)
 {
-	std::string root_path;
-	
-	// root 우선순위: location > server > default
-	if (!loc->opRootDirective.empty()) {
-		root_path = loc->opRootDirective[0].path;
-		DEBUG_LOG("[PathResolver] Using root from location: " << root_path);
-	} else if (server != NULL && !server->opRootDirective.empty()) {
-		root_path = server->opRootDirective[0].path;
-		DEBUG_LOG("[PathResolver] Using root from server: " << root_path);
-	} else {
-		root_path = "/var/www/html";
-		DEBUG_LOG("[PathResolver] Using default root: " << root_path);
-	}
+	// root 우선순위(location > server > default)는 컴파일 시 확정됨
+	const std::string& root_path = loc->compiled->root;
+	DEBUG_LOG("[PathResolver] Using root: " << root_path);
 	
 	std::string resolved = root_path + "/" + uri;
 	
@@ -187,16 +169,18 @@ std::string PathResolver::findIndexFile(
 	const std::string& dirPath, 
 	const LocationContext* loc)
 {
+	RequestTrace::Timer timer(RequestTrace::PHASE_RESOLVE);
 	DEBUG_LOG("[PathResolver] Finding index file in: " << dirPath);
 	
-	if (loc == NULL || loc->opIndexDirective.empty()) {
+	if (loc == NULL || loc->compiled == NULL || loc->compiled->indexFiles.empty()) {
 		DEBUG_LOG("[PathResolver] No index directive");
 		return "";
 	}
 
 	// 설정된 index 파일들을 순서대로 검사
-	for (size_t i = 0; i < loc->opIndexDirective.size(); ++i) {
-		std::string index_file = loc->opIndexDirective[i].filename;
+	const std::vector<std::string>& indexFiles = loc->compiled->indexFiles;
+	for (size_t i = 0; i < indexFiles.size(); ++i) {
+		const std::string& index_file = indexFiles[i];
 		
 		std::string full_path = dirPath + "/" + index_file;
 		full_path = FileUtils::normalizePath(full_path);